@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+
+#
+#  Program: 3D Slicer
+#
+#  Copyright (c) Kitware Inc.
+#
+#  See COPYRIGHT.txt
+#  or http://www.slicer.org/copyright/copyright.txt for details.
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#
+
+import os
+import sys
+
+from SlicerAppTesting import *
+
+"""
+Usage:
+    SlicerOptionLazyModuleLoadingTest.py /path/to/Slicer /path/to/volume
+"""
+
+# Code run by the application started with "--lazy-module-loading"
+checkLazyLoadingCode = """
+import slicer
+factoryManager = slicer.app.moduleManager().factoryManager()
+assert factoryManager.lazyLoading, "Lazy loading is not enabled"
+
+# Modules that register IO or that other modules depend on are loaded at startup
+for moduleName in factoryManager.instantiatedModuleNames():
+  if not factoryManager.isLoadedOnDemand(moduleName):
+    assert factoryManager.isLoaded(moduleName), "Module %s is not loaded at startup" % moduleName
+assert not factoryManager.isLoadedOnDemand('Volumes'), "Volumes module registers IO"
+assert 'volumes' in dir(slicer.modules), "slicer.modules.volumes is not set"
+
+# Readers are registered
+volumeNode = slicer.util.loadVolume(r'{volume}', returnNode=True)[1]
+assert volumeNode is not None, "Failed to load volume"
+
+# Other modules are loaded when they are first accessed
+onDemandModuleNames = [moduleName for moduleName in factoryManager.instantiatedModuleNames()
+                       if factoryManager.isLoadedOnDemand(moduleName)]
+assert len(onDemandModuleNames) > 0, "No module is loaded on demand"
+for moduleName in onDemandModuleNames:
+  assert not factoryManager.isLoaded(moduleName), "Module %s is loaded at startup" % moduleName
+moduleName = onDemandModuleNames[0]
+module = getattr(slicer.modules, moduleName.lower())
+assert module is not None, "Failed to access slicer.modules.%s" % moduleName.lower()
+assert factoryManager.isLoaded(moduleName), "Module %s is not loaded on demand" % moduleName
+assert slicer.app.moduleManager().module(moduleName) is not None, "Module %s is not returned by the module manager" % moduleName
+
+# Modules loaded on demand are listed and loaded by the module manager
+moduleManager = slicer.app.moduleManager()
+for onDemandModuleName in onDemandModuleNames:
+  assert onDemandModuleName in moduleManager.modulesNames(), "Module %s is not listed" % onDemandModuleName
+if len(onDemandModuleNames) > 1:
+  moduleName = onDemandModuleNames[1]
+  assert slicer.util.getModule(moduleName) is not None, "Failed to get module %s" % moduleName
+  assert factoryManager.isLoaded(moduleName), "Module %s is not loaded by module()" % moduleName
+
+# Scripted modules that implement setup() are loaded at startup
+if 'SegmentStatistics' in factoryManager.instantiatedModuleNames():
+  assert not factoryManager.isLoadedOnDemand('SegmentStatistics'), "SegmentStatistics registers plugins in setup()"
+"""
+
+if __name__ == '__main__':
+
+  if len(sys.argv) != 3:
+    print(os.path.basename(sys.argv[0]) +" /path/to/Slicer /path/to/volume")
+    exit(EXIT_FAILURE)
+
+  slicer_executable = os.path.expanduser(sys.argv[1])
+  volume_path = os.path.expanduser(sys.argv[2])
+
+  args = ['--testing', '--disable-settings', '--no-main-window', '--lazy-module-loading']
+  args.extend(['--python-code', checkLazyLoadingCode.format(volume=volume_path)])
+  (returnCode, stdout, stderr) = runSlicerAndExit(slicer_executable, args)
+  assert returnCode == EXIT_SUCCESS
+  print("=> ok\n")
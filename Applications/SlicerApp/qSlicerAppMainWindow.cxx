@@ -64,6 +64,7 @@
 #include "qSlicerCommandOptions.h"
 #include "qSlicerCoreCommandOptions.h"
 #include "qSlicerLayoutManager.h"
+#include "qSlicerModuleFactoryManager.h"
 #include "qSlicerModuleManager.h"
 #include "qSlicerModulesMenu.h"
 #include "qSlicerModuleSelectorToolBar.h"
@@ -182,6 +183,8 @@ void qSlicerAppMainWindowPrivate::setupUi(QMainWindow * mainWindow)
 
   QObject::connect(moduleManager,SIGNAL(moduleLoaded(QString)),
                    q, SLOT(onModuleLoaded(QString)));
+  QObject::connect(moduleManager,SIGNAL(moduleDeferred(QString)),
+                   q, SLOT(onModuleLoaded(QString)));
 
   QObject::connect(moduleManager, SIGNAL(moduleAboutToBeUnloaded(QString)),
                    q, SLOT(onModuleAboutToBeUnloaded(QString)));
@@ -1031,8 +1034,9 @@ void qSlicerAppMainWindow::on_HelpKeyboardShortcutsAction_triggered()
   qSlicerModuleManager * moduleManager = qSlicerApplication::application()->moduleManager();
   foreach(const QString& moduleName, moduleManager->modulesNames())
     {
-    qSlicerAbstractModule* module =
-      qobject_cast<qSlicerAbstractModule*>(moduleManager->module(moduleName));
+    // Don't load the modules that are loaded on demand
+    qSlicerAbstractModule* module = qobject_cast<qSlicerAbstractModule*>(
+      moduleManager->factoryManager()->moduleInstance(moduleName));
     if (module)
       {
       moduleActions << module->action();
@@ -1432,8 +1436,9 @@ void qSlicerAppMainWindow::onModuleLoaded(const QString& moduleName)
 {
   Q_D(qSlicerAppMainWindow);
 
-  qSlicerAbstractCoreModule* coreModule =
-    qSlicerApplication::application()->moduleManager()->module(moduleName);
+  // Don't use module(), it would load the modules that are loaded on demand
+  qSlicerAbstractCoreModule* coreModule = qSlicerApplication::application()
+    ->moduleManager()->factoryManager()->moduleInstance(moduleName);
   qSlicerAbstractModule* module = qobject_cast<qSlicerAbstractModule*>(coreModule);
   if (!module)
     {
@@ -207,10 +207,11 @@ class ScriptedLoadableModuleLogic():
     Return the first available parameter node for this module
     If no parameter nodes are available for this module then a new one is created.
     """
-    numberOfScriptedModuleNodes =  slicer.mrmlScene.GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode")
-    for nodeIndex in xrange(numberOfScriptedModuleNodes):
-      parameterNode  = slicer.mrmlScene.GetNthNodeByClass( nodeIndex, "vtkMRMLScriptedModuleNode" )
-      if parameterNode.GetAttribute("ModuleName") == self.moduleName:
+    nodes = slicer.mrmlScene.GetNodesByAttribute("ModuleName", self.moduleName)
+    nodes.UnRegister(slicer.mrmlScene)
+    for nodeIndex in xrange(nodes.GetNumberOfItems()):
+      parameterNode = nodes.GetItemAsObject(nodeIndex)
+      if parameterNode.IsA("vtkMRMLScriptedModuleNode"):
         return parameterNode
     # no parameter node was found for this module, therefore we add a new one now
     parameterNode = self.createParameterNode()
@@ -223,10 +224,11 @@ class ScriptedLoadableModuleLogic():
     Multiple parameter nodes are useful for storing multiple parameter sets in a single scene.
     """
     foundParameterNodes = []
-    numberOfScriptedModuleNodes =  slicer.mrmlScene.GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode")
-    for nodeIndex in xrange(numberOfScriptedModuleNodes):
-      parameterNode  = slicer.mrmlScene.GetNthNodeByClass( nodeIndex, "vtkMRMLScriptedModuleNode" )
-      if parameterNode.GetAttribute("ModuleName") == self.moduleName:
+    nodes = slicer.mrmlScene.GetNodesByAttribute("ModuleName", self.moduleName)
+    nodes.UnRegister(slicer.mrmlScene)
+    for nodeIndex in xrange(nodes.GetNumberOfItems()):
+      parameterNode = nodes.GetItemAsObject(nodeIndex)
+      if parameterNode.IsA("vtkMRMLScriptedModuleNode"):
         foundParameterNodes.append(parameterNode)
     return foundParameterNodes
 
@@ -1,16 +1,43 @@
 """ This module sets up root logging and loads the Slicer library modules into its namespace."""
 
 #-----------------------------------------------------------------------------
-def _createModule(name, globals, docstring):
+def _createModule(name, globals, docstring, moduleType=None):
   import imp
   import sys
   moduleName = name.split('.')[-1]
-  module = imp.new_module( moduleName )
+  if moduleType is None:
+    module = imp.new_module( moduleName )
+  else:
+    module = moduleType( moduleName )
   module.__file__ = __file__
   module.__doc__ = docstring
   sys.modules[name] = module
   globals[moduleName] = module
 
+#-----------------------------------------------------------------------------
+import types
+
+class _ModulesModule(types.ModuleType):
+  """Module type of ``slicer.modules``: modules that are loaded on demand
+  (see ``qSlicerModuleFactoryManager::lazyLoading``) are loaded when their
+  attribute is first accessed."""
+  def __getattr__(self, name):
+    if name.startswith('__'):
+      raise AttributeError(name)
+    try:
+      factoryManager = app.moduleManager().factoryManager()
+    except NameError:
+      raise AttributeError(name)
+    for moduleName in factoryManager.instantiatedModuleNames():
+      if moduleName.lower() == name and not factoryManager.isLoaded(moduleName):
+        module = factoryManager.loadModuleOnDemand(moduleName)
+        if module is not None:
+          # Set by the module manager when the module is loaded, set it
+          # here too in case the application is not fully initialized.
+          setattr(self, name, module)
+          return module
+    raise AttributeError(name)
+
 #-----------------------------------------------------------------------------
 # Create slicer.modules and slicer.moduleNames
 
@@ -19,7 +46,9 @@ _createModule('slicer.modules', globals(),
 
 The module attributes are the lower-cased Slicer module names, the
 associated value is an instance of ``qSlicerAbstractCoreModule``.
-""")
+Modules that are loaded on demand are loaded when their attribute is
+first accessed.
+""", _ModulesModule)
 
 _createModule('slicer.moduleNames', globals(),
 """This module provides an access to all instantiated Slicer module names.
@@ -46,5 +75,6 @@ for kit in available_kits:
 # Cleanup: Removing things the user shouldn't have to see.
 
 del _createModule
+del types
 del available_kits
 del kit
@@ -493,7 +493,7 @@ def selectedModule():
 
 def moduleNames():
   from slicer import app
-  return app.moduleManager().factoryManager().loadedModuleNames()
+  return app.moduleManager().modulesNames()
 
 def getModule(moduleName):
   from slicer import app
@@ -21,6 +21,7 @@
 #include "qSlicerApplicationHelper.h"
 
 // Qt includes
+#include <QFileInfo>
 #include <QFont>
 #include <QSettings>
 #include <QStyleFactory>
@@ -215,6 +216,13 @@ void qSlicerApplicationHelper::setupModuleFactoryManager(qSlicerModuleFactoryMan
 
     qSlicerCLIExecutableModuleFactory* cliExecutableFactory = new qSlicerCLIExecutableModuleFactory();
     cliExecutableFactory->setTempDirectory(tempDirectory);
+    // Cache descriptions of executables without XML file so that they
+    // are not run with "--xml" at each startup.
+    if (app->userSettings()->value("Modules/CacheCLIDescriptions", true).toBool())
+      {
+      cliExecutableFactory->setXmlDescriptionCacheDirectory(
+        QFileInfo(app->slicerRevisionUserSettingsFilePath()).absolutePath() + "/CLIDescriptionCache");
+      }
     moduleFactoryManager->registerFactory(cliExecutableFactory, preferExecutableCLIs ? 1 : 0);
 
     if (!options->disableBuiltInModules() &&
@@ -125,6 +125,10 @@ void qSlicerApplicationHelper::postInitializeApplication(
     moduleFactoryManager->addModuleToIgnore(moduleToIgnore);
     }
 
+  QString moduleStartupTraceFile = app.commandOptions()->moduleStartupTraceFile();
+  moduleFactoryManager->setProfilingEnabled(!moduleStartupTraceFile.isEmpty());
+  moduleFactoryManager->setLazyLoading(app.commandOptions()->lazyModuleLoading());
+
   // Register and instantiate modules
   splashMessage(splashScreen, "Registering modules...");
   moduleFactoryManager->registerModules();
@@ -164,6 +168,10 @@ void qSlicerApplicationHelper::postInitializeApplication(
   foreach(const QString& name, moduleFactoryManager->instantiatedModuleNames())
     {
     Q_ASSERT(!name.isNull());
+    if (moduleFactoryManager->isLoadedOnDemand(name))
+      {
+      continue;
+      }
     splashMessage(splashScreen, "Loading module \"" + name + "\"...");
     moduleFactoryManager->loadModule(name);
     }
@@ -171,6 +179,11 @@ void qSlicerApplicationHelper::postInitializeApplication(
     {
     qDebug() << "Number of loaded modules:" << moduleManager->modulesNames().count();
     }
+  if (!moduleStartupTraceFile.isEmpty())
+    {
+    moduleFactoryManager->writeProfilingTrace(moduleStartupTraceFile);
+    moduleFactoryManager->setProfilingEnabled(false);
+    }
 
   splashMessage(splashScreen, QString());
 
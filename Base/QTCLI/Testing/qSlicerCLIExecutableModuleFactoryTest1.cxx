@@ -19,15 +19,102 @@
 ==============================================================================*/
 
 // QT includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QTime>
+
+// CTK includes
+#include <ctkUtils.h>
 
 // SlicerQt includes
 #include <qSlicerCLIExecutableModuleFactory.h>
+#include <qSlicerModuleFactoryManager.h>
 
 // STD includes
 
 #include "vtkMRMLCoreTestingMacros.h"
 
-int qSlicerCLIExecutableModuleFactoryTest1(int, char * [] )
+namespace
+{
+
+/// Time spent by each test executable before printing its description
+const int ProbeDurationInSeconds = 2;
+
+//-----------------------------------------------------------------------------
+// Create an executable without XML file next to it that prints its
+// description when it is run (with "--xml").
+bool createTestExecutable(const QDir& directory, const QString& moduleName)
+{
+  QFile descriptionFile(directory.filePath(moduleName + ".description"));
+  if (!descriptionFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+    return false;
+    }
+  QTextStream(&descriptionFile)
+    << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    << "<executable>\n"
+    << "  <category>Testing</category>\n"
+    << "  <title>" << moduleName << "</title>\n"
+    << "</executable>\n";
+  descriptionFile.close();
+
+#ifdef _WIN32
+  QFile executableFile(directory.filePath(moduleName + ".bat"));
+#else
+  QFile executableFile(directory.filePath(moduleName));
+#endif
+  if (!executableFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+    return false;
+    }
+  QTextStream stream(&executableFile);
+#ifdef _WIN32
+  stream << "@ping -n " << ProbeDurationInSeconds + 1 << " 127.0.0.1 > nul\n"
+         << "@type \"%~dp0" << moduleName << ".description\"\n";
+#else
+  stream << "#!/bin/sh\n"
+         << "sleep " << ProbeDurationInSeconds << "\n"
+         << "cat \"$(dirname \"$0\")/" << moduleName << ".description\"\n";
+#endif
+  stream.flush();
+  executableFile.close();
+  return executableFile.setPermissions(executableFile.permissions()
+    | QFile::ExeOwner | QFile::ExeUser);
+}
+
+//-----------------------------------------------------------------------------
+int numberOfCacheEntries(const QDir& cacheDirectory)
+{
+  return cacheDirectory.entryList(QStringList() << "*.xmlcache", QDir::Files).count();
+}
+
+//-----------------------------------------------------------------------------
+// Register the executables of \a executableDirectory with a new factory
+// manager and return the time spent in seconds.
+double registerExecutables(const QString& executableDirectory, const QString& cacheDirectory,
+                           int maximumThreadCount, QStringList& registeredModuleNames)
+{
+  qSlicerModuleFactoryManager moduleFactoryManager;
+  qSlicerCLIExecutableModuleFactory* factory = new qSlicerCLIExecutableModuleFactory();
+  factory->setXmlDescriptionCacheDirectory(cacheDirectory);
+  factory->setXmlDescriptionProbeMaximumThreadCount(maximumThreadCount);
+  moduleFactoryManager.registerFactory(factory);
+  moduleFactoryManager.addSearchPath(executableDirectory);
+  moduleFactoryManager.setModulesToIgnore(QStringList() << "IgnoredProbeTest");
+
+  QTime timeProbe;
+  timeProbe.start();
+  moduleFactoryManager.registerModules();
+  double registrationTimeInSeconds = timeProbe.elapsed() / 1000.0;
+
+  registeredModuleNames = moduleFactoryManager.registeredModuleNames();
+  return registrationTimeInSeconds;
+}
+
+//-----------------------------------------------------------------------------
+int testKeys()
 {
   QStringList executableNames;
   executableNames << "Threshold.exe"
@@ -47,6 +134,91 @@ int qSlicerCLIExecutableModuleFactoryTest1(int, char * [] )
       return EXIT_FAILURE;
       }
     }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int testParallelProbe()
+{
+  QDir testDirectory(QDir::temp().filePath(
+    QString("qSlicerCLIExecutableModuleFactoryTest1-%1").arg(QCoreApplication::applicationPid())));
+  ctk::removeDirRecursively(testDirectory.absolutePath());
+  QDir().mkpath(testDirectory.filePath("Executables"));
+  QDir executableDirectory(testDirectory.filePath("Executables"));
+  QDir cacheDirectory(testDirectory.filePath("Cache"));
+
+  const int numberOfExecutables = 4;
+  QStringList moduleNames;
+  for (int i = 0; i < numberOfExecutables; ++i)
+    {
+    moduleNames << QString("ProbeTest%1").arg(i);
+    }
+  foreach(const QString& moduleName, QStringList(moduleNames) << "IgnoredProbeTest")
+    {
+    if (!createTestExecutable(executableDirectory, moduleName))
+      {
+      std::cerr << __LINE__ << " - Failed to create test executable "
+                << qPrintable(moduleName) << std::endl;
+      ctk::removeDirRecursively(testDirectory.absolutePath());
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Descriptions are retrieved when the modules are registered, one
+  // executable per thread.
+  QStringList registeredModuleNames;
+  double registrationTime = registerExecutables(executableDirectory.absolutePath(),
+    cacheDirectory.absolutePath(), numberOfExecutables, registeredModuleNames);
+  registeredModuleNames.sort();
+  int numberOfProbedExecutables = numberOfCacheEntries(cacheDirectory);
+  // Running the executables one after the other would take
+  // numberOfExecutables * ProbeDurationInSeconds.
+  double maximumRegistrationTime = (numberOfExecutables - 1) * ProbeDurationInSeconds;
+
+  // Cached descriptions are used, executables are not run anymore.
+  QStringList cachedRegisteredModuleNames;
+  double cachedRegistrationTime = registerExecutables(executableDirectory.absolutePath(),
+    cacheDirectory.absolutePath(), numberOfExecutables, cachedRegisteredModuleNames);
+  int numberOfCachedExecutables = numberOfCacheEntries(cacheDirectory);
+
+  ctk::removeDirRecursively(testDirectory.absolutePath());
+
+  if (registeredModuleNames != moduleNames)
+    {
+    std::cerr << __LINE__ << " - Error in registerModules()" << std::endl
+              << "registeredModuleNames = " << qPrintable(registeredModuleNames.join(" ")) << std::endl
+              << "expected = " << qPrintable(moduleNames.join(" ")) << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Ignored modules are not probed
+  CHECK_INT(numberOfProbedExecutables, numberOfExecutables);
+  if (registrationTime >= maximumRegistrationTime)
+    {
+    std::cerr << __LINE__ << " - Descriptions were not retrieved in parallel: "
+              << "registration took " << registrationTime << "s, expected less than "
+              << maximumRegistrationTime << "s" << std::endl;
+    return EXIT_FAILURE;
+    }
+  CHECK_INT(cachedRegisteredModuleNames.count(), numberOfExecutables);
+  CHECK_INT(numberOfCachedExecutables, numberOfExecutables);
+  if (cachedRegistrationTime >= ProbeDurationInSeconds)
+    {
+    std::cerr << __LINE__ << " - Cached descriptions were not used: "
+              << "registration took " << cachedRegistrationTime << "s" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIExecutableModuleFactoryTest1(int argc, char * argv[] )
+{
+  QCoreApplication app(argc, argv);
+
+  CHECK_EXIT_SUCCESS(testKeys());
+  CHECK_EXIT_SUCCESS(testParallelProbe());
 
   return EXIT_SUCCESS;
 }
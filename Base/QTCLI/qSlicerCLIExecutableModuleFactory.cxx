@@ -19,7 +19,13 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QProcess>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 // SlicerQt includes
 #include "qSlicerCLIExecutableModuleFactory.h"
@@ -28,9 +34,47 @@
 #include "qSlicerUtils.h"
 #include <vtkSlicerCLIModuleLogic.h>
 
+namespace
+{
+
+/// Version of the cache entry format, increment it when the format changes.
+const qint32 XmlDescriptionCacheVersion = 1;
+
+//-----------------------------------------------------------------------------
+QString xmlDescriptionCacheFilePath(const QString& cacheDirectory, const QString& executablePath)
+{
+  QByteArray pathHash = QCryptographicHash::hash(
+    QFileInfo(executablePath).absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex();
+  return QDir(cacheDirectory).filePath(QString(pathHash) + ".xmlcache");
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+/// Run a CLI executable with "--xml" on a worker thread
+class qSlicerCLIExecutableModuleFactoryProbeTask : public QRunnable
+{
+public:
+  qSlicerCLIExecutableModuleFactoryProbeTask(qSlicerCLIExecutableModuleFactoryItem* item)
+    : Item(item)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Item->probeXmlDescription();
+  }
+
+  qSlicerCLIExecutableModuleFactoryItem* Item;
+};
+
 //-----------------------------------------------------------------------------
 qSlicerCLIExecutableModuleFactoryItem::qSlicerCLIExecutableModuleFactoryItem(
-  const QString& newTempDirectory) : TempDirectory(newTempDirectory)
+  const QString& newTempDirectory, const QString& newXmlDescriptionCacheDirectory)
+  : TempDirectory(newTempDirectory)
+  , XmlDescriptionCacheDirectory(newXmlDescriptionCacheDirectory)
+  , CLIModule(0)
+  , XmlDescriptionRetrieved(false)
 {
 }
 
@@ -60,7 +104,8 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
 
   //
   // If the xml file exists, read it and associate it with the module
-  // description. If not, run the CLI executable with "--xml".
+  // description. If not, use the description retrieved when the items were
+  // registered or found in the cache, or run the CLI executable with "--xml".
   //
   QString xmlDescription;
   if (QFile::exists(xmlFilePath))
@@ -76,9 +121,14 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
       this->appendInstantiateErrorString("Failed to read Xml Description");
       }
     }
-  else
+  else if (this->XmlDescriptionRetrieved)
+    {
+    xmlDescription = this->RetrievedXmlDescription;
+    }
+  else if (!this->readCachedXmlDescription(xmlDescription))
     {
     xmlDescription = this->runCLIWithXmlArgument();
+    this->writeCachedXmlDescription(xmlDescription);
     }
   if (xmlDescription.isEmpty())
     {
@@ -97,15 +147,114 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
 }
 
 //-----------------------------------------------------------------------------
-QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+bool qSlicerCLIExecutableModuleFactoryItem::isXmlDescriptionProbeRequired()
 {
-  ctkScopedCurrentDir scopedCurrentDir(QFileInfo(this->path()).path());
+  if (this->XmlDescriptionRetrieved || QFile::exists(this->xmlModuleDescriptionFilePath()))
+    {
+    return false;
+    }
+  if (this->readCachedXmlDescription(this->RetrievedXmlDescription))
+    {
+    this->XmlDescriptionRetrieved = true;
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::probeXmlDescription()
+{
+  this->RetrievedXmlDescription = this->runCLIWithXmlArgument();
+  this->writeCachedXmlDescription(this->RetrievedXmlDescription);
+  this->XmlDescriptionRetrieved = true;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIExecutableModuleFactoryItem::readCachedXmlDescription(QString& xmlDescription)
+{
+  if (this->XmlDescriptionCacheDirectory.isEmpty())
+    {
+    return false;
+    }
+  QFile cacheFile(xmlDescriptionCacheFilePath(this->XmlDescriptionCacheDirectory, this->path()));
+  if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  QDataStream stream(&cacheFile);
+  qint32 version = 0;
+  stream >> version;
+  if (version != XmlDescriptionCacheVersion)
+    {
+    return false;
+    }
+  QString executablePath;
+  qint64 executableSize = -1;
+  qint64 executableLastModified = -1;
+  QString cachedXmlDescription;
+  stream >> executablePath >> executableSize >> executableLastModified >> cachedXmlDescription;
+
+  QFileInfo executableInfo(this->path());
+  if (stream.status() != QDataStream::Ok
+    || executablePath != executableInfo.absoluteFilePath()
+    || executableSize != executableInfo.size()
+    || executableLastModified != executableInfo.lastModified().toMSecsSinceEpoch()
+    || cachedXmlDescription.isEmpty())
+    {
+    return false;
+    }
+  xmlDescription = cachedXmlDescription;
+  return true;
+}
 
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::writeCachedXmlDescription(const QString& xmlDescription)
+{
+  if (this->XmlDescriptionCacheDirectory.isEmpty() || xmlDescription.isEmpty())
+    {
+    return;
+    }
+  QDir().mkpath(this->XmlDescriptionCacheDirectory);
+  QString cacheFilePath = xmlDescriptionCacheFilePath(this->XmlDescriptionCacheDirectory, this->path());
+  // Write into a temporary file first so that other application instances
+  // never read a partially written entry.
+  QString tempCacheFilePath = cacheFilePath + QString(".%1.tmp").arg(QCoreApplication::applicationPid());
+  QFile tempCacheFile(tempCacheFilePath);
+  if (!tempCacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return;
+    }
+  QFileInfo executableInfo(this->path());
+  QDataStream stream(&tempCacheFile);
+  stream << XmlDescriptionCacheVersion
+         << executableInfo.absoluteFilePath()
+         << static_cast<qint64>(executableInfo.size())
+         << static_cast<qint64>(executableInfo.lastModified().toMSecsSinceEpoch())
+         << xmlDescription;
+  tempCacheFile.close();
+  if (stream.status() != QDataStream::Ok)
+    {
+    QFile::remove(tempCacheFilePath);
+    return;
+    }
+  QFile::remove(cacheFilePath);
+  if (!QFile::rename(tempCacheFilePath, cacheFilePath))
+    {
+    QFile::remove(tempCacheFilePath);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactoryItem::runCLIWithXmlArgument()
+{
   int cliProcessTimeoutInMs = 5000;
   QProcess cli;
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
   env.insert("ITK_AUTOLOAD_PATH", "");
   cli.setProcessEnvironment(env);
+  // Set the working directory of the process instead of changing the current
+  // directory of the application, the probe may run on a worker thread.
+  cli.setWorkingDirectory(QFileInfo(this->path()).path());
   cli.start(this->path(), QStringList(QString("--xml")));
   bool res = cli.waitForFinished(cliProcessTimeoutInMs);
   if (!res)
@@ -197,6 +346,8 @@ public:
 
 private:
   QString TempDirectory;
+  QString XmlDescriptionCacheDirectory;
+  int XmlDescriptionProbeMaximumThreadCount;
 };
 
 //-----------------------------------------------------------------------------
@@ -204,6 +355,7 @@ qSlicerCLIExecutableModuleFactoryPrivate::qSlicerCLIExecutableModuleFactoryPriva
 :q_ptr(&object)
 {
   this->TempDirectory = QDir::tempPath();
+  this->XmlDescriptionProbeMaximumThreadCount = QThread::idealThreadCount();
 }
 
 //-----------------------------------------------------------------------------
@@ -225,6 +377,33 @@ void qSlicerCLIExecutableModuleFactory::registerItems()
 {
   QStringList modulePaths = qSlicerCLIModuleFactoryHelper::modulePaths();
   this->registerAllFileItems(modulePaths);
+  this->probeXmlDescriptions(this->itemKeys());
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::fileItemsRegistered(const QStringList& moduleNames)
+{
+  this->probeXmlDescriptions(moduleNames);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::probeXmlDescriptions(const QStringList& keys)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(qMax(1, d->XmlDescriptionProbeMaximumThreadCount));
+  foreach(const QString& key, keys)
+    {
+    qSlicerCLIExecutableModuleFactoryItem* item =
+      dynamic_cast<qSlicerCLIExecutableModuleFactoryItem*>(this->item(key));
+    if (!item || !item->isXmlDescriptionProbeRequired())
+      {
+      continue;
+      }
+    // The task is deleted by the thread pool once run
+    threadPool.start(new qSlicerCLIExecutableModuleFactoryProbeTask(item));
+    }
+  threadPool.waitForDone();
 }
 
 //-----------------------------------------------------------------------------
@@ -246,7 +425,7 @@ ctkAbstractFactoryItem<qSlicerAbstractCoreModule>* qSlicerCLIExecutableModuleFac
 ::createFactoryFileBasedItem()
 {
   Q_D(qSlicerCLIExecutableModuleFactory);
-  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory);
+  return new qSlicerCLIExecutableModuleFactoryItem(d->TempDirectory, d->XmlDescriptionCacheDirectory);
 }
 
 //-----------------------------------------------------------------------------
@@ -261,3 +440,31 @@ void qSlicerCLIExecutableModuleFactory::setTempDirectory(const QString& newTempD
   Q_D(qSlicerCLIExecutableModuleFactory);
   d->TempDirectory = newTempDirectory;
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::setXmlDescriptionCacheDirectory(const QString& newXmlDescriptionCacheDirectory)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  d->XmlDescriptionCacheDirectory = newXmlDescriptionCacheDirectory;
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIExecutableModuleFactory::xmlDescriptionCacheDirectory()const
+{
+  Q_D(const qSlicerCLIExecutableModuleFactory);
+  return d->XmlDescriptionCacheDirectory;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactory::setXmlDescriptionProbeMaximumThreadCount(int maximumThreadCount)
+{
+  Q_D(qSlicerCLIExecutableModuleFactory);
+  d->XmlDescriptionProbeMaximumThreadCount = maximumThreadCount;
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCLIExecutableModuleFactory::xmlDescriptionProbeMaximumThreadCount()const
+{
+  Q_D(const qSlicerCLIExecutableModuleFactory);
+  return d->XmlDescriptionProbeMaximumThreadCount;
+}
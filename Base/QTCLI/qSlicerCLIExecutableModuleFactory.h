@@ -23,6 +23,7 @@
 
 // SlicerQT includes
 #include "qSlicerAbstractCoreModule.h"
+#include "qSlicerAbstractModuleFactoryManager.h"
 #include "qSlicerBaseQTCLIExport.h"
 class qSlicerCLIModule;
 
@@ -35,25 +36,51 @@ class qSlicerCLIExecutableModuleFactoryItem
   : public ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>
 {
 public:
-  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory);
+  qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory,
+                                        const QString& newXmlDescriptionCacheDirectory = QString());
   virtual bool load();
   virtual void uninstantiate();
+
+  /// Return true if the XML description can only be retrieved by running the
+  /// executable with "--xml": there is no XML file next to the executable
+  /// and no up-to-date description in the cache.
+  /// A description found in the cache is kept for instanciator().
+  bool isXmlDescriptionProbeRequired();
+
+  /// Run the executable with "--xml", cache the description and keep it for
+  /// instanciator().
+  /// It does not change the current directory, it can be called from a
+  /// worker thread.
+  void probeXmlDescription();
+
 protected:
   /// Return path of the expected XML file.
   QString xmlModuleDescriptionFilePath();
 
   virtual qSlicerAbstractCoreModule* instanciator();
   QString runCLIWithXmlArgument();
+
+  /// Read the description of the executable from the cache.
+  /// Return false if the cache is disabled or if the executable has been
+  /// modified (different size or modification time) since it was cached.
+  bool readCachedXmlDescription(QString& xmlDescription);
+  /// Store the description of the executable in the cache.
+  void writeCachedXmlDescription(const QString& xmlDescription);
+
 private:
   QString TempDirectory;
+  QString XmlDescriptionCacheDirectory;
   qSlicerCLIModule* CLIModule;
+  bool XmlDescriptionRetrieved;
+  QString RetrievedXmlDescription;
 };
 
 class qSlicerCLIExecutableModuleFactoryPrivate;
 
 //-----------------------------------------------------------------------------
 class Q_SLICER_BASE_QTCLI_EXPORT qSlicerCLIExecutableModuleFactory :
-  public ctkAbstractFileBasedFactory<qSlicerAbstractCoreModule>
+  public ctkAbstractFileBasedFactory<qSlicerAbstractCoreModule>,
+  public qSlicerFileBasedModuleFactoryInterface
 {
 public:
   typedef ctkAbstractFileBasedFactory<qSlicerAbstractCoreModule> Superclass;
@@ -63,6 +90,11 @@ public:
 
   virtual void registerItems();
 
+  /// Retrieve in parallel the XML descriptions of the executables registered
+  /// by the module factory manager.
+  /// \sa qSlicerFileBasedModuleFactoryInterface
+  virtual void fileItemsRegistered(const QStringList& moduleNames);
+
   /// Extract module name given \a executableName
   /// For example:
   ///  Threshold.exe -> threshold
@@ -71,9 +103,24 @@ public:
 
   void setTempDirectory(const QString& newTempDirectory);
 
+  /// Directory where the XML descriptions retrieved by running executables
+  /// with "--xml" are cached. Entries are keyed by executable path, size and
+  /// modification time. Caching is disabled if empty (default).
+  void setXmlDescriptionCacheDirectory(const QString& newXmlDescriptionCacheDirectory);
+  QString xmlDescriptionCacheDirectory()const;
+
+  /// Maximum number of executables run concurrently with "--xml" when
+  /// registering items. Default is QThread::idealThreadCount().
+  void setXmlDescriptionProbeMaximumThreadCount(int maximumThreadCount);
+  int xmlDescriptionProbeMaximumThreadCount()const;
+
 protected:
   virtual bool isValidFile(const QFileInfo& file)const;
 
+  /// Retrieve in parallel the XML descriptions of the items \a keys that
+  /// have no XML file and no cached description.
+  void probeXmlDescriptions(const QStringList& keys);
+
   virtual ctkAbstractFactoryItem<qSlicerAbstractCoreModule>*
     createFactoryFileBasedItem();
 
@@ -261,3 +261,9 @@ QStringList qSlicerCLIModule::associatedNodeTypes()const
 {
   return QStringList() << "vtkMRMLCommandLineModuleNode";
 }
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModule::registersIO()const
+{
+  return false;
+}
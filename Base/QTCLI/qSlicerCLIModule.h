@@ -89,6 +89,9 @@ public:
   /// Specify editable node types
   virtual QStringList associatedNodeTypes()const;
 
+  /// CLI modules don't register any IO, return false.
+  virtual bool registersIO()const;
+
   virtual QImage logo() const;
   void setLogo(const ModuleLogo& logo);
 
@@ -321,3 +321,9 @@ QStringList qSlicerAbstractCoreModule::associatedNodeTypes()const
 {
   return QStringList();
 }
+
+//-----------------------------------------------------------------------------
+bool qSlicerAbstractCoreModule::registersIO()const
+{
+  return true;
+}
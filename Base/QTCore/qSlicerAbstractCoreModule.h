@@ -295,6 +295,14 @@ public:
   /// Return node types associated with this module (e.g., node types this module can edit)
   virtual QStringList associatedNodeTypes()const;
 
+  /// Return true if the module registers readers, writers, file dialogs or
+  /// other plugins when it is set up. Such modules are loaded at startup even if lazy
+  /// loading is enabled.
+  /// The default implementation returns true, modules that never register
+  /// IO can reimplement it to be loaded on demand.
+  /// \sa qSlicerModuleFactoryManager::lazyLoading
+  virtual bool registersIO()const;
+
 public slots:
 
   /// Set the current MRML scene to the module, it is propagated to the logic
@@ -20,6 +20,9 @@
 
 // Qt includes
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
 
 // SlicerQt includes
 #include "qSlicerCoreApplication.h"
@@ -30,6 +33,44 @@
 #include <csignal>
 #include <typeinfo>
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+/// Time spent in one phase of a module startup
+struct qSlicerModuleProfilingEvent
+{
+  QString ModuleName;
+  QString Phase;
+  qint64 StartInUs;
+  qint64 DurationInUs;
+};
+
+//-----------------------------------------------------------------------------
+QString escapeJSONString(const QString& text)
+{
+  QString escaped;
+  foreach(const QChar& character, text)
+    {
+    if (character == '"' || character == '\\')
+      {
+      escaped += '\\';
+      escaped += character;
+      }
+    else if (character.unicode() < 0x20)
+      {
+      escaped += QString("\\u%1").arg(character.unicode(), 4, 16, QChar('0'));
+      }
+    else
+      {
+      escaped += character;
+      }
+    }
+  return escaped;
+}
+
+} // end of anonymous namespace
+
 //-----------------------------------------------------------------------------
 class qSlicerAbstractModuleFactoryManagerPrivate
 {
@@ -61,6 +102,10 @@ public:
   QMap<QString, QStringList> ModuleDependees;
 
   bool Verbose;
+
+  // Profiling is enabled if the timer is valid
+  QElapsedTimer ProfilingTimer;
+  QList<qSlicerModuleProfilingEvent> ProfilingEvents;
 };
 
 //-----------------------------------------------------------------------------
@@ -274,6 +319,16 @@ void qSlicerAbstractModuleFactoryManager::registerModules()
       }
     this->registerModules(path);
     }
+  // Let file based factories process all their registered files at once
+  foreach(qSlicerFileBasedModuleFactory* factory, d->fileBasedFactories())
+    {
+    qSlicerFileBasedModuleFactoryInterface* factoryInterface =
+      dynamic_cast<qSlicerFileBasedModuleFactoryInterface*>(factory);
+    if (factoryInterface)
+      {
+      factoryInterface->fileItemsRegistered(d->RegisteredModules.keys(factory));
+      }
+    }
   emit this->modulesRegistered(d->RegisteredModules.keys());
 }
 
@@ -294,6 +349,7 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
 {
   Q_D(qSlicerAbstractModuleFactoryManager);
 
+  qint64 startTimestamp = this->profilingTimestamp();
   qSlicerFileBasedModuleFactory* moduleFactory = 0;
   foreach(qSlicerFileBasedModuleFactory* factory, d->fileBasedFactories())
     {
@@ -361,6 +417,7 @@ void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
     return;
     }
   d->RegisteredModules[moduleName] = moduleFactory;
+  this->addProfilingEvent(moduleName, "registration", startTimestamp);
   if (!dontEmitSignal)
     {
     emit moduleRegistered(moduleName);
@@ -400,7 +457,9 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
     qCritical() << "Fail to instantiate module " << moduleName << " (not registered)";
     return 0;
     }
+  qint64 startTimestamp = this->profilingTimestamp();
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  this->addProfilingEvent(moduleName, "instantiation", startTimestamp);
   if (!module)
     {
     qCritical() << "Fail to instantiate module " << moduleName;
@@ -554,3 +613,85 @@ void qSlicerAbstractModuleFactoryManager::setIsVerbose(bool flag)
   d->Verbose = flag;
 }
 
+
+//---------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::setProfilingEnabled(bool enabled)
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  d->ProfilingEvents.clear();
+  if (enabled)
+    {
+    d->ProfilingTimer.start();
+    }
+  else
+    {
+    d->ProfilingTimer.invalidate();
+    }
+}
+
+//---------------------------------------------------------------------------
+bool qSlicerAbstractModuleFactoryManager::isProfilingEnabled()const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  return d->ProfilingTimer.isValid();
+}
+
+//---------------------------------------------------------------------------
+qint64 qSlicerAbstractModuleFactoryManager::profilingTimestamp()const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  if (!d->ProfilingTimer.isValid())
+    {
+    return -1;
+    }
+  return d->ProfilingTimer.nsecsElapsed() / 1000;
+}
+
+//---------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::addProfilingEvent(
+  const QString& moduleName, const QString& phase, qint64 startTimestamp)
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  if (!d->ProfilingTimer.isValid() || startTimestamp < 0)
+    {
+    return;
+    }
+  qSlicerModuleProfilingEvent event;
+  event.ModuleName = moduleName;
+  event.Phase = phase;
+  event.StartInUs = startTimestamp;
+  event.DurationInUs = this->profilingTimestamp() - startTimestamp;
+  d->ProfilingEvents << event;
+  if (d->Verbose)
+    {
+    qDebug() << "Module" << moduleName << phase << "took" << event.DurationInUs / 1000.0 << "ms";
+    }
+}
+
+//---------------------------------------------------------------------------
+bool qSlicerAbstractModuleFactoryManager::writeProfilingTrace(const QString& fileName)const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  QFile traceFile(fileName);
+  if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+    qWarning() << "writeProfilingTrace failed: cannot write file" << fileName;
+    return false;
+    }
+  QTextStream stream(&traceFile);
+  stream << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+  for (int i = 0; i < d->ProfilingEvents.count(); ++i)
+    {
+    const qSlicerModuleProfilingEvent& event = d->ProfilingEvents[i];
+    stream << (i > 0 ? ",\n" : "\n")
+           << "    {\"name\": \"" << escapeJSONString(event.ModuleName) << "\""
+           << ", \"cat\": \"" << escapeJSONString(event.Phase) << "\""
+           << ", \"ph\": \"X\""
+           << ", \"ts\": " << event.StartInUs
+           << ", \"dur\": " << event.DurationInUs
+           << ", \"pid\": 1, \"tid\": 1}";
+    }
+  stream << "\n  ]\n}\n";
+  stream.flush();
+  return traceFile.error() == QFile::NoError;
+}
@@ -34,6 +34,23 @@ class qSlicerAbstractCoreModule;
 
 class qSlicerAbstractModuleFactoryManagerPrivate;
 
+/// File based module factories that need to process all their file items at
+/// once (e.g. to retrieve module descriptions in parallel) implement this
+/// interface.
+/// \sa qSlicerAbstractModuleFactoryManager::registerModules()
+class Q_SLICER_BASE_QTCORE_EXPORT qSlicerFileBasedModuleFactoryInterface
+{
+public:
+  virtual ~qSlicerFileBasedModuleFactoryInterface(){}
+
+  /// Called by qSlicerAbstractModuleFactoryManager::registerModules() once the
+  /// files of all the search paths are registered.
+  /// \a moduleNames are the keys of the items registered with the factory,
+  /// ignored modules and modules registered by a factory with a higher
+  /// priority are excluded.
+  virtual void fileItemsRegistered(const QStringList& moduleNames) = 0;
+};
+
 /// Loading modules into slicer happens in multiple steps:
 /// 1) module factories must be registered into the factory manager:
 ///   qSlicerModuleFactoryManager* factoryManager = app->moduleManager()->factoryManager();
@@ -82,6 +99,12 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerAbstractModuleFactoryManager : public Q
   /// Due to the large amount of modules to load, it can be faster (and less
   /// overwhelming) to load only a subset of the modules.
   Q_PROPERTY(QStringList modulesToIgnore READ modulesToIgnore WRITE setModulesToIgnore NOTIFY modulesToIgnoreChanged)
+
+  /// This property controls whether the time spent registering,
+  /// instantiating and loading each module is recorded.
+  /// Enabling it clears previously recorded timings. Disabled by default.
+  /// \sa writeProfilingTrace()
+  Q_PROPERTY(bool profilingEnabled READ isProfilingEnabled WRITE setProfilingEnabled)
 public:
   typedef ctkAbstractFileBasedFactory<qSlicerAbstractCoreModule> qSlicerFileBasedModuleFactory;
   typedef ctkAbstractFactory<qSlicerAbstractCoreModule> qSlicerModuleFactory;
@@ -158,6 +181,8 @@ public:
 
   /// Scan the paths in \a searchPaths and for each file, attempt to register
   /// using one of the registered factories.
+  /// File based factories implementing qSlicerFileBasedModuleFactoryInterface
+  /// are then notified that all the files are registered.
   void registerModules();
 
   Q_INVOKABLE void registerModule(const QFileInfo& file);
@@ -186,6 +211,18 @@ public:
   /// Enable/Disable verbose output during module discovery process
   void setVerboseModuleDiscovery(bool value);
 
+  void setProfilingEnabled(bool enabled);
+  bool isProfilingEnabled()const;
+
+  /// Write the timings recorded since profiling was enabled into \a fileName
+  /// using the Trace Event JSON format (it can be viewed in chrome://tracing).
+  /// There is one event per module and phase: "registration" (includes library
+  /// loading for loadable modules), "instantiation" (includes Python import
+  /// for scripted modules) and "load" (module logic setup).
+  /// Return false if the file can't be written.
+  /// \sa profilingEnabled
+  Q_INVOKABLE bool writeProfilingTrace(const QString& fileName)const;
+
   /// Return the list of modules that have \a module as a dependency.
   /// Note that the list can contain unloaded modules.
   /// \sa qSlicerAbstractCoreModule::dependencies(), moduleDependees()
@@ -233,6 +270,15 @@ protected:
   /// Uninstantiate a module given its \a moduleName
   virtual void uninstantiateModule(const QString& moduleName);
 
+  /// Return the time elapsed since profiling was enabled in microseconds,
+  /// -1 if profiling is disabled.
+  qint64 profilingTimestamp()const;
+
+  /// Record that the \a phase of module \a moduleName started at
+  /// \a startTimestamp and ends now. No-op if profiling is disabled.
+  /// \sa profilingTimestamp()
+  void addProfilingEvent(const QString& moduleName, const QString& phase, qint64 startTimestamp);
+
 private:
   Q_DECLARE_PRIVATE(qSlicerAbstractModuleFactoryManager);
   Q_DISABLE_COPY(qSlicerAbstractModuleFactoryManager);
@@ -305,6 +305,20 @@ bool qSlicerCoreCommandOptions::verboseModuleDiscovery() const
   return d->ParsedArgs.value("verbose-module-discovery").toBool();
 }
 
+//-----------------------------------------------------------------------------
+QString qSlicerCoreCommandOptions::moduleStartupTraceFile() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("module-startup-trace").toString();
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreCommandOptions::lazyModuleLoading() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("lazy-module-loading").toBool();
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCoreCommandOptions::verbose()const
 {
@@ -454,6 +468,14 @@ void qSlicerCoreCommandOptions::addArguments()
   this->addArgument("verbose-module-discovery", "", QVariant::Bool,
                     "Enable verbose output during module discovery process.");
 
+  this->addArgument("module-startup-trace", "", QVariant::String,
+                    "Write the time spent registering, instantiating and loading each module "
+                    "at startup into the given file (Trace Event JSON format).");
+
+  this->addArgument("lazy-module-loading", "", QVariant::Bool,
+                    "Load modules that no other module depends on and that don't register "
+                    "readers or writers only when they are first used.");
+
   this->addArgument("disable-settings", "", QVariant::Bool,
                     "Start application ignoring user settings and using new temporary settings.");
 
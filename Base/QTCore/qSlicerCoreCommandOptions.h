@@ -53,6 +53,8 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerCoreCommandOptions : public ctkCommandL
   Q_PROPERTY(bool displayTemporaryPathAndExit READ displayTemporaryPathAndExit CONSTANT)
   Q_PROPERTY(bool displayMessageAndExit READ displayMessageAndExit STORED false CONSTANT)
   Q_PROPERTY(bool verboseModuleDiscovery READ verboseModuleDiscovery CONSTANT)
+  Q_PROPERTY(QString moduleStartupTraceFile READ moduleStartupTraceFile CONSTANT)
+  Q_PROPERTY(bool lazyModuleLoading READ lazyModuleLoading CONSTANT)
   Q_PROPERTY(bool disableMessageHandlers READ disableMessageHandlers CONSTANT)
   Q_PROPERTY(bool testingEnabled READ isTestingEnabled CONSTANT)
 #ifdef Slicer_USE_PYTHONQT
@@ -157,6 +159,16 @@ public:
   /// Return True if slicer should display details regarding the module discovery process
   bool verboseModuleDiscovery()const;
 
+  /// Return the file where the time spent registering, instantiating and
+  /// loading each module at startup should be written, empty if none.
+  /// \sa qSlicerAbstractModuleFactoryManager::writeProfilingTrace()
+  QString moduleStartupTraceFile()const;
+
+  /// Return True if modules that are not needed at startup should only be
+  /// loaded when first used.
+  /// \sa qSlicerModuleFactoryManager::lazyLoading
+  bool lazyModuleLoading()const;
+
   /// Return True if slicer should display information at startup
   bool verbose()const;
 
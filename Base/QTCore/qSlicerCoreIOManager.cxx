@@ -21,6 +21,13 @@
 // Qt includes
 #include <QDebug>
 #include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTime>
+#include <QWaitCondition>
 
 // CTK includes
 #include <ctkUtils.h>
@@ -41,7 +48,125 @@
 #include <vtkCollection.h>
 #include <vtkDataFileFormatHelper.h> // for GetFileExtensionFromFormatString()
 #include <vtkNew.h>
+#include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
+#include <vtksys/SystemInformation.hxx>
+
+//-----------------------------------------------------------------------------
+/// Decode a file on a worker thread using qSlicerFileReader::prepareLoad()
+class qSlicerCoreIOManagerPrepareLoadTask : public QRunnable
+{
+public:
+  qSlicerCoreIOManagerPrepareLoadTask(qSlicerFileReader* reader,
+    const qSlicerIO::IOFileType& fileType, const qSlicerIO::IOProperties& properties,
+    qint64 estimatedMemory)
+    : Reader(reader)
+    , FileType(fileType)
+    , Properties(properties)
+    , EstimatedMemory(estimatedMemory)
+    , Started(false)
+    , Finished(false)
+    , Prepared(false)
+    , PrepareTimeInSeconds(0.0)
+  {
+    this->setAutoDelete(false);
+  }
+
+  virtual void run()
+  {
+    QTime timeProbe;
+    timeProbe.start();
+    bool prepared = this->Reader->prepareLoad(this->Properties);
+    QMutexLocker locker(&this->Mutex);
+    this->Prepared = prepared;
+    this->PrepareTimeInSeconds = timeProbe.elapsed() / 1000.0;
+    this->Finished = true;
+    this->FinishedCondition.wakeAll();
+  }
+
+  void waitForFinished()
+  {
+    QMutexLocker locker(&this->Mutex);
+    while (!this->Finished)
+      {
+      this->FinishedCondition.wait(&this->Mutex);
+      }
+  }
+
+  qSlicerFileReader* Reader;
+  qSlicerIO::IOFileType FileType;
+  qSlicerIO::IOProperties Properties;
+  qint64 EstimatedMemory;
+  /// Set on the main thread when the task is submitted to the thread pool
+  bool Started;
+  /// Members below are set by the worker thread, read them after waitForFinished()
+  bool Finished;
+  bool Prepared;
+  double PrepareTimeInSeconds;
+
+  QMutex Mutex;
+  QWaitCondition FinishedCondition;
+};
+
+typedef QSharedPointer<qSlicerCoreIOManagerPrepareLoadTask> qSlicerCoreIOManagerPrepareLoadTaskPointer;
+
+//-----------------------------------------------------------------------------
+/// Write node data on a worker thread using vtkMRMLStorageNode::WriteDataDetached()
+class qSlicerCoreIOManagerWriteTask : public QRunnable
+{
+public:
+  qSlicerCoreIOManagerWriteTask(vtkMRMLStorageNode* storageNode,
+    vtkMRMLStorableNode* node, int fileIndex, qint64 estimatedMemory)
+    : StorageNode(storageNode)
+    , Node(node)
+    , FileIndex(fileIndex)
+    , EstimatedMemory(estimatedMemory)
+    , Started(false)
+    , Finished(false)
+    , Written(false)
+    , WriteTimeInSeconds(0.0)
+  {
+    this->setAutoDelete(false);
+  }
+
+  virtual void run()
+  {
+    QTime timeProbe;
+    timeProbe.start();
+    bool written = this->StorageNode->WriteDataDetached();
+    QMutexLocker locker(&this->Mutex);
+    this->Written = written;
+    this->WriteTimeInSeconds = timeProbe.elapsed() / 1000.0;
+    this->Finished = true;
+    this->FinishedCondition.wakeAll();
+  }
+
+  void waitForFinished()
+  {
+    QMutexLocker locker(&this->Mutex);
+    while (!this->Finished)
+      {
+      this->FinishedCondition.wait(&this->Mutex);
+      }
+  }
+
+  vtkSmartPointer<vtkMRMLStorageNode> StorageNode;
+  vtkSmartPointer<vtkMRMLStorableNode> Node;
+  /// Index of the file in the list of files being saved
+  int FileIndex;
+  qint64 EstimatedMemory;
+  /// Set on the main thread when the task is submitted to the thread pool
+  bool Started;
+  /// Members below are set by the worker thread, read them after waitForFinished()
+  bool Finished;
+  bool Written;
+  double WriteTimeInSeconds;
+
+  QMutex Mutex;
+  QWaitCondition FinishedCondition;
+};
+
+typedef QSharedPointer<qSlicerCoreIOManagerWriteTask> qSlicerCoreIOManagerWriteTaskPointer;
 
 //-----------------------------------------------------------------------------
 class qSlicerCoreIOManagerPrivate
@@ -56,15 +181,69 @@ public:
 
   QList<qSlicerFileWriter*> writers(const qSlicerIO::IOFileType &fileType, const qSlicerIO::IOProperties& parameters)const;
 
+  /// Submit tasks to the thread pool, in the order of the files, as long as the memory budget allows
+  void startPrepareLoadTasks();
+  /// Remove the task of the file from the pending tasks and wait until it is finished.
+  /// Returns null if the file was not prepared in parallel.
+  qSlicerCoreIOManagerPrepareLoadTaskPointer takePrepareLoadTask(
+    const qSlicerIO::IOFileType& fileType, const QString& fileName);
+  /// Release the memory of a task taken by takePrepareLoadTask() after it is loaded
+  void releasePrepareLoadTask(qSlicerCoreIOManagerPrepareLoadTaskPointer task);
+
+  /// Submit write tasks to the thread pool, in order, as long as the memory budget allows
+  void startWriteTasks();
+  /// Wait until the task is finished and mark the node as stored if the data was written.
+  /// The task is moved to the finished tasks.
+  void finishWriteTask(qSlicerCoreIOManagerWriteTaskPointer task);
+  /// Return true if node data of the file was scheduled to be written on a worker thread
+  bool isWriteScheduled(int fileIndex)const;
+
   QSettings*        ExtensionFileType;
   QList<qSlicerFileReader*> Readers;
   QList<qSlicerFileWriter*> Writers;
   QMap<qSlicerIO::IOFileType, QStringList> FileTypes;
+
+  bool ParallelLoadEnabled;
+  qint64 ParallelLoadMemoryBudget;
+  /// Files of the current parallel load that are not loaded yet, in loading order
+  QList<qSlicerCoreIOManagerPrepareLoadTaskPointer> PrepareLoadTasks;
+  /// Estimated memory of the files that are being decoded or decoded but not loaded yet
+  qint64 PrepareLoadMemoryInUse;
+  /// Declared after the tasks so that it waits for the running tasks before they are deleted
+  QThreadPool PrepareLoadThreadPool;
+
+  bool ParallelSaveEnabled;
+  qint64 ParallelSaveMemoryBudget;
+  /// Set while saveNodes() saves a list of files with parallel saving enabled
+  bool ParallelSaveInProgress;
+  /// Index of the file being saved in the list of files
+  int SaveFileIndex;
+  /// Node data scheduled to be written that is not finished yet, in saving order
+  QList<qSlicerCoreIOManagerWriteTaskPointer> WriteTasks;
+  QList<qSlicerCoreIOManagerWriteTaskPointer> FinishedWriteTasks;
+  /// Nodes reported as written by the writer of the last saved file
+  QStringList WrittenNodes;
+  /// Memory of the node data that is being written
+  qint64 WriteMemoryInUse;
+  /// Declared after the tasks so that it waits for the running tasks before they are deleted
+  QThreadPool WriteThreadPool;
 };
 
 //-----------------------------------------------------------------------------
 qSlicerCoreIOManagerPrivate::qSlicerCoreIOManagerPrivate()
+  : ParallelLoadEnabled(false)
+  , PrepareLoadMemoryInUse(0)
+  , ParallelSaveEnabled(false)
+  , ParallelSaveInProgress(false)
+  , SaveFileIndex(-1)
+  , WriteMemoryInUse(0)
 {
+  vtksys::SystemInformation systemInformation;
+  systemInformation.RunMemoryCheck();
+  // total physical memory is reported in MiB
+  qint64 totalPhysicalMemory = static_cast<qint64>(systemInformation.GetTotalPhysicalMemory()) * 1024 * 1024;
+  this->ParallelLoadMemoryBudget = totalPhysicalMemory > 0 ? totalPhysicalMemory / 4 : Q_INT64_C(1073741824);
+  this->ParallelSaveMemoryBudget = this->ParallelLoadMemoryBudget;
 }
 
 //-----------------------------------------------------------------------------
@@ -115,6 +294,122 @@ QList<qSlicerFileReader*> qSlicerCoreIOManagerPrivate::readers(const QString& fi
   return matchingReaders;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::startPrepareLoadTasks()
+{
+  foreach(qSlicerCoreIOManagerPrepareLoadTaskPointer task, this->PrepareLoadTasks)
+    {
+    if (task->Started)
+      {
+      continue;
+      }
+    if (this->PrepareLoadMemoryInUse > 0
+      && this->PrepareLoadMemoryInUse + task->EstimatedMemory > this->ParallelLoadMemoryBudget)
+      {
+      // keep the order of the files, wait until loaded files release memory
+      break;
+      }
+    task->Started = true;
+    this->PrepareLoadMemoryInUse += task->EstimatedMemory;
+    task->Reader->initializePrepareLoad(task->Properties);
+    this->PrepareLoadThreadPool.start(task.data());
+    }
+}
+
+//-----------------------------------------------------------------------------
+qSlicerCoreIOManagerPrepareLoadTaskPointer qSlicerCoreIOManagerPrivate::takePrepareLoadTask(
+  const qSlicerIO::IOFileType& fileType, const QString& fileName)
+{
+  for (int taskIndex = 0; taskIndex < this->PrepareLoadTasks.count(); ++taskIndex)
+    {
+    qSlicerCoreIOManagerPrepareLoadTaskPointer task = this->PrepareLoadTasks[taskIndex];
+    if (task->FileType != fileType || task->Properties["fileName"].toString() != fileName)
+      {
+      continue;
+      }
+    this->PrepareLoadTasks.removeAt(taskIndex);
+    if (!task->Started)
+      {
+      // files are loaded in a different order than they were submitted
+      return qSlicerCoreIOManagerPrepareLoadTaskPointer();
+      }
+    task->waitForFinished();
+    return task;
+    }
+  return qSlicerCoreIOManagerPrepareLoadTaskPointer();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::releasePrepareLoadTask(qSlicerCoreIOManagerPrepareLoadTaskPointer task)
+{
+  // Data that load() did not use (e.g., because another reader loaded the file) is released
+  task->Reader->discardPreparedLoad(task->Properties);
+  this->PrepareLoadMemoryInUse -= task->EstimatedMemory;
+  this->startPrepareLoadTasks();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::startWriteTasks()
+{
+  foreach(qSlicerCoreIOManagerWriteTaskPointer task, this->WriteTasks)
+    {
+    if (task->Started)
+      {
+      continue;
+      }
+    if (this->WriteMemoryInUse > 0
+      && this->WriteMemoryInUse + task->EstimatedMemory > this->ParallelSaveMemoryBudget)
+      {
+      // wait until written node data is released
+      break;
+      }
+    task->Started = true;
+    this->WriteMemoryInUse += task->EstimatedMemory;
+    this->WriteThreadPool.start(task.data());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::finishWriteTask(qSlicerCoreIOManagerWriteTaskPointer task)
+{
+  if (!task->Started)
+    {
+    task->Started = true;
+    this->WriteMemoryInUse += task->EstimatedMemory;
+    this->WriteThreadPool.start(task.data());
+    }
+  task->waitForFinished();
+  task->StorageNode->EndWriteDataDetached(task->Node, task->Written);
+  this->WriteMemoryInUse -= task->EstimatedMemory;
+  this->WriteTasks.removeOne(task);
+  this->FinishedWriteTasks << task;
+  this->startWriteTasks();
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManagerPrivate::isWriteScheduled(int fileIndex)const
+{
+  if (fileIndex < 0)
+    {
+    return false;
+    }
+  foreach(qSlicerCoreIOManagerWriteTaskPointer task, this->WriteTasks)
+    {
+    if (task->FileIndex == fileIndex)
+      {
+      return true;
+      }
+    }
+  foreach(qSlicerCoreIOManagerWriteTaskPointer task, this->FinishedWriteTasks)
+    {
+    if (task->FileIndex == fileIndex)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
 //-----------------------------------------------------------------------------
 QList<qSlicerFileWriter*> qSlicerCoreIOManagerPrivate::writers(
     const qSlicerIO::IOFileType& fileType, const qSlicerIO::IOProperties& parameters)const
@@ -476,6 +771,10 @@ bool qSlicerCoreIOManager::loadNodes(const qSlicerIO::IOFileType& fileType,
 
   const QList<qSlicerFileReader*>& readers = this->readers(fileType);
 
+  // If the file was decoded on a worker thread, wait for it
+  qSlicerCoreIOManagerPrepareLoadTaskPointer prepareLoadTask =
+    d->takePrepareLoadTask(fileType, parameters["fileName"].toString());
+
   // If no readers were able to read and load the file(s), success will remain false
   bool success = false;
 
@@ -493,16 +792,22 @@ bool qSlicerCoreIOManager::loadNodes(const qSlicerIO::IOFileType& fileType,
       {
       continue;
       }
-    float elapsedTimeInSeconds = timeProbe.elapsed() / 1000.0;
-    qDebug() << reader->description() << "Reader has successfully read the file"
-             << parameters["fileName"].toString()
-             << QString("[%1s]").arg(
-                  QString::number(elapsedTimeInSeconds,'f', 2));
+    double elapsedTimeInSeconds = timeProbe.elapsed() / 1000.0;
+    loadedFileParameters.insert("loadTimeInSeconds", elapsedTimeInSeconds);
+    if (!prepareLoadTask.isNull() && prepareLoadTask->Prepared && prepareLoadTask->Reader == reader)
+      {
+      loadedFileParameters.insert("prepareTimeInSeconds", prepareLoadTask->PrepareTimeInSeconds);
+      }
     nodes << reader->loadedNodes();
     success = true;
     break;
     }
 
+  if (!prepareLoadTask.isNull())
+    {
+    d->releasePrepareLoadTask(prepareLoadTask);
+    }
+
   loadedFileParameters.insert("nodeIDs", nodes);
 
   emit newFileLoaded(loadedFileParameters);
@@ -524,6 +829,7 @@ bool qSlicerCoreIOManager::
 loadNodes(const QList<qSlicerIO::IOProperties>& files,
           vtkCollection* loadedNodes)
 {
+  this->beginParallelLoad(files);
   bool res = true;
   foreach(qSlicerIO::IOProperties fileProperties, files)
     {
@@ -534,9 +840,109 @@ loadNodes(const QList<qSlicerIO::IOProperties>& files,
 
       && res;
     }
+  this->endParallelLoad();
   return res;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setParallelLoadEnabled(bool enabled)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ParallelLoadEnabled = enabled;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::isParallelLoadEnabled()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ParallelLoadEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setParallelLoadMemoryBudget(qint64 bytes)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ParallelLoadMemoryBudget = bytes;
+}
+
+//-----------------------------------------------------------------------------
+qint64 qSlicerCoreIOManager::parallelLoadMemoryBudget()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ParallelLoadMemoryBudget;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::beginParallelLoad(const QList<qSlicerIO::IOProperties>& files)
+{
+  Q_D(qSlicerCoreIOManager);
+  if (!d->PrepareLoadTasks.isEmpty())
+    {
+    // files of a previous load that were not loaded
+    this->endParallelLoad();
+    }
+  if (!d->ParallelLoadEnabled || files.count() < 2)
+    {
+    return;
+    }
+  foreach(const qSlicerIO::IOProperties& fileProperties, files)
+    {
+    if (fileProperties["fileName"].type() == QVariant::StringList)
+      {
+      // lists of files are loaded file by file on the main thread
+      continue;
+      }
+    qSlicerIO::IOFileType fileType = fileProperties["fileType"].toString();
+    QString fileName = fileProperties["fileName"].toString();
+    // Use the same reader as loadNodes() would try first
+    qSlicerFileReader* preparingReader = 0;
+    foreach(qSlicerFileReader* reader, this->readers(fileType))
+      {
+      reader->setMRMLScene(d->currentScene());
+      if (reader->canLoadFile(fileName))
+        {
+        preparingReader = reader;
+        break;
+        }
+      }
+    if (!preparingReader)
+      {
+      continue;
+      }
+    qint64 estimatedMemory = QFileInfo(fileName).size();
+    foreach(const QString& additionalFileName, fileProperties["fileNames"].toStringList())
+      {
+      if (additionalFileName != fileName)
+        {
+        estimatedMemory += QFileInfo(additionalFileName).size();
+        }
+      }
+    d->PrepareLoadTasks << qSlicerCoreIOManagerPrepareLoadTaskPointer(
+      new qSlicerCoreIOManagerPrepareLoadTask(preparingReader, fileType, fileProperties, estimatedMemory));
+    }
+  d->startPrepareLoadTasks();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::endParallelLoad()
+{
+  Q_D(qSlicerCoreIOManager);
+  if (d->PrepareLoadTasks.isEmpty())
+    {
+    return;
+    }
+  d->PrepareLoadThreadPool.waitForDone();
+  foreach(qSlicerCoreIOManagerPrepareLoadTaskPointer task, d->PrepareLoadTasks)
+    {
+    if (task->Started && task->Prepared)
+      {
+      task->Reader->discardPreparedLoad(task->Properties);
+      }
+    }
+  d->PrepareLoadTasks.clear();
+  d->PrepareLoadMemoryInUse = 0;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLNode* qSlicerCoreIOManager::loadNodesAndGetFirst(
   qSlicerIO::IOFileType fileType,
@@ -582,6 +988,8 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
 
   Q_ASSERT(parameters.contains("fileName"));
 
+  d->WrittenNodes.clear();
+
   // HACK - See http://www.na-mic.org/Bug/view.php?id=3322
   //        Sort writers to ensure generic ones are last.
   const QList<qSlicerFileWriter*> writers = d->writers(fileType, parameters);
@@ -612,8 +1020,15 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
     return false;
     }
 
+  // Nodes whose data is written on a worker thread are reported by
+  // saveNodes(const QList<qSlicerIO::IOProperties>&, QList<qSlicerIO::IOProperties>*)
+  // once the write is complete.
+
+  d->WrittenNodes = nodes;
+
   if (nodes.count() == 0 &&
-      fileType != QString("SceneFile"))
+      fileType != QString("SceneFile") &&
+      !d->isWriteScheduled(d->SaveFileIndex))
     {
     // the writer did not report error
     // but did not report any successfully written nodes either
@@ -623,6 +1038,141 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                                     QList<qSlicerIO::IOProperties>* savedFiles)
+{
+  Q_D(qSlicerCoreIOManager);
+
+  d->ParallelSaveInProgress = d->ParallelSaveEnabled && files.count() > 1;
+  QList<qSlicerIO::IOProperties> savedFileProperties;
+  for (int fileIndex = 0; fileIndex < files.count(); ++fileIndex)
+    {
+    qSlicerIO::IOProperties fileProperties = files[fileIndex];
+    d->SaveFileIndex = fileIndex;
+    QTime timeProbe;
+    timeProbe.start();
+    bool success = this->saveNodes(
+      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
+      fileProperties);
+    fileProperties.insert("success", success);
+    fileProperties.insert("saveTimeInSeconds", timeProbe.elapsed() / 1000.0);
+    fileProperties.insert("writtenNodes", d->WrittenNodes);
+    savedFileProperties << fileProperties;
+    }
+  d->ParallelSaveInProgress = false;
+  d->SaveFileIndex = -1;
+
+  // Wait for the node data written on worker threads
+  while (!d->WriteTasks.isEmpty())
+    {
+    d->finishWriteTask(d->WriteTasks.first());
+    }
+  foreach(qSlicerCoreIOManagerWriteTaskPointer task, d->FinishedWriteTasks)
+    {
+    qSlicerIO::IOProperties& fileProperties = savedFileProperties[task->FileIndex];
+    fileProperties["success"] = fileProperties["success"].toBool() && task->Written;
+    fileProperties.insert("writeTimeInSeconds", task->WriteTimeInSeconds);
+    if (task->Written)
+      {
+      QStringList writtenNodes = fileProperties["writtenNodes"].toStringList();
+      writtenNodes << QString(task->Node->GetID());
+      fileProperties["writtenNodes"] = writtenNodes;
+      }
+    }
+  d->FinishedWriteTasks.clear();
+  d->WrittenNodes.clear();
+
+  bool res = true;
+  foreach(const qSlicerIO::IOProperties& fileProperties, savedFileProperties)
+    {
+    res = fileProperties["success"].toBool() && res;
+    }
+  if (savedFiles)
+    {
+    *savedFiles = savedFileProperties;
+    }
+  return res;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::scheduleParallelWrite(vtkMRMLStorageNode* storageNode, vtkMRMLStorableNode* node)
+{
+  Q_D(qSlicerCoreIOManager);
+  if (!d->ParallelSaveInProgress || !storageNode || !node
+    || !storageNode->CanWriteDataDetached(node))
+    {
+    return false;
+    }
+  // the storage node can only keep the data of one write
+  this->finishParallelWrite(storageNode);
+  if (!storageNode->PrepareWriteDataDetached(node))
+    {
+    return false;
+    }
+  qint64 estimatedMemory = static_cast<qint64>(storageNode->GetDetachedDataActualMemorySize()) * 1024;
+  d->WriteTasks << qSlicerCoreIOManagerWriteTaskPointer(
+    new qSlicerCoreIOManagerWriteTask(storageNode, node, d->SaveFileIndex, estimatedMemory));
+  d->startWriteTasks();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::finishParallelWrite(vtkMRMLStorageNode* storageNode)
+{
+  Q_D(qSlicerCoreIOManager);
+  foreach(qSlicerCoreIOManagerWriteTaskPointer task, d->WriteTasks)
+    {
+    if (task->StorageNode.GetPointer() == storageNode)
+      {
+      d->finishWriteTask(task);
+      break;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setParallelSaveEnabled(bool enabled)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ParallelSaveEnabled = enabled;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::isParallelSaveEnabled()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ParallelSaveEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setParallelSaveMaximumThreadCount(int threadCount)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->WriteThreadPool.setMaxThreadCount(threadCount);
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCoreIOManager::parallelSaveMaximumThreadCount()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->WriteThreadPool.maxThreadCount();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setParallelSaveMemoryBudget(qint64 bytes)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ParallelSaveMemoryBudget = bytes;
+}
+
+//-----------------------------------------------------------------------------
+qint64 qSlicerCoreIOManager::parallelSaveMemoryBudget()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ParallelSaveMemoryBudget;
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCoreIOManager::saveScene(const QString& fileName, QImage screenShot)
 {
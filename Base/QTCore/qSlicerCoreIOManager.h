@@ -46,6 +46,22 @@ class qSlicerFileWriter;
 class Q_SLICER_BASE_QTCORE_EXPORT qSlicerCoreIOManager:public QObject
 {
   Q_OBJECT;
+  /// Decode files on worker threads when multiple files are loaded at once.
+  /// \sa setParallelLoadEnabled()
+  Q_PROPERTY(bool parallelLoadEnabled READ isParallelLoadEnabled WRITE setParallelLoadEnabled)
+  /// Maximum memory (in bytes) used by files decoded on worker threads that
+  /// are not added to the scene yet.
+  /// \sa setParallelLoadMemoryBudget()
+  Q_PROPERTY(qint64 parallelLoadMemoryBudget READ parallelLoadMemoryBudget WRITE setParallelLoadMemoryBudget)
+  /// Write node data on worker threads when multiple nodes are saved at once.
+  /// \sa setParallelSaveEnabled()
+  Q_PROPERTY(bool parallelSaveEnabled READ isParallelSaveEnabled WRITE setParallelSaveEnabled)
+  /// Maximum number of worker threads writing node data.
+  /// \sa setParallelSaveMaximumThreadCount()
+  Q_PROPERTY(int parallelSaveMaximumThreadCount READ parallelSaveMaximumThreadCount WRITE setParallelSaveMaximumThreadCount)
+  /// Maximum memory (in bytes) used by node data that is written on worker threads.
+  /// \sa setParallelSaveMemoryBudget()
+  Q_PROPERTY(qint64 parallelSaveMemoryBudget READ parallelSaveMemoryBudget WRITE setParallelSaveMemoryBudget)
 public:
   qSlicerCoreIOManager(QObject* parent = 0);
   virtual ~qSlicerCoreIOManager();
@@ -106,9 +122,32 @@ public:
 
   /// Utility function that loads a bunch of files. The "fileType" attribute should
   /// in the parameter map for each node to load.
+  /// If parallel loading is enabled then the files are decoded on worker threads
+  /// and only the nodes are added to the scene sequentially, in the order of the files.
+  /// \sa setParallelLoadEnabled()
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = 0);
 
+  /// Enable decoding of files on a pool of worker threads when multiple files
+  /// are loaded by loadNodes(const QList<qSlicerIO::IOProperties>&, vtkCollection*).
+  /// Readers decode the files in qSlicerFileReader::prepareLoad(), the nodes are
+  /// added to the scene in qSlicerFileReader::load(), on the main thread.
+  /// Readers that do not implement prepareLoad() read the files on the main thread.
+  /// Entries whose "fileName" property is a string list are loaded file by file
+  /// on the main thread as well.
+  /// Disabled by default.
+  /// \sa setParallelLoadMemoryBudget()
+  void setParallelLoadEnabled(bool enabled);
+  bool isParallelLoadEnabled()const;
+
+  /// Set the maximum memory (in bytes) that may be used by files that have been
+  /// decoded on worker threads but not added to the scene yet. The size of the
+  /// files on disk is used as an estimate of the memory needed for decoding.
+  /// A file is always decoded if no other file is in progress.
+  /// By default it is a quarter of the physical memory.
+  void setParallelLoadMemoryBudget(qint64 bytes);
+  qint64 parallelLoadMemoryBudget()const;
+
   /// Load a list of node corresponding to \a fileType and return the first loaded node.
   /// This function is provided for convenience and is equivalent to call loadNodes
   /// with a vtkCollection parameter and retrieve the first element.
@@ -139,6 +178,61 @@ public:
                              const qSlicerIO::IOProperties& parameters);
 #endif
 
+  /// Utility function that saves a bunch of nodes. The "fileType" attribute should
+  /// be in the parameter map of each file to save.
+  /// If parallel saving is enabled then the data of the nodes is written on
+  /// worker threads by the writers that use scheduleParallelWrite(). All the
+  /// files are written when the function returns.
+  /// If \a savedFiles is not null, it is set to the parameters of each file,
+  /// in the same order, with a \a success (bool) key, the IDs of the nodes
+  /// that were written in \a writtenNodes (QStringList) and the time spent in
+  /// \a saveTimeInSeconds (on the main thread) and, if the data was written on
+  /// a worker thread, \a writeTimeInSeconds (double) keys.
+  /// Nodes written on a worker thread are reported only once the write is complete.
+  /// Return true if all the files were saved.
+  /// \sa setParallelSaveEnabled()
+  virtual bool saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                         QList<qSlicerIO::IOProperties>* savedFiles = 0);
+
+  /// Write the data of \a node with \a storageNode on a worker thread if the
+  /// node is saved by saveNodes(const QList<qSlicerIO::IOProperties>&, QList<qSlicerIO::IOProperties>*)
+  /// with parallel saving enabled, and if the storage node supports it.
+  /// Writers should call it instead of vtkMRMLStorageNode::WriteData().
+  /// Return true if the data is scheduled to be written, the result of the write
+  /// is then reported by saveNodes() and the writer must not report the node as
+  /// written. Return false otherwise, the writer must write the data itself.
+  /// \sa vtkMRMLStorageNode::CanWriteDataDetached()
+  bool scheduleParallelWrite(vtkMRMLStorageNode* storageNode, vtkMRMLStorableNode* node);
+
+  /// Wait until the data scheduled to be written by \a storageNode on a worker
+  /// thread is written. Writers must call it before they modify the properties
+  /// of a storage node (file name, format, compression...), as the storage node
+  /// is in use until the write is complete.
+  /// Does nothing if no data of \a storageNode is being written.
+  /// \sa scheduleParallelWrite()
+  void finishParallelWrite(vtkMRMLStorageNode* storageNode);
+
+  /// Enable writing of node data on a pool of worker threads when multiple
+  /// nodes are saved by saveNodes(const QList<qSlicerIO::IOProperties>&, QList<qSlicerIO::IOProperties>*).
+  /// Node data is copied on the main thread, written into a temporary file
+  /// on a worker thread and the temporary file replaces the file once it is complete.
+  /// Disabled by default.
+  /// \sa setParallelSaveMaximumThreadCount(), setParallelSaveMemoryBudget()
+  void setParallelSaveEnabled(bool enabled);
+  bool isParallelSaveEnabled()const;
+
+  /// Set the maximum number of worker threads that write node data.
+  /// By default it is the number of processor cores.
+  void setParallelSaveMaximumThreadCount(int threadCount);
+  int parallelSaveMaximumThreadCount()const;
+
+  /// Set the maximum memory (in bytes) that may be used by node data that is
+  /// written on worker threads. Data of a node is always written if no other
+  /// node data is in progress.
+  /// By default it is a quarter of the physical memory.
+  void setParallelSaveMemoryBudget(qint64 bytes);
+  qint64 parallelSaveMemoryBudget()const;
+
   /// Save a scene corresponding to \a fileName
   /// This function is provided for convenience and is equivalent to call
   /// saveNodes function with QString("SceneFile") with the fileName
@@ -163,6 +257,9 @@ signals:
   /// The \a loadedFileParameters QVariant map contains the parameters
   /// passed to the reader and also the \a fileType and \a nodeIDs keys respectively
   /// associated with a QString and a QStringList.
+  /// Timing of successfully loaded files is reported in the \a loadTimeInSeconds
+  /// (time spent on the main thread) and, if the file was decoded on a worker
+  /// thread, \a prepareTimeInSeconds keys (double).
   /// \sa loadNodes(const qSlicerIO::IOFileType&, const qSlicerIO::IOProperties&, vtkCollection*)
   void newFileLoaded(const qSlicerIO::IOProperties& loadedFileParameters);
 
@@ -180,6 +277,16 @@ protected:
   QList<qSlicerFileReader*> readers(const qSlicerIO::IOFileType& fileType)const;
   qSlicerFileReader* reader(const QString& ioDescription)const;
 
+  /// Start decoding \a files on worker threads if parallel loading is enabled.
+  /// Must be followed by endParallelLoad() when all files are loaded.
+  /// Subclasses that reimplement loadNodes(const QList<qSlicerIO::IOProperties>&, vtkCollection*)
+  /// should call these methods to support parallel loading.
+  /// \sa setParallelLoadEnabled()
+  void beginParallelLoad(const QList<qSlicerIO::IOProperties>& files);
+  /// Wait for the worker threads and release the data of the files that were
+  /// decoded but not loaded (e.g., because loading was canceled).
+  void endParallelLoad();
+
 protected:
   QScopedPointer<qSlicerCoreIOManagerPrivate> d_ptr;
 
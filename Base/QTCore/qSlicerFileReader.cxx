@@ -106,6 +106,25 @@ bool qSlicerFileReader::load(const IOProperties& properties)
   return false;
 }
 
+//----------------------------------------------------------------------------
+bool qSlicerFileReader::prepareLoad(const IOProperties& properties)
+{
+  Q_UNUSED(properties);
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void qSlicerFileReader::initializePrepareLoad(const IOProperties& properties)
+{
+  Q_UNUSED(properties);
+}
+
+//----------------------------------------------------------------------------
+void qSlicerFileReader::discardPreparedLoad(const IOProperties& properties)
+{
+  Q_UNUSED(properties);
+}
+
 //----------------------------------------------------------------------------
 void qSlicerFileReader::setLoadedNodes(const QStringList& nodes)
 {
@@ -64,6 +64,29 @@ public:
   /// \sa setLoadedNodes(), load()
   QStringList loadedNodes()const;
 
+  /// Decode the file(s) described by \a properties without modifying the scene,
+  /// so that a subsequent load() call with the same properties only has to add the
+  /// nodes to the scene.
+  /// It is called from worker threads when multiple files are loaded in parallel,
+  /// therefore it must not modify the scene, must not access any GUI object and must
+  /// support preparing different files concurrently.
+  /// Returns true if data has been prepared. The default implementation does nothing
+  /// and returns false, the file is then read as usual in load().
+  /// \sa initializePrepareLoad(), discardPreparedLoad(), qSlicerCoreIOManager::setParallelLoadEnabled()
+  virtual bool prepareLoad(const IOProperties& properties);
+
+  /// Called on the main thread before prepareLoad() is started for \a properties
+  /// on a worker thread. Readers can get here anything that they need from the
+  /// scene or the logic (e.g., default nodes), because prepareLoad() must not access them.
+  /// The default implementation does nothing.
+  /// \sa prepareLoad()
+  virtual void initializePrepareLoad(const IOProperties& properties);
+
+  /// Release the data prepared by prepareLoad() for \a properties if it has not
+  /// been used by load() (e.g., loading has been canceled).
+  /// The default implementation does nothing.
+  virtual void discardPreparedLoad(const IOProperties& properties);
+
 protected:
   /// Must be called in load() on success with the list of nodes added into the
   /// scene.
@@ -39,6 +39,7 @@ public:
   QStringList LoadedModules;
   vtkSlicerApplicationLogic* AppLogic;
   vtkMRMLScene* MRMLScene;
+  bool LazyLoading;
 };
 
 //-----------------------------------------------------------------------------
@@ -49,6 +50,7 @@ qSlicerModuleFactoryManagerPrivate
 {
   this->AppLogic = 0;
   this->MRMLScene = 0;
+  this->LazyLoading = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -79,6 +81,11 @@ int qSlicerModuleFactoryManager::loadModules()
 {
   foreach(const QString& name, this->instantiatedModuleNames())
     {
+    if (this->isLoadedOnDemand(name))
+      {
+      emit this->moduleDeferred(name);
+      continue;
+      }
     this->loadModule(name);
     }
   emit this->modulesLoaded(this->loadedModuleNames());
@@ -168,6 +175,8 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
   // Update internal Map
   d->LoadedModules << name;
 
+  qint64 startTimestamp = this->profilingTimestamp();
+
   // Initialize module
   instance->initialize(d->AppLogic);
 
@@ -186,6 +195,8 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
   this->connect(this,SIGNAL(mrmlSceneChanged(vtkMRMLScene*)),
                 instance, SLOT(setMRMLScene(vtkMRMLScene*)));
 
+  this->addProfilingEvent(name, "load", startTimestamp);
+
   // Handle post-load initialization
   emit this->moduleLoaded(name);
 
@@ -288,6 +299,55 @@ qSlicerAbstractCoreModule* qSlicerModuleFactoryManager::loadedModule(const QStri
   return this->moduleInstance(name);
 }
 
+//---------------------------------------------------------------------------
+qSlicerAbstractCoreModule* qSlicerModuleFactoryManager::loadModuleOnDemand(const QString& name)
+{
+  if (!this->isLoaded(name))
+    {
+    if (this->Superclass::isVerbose())
+      {
+      qDebug() << "Loading module on demand" << name;
+      }
+    if (!this->loadModule(name))
+      {
+      return 0;
+      }
+    }
+  return this->loadedModule(name);
+}
+
+//---------------------------------------------------------------------------
+bool qSlicerModuleFactoryManager::isLoadedOnDemand(const QString& name)const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  if (!d->LazyLoading)
+    {
+    return false;
+    }
+  qSlicerAbstractCoreModule* instance = this->moduleInstance(name);
+  if (!instance)
+    {
+    return false;
+    }
+  // Modules that other modules rely on or that add support for file types
+  // are always loaded.
+  return this->moduleDependees(name).isEmpty() && !instance->registersIO();
+}
+
+//---------------------------------------------------------------------------
+void qSlicerModuleFactoryManager::setLazyLoading(bool lazy)
+{
+  Q_D(qSlicerModuleFactoryManager);
+  d->LazyLoading = lazy;
+}
+
+//---------------------------------------------------------------------------
+bool qSlicerModuleFactoryManager::lazyLoading()const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  return d->LazyLoading;
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerModuleFactoryManager::setAppLogic(vtkSlicerApplicationLogic* logic)
 {
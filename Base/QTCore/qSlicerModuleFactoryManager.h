@@ -38,6 +38,18 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerModuleFactoryManager
   : public qSlicerAbstractModuleFactoryManager
 {
   Q_OBJECT
+  /// This property controls whether some modules are loaded only when they
+  /// are first used.
+  ///
+  /// When enabled, loadModules() does not load the modules that no other
+  /// module depends on and that don't register IO (readers, writers or file
+  /// dialogs), see qSlicerAbstractCoreModule::registersIO(). These modules are
+  /// instantiated, but loaded by loadModuleOnDemand(), or when a module that
+  /// depends on them is loaded.
+  /// It speeds up startup when only a few modules are needed (e.g. batch
+  /// processing). Disabled by default.
+  /// \sa isLoadedOnDemand(), loadModuleOnDemand()
+  Q_PROPERTY(bool lazyLoading READ lazyLoading WRITE setLazyLoading)
 public:
   typedef qSlicerAbstractModuleFactoryManager Superclass;
   qSlicerModuleFactoryManager(QObject* newParent = 0);
@@ -47,7 +59,8 @@ public:
 
   virtual void printAdditionalInfo();
 
-  /// Load all the instantiated modules.
+  /// Load all the instantiated modules, except the modules that are loaded
+  /// on demand.
   /// To register and initialize modules, please use
   /// qSlicerModuleFactoryManager::registerModules();
   /// qSlicerModuleFactoryManager::initializeModules();
@@ -69,8 +82,23 @@ public:
 
   /// Return the loaded module identified by \a name, 0 if no module
   /// has been loaded yet, even if the module has been instantiated.
+  /// \sa loadModuleOnDemand()
   Q_INVOKABLE qSlicerAbstractCoreModule* loadedModule(const QString& name)const;
 
+  /// Load the module identified by \a name if it is not loaded yet and
+  /// return it. Return 0 if the module fails to be loaded.
+  /// \sa lazyLoading, isLoadedOnDemand()
+  Q_INVOKABLE qSlicerAbstractCoreModule* loadModuleOnDemand(const QString& name);
+
+  /// Return true if lazy loading is enabled and the instantiated module
+  /// \a name is not loaded at startup: no other instantiated module depends
+  /// on it and it does not register IO.
+  /// \sa lazyLoading, qSlicerAbstractCoreModule::registersIO()
+  Q_INVOKABLE bool isLoadedOnDemand(const QString& name)const;
+
+  void setLazyLoading(bool lazy);
+  bool lazyLoading()const;
+
   /// Set the application logic to pass to modules at "load" time.
   void setAppLogic(vtkSlicerApplicationLogic* applicationLogic);
   vtkSlicerApplicationLogic* appLogic()const;
@@ -99,6 +127,9 @@ signals:
 
   void modulesLoaded(const QStringList& modulesNames);
   void moduleLoaded(const QString& moduleName);
+  /// Emitted by loadModules() for each module that is loaded on demand.
+  /// \sa isLoadedOnDemand()
+  void moduleDeferred(const QString& moduleName);
 
   void modulesAboutToBeUnloaded(const QStringList& modulesNames);
   void moduleAboutToBeUnloaded(const QString& moduleName);
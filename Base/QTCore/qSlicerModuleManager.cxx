@@ -43,6 +43,8 @@ qSlicerModuleManager::qSlicerModuleManager(QObject* newParent)
   d->ModuleFactoryManager = new qSlicerModuleFactoryManager(this);
   connect(d->ModuleFactoryManager, SIGNAL(moduleLoaded(QString)),
           this, SIGNAL(moduleLoaded(QString)));
+  connect(d->ModuleFactoryManager, SIGNAL(moduleDeferred(QString)),
+          this, SIGNAL(moduleDeferred(QString)));
   connect(d->ModuleFactoryManager, SIGNAL(moduleAboutToBeUnloaded(QString)),
           this, SIGNAL(moduleAboutToBeUnloaded(QString)));
 }
@@ -72,12 +74,25 @@ qSlicerModuleFactoryManager* qSlicerModuleManager::factoryManager()const
 qSlicerAbstractCoreModule* qSlicerModuleManager::module(const QString& name)const
 {
   Q_D(const qSlicerModuleManager);
-  return d->ModuleFactoryManager->loadedModule(name);
+  qSlicerAbstractCoreModule* module = d->ModuleFactoryManager->loadedModule(name);
+  if (!module && d->ModuleFactoryManager->isLoadedOnDemand(name))
+    {
+    module = d->ModuleFactoryManager->loadModuleOnDemand(name);
+    }
+  return module;
 }
 
 //---------------------------------------------------------------------------
 QStringList qSlicerModuleManager::modulesNames()const
 {
   Q_D(const qSlicerModuleManager);
-  return d->ModuleFactoryManager->loadedModuleNames();
+  QStringList names = d->ModuleFactoryManager->loadedModuleNames();
+  foreach(const QString& name, d->ModuleFactoryManager->instantiatedModuleNames())
+    {
+    if (!names.contains(name) && d->ModuleFactoryManager->isLoadedOnDemand(name))
+      {
+      names << name;
+      }
+    }
+  return names;
 }
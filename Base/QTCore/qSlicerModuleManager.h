@@ -49,14 +49,21 @@ public:
   /// Return a pointer to the current module factory manager
   Q_INVOKABLE qSlicerModuleFactoryManager * factoryManager()const;
 
-  /// Return the list of all the loaded modules
+  /// Return the list of all the loaded modules and of the modules that are
+  /// loaded on demand.
+  /// \sa qSlicerModuleFactoryManager::isLoadedOnDemand()
   Q_INVOKABLE QStringList modulesNames()const;
 
-  /// Return the loaded module identified by \a name
+  /// Return the loaded module identified by \a name. A module that is loaded
+  /// on demand is loaded by the first call.
+  /// \sa qSlicerModuleFactoryManager::loadModuleOnDemand()
   Q_INVOKABLE qSlicerAbstractCoreModule* module(const QString& name)const;
 
 signals:
   void moduleLoaded(const QString& module);
+  /// Emitted for the modules that are not loaded at startup but on demand.
+  /// \sa module()
+  void moduleDeferred(const QString& module);
   void moduleAboutToBeUnloaded(const QString& module);
 
 protected:
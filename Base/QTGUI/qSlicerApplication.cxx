@@ -76,6 +76,7 @@
 
 // qMRMLWidget includes
 #include "qMRMLEventBrokerConnection.h"
+#include "qMRMLSceneModel.h"
 
 // qMRML includes
 #ifdef Slicer_USE_QtTesting
@@ -242,6 +243,10 @@ void qSlicerApplicationPrivate::init()
   q->setupFileLogging();
   q->logApplicationInformation();
 
+  // Must be set before module widgets (and their node selectors) are created
+  qMRMLSceneModel::setDefaultDeferNodeModifiedUpdate(
+    q->userSettings()->value("Developer/DeferNodeModifiedUpdate", true).toBool());
+
   //----------------------------------------------------------------------------
   // Settings Dialog
   //----------------------------------------------------------------------------
@@ -127,9 +127,20 @@ void qSlicerIOManagerPrivate::stopProgressDialog()
 //-----------------------------------------------------------------------------
 void qSlicerIOManagerPrivate::readSettings()
 {
+  Q_Q(qSlicerIOManager);
   QSettings settings;
   settings.beginGroup("ioManager");
 
+  // Decode files on worker threads when multiple files are loaded (e.g., drag-and-drop)
+  q->setParallelLoadEnabled(settings.value("parallelLoad", false).toBool());
+
+  // Write node data on worker threads when multiple nodes are saved (e.g., save data dialog)
+  q->setParallelSaveEnabled(settings.value("parallelSave", false).toBool());
+  if (settings.contains("parallelSaveMaximumThreadCount"))
+    {
+    q->setParallelSaveMaximumThreadCount(settings.value("parallelSaveMaximumThreadCount").toInt());
+    }
+
   if (!settings.value("favoritesPaths").toList().isEmpty())
     {
     foreach (const QString& varUrl, settings.value("favoritesPaths").toStringList())
@@ -434,6 +445,7 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
   Q_D(qSlicerIOManager);
 
   bool needStop = d->startProgressDialog(files.count());
+  this->beginParallelLoad(files);
   bool res = true;
   foreach(qSlicerIO::IOProperties fileProperties, files)
     {
@@ -449,6 +461,7 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
       break;
       }
     }
+  this->endParallelLoad();
 
   if (needStop)
     {
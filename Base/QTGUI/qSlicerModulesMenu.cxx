@@ -24,6 +24,7 @@
 
 // CTK includes
 #include "qSlicerAbstractModule.h"
+#include "qSlicerModuleFactoryManager.h"
 #include "qSlicerModuleManager.h"
 
 // SlicerQt includes
@@ -362,6 +363,9 @@ void qSlicerModulesMenu::setModuleManager(qSlicerModuleManager* moduleManager)
     QObject::disconnect(d->ModuleManager,
                         SIGNAL(moduleLoaded(QString)),
                         this, SLOT(addModule(QString)));
+    QObject::disconnect(d->ModuleManager,
+                        SIGNAL(moduleDeferred(QString)),
+                        this, SLOT(addModule(QString)));
     QObject::disconnect(d->ModuleManager,
                         SIGNAL(moduleAboutToBeUnloaded(QString)),
                         this, SLOT(removeModule(QString)));
@@ -380,6 +384,9 @@ void qSlicerModulesMenu::setModuleManager(qSlicerModuleManager* moduleManager)
   QObject::connect(d->ModuleManager,
                    SIGNAL(moduleLoaded(QString)),
                    this, SLOT(addModule(QString)));
+  QObject::connect(d->ModuleManager,
+                   SIGNAL(moduleDeferred(QString)),
+                   this, SLOT(addModule(QString)));
   QObject::connect(d->ModuleManager,
                    SIGNAL(moduleAboutToBeUnloaded(QString)),
                    this, SLOT(removeModule(QString)));
@@ -404,7 +411,14 @@ QAction* qSlicerModulesMenu::moduleAction(const QString& moduleName)const
 void qSlicerModulesMenu::addModule(const QString& moduleName)
 {
   Q_D(qSlicerModulesMenu);
-  this->addModule(d->ModuleManager ? d->ModuleManager->module(moduleName) : 0);
+  // A module loaded on demand is already in the menu.
+  if (d->action(QVariant(moduleName), d->AllModulesMenu))
+    {
+    return;
+    }
+  // Don't use module(), it would load the modules that are loaded on demand.
+  this->addModule(d->ModuleManager ?
+    d->ModuleManager->factoryManager()->moduleInstance(moduleName) : 0);
 }
 
 //---------------------------------------------------------------------------
@@ -478,7 +492,8 @@ void qSlicerModulesMenu::addModule(qSlicerAbstractCoreModule* moduleToAdd)
 void qSlicerModulesMenu::removeModule(const QString& moduleName)
 {
    Q_D(qSlicerModulesMenu);
-  this->removeModule(d->ModuleManager ? d->ModuleManager->module(moduleName) : 0);
+  this->removeModule(d->ModuleManager ?
+    d->ModuleManager->factoryManager()->moduleInstance(moduleName) : 0);
 }
 
 //---------------------------------------------------------------------------
@@ -142,13 +142,16 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
     return false;
     }
 
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  // The storage node may still be writing the data of a previously saved file
+  // on a worker thread, its properties can only be changed once it is done.
+  coreIOManager->finishParallelWrite(snode);
+
   Q_ASSERT(!properties["fileName"].toString().isEmpty());
   QString fileName = properties["fileName"].toString();
   snode->SetFileName(fileName.toLatin1());
 
-  qSlicerCoreIOManager* coreIOManager =
-    qSlicerCoreApplication::application()->coreIOManager();
-
   QString fileFormat =
     properties.value("fileFormat", coreIOManager->completeSlicerWritableFileNameSuffix(node)).toString();
   snode->SetWriteFileFormat(fileFormat.toLatin1());
@@ -157,6 +160,13 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
     {
     snode->SetUseCompression(properties["useCompression"].toInt());
     }
+  // When multiple nodes are saved, the data may be written on a worker thread.
+  // The node is then reported as written by the IO manager once the write is complete.
+  if (coreIOManager->scheduleParallelWrite(snode, node))
+    {
+    return true;
+    }
+
   bool res = snode->WriteData(node);
 
   if (res)
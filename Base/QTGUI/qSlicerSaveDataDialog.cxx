@@ -814,6 +814,8 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 {
   QMessageBox::StandardButton forceOverwrite = QMessageBox::Ignore;
   QList<qSlicerIO::IOProperties> files;
+  // row of each file to save
+  QList<int> rows;
   const int sceneRow = this->findSceneRow();
   for (int row = 0; row < this->FileWidget->rowCount(); ++row)
     {
@@ -825,7 +827,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 
     QTableWidgetItem* selectItem = this->FileWidget->item(row, SelectColumn);
     QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
-    QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
 
     Q_ASSERT(selectItem);
     Q_ASSERT(nodeNameItem);
@@ -885,7 +886,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
     qSlicerCoreIOManager* coreIOManager =
       qSlicerCoreApplication::application()->coreIOManager();
     Q_ASSERT(coreIOManager);
-    qSlicerIO::IOFileType fileType = coreIOManager->fileWriterFileType(node);
     qSlicerIO::IOProperties savingParameters;
     if (options)
       {
@@ -893,28 +893,80 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
       // \todo fileName is wrong as it contains an obsolete directory
       savingParameters = options->properties();
       }
+    savingParameters["fileType"] = coreIOManager->fileWriterFileType(node);
     savingParameters["nodeID"] = QString(node->GetID());
     savingParameters["fileName"] = file.absoluteFilePath();
     savingParameters["fileFormat"] = format;
-    bool res = coreIOManager->saveNodes(fileType, savingParameters);
+    files << savingParameters;
+    rows << row;
+    }
 
-    // node has failed to be written
-    if (!res)
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  Q_ASSERT(coreIOManager);
+
+  if (!coreIOManager->isParallelSaveEnabled())
+    {
+    // Save nodes one by one so that saving can be stopped at the first failure
+    for (int fileIndex = 0; fileIndex < files.count(); ++fileIndex)
       {
-      QMessageBox::StandardButton answer =
-        QMessageBox::question(this, tr("Saving node..."),
-                              tr("Cannot write data file: %1.\n"
-                                 "Do you want to continue saving?").arg(file.absoluteFilePath()),
-                              QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
-      if (answer == QMessageBox::No)
+      const qSlicerIO::IOProperties& savingParameters = files[fileIndex];
+      bool res = coreIOManager->saveNodes(
+        static_cast<qSlicerIO::IOFileType>(savingParameters["fileType"].toString()),
+        savingParameters);
+
+      // node has failed to be written
+      if (!res)
         {
-        return false;
+        QMessageBox::StandardButton answer =
+          QMessageBox::question(this, tr("Saving node..."),
+                                tr("Cannot write data file: %1.\n"
+                                   "Do you want to continue saving?").arg(savingParameters["fileName"].toString()),
+                                QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (answer == QMessageBox::No)
+          {
+          return false;
+          }
         }
+
+      // clean up node after saving
+      const int row = rows[fileIndex];
+      this->FileWidget->item(row, NodeNameColumn)->setCheckState(Qt::Unchecked);
+      this->FileWidget->item(row, NodeStatusColumn)->setText("Not Modified");
       }
+    return true;
+    }
 
+  // Save all the nodes at once so that their data can be written in parallel
+  QList<qSlicerIO::IOProperties> savedFiles;
+  coreIOManager->saveNodes(files, &savedFiles);
+
+  QStringList failedFileNames;
+  for (int fileIndex = 0; fileIndex < savedFiles.count(); ++fileIndex)
+    {
+    if (!savedFiles[fileIndex]["success"].toBool())
+      {
+      failedFileNames << savedFiles[fileIndex]["fileName"].toString();
+      continue;
+      }
     // clean up node after saving
-    nodeNameItem->setCheckState(Qt::Unchecked);
-    nodeStatusItem->setText("Not Modified");
+    const int row = rows[fileIndex];
+    this->FileWidget->item(row, NodeNameColumn)->setCheckState(Qt::Unchecked);
+    this->FileWidget->item(row, NodeStatusColumn)->setText("Not Modified");
+    }
+
+  // nodes have failed to be written
+  if (!failedFileNames.isEmpty())
+    {
+    QMessageBox::StandardButton answer =
+      QMessageBox::question(this, tr("Saving node..."),
+                            tr("Cannot write data file(s):\n%1\n"
+                               "Do you want to continue saving?").arg(failedFileNames.join("\n")),
+                            QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+    if (answer == QMessageBox::No)
+      {
+      return false;
+      }
     }
   return true;
 }
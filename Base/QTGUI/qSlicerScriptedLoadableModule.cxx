@@ -249,6 +249,38 @@ void qSlicerScriptedLoadableModule::registerIO()
   // TODO qSlicerScriptedFileReader
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerScriptedLoadableModule::registersIO()const
+{
+  Q_D(const qSlicerScriptedLoadableModule);
+  if (d->PythonSource.isEmpty() || !Py_IsInitialized())
+    {
+    return false;
+    }
+  QString moduleName = QFileInfo(d->PythonSource).baseName();
+  PyObject * module = PyImport_AddModule(moduleName.toLatin1());
+  if (!module)
+    {
+    PyErr_Clear();
+    return false;
+    }
+  if (PyObject_HasAttrString(module, QString(moduleName + "FileWriter").toLatin1())
+    || PyObject_HasAttrString(module, QString(moduleName + "FileDialog").toLatin1()))
+    {
+    return true;
+    }
+  // ScriptedLoadableModule does not define setup(), a module class that has
+  // one registers something (e.g. subject hierarchy plugins) at startup.
+  PythonQtObjectPtr moduleClass;
+  moduleClass.setNewRef(PyObject_GetAttrString(module, moduleName.toLatin1()));
+  if (!moduleClass)
+    {
+    PyErr_Clear();
+    return false;
+    }
+  return PyObject_HasAttrString(moduleClass, "setup");
+}
+
 //-----------------------------------------------------------------------------
 qSlicerAbstractModuleRepresentation* qSlicerScriptedLoadableModule::createWidgetRepresentation()
 {
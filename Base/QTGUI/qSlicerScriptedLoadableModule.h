@@ -92,6 +92,13 @@ public:
   virtual bool isHidden()const;
   void setHidden(bool hidden);
 
+  /// Return true if the python source defines a file writer
+  /// (<ModuleName>FileWriter class) or a file dialog (<ModuleName>FileDialog class),
+  /// or if the module class implements setup(). Such a setup() typically
+  /// registers plugins that must be available before the module is used.
+  /// \sa registerIO(), registerFileDialog()
+  virtual bool registersIO()const;
+
 protected:
 
   virtual void setup();
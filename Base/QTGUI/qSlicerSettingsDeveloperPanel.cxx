@@ -26,6 +26,9 @@
 #include "qSlicerSettingsDeveloperPanel.h"
 #include "ui_qSlicerSettingsDeveloperPanel.h"
 
+// MRMLWidgets includes
+#include "qMRMLSceneModel.h"
+
 // --------------------------------------------------------------------------
 // qSlicerSettingsDeveloperPanelPrivate
 
@@ -61,6 +64,7 @@ void qSlicerSettingsDeveloperPanelPrivate::init()
   // Default values
   this->DeveloperModeEnabledCheckBox->setChecked(false);
   this->QtTestingEnabledCheckBox->setChecked(false);
+  this->DeferNodeModifiedUpdateCheckBox->setChecked(true);
 #ifndef Slicer_USE_QtTesting
   this->QtTestingEnabledCheckBox->hide();
   this->QtTestingEnabledLabel->hide();
@@ -76,11 +80,18 @@ void qSlicerSettingsDeveloperPanelPrivate::init()
                       "checked", SIGNAL(toggled(bool)),
                       "Enable/Disable QtTesting", ctkSettingsPanel::OptionRequireRestart);
 
+  // Existing node selectors keep their update mode, therefore restart is required
+  q->registerProperty("Developer/DeferNodeModifiedUpdate", this->DeferNodeModifiedUpdateCheckBox,
+                      "checked", SIGNAL(toggled(bool)),
+                      "Defer node selector updates", ctkSettingsPanel::OptionRequireRestart);
+
   // Actions to propagate to the application when settings are changed
   QObject::connect(this->DeveloperModeEnabledCheckBox, SIGNAL(toggled(bool)),
                    q, SLOT(enableDeveloperMode(bool)));
   QObject::connect(this->QtTestingEnabledCheckBox, SIGNAL(toggled(bool)),
                    q, SLOT(enableQtTesting(bool)));
+  QObject::connect(this->DeferNodeModifiedUpdateCheckBox, SIGNAL(toggled(bool)),
+                   q, SLOT(setDeferNodeModifiedUpdate(bool)));
 
 }
 
@@ -112,3 +123,10 @@ void qSlicerSettingsDeveloperPanel::enableQtTesting(bool value)
 {
   Q_UNUSED(value);
 }
+
+// --------------------------------------------------------------------------
+void qSlicerSettingsDeveloperPanel::setDeferNodeModifiedUpdate(bool value)
+{
+  // Applies to the node selectors created from now on
+  qMRMLSceneModel::setDefaultDeferNodeModifiedUpdate(value);
+}
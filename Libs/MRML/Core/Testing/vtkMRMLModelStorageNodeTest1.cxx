@@ -21,9 +21,14 @@
 #include <vtkTriangleFilter.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkVoxel.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iterator>
 
 //---------------------------------------------------------------------------
 int TestReadWriteData(vtkMRMLScene* scene, const char* extension, vtkPointSet*mesh);
+int TestDetachedWriteData(vtkMRMLScene* scene, const char* extension, vtkPointSet*mesh, bool detachedWriteSupported);
 void CreateVoxelMeshes(vtkUnstructuredGrid* ug, vtkPolyData* poly);
 
 //---------------------------------------------------------------------------
@@ -53,6 +58,11 @@ int vtkMRMLModelStorageNodeTest1(int argc, char * argv[] )
   CHECK_EXIT_SUCCESS(TestReadWriteData(scene.GetPointer(), ".ply", poly.GetPointer()));
   CHECK_EXIT_SUCCESS(TestReadWriteData(scene.GetPointer(), ".obj", poly.GetPointer()));
 
+  CHECK_EXIT_SUCCESS(TestDetachedWriteData(scene.GetPointer(), ".vtu", ug.GetPointer(), true));
+  CHECK_EXIT_SUCCESS(TestDetachedWriteData(scene.GetPointer(), ".vtp", poly.GetPointer(), true));
+  CHECK_EXIT_SUCCESS(TestDetachedWriteData(scene.GetPointer(), ".stl", poly.GetPointer(), true));
+  CHECK_EXIT_SUCCESS(TestDetachedWriteData(scene.GetPointer(), ".obj", poly.GetPointer(), false));
+
   return EXIT_SUCCESS;
 }
 
@@ -98,3 +108,79 @@ int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkPointSet *m
 
   return EXIT_SUCCESS;
 }
+
+//---------------------------------------------------------------------------
+int TestDetachedWriteData(vtkMRMLScene* scene, const char *extension, vtkPointSet *mesh, bool detachedWriteSupported)
+{
+  std::string fileName = std::string(scene->GetRootDirectory()) +
+                         std::string("/vtkMRMLModelNodeTest1Detached") +
+                         std::string(extension);
+  std::string temporaryFileName = std::string(scene->GetRootDirectory()) +
+                         std::string("/.tmp-vtkMRMLModelNodeTest1Detached") +
+                         std::string(extension);
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetAndObserveMesh(mesh);
+  CHECK_NOT_NULL(scene->AddNode(modelNode.GetPointer()));
+  modelNode->AddDefaultStorageNode();
+  vtkMRMLStorageNode* storageNode = modelNode->GetStorageNode();
+  CHECK_NOT_NULL(storageNode);
+  storageNode->SetFileName(fileName.c_str());
+
+  std::cout << "Testing detached write of " << extension << std::endl;
+  CHECK_BOOL(storageNode->CanWriteDataDetached(modelNode.GetPointer()), detachedWriteSupported);
+  if (!detachedWriteSupported)
+    {
+    return EXIT_SUCCESS;
+    }
+
+  CHECK_BOOL(modelNode->GetModifiedSinceRead(), true);
+  CHECK_BOOL(storageNode->PrepareWriteDataDetached(modelNode.GetPointer()), true);
+  CHECK_BOOL(storageNode->GetDetachedDataActualMemorySize() > 0, true);
+  // Nothing is written until WriteDataDetached() is called
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileName.c_str(), true), false);
+  CHECK_BOOL(storageNode->WriteDataDetached(), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileName.c_str(), true), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(temporaryFileName.c_str(), true), false);
+  // The node is marked as stored only when the write is ended
+  CHECK_BOOL(modelNode->GetModifiedSinceRead(), true);
+  storageNode->EndWriteDataDetached(modelNode.GetPointer(), true);
+  CHECK_BOOL(storageNode->HasDetachedData(), false);
+  CHECK_BOOL(modelNode->GetModifiedSinceRead(), false);
+
+  // Read the written file
+  vtkNew<vtkMRMLModelNode> readModelNode;
+  CHECK_NOT_NULL(scene->AddNode(readModelNode.GetPointer()));
+  readModelNode->AddDefaultStorageNode();
+  readModelNode->GetStorageNode()->SetFileName(fileName.c_str());
+  CHECK_BOOL(readModelNode->GetStorageNode()->ReadData(readModelNode.GetPointer()), true);
+  CHECK_NOT_NULL(readModelNode->GetMesh());
+  CHECK_INT(readModelNode->GetMesh()->GetNumberOfPoints(), mesh->GetNumberOfPoints());
+
+  // An existing file is replaced and nothing is written without prepared data
+  CHECK_BOOL(storageNode->PrepareWriteDataDetached(modelNode.GetPointer()), true);
+  CHECK_BOOL(storageNode->WriteDataDetached(), true);
+  storageNode->EndWriteDataDetached(modelNode.GetPointer(), true);
+  // Errors of the write are not logged from the (worker) thread that writes,
+  // they are reported when the write is ended
+  CHECK_BOOL(storageNode->WriteDataDetached(), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  storageNode->EndWriteDataDetached(modelNode.GetPointer(), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  // Storage node properties are captured when the write is prepared
+  storageNode->SetUseCompression(0);
+  CHECK_BOOL(storageNode->PrepareWriteDataDetached(modelNode.GetPointer()), true);
+  storageNode->SetUseCompression(1);
+  CHECK_BOOL(storageNode->WriteDataDetached(), true);
+  storageNode->EndWriteDataDetached(modelNode.GetPointer(), true);
+  if (std::string(extension) == ".vtp" || std::string(extension) == ".vtu")
+    {
+    std::ifstream writtenFile(fileName.c_str());
+    std::string content((std::istreambuf_iterator<char>(writtenFile)), std::istreambuf_iterator<char>());
+    CHECK_BOOL(content.find("format=\"ascii\"") != std::string::npos, true);
+    }
+
+  return EXIT_SUCCESS;
+}
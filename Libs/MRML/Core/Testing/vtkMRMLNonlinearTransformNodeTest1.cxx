@@ -23,11 +23,17 @@
 
 #include <vtkCollection.h>
 #include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
 #include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPoints.h>
 #include <vtkPointSource.h>
+#include <vtkSmartPointer.h>
 #include <vtkTransform.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include "vtkMRMLCoreTestingMacros.h"
 
 int TestBSplineTransform(const char *filename);
@@ -37,6 +43,7 @@ int TestCompositeTransformHardenSplit(const char *filename);
 int TestBSplineLinearCompositeTransformSplit(const char *filename);
 int TestRelativeTransforms(const char *filename);
 int TestGetTransform();
+int TestCachedInverseDisplacementField(const char *filename);
 
 int vtkMRMLNonlinearTransformNodeTest1(int argc, char * argv[] )
 {
@@ -55,6 +62,7 @@ int vtkMRMLNonlinearTransformNodeTest1(int argc, char * argv[] )
   CHECK_EXIT_SUCCESS(TestBSplineLinearCompositeTransformSplit(filename));
   CHECK_EXIT_SUCCESS(TestRelativeTransforms(filename));
   CHECK_EXIT_SUCCESS(TestGetTransform());
+  CHECK_EXIT_SUCCESS(TestCachedInverseDisplacementField(filename));
 
   std::cout << "Success" << std::endl;
   return EXIT_SUCCESS;
@@ -415,3 +423,162 @@ int TestGetTransform()
 
   return EXIT_SUCCESS;
 }
+
+//---------------------------------------------------------------------------
+// Returns true if the transform uses a cached inverse displacement field
+// (instead of the exact transform from world).
+bool IsCachedInverseUsed(vtkGeneralTransform* transform)
+{
+  return transform->GetNumberOfConcatenatedTransforms() == 1
+    && strcmp(transform->GetConcatenatedTransform(0)->GetClassName(), "vtkMRMLTransformNodeCachedGridTransform") == 0;
+}
+
+//---------------------------------------------------------------------------
+int TestCachedInverseDisplacementField(const char *filename)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetURL(filename);
+  scene->Import();
+
+  vtkMRMLTransformNode *transformNode = vtkMRMLTransformNode::SafeDownCast(scene->GetNodeByID("vtkMRMLGridTransformNode1"));
+  CHECK_NOT_NULL(transformNode);
+  // Grid transform is stored as transform from parent. Invert it so that
+  // transform from world can only be computed by iterative inversion.
+  transformNode->Inverse();
+
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  for (int axis = 0; axis < 3; axis++)
+    {
+    ijkToRAS->SetElement(axis, axis, 5.0);
+    ijkToRAS->SetElement(axis, 3, -25.0);
+    }
+  int extent[6] = { 0, 10, 0, 10, 0, 10 };
+
+  vtkImageData* inverseDisplacementField = transformNode->GetCachedDisplacementField(ijkToRAS.GetPointer(), extent, false);
+  CHECK_NOT_NULL(inverseDisplacementField);
+
+  // Compare to inverse computed point by point
+  vtkNew<vtkGeneralTransform> transformFromWorld;
+  transformNode->GetTransformFromWorld(transformFromWorld.GetPointer());
+  for (int k = extent[4]; k <= extent[5]; k += 5)
+    {
+    for (int j = extent[2]; j <= extent[3]; j += 5)
+      {
+      for (int i = extent[0]; i <= extent[1]; i += 5)
+        {
+        double point_IJK[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+        double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
+        double expectedInverse_RAS[3] = { 0.0, 0.0, 0.0 };
+        transformFromWorld->TransformPoint(point_RAS, expectedInverse_RAS);
+        double cachedInverse_RAS[3] = { 0.0, 0.0, 0.0 };
+        for (int c = 0; c < 3; c++)
+          {
+          cachedInverse_RAS[c] = point_RAS[c] + inverseDisplacementField->GetScalarComponentAsDouble(i, j, k, c);
+          }
+        CHECK_BOOL(vtkMath::Distance2BetweenPoints(expectedInverse_RAS, cachedInverse_RAS) < 0.1*0.1, true);
+        }
+      }
+    }
+
+  // Cached field is reused if nothing has changed
+  CHECK_POINTER(transformNode->GetCachedDisplacementField(ijkToRAS.GetPointer(), extent, false), inverseDisplacementField);
+
+  // Cached field is recomputed if the transform is modified
+  // (keep a reference to the previous field to make sure a new object is allocated)
+  vtkSmartPointer<vtkImageData> previousInverseDisplacementField = inverseDisplacementField;
+  transformNode->GetTransformToParent()->Modified();
+  CHECK_POINTER_DIFFERENT(transformNode->GetCachedDisplacementField(ijkToRAS.GetPointer(), extent, false),
+    previousInverseDisplacementField.GetPointer());
+
+  // Displacement field computed slab by slab into the same image is the same as the cached field
+  inverseDisplacementField = transformNode->GetCachedDisplacementField(ijkToRAS.GetPointer(), extent, false);
+  vtkNew<vtkImageData> slabDisplacementField;
+  for (int firstSlice = extent[4]; firstSlice <= extent[5]; firstSlice += 4)
+    {
+    int slabExtent[6] = { extent[0], extent[1], extent[2], extent[3], firstSlice, std::min(firstSlice + 3, extent[5]) };
+    CHECK_BOOL(transformNode->ComputeDisplacementField(ijkToRAS.GetPointer(), slabExtent,
+      slabDisplacementField.GetPointer(), false), true);
+    for (int k = slabExtent[4]; k <= slabExtent[5]; k++)
+      {
+      for (int j = slabExtent[2]; j <= slabExtent[3]; j += 5)
+        {
+        for (int i = slabExtent[0]; i <= slabExtent[1]; i += 5)
+          {
+          for (int c = 0; c < 3; c++)
+            {
+            CHECK_DOUBLE_TOLERANCE(slabDisplacementField->GetScalarComponentAsDouble(i, j, k, c),
+              inverseDisplacementField->GetScalarComponentAsDouble(i, j, k, c), 0.01);
+            }
+          }
+        }
+      }
+    }
+
+  // Transform from world using the cached inverse on an oblique, single-slice grid (as in a slice view)
+  vtkNew<vtkTransform> sliceTransform;
+  sliceTransform->Translate(-20.0, -15.0, 2.0);
+  sliceTransform->RotateZ(30.0);
+  sliceTransform->RotateX(20.0);
+  sliceTransform->Scale(2.0, 2.0, 1.0);
+  vtkNew<vtkMatrix4x4> sliceIJKToRAS;
+  sliceIJKToRAS->DeepCopy(sliceTransform->GetMatrix());
+  int sliceExtent[6] = { 0, 20, 0, 15, 0, 0 };
+
+  // The inverse is not cached at the first request after the transform is modified
+  vtkNew<vtkGeneralTransform> cachedTransformFromWorld;
+  transformNode->GetTransformToParent()->Modified();
+  transformNode->GetTransformFromWorldUsingCachedInverse(cachedTransformFromWorld.GetPointer(),
+    sliceIJKToRAS.GetPointer(), sliceExtent);
+  CHECK_BOOL(IsCachedInverseUsed(cachedTransformFromWorld.GetPointer()), false);
+
+  // The inverse is cached at the next request of the same grid
+  transformNode->GetTransformFromWorldUsingCachedInverse(cachedTransformFromWorld.GetPointer(),
+    sliceIJKToRAS.GetPointer(), sliceExtent);
+  CHECK_BOOL(IsCachedInverseUsed(cachedTransformFromWorld.GetPointer()), true);
+  transformNode->GetTransformFromWorld(transformFromWorld.GetPointer());
+  double expectedInverse_RAS[3] = { 0.0, 0.0, 0.0 };
+  double cachedInverse_RAS[3] = { 0.0, 0.0, 0.0 };
+  for (int j = sliceExtent[2]; j <= sliceExtent[3]; j += 3)
+    {
+    for (int i = sliceExtent[0]; i <= sliceExtent[1]; i += 4)
+      {
+      double point_IJK[4] = { static_cast<double>(i), static_cast<double>(j), 0.0, 1.0 };
+      double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+      sliceIJKToRAS->MultiplyPoint(point_IJK, point_RAS);
+      transformFromWorld->TransformPoint(point_RAS, expectedInverse_RAS);
+      cachedTransformFromWorld->TransformPoint(point_RAS, cachedInverse_RAS);
+      CHECK_BOOL(vtkMath::Distance2BetweenPoints(expectedInverse_RAS, cachedInverse_RAS) < 0.01*0.01, true);
+      }
+    }
+  // Exact inverse is used away from the grid points
+  double offGrid_RAS[3] = { sliceIJKToRAS->GetElement(0, 3) + 3.0 * sliceIJKToRAS->GetElement(0, 2),
+    sliceIJKToRAS->GetElement(1, 3) + 3.0 * sliceIJKToRAS->GetElement(1, 2),
+    sliceIJKToRAS->GetElement(2, 3) + 3.0 * sliceIJKToRAS->GetElement(2, 2) };
+  transformFromWorld->TransformPoint(offGrid_RAS, expectedInverse_RAS);
+  cachedTransformFromWorld->TransformPoint(offGrid_RAS, cachedInverse_RAS);
+  CHECK_BOOL(vtkMath::Distance2BetweenPoints(expectedInverse_RAS, cachedInverse_RAS) < 1.0e-6, true);
+
+  // Modifying the transform invalidates the cache, the exact inverse is used until the next request
+  transformNode->GetTransformToParent()->Modified();
+  transformNode->GetTransformFromWorldUsingCachedInverse(cachedTransformFromWorld.GetPointer(),
+    sliceIJKToRAS.GetPointer(), sliceExtent);
+  CHECK_BOOL(IsCachedInverseUsed(cachedTransformFromWorld.GetPointer()), false);
+  transformNode->GetTransformFromWorldUsingCachedInverse(cachedTransformFromWorld.GetPointer(),
+    sliceIJKToRAS.GetPointer(), sliceExtent);
+  CHECK_BOOL(IsCachedInverseUsed(cachedTransformFromWorld.GetPointer()), true);
+
+  // Removing the cached field of a grid keeps the fields cached for other grids
+  vtkNew<vtkMatrix4x4> otherIJKToRAS;
+  otherIJKToRAS->DeepCopy(ijkToRAS.GetPointer());
+  otherIJKToRAS->SetElement(0, 3, -20.0);
+  vtkImageData* otherInverseDisplacementField =
+    transformNode->GetCachedDisplacementField(otherIJKToRAS.GetPointer(), extent, false);
+  CHECK_NOT_NULL(transformNode->GetCachedDisplacementField(ijkToRAS.GetPointer(), extent, false));
+  transformNode->RemoveCachedDisplacementField(ijkToRAS.GetPointer(), extent, false);
+  CHECK_POINTER(transformNode->GetCachedDisplacementField(otherIJKToRAS.GetPointer(), extent, false),
+    otherInverseDisplacementField);
+
+  scene->Clear(1);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLStorageNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointSet.h>
+
+// STD includes
+#include <set>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+const char sceneXML[] =
+  "<MRML version=\"Slicer4.4.0\" userTags=\"\">"
+  "  <ModelStorage id=\"vtkMRMLModelStorageNode1\" fileName=\"cube.vtk\" ></ModelStorage>"
+  "  <Model id=\"vtkMRMLModelNode1\" name=\"cube\" storageNodeRef=\"vtkMRMLModelStorageNode1\" ></Model>"
+  "  <ModelStorage id=\"vtkMRMLModelStorageNode2\" fileName=\"sphere.vtp\" ></ModelStorage>"
+  "  <Model id=\"vtkMRMLModelNode2\" name=\"sphere\" storageNodeRef=\"vtkMRMLModelStorageNode2\" ></Model>"
+  "  <ModelStorage id=\"vtkMRMLModelStorageNode3\" fileName=\"PentaHexa.vtk\" ></ModelStorage>"
+  "  <Model id=\"vtkMRMLModelNode3\" name=\"mesh\" storageNodeRef=\"vtkMRMLModelStorageNode3\" ></Model>"
+  "  <VolumeArchetypeStorage id=\"vtkMRMLVolumeArchetypeStorageNode1\" fileName=\"fixed.nrrd\" ></VolumeArchetypeStorage>"
+  "  <Volume id=\"vtkMRMLScalarVolumeNode1\" name=\"fixed\" storageNodeRef=\"vtkMRMLVolumeArchetypeStorageNode1\" ></Volume>"
+  "  <VolumeArchetypeStorage id=\"vtkMRMLVolumeArchetypeStorageNode2\" fileName=\"moving.nrrd\" ></VolumeArchetypeStorage>"
+  "  <Volume id=\"vtkMRMLScalarVolumeNode2\" name=\"moving\" storageNodeRef=\"vtkMRMLVolumeArchetypeStorageNode2\" ></Volume>"
+  "</MRML>"
+  ;
+
+const char* modelIDs[] = { "vtkMRMLModelNode1", "vtkMRMLModelNode2", "vtkMRMLModelNode3", NULL };
+const char* volumeIDs[] = { "vtkMRMLScalarVolumeNode1", "vtkMRMLScalarVolumeNode2", NULL };
+
+//---------------------------------------------------------------------------
+void RecordProgress(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                    void* clientData, void* callData)
+{
+  std::vector<int>* progress = reinterpret_cast<std::vector<int>*>(clientData);
+  progress->push_back(static_cast<int>(reinterpret_cast<size_t>(callData)));
+}
+
+//---------------------------------------------------------------------------
+void RecordNodeProgress(vtkObject* caller, unsigned long vtkNotUsed(eid),
+                        void* clientData, void* callData)
+{
+  std::set<vtkObject*>* completedNodes = reinterpret_cast<std::set<vtkObject*>*>(clientData);
+  double* progress = reinterpret_cast<double*>(callData);
+  if (progress && *progress >= 1.0)
+    {
+    completedNodes->insert(caller);
+    }
+}
+
+//---------------------------------------------------------------------------
+/// Observe progress of the storage nodes as they are added to the scene
+void ObserveStorageNodeProgress(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                                void* clientData, void* callData)
+{
+  vtkMRMLStorageNode* storageNode = vtkMRMLStorageNode::SafeDownCast(reinterpret_cast<vtkObject*>(callData));
+  if (storageNode)
+    {
+    storageNode->AddObserver(vtkCommand::ProgressEvent, reinterpret_cast<vtkCallbackCommand*>(clientData));
+    }
+}
+
+//---------------------------------------------------------------------------
+int ImportScene(vtkMRMLScene* scene, const char* dataDir, bool concurrent, std::vector<int>& progress,
+                std::set<vtkObject*>& completedStorageNodes)
+{
+  vtkNew<vtkCallbackCommand> progressCallback;
+  progressCallback->SetCallback(RecordProgress);
+  progressCallback->SetClientData(&progress);
+  scene->AddObserver(vtkMRMLScene::ProgressImportEvent, progressCallback.GetPointer());
+
+  vtkNew<vtkCallbackCommand> nodeProgressCallback;
+  nodeProgressCallback->SetCallback(RecordNodeProgress);
+  nodeProgressCallback->SetClientData(&completedStorageNodes);
+  vtkNew<vtkCallbackCommand> nodeAddedCallback;
+  nodeAddedCallback->SetCallback(ObserveStorageNodeProgress);
+  nodeAddedCallback->SetClientData(nodeProgressCallback.GetPointer());
+  scene->AddObserver(vtkMRMLScene::NodeAddedEvent, nodeAddedCallback.GetPointer());
+
+  scene->SetRootDirectory(dataDir);
+  scene->SetSceneXMLString(sceneXML);
+  scene->SetLoadFromXMLString(1);
+  scene->SetConcurrentReadDataOnLoad(concurrent);
+  CHECK_BOOL(scene->GetConcurrentReadDataOnLoad(), concurrent);
+  CHECK_INT(scene->Import(), 1);
+  CHECK_INT(scene->GetErrorCode(), 0);
+
+  scene->RemoveObserver(progressCallback.GetPointer());
+  scene->RemoveObserver(nodeAddedCallback.GetPointer());
+  std::vector<vtkMRMLNode*> storageNodes;
+  scene->GetNodesByClass("vtkMRMLStorageNode", storageNodes);
+  for (std::vector<vtkMRMLNode*>::iterator nodeIt = storageNodes.begin(); nodeIt != storageNodes.end(); ++nodeIt)
+    {
+    (*nodeIt)->RemoveObserver(nodeProgressCallback.GetPointer());
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneConcurrentReadTest(int argc, char * argv[] )
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/data" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char* dataDir = argv[1];
+
+  vtkNew<vtkMRMLScene> sequentialScene;
+  std::vector<int> sequentialProgress;
+  std::set<vtkObject*> sequentialCompletedStorageNodes;
+  CHECK_EXIT_SUCCESS(ImportScene(sequentialScene.GetPointer(), dataDir, false, sequentialProgress,
+    sequentialCompletedStorageNodes));
+  CHECK_BOOL(sequentialProgress.empty(), true);
+
+  vtkNew<vtkMRMLScene> concurrentScene;
+  std::vector<int> concurrentProgress;
+  std::set<vtkObject*> concurrentCompletedStorageNodes;
+  CHECK_EXIT_SUCCESS(ImportScene(concurrentScene.GetPointer(), dataDir, true, concurrentProgress,
+    concurrentCompletedStorageNodes));
+
+  // Each storage node that read its data concurrently reports its own progress
+  CHECK_INT(static_cast<int>(concurrentCompletedStorageNodes.size()), 5);
+
+  // One progress event per node that has data read concurrently, up to 100%
+  CHECK_INT(static_cast<int>(concurrentProgress.size()), 5);
+  for (size_t i = 1; i < concurrentProgress.size(); ++i)
+    {
+    CHECK_BOOL(concurrentProgress[i] > concurrentProgress[i - 1], true);
+    }
+  CHECK_INT(concurrentProgress.back(), 100);
+
+  // Same data is read in both modes
+  for (int i = 0; modelIDs[i]; ++i)
+    {
+    vtkMRMLModelNode* sequentialModel = vtkMRMLModelNode::SafeDownCast(sequentialScene->GetNodeByID(modelIDs[i]));
+    vtkMRMLModelNode* concurrentModel = vtkMRMLModelNode::SafeDownCast(concurrentScene->GetNodeByID(modelIDs[i]));
+    CHECK_NOT_NULL(sequentialModel);
+    CHECK_NOT_NULL(concurrentModel);
+    CHECK_NOT_NULL(sequentialModel->GetMesh());
+    CHECK_NOT_NULL(concurrentModel->GetMesh());
+    CHECK_INT(concurrentModel->GetMeshType(), sequentialModel->GetMeshType());
+    CHECK_INT(concurrentModel->GetMesh()->GetNumberOfPoints(), sequentialModel->GetMesh()->GetNumberOfPoints());
+    CHECK_INT(concurrentModel->GetMesh()->GetNumberOfCells(), sequentialModel->GetMesh()->GetNumberOfCells());
+    CHECK_BOOL(concurrentModel->GetModifiedSinceRead(), false);
+    CHECK_BOOL(concurrentModel->GetStorageNode()->HasDetachedData(), false);
+    }
+  for (int i = 0; volumeIDs[i]; ++i)
+    {
+    vtkMRMLScalarVolumeNode* sequentialVolume = vtkMRMLScalarVolumeNode::SafeDownCast(sequentialScene->GetNodeByID(volumeIDs[i]));
+    vtkMRMLScalarVolumeNode* concurrentVolume = vtkMRMLScalarVolumeNode::SafeDownCast(concurrentScene->GetNodeByID(volumeIDs[i]));
+    CHECK_NOT_NULL(sequentialVolume);
+    CHECK_NOT_NULL(concurrentVolume);
+    CHECK_NOT_NULL(sequentialVolume->GetImageData());
+    CHECK_NOT_NULL(concurrentVolume->GetImageData());
+    int sequentialDimensions[3] = { 0, 0, 0 };
+    int concurrentDimensions[3] = { 0, 0, 0 };
+    sequentialVolume->GetImageData()->GetDimensions(sequentialDimensions);
+    concurrentVolume->GetImageData()->GetDimensions(concurrentDimensions);
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      CHECK_INT(concurrentDimensions[axis], sequentialDimensions[axis]);
+      CHECK_DOUBLE(concurrentVolume->GetSpacing()[axis], sequentialVolume->GetSpacing()[axis]);
+      CHECK_DOUBLE(concurrentVolume->GetOrigin()[axis], sequentialVolume->GetOrigin()[axis]);
+      }
+    CHECK_DOUBLE(concurrentVolume->GetImageData()->GetScalarRange()[1], sequentialVolume->GetImageData()->GetScalarRange()[1]);
+    CHECK_BOOL(concurrentVolume->GetModifiedSinceRead(), false);
+    }
+
+  // Missing file is reported as error
+  vtkNew<vtkMRMLScene> missingFileScene;
+  missingFileScene->SetRootDirectory(dataDir);
+  missingFileScene->SetSceneXMLString(
+    "<MRML version=\"Slicer4.4.0\" userTags=\"\">"
+    "  <ModelStorage id=\"vtkMRMLModelStorageNode1\" fileName=\"missing.vtk\" ></ModelStorage>"
+    "  <Model id=\"vtkMRMLModelNode1\" name=\"missing\" storageNodeRef=\"vtkMRMLModelStorageNode1\" ></Model>"
+    "</MRML>");
+  missingFileScene->SetLoadFromXMLString(1);
+  missingFileScene->ConcurrentReadDataOnLoadOn();
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(missingFileScene->Import(), 0);
+  // The error of the read on the worker thread is reported once, on the main thread
+  TESTING_OUTPUT_ASSERT_ERRORS(1);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  vtkMRMLModelNode* missingModel = vtkMRMLModelNode::SafeDownCast(missingFileScene->GetNodeByID("vtkMRMLModelNode1"));
+  CHECK_NOT_NULL(missingModel);
+  CHECK_BOOL(missingModel->GetStorageNode()->HasDetachedReadError(), false);
+  CHECK_INT(missingFileScene->GetErrorCode(), 1);
+
+  std::cout << "Concurrent read test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
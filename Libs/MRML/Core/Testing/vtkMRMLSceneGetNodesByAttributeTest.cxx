@@ -0,0 +1,109 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int GetNumberOfNodesByAttribute(vtkMRMLScene* scene, const char* name, const char* value)
+{
+  std::vector<vtkMRMLNode*> nodes;
+  return scene->GetNodesByAttribute(name, value, nodes);
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneGetNodesByAttributeTest(int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Attributes set before the node is added to the scene are indexed
+  vtkNew<vtkMRMLScriptedModuleNode> parameterNode1;
+  parameterNode1->SetAttribute("ModuleName", "Module1");
+  scene->AddNode(parameterNode1.GetPointer());
+  vtkNew<vtkMRMLModelNode> modelNode;
+  scene->AddNode(modelNode.GetPointer());
+  vtkNew<vtkMRMLScriptedModuleNode> parameterNode2;
+  scene->AddNode(parameterNode2.GetPointer());
+
+  std::vector<vtkMRMLNode*> nodes;
+  CHECK_INT(scene->GetNodesByAttribute("ModuleName", "Module1", nodes), 1);
+  CHECK_POINTER(nodes[0], parameterNode1.GetPointer());
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module2"), 0);
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "NotSetAttribute", NULL), 0);
+
+  // Attributes set after the node is added to the scene are indexed,
+  // nodes are returned in scene order
+  modelNode->SetAttribute("ModuleName", "Module1");
+  parameterNode2->SetAttribute("ModuleName", "Module2");
+  CHECK_INT(scene->GetNodesByAttribute("ModuleName", "Module1", nodes), 2);
+  CHECK_POINTER(nodes[0], parameterNode1.GetPointer());
+  CHECK_POINTER(nodes[1], modelNode.GetPointer());
+  CHECK_INT(scene->GetNodesByAttribute("ModuleName", NULL, nodes), 3);
+  CHECK_POINTER(nodes[2], parameterNode2.GetPointer());
+
+  // Changed and removed attributes
+  parameterNode1->SetAttribute("ModuleName", "Module2");
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module1"), 1);
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module2"), 2);
+  modelNode->RemoveAttribute("ModuleName");
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module1"), 0);
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", NULL), 2);
+
+  // Attributes of copied nodes
+  vtkNew<vtkMRMLModelNode> sourceNode;
+  sourceNode->SetAttribute("Color", "Red");
+  modelNode->Copy(sourceNode.GetPointer());
+  CHECK_INT(scene->GetNodesByAttribute("Color", "Red", nodes), 1);
+  CHECK_POINTER(nodes[0], modelNode.GetPointer());
+
+  // Collection version
+  vtkSmartPointer<vtkCollection> collection = vtkSmartPointer<vtkCollection>::Take(
+    scene->GetNodesByAttribute("ModuleName", "Module2"));
+  CHECK_NOT_NULL(collection);
+  CHECK_INT(collection->GetNumberOfItems(), 2);
+  CHECK_POINTER(collection->GetItemAsObject(0), parameterNode1.GetPointer());
+
+  // Removed nodes are not indexed anymore, even if their attributes change
+  scene->RemoveNode(parameterNode1.GetPointer());
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module2"), 1);
+  parameterNode1->SetAttribute("ModuleName", "Module3");
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", "Module3"), 0);
+
+  // Index is cleared with the scene
+  scene->Clear(1);
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "ModuleName", NULL), 0);
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), "Color", NULL), 0);
+
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_INT(GetNumberOfNodesByAttribute(scene.GetPointer(), NULL, NULL), 0);
+  CHECK_NULL(scene->GetNodesByAttribute(NULL, NULL));
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  std::cout << "Get nodes by attribute test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
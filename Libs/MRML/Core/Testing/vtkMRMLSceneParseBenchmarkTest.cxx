@@ -0,0 +1,216 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+// A synthetic scene made of transform, model and model display nodes is
+// imported from an XML string and the parsing time is printed. The number of
+// models can be specified as first argument (e.g., run with 10000 or 100000
+// to benchmark on large scenes).
+// The indexed tag to class lookup is also timed against the linear search
+// over registered node classes that was used before.
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+std::string GenerateSceneXML(int numberOfModels)
+{
+  std::stringstream ss;
+  ss << "<MRML version=\"Slicer4.4.0\" userTags=\"\">\n";
+  for (int i = 1; i <= numberOfModels; ++i)
+    {
+    ss << "  <LinearTransform id=\"vtkMRMLLinearTransformNode" << i << "\" name=\"Transform" << i << "\""
+       << " hideFromEditors=\"false\" selectable=\"true\" selected=\"false\""
+       << " matrixTransformToParent=\"1 0 0 " << i << " 0 1 0 0 0 0 1 0 0 0 0 1\" ></LinearTransform>\n";
+    ss << "  <ModelDisplay id=\"vtkMRMLModelDisplayNode" << i << "\" name=\"ModelDisplay" << i << "\""
+       << " hideFromEditors=\"true\" selectable=\"true\" selected=\"false\""
+       << " color=\"0.5 0.5 0.5\" opacity=\"1\" visibility=\"true\" scalarVisibility=\"false\""
+       << " ></ModelDisplay>\n";
+    ss << "  <Model id=\"vtkMRMLModelNode" << i << "\" name=\"Model" << i << "\""
+       << " hideFromEditors=\"false\" selectable=\"true\" selected=\"false\""
+       << " transformNodeRef=\"vtkMRMLLinearTransformNode" << i << "\""
+       << " displayNodeRef=\"vtkMRMLModelDisplayNode" << i << "\""
+       << " references=\"display:vtkMRMLModelDisplayNode" << i << ";transform:vtkMRMLLinearTransformNode" << i << ";\""
+       << " ></Model>\n";
+    }
+  ss << "</MRML>\n";
+  return ss.str();
+}
+
+//---------------------------------------------------------------------------
+int TestParseScene(int numberOfModels)
+{
+  std::string sceneXML = GenerateSceneXML(numberOfModels);
+
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetSceneXMLString(sceneXML);
+  scene->SetLoadFromXMLString(1);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  CHECK_INT(scene->Import(), 1);
+  timer->StopTimer();
+  std::cout << "Scene of " << 3 * numberOfModels << " nodes (" << sceneXML.size() << " bytes) imported in "
+    << timer->GetElapsedTime() << " seconds" << std::endl;
+
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLLinearTransformNode"), numberOfModels);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelDisplayNode"), numberOfModels);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), numberOfModels);
+
+  // Attributes and references of the last nodes are read
+  std::stringstream lastModelID;
+  lastModelID << "vtkMRMLModelNode" << numberOfModels;
+  vtkMRMLModelNode* lastModel = vtkMRMLModelNode::SafeDownCast(scene->GetNodeByID(lastModelID.str().c_str()));
+  CHECK_NOT_NULL(lastModel);
+  CHECK_NOT_NULL(lastModel->GetDisplayNode());
+  CHECK_NOT_NULL(lastModel->GetParentTransformNode());
+  CHECK_DOUBLE(vtkMRMLLinearTransformNode::SafeDownCast(
+    lastModel->GetParentTransformNode())->GetMatrixTransformToParent()->GetElement(0, 3), numberOfModels);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestRegisteredNodeClassLookup()
+{
+  vtkNew<vtkMRMLScene> scene;
+  CHECK_STRING(scene->GetClassNameByTag("Model"), "vtkMRMLModelNode");
+  CHECK_STRING(scene->GetTagByClassName("vtkMRMLModelNode"), "Model");
+  CHECK_NULL(scene->GetClassNameByTag("NotRegisteredTag"));
+  CHECK_NULL(scene->GetTagByClassName("vtkMRMLNotRegisteredNode"));
+
+  vtkSmartPointer<vtkMRMLNode> node = vtkSmartPointer<vtkMRMLNode>::Take(
+    scene->CreateNodeByClass("vtkMRMLModelDisplayNode"));
+  CHECK_NOT_NULL(node);
+  CHECK_STRING(node->GetClassName(), "vtkMRMLModelDisplayNode");
+
+  // Registering a class with an existing tag overrides the previous class
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  scene->RegisterNodeClass(displayNode.GetPointer(), "Model");
+  TESTING_OUTPUT_ASSERT_WARNINGS_END();
+  CHECK_STRING(scene->GetClassNameByTag("Model"), "vtkMRMLModelDisplayNode");
+  CHECK_NULL(scene->GetTagByClassName("vtkMRMLModelNode"));
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Reference implementation: linear search of the tag among the registered
+// node classes, as done before the classes were indexed by tag.
+const char* GetClassNameByTagLinear(vtkMRMLScene* scene, const char* tagName)
+{
+  for (int i = 0; i < scene->GetNumberOfRegisteredNodeClasses(); ++i)
+    {
+    vtkMRMLNode* node = scene->GetNthRegisteredNodeClass(i);
+    if (node && node->GetNodeTagName() && !strcmp(node->GetNodeTagName(), tagName))
+      {
+      return node->GetClassName();
+      }
+    }
+  return 0;
+}
+
+//---------------------------------------------------------------------------
+int TestRegisteredNodeClassLookupPerformance(int numberOfModels)
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Both lookups agree on every registered tag
+  std::vector<std::string> tags;
+  for (int i = 0; i < scene->GetNumberOfRegisteredNodeClasses(); ++i)
+    {
+    vtkMRMLNode* node = scene->GetNthRegisteredNodeClass(i);
+    const char* tag = scene->GetTagByClassName(node->GetClassName());
+    if (!tag)
+      {
+      continue;
+      }
+    tags.push_back(tag);
+    CHECK_STRING(scene->GetClassNameByTag(tag), GetClassNameByTagLinear(scene.GetPointer(), tag));
+    }
+  CHECK_BOOL(tags.empty(), false);
+
+  // Same tags as in the synthetic scene, one lookup per element
+  const char* sceneTags[3] = { "LinearTransform", "ModelDisplay", "Model" };
+  int numberOfLookups = 3 * numberOfModels;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  int linearFound = 0;
+  for (int i = 0; i < numberOfLookups; ++i)
+    {
+    linearFound += (GetClassNameByTagLinear(scene.GetPointer(), sceneTags[i % 3]) != 0);
+    }
+  timer->StopTimer();
+  double linearTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  int indexedFound = 0;
+  for (int i = 0; i < numberOfLookups; ++i)
+    {
+    indexedFound += (scene->GetClassNameByTag(sceneTags[i % 3]) != 0);
+    }
+  timer->StopTimer();
+  double indexedTime = timer->GetElapsedTime();
+
+  CHECK_INT(linearFound, numberOfLookups);
+  CHECK_INT(indexedFound, numberOfLookups);
+
+  std::cout << numberOfLookups << " tag lookups among " << scene->GetNumberOfRegisteredNodeClasses()
+    << " registered classes: linear search " << linearTime << " seconds, indexed "
+    << indexedTime << " seconds";
+  if (indexedTime > 0.)
+    {
+    std::cout << " (speedup x" << linearTime / indexedTime << ")";
+    }
+  std::cout << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneParseBenchmarkTest(int argc, char * argv[] )
+{
+  int numberOfModels = 1000;
+  if (argc > 1)
+    {
+    numberOfModels = atoi(argv[1]);
+    }
+
+  CHECK_EXIT_SUCCESS(TestRegisteredNodeClassLookup());
+  CHECK_EXIT_SUCCESS(TestRegisteredNodeClassLookupPerformance(numberOfModels));
+  CHECK_EXIT_SUCCESS(TestParseScene(numberOfModels));
+
+  std::cout << "Scene parse benchmark test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyConstants.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// Items are looked up by data node and UID after each operation that modifies the tree,
+// to make sure that the lookup index of the subject hierarchy is kept up-to-date.
+
+//---------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNodeLookupTest(int vtkNotUsed(argc), char * vtkNotUsed(argv)[])
+{
+  const vtkIdType invalidItemID = vtkMRMLSubjectHierarchyNode::GetInvalidItemID();
+  const char* uidName = vtkMRMLSubjectHierarchyConstants::GetDICOMUIDName();
+  const char* instanceUIDName = vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName();
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene.GetPointer());
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  // Add
+  vtkIdType patient1ItemID = shNode->CreateSubjectItem(sceneItemID, "Patient1");
+  shNode->SetItemUID(patient1ItemID, uidName, "PATIENT1");
+  vtkIdType patient2ItemID = shNode->CreateSubjectItem(sceneItemID, "Patient2");
+  shNode->SetItemUID(patient2ItemID, uidName, "PATIENT2");
+  vtkIdType studyItemID = shNode->CreateStudyItem(patient1ItemID, "Study");
+  shNode->SetItemUID(studyItemID, uidName, "STUDY");
+
+  vtkNew<vtkMRMLScalarVolumeNode> volume1Node;
+  scene->AddNode(volume1Node.GetPointer());
+  vtkIdType volume1ItemID = shNode->CreateItem(studyItemID, volume1Node.GetPointer());
+  shNode->SetItemUID(volume1ItemID, uidName, "VOLUME1");
+  shNode->SetItemUID(volume1ItemID, instanceUIDName, "INSTANCE11 INSTANCE12 INSTANCE13");
+
+  vtkNew<vtkMRMLScalarVolumeNode> volume2Node;
+  scene->AddNode(volume2Node.GetPointer());
+  vtkIdType volume2ItemID = shNode->CreateItem(patient2ItemID, volume2Node.GetPointer());
+  shNode->SetItemUID(volume2ItemID, uidName, "VOLUME2");
+
+  CHECK_INT(shNode->GetItemByDataNode(volume1Node.GetPointer()), volume1ItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volume2Node.GetPointer()), volume2ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "PATIENT1"), patient1ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "PATIENT2"), patient2ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "STUDY"), studyItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME1"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME2"), volume2ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUID(instanceUIDName, "INSTANCE12"), invalidItemID);
+  // UID list entries, whole list, and substring of an entry
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE12"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE11 INSTANCE12 INSTANCE13"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "STANCE13"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE21"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUIDList(uidName, "VOLUME2"), volume2ItemID);
+
+  // Reparent a branch
+  shNode->SetItemParent(studyItemID, patient2ItemID);
+  CHECK_INT(shNode->GetItemParent(studyItemID), patient2ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "STUDY"), studyItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volume1Node.GetPointer()), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME1"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE13"), volume1ItemID);
+
+  // Reparent a data item
+  shNode->SetItemParent(volume2ItemID, studyItemID);
+  CHECK_INT(shNode->GetItemParent(volume2ItemID), studyItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volume2Node.GetPointer()), volume2ItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME2"), volume2ItemID);
+
+  // Change UID
+  shNode->SetItemUID(volume1ItemID, uidName, "VOLUME1_CHANGED");
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME1"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME1_CHANGED"), volume1ItemID);
+  shNode->SetItemUID(volume1ItemID, instanceUIDName, "INSTANCE14 INSTANCE15");
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE12"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE15"), volume1ItemID);
+  CHECK_INT(shNode->GetItemByUID(instanceUIDName, "INSTANCE14 INSTANCE15"), volume1ItemID);
+  CHECK_STRING(shNode->GetItemUID(volume1ItemID, uidName).c_str(), "VOLUME1_CHANGED");
+
+  // Remove an item without its data node
+  CHECK_BOOL(shNode->RemoveItem(volume2ItemID, false), true);
+  CHECK_INT(shNode->GetItemByDataNode(volume2Node.GetPointer()), invalidItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME2"), invalidItemID);
+  CHECK_POINTER(volume2Node->GetScene(), scene.GetPointer());
+
+  // Add the data node again to a new item, the UID of the removed item is not found
+  vtkIdType volume2NewItemID = shNode->CreateItem(patient1ItemID, volume2Node.GetPointer());
+  CHECK_BOOL(volume2NewItemID != invalidItemID, true);
+  CHECK_INT(shNode->GetItemByDataNode(volume2Node.GetPointer()), volume2NewItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME2"), invalidItemID);
+
+  // Remove a branch with its data nodes
+  CHECK_BOOL(shNode->RemoveItem(patient2ItemID), true);
+  CHECK_INT(shNode->GetItemByUID(uidName, "PATIENT2"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "STUDY"), invalidItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volume1Node.GetPointer()), invalidItemID);
+  CHECK_INT(shNode->GetItemByUID(uidName, "VOLUME1_CHANGED"), invalidItemID);
+  CHECK_INT(shNode->GetItemByUIDList(instanceUIDName, "INSTANCE15"), invalidItemID);
+  CHECK_NULL(volume1Node->GetScene());
+
+  // Items outside of the removed branch are still found
+  CHECK_INT(shNode->GetItemByUID(uidName, "PATIENT1"), patient1ItemID);
+  CHECK_INT(shNode->GetItemByDataNode(volume2Node.GetPointer()), volume2NewItemID);
+
+  return EXIT_SUCCESS;
+}
@@ -141,6 +141,65 @@ int vtkMRMLTransformNodeTest1(int , char * [] )
   vtkNew<vtkMatrix4x4> identity;
   CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(identity.GetPointer(), test_mx.GetPointer()), true);
 
+  // Transform to world is cached, test that the cache is updated when a parent transform changes
+  CHECK_INT(eTransform->IsTransformToWorldLinear(), 1);
+  vtkSmartPointer<vtkMatrix4x4> w_from_b_modified_mx = vtkSmartPointer<vtkMatrix4x4>::Take(CreateTransformMatrix(-5, 17, 42, 10, -20, 30));
+  bTransform->SetMatrixTransformToParent(w_from_b_modified_mx.GetPointer());
+  vtkNew<vtkMatrix4x4> w_from_e_modified_mx;
+  vtkMatrix4x4::Multiply4x4(w_from_b_modified_mx.GetPointer(), b_from_e_mx.GetPointer(), w_from_e_modified_mx.GetPointer());
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_modified_mx.GetPointer(), test_mx.GetPointer()), true);
+
+  // GetTransformToWorld and GetTransformFromWorld return the transforms of the chain
+  vtkNew<vtkGeneralTransform> e_to_w_tr;
+  eTransform->GetTransformToWorld(e_to_w_tr.GetPointer());
+  double inputPoint[3] = { 12.0, -3.5, 27.0 };
+  double expectedPoint[4] = { inputPoint[0], inputPoint[1], inputPoint[2], 1.0 };
+  w_from_e_modified_mx->MultiplyPoint(expectedPoint, expectedPoint);
+  double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+  e_to_w_tr->TransformPoint(inputPoint, transformedPoint);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_DOUBLE_TOLERANCE(transformedPoint[i], expectedPoint[i], 1e-6);
+    }
+  vtkNew<vtkGeneralTransform> w_to_e_tr;
+  eTransform->GetTransformFromWorld(w_to_e_tr.GetPointer());
+  double roundTripPoint[3] = { 0.0, 0.0, 0.0 };
+  w_to_e_tr->TransformPoint(transformedPoint, roundTripPoint);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_DOUBLE_TOLERANCE(roundTripPoint[i], inputPoint[i], 1e-6);
+    }
+
+  // Transform to world follows changes of a parent transform without calling GetTransformToWorld again
+  bTransform->SetMatrixTransformToParent(w_from_b_mx.GetPointer());
+  double expectedOriginalPoint[4] = { inputPoint[0], inputPoint[1], inputPoint[2], 1.0 };
+  w_from_e_mx->MultiplyPoint(expectedOriginalPoint, expectedOriginalPoint);
+  e_to_w_tr->TransformPoint(inputPoint, transformedPoint);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_DOUBLE_TOLERANCE(transformedPoint[i], expectedOriginalPoint[i], 1e-6);
+    }
+  w_to_e_tr->TransformPoint(transformedPoint, roundTripPoint);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_DOUBLE_TOLERANCE(roundTripPoint[i], inputPoint[i], 1e-6);
+    }
+  bTransform->SetMatrixTransformToParent(w_from_b_modified_mx.GetPointer());
+
+  // Inverting a transform in the middle of the chain updates the cache of all descendants
+  cTransform->Inverse();
+  vtkNew<vtkMatrix4x4> b_from_e_inverted_c_mx;
+  vtkMatrix4x4::Multiply4x4(c_from_b_mx.GetPointer(), c_from_e_mx.GetPointer(), b_from_e_inverted_c_mx.GetPointer());
+  vtkNew<vtkMatrix4x4> w_from_e_inverted_c_mx;
+  vtkMatrix4x4::Multiply4x4(w_from_b_modified_mx.GetPointer(), b_from_e_inverted_c_mx.GetPointer(), w_from_e_inverted_c_mx.GetPointer());
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_inverted_c_mx.GetPointer(), test_mx.GetPointer()), true);
+  cTransform->Inverse();
+  bTransform->SetMatrixTransformToParent(w_from_b_mx.GetPointer());
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_mx.GetPointer(), test_mx.GetPointer()), true);
+
   // Test when there is a nonlinear transform above the common parent of two transform nodes.
   // Transform to world is nonlinear but the relative transform is linear.
   vtkNew<vtkMRMLBSplineTransformNode> nonlinearTransform;
@@ -160,6 +219,13 @@ int vtkMRMLTransformNodeTest1(int , char * [] )
   CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(c_from_r_mx.GetPointer(), test_mx.GetPointer()), true);
   CHECK_POINTER(rTransform->GetFirstCommonParent(dTransform.GetPointer()), bTransform.GetPointer());
 
+  // Transform to world of all descendants becomes non-linear
+  CHECK_INT(eTransform->IsTransformToWorldLinear(), 0);
+  bTransform->SetAndObserveTransformNodeID(NULL);
+  CHECK_INT(eTransform->IsTransformToWorldLinear(), 1);
+  eTransform->GetMatrixTransformToWorld(test_mx.GetPointer());
+  CHECK_BOOL(vtkAddonMathUtilities::MatrixAreEqual(w_from_e_mx.GetPointer(), test_mx.GetPointer()), true);
+
   std::cout << "vtkMRMLTransformNodeTest1 successfully completed" << std::endl;
   return EXIT_SUCCESS;
 }
@@ -11,11 +11,198 @@
 =========================================================================auto=*/
 
 #include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
 
-int vtkMRMLVolumeArchetypeStorageNodeTest1(int , char * [] )
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtksys/SystemTools.hxx>
+
+//---------------------------------------------------------------------------
+int TestDeferredRead(const std::string& fileName);
+int TestDetachedWrite(const std::string& tempDir);
+
+//---------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNodeTest1(int argc, char * argv[] )
 {
   vtkNew<vtkMRMLVolumeArchetypeStorageNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  if (argc > 1)
+    {
+    std::string fileName = std::string(argv[1]) + "/fixed.nrrd";
+    CHECK_EXIT_SUCCESS(TestDeferredRead(fileName));
+    }
+  if (argc > 2)
+    {
+    CHECK_EXIT_SUCCESS(TestDetachedWrite(argv[2]));
+    }
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestDeferredRead(const std::string& fileName)
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Reference: volume read immediately
+  vtkNew<vtkMRMLScalarVolumeNode> referenceVolumeNode;
+  scene->AddNode(referenceVolumeNode.GetPointer());
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> referenceStorageNode;
+  scene->AddNode(referenceStorageNode.GetPointer());
+  referenceStorageNode->SetFileName(fileName.c_str());
+  CHECK_INT(referenceStorageNode->ReadData(referenceVolumeNode.GetPointer()), 1);
+  CHECK_BOOL(referenceVolumeNode->GetImageDataDeferred(), false);
+  CHECK_NOT_NULL(referenceVolumeNode->GetImageData());
+
+  // Volume read with deferred reading
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  scene->AddNode(storageNode.GetPointer());
+  storageNode->SetFileName(fileName.c_str());
+  storageNode->DeferredReadOn();
+  CHECK_INT(storageNode->ReadData(volumeNode.GetPointer()), 1);
+  CHECK_BOOL(volumeNode->GetImageDataDeferred(), true);
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), false);
+
+  // Geometry is available without reading the voxels
+  double referenceBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  referenceVolumeNode->GetRASBounds(referenceBounds);
+  double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  volumeNode->GetRASBounds(bounds);
+  for (int i = 0; i < 6; i++)
+    {
+    CHECK_DOUBLE_TOLERANCE(bounds[i], referenceBounds[i], 1e-6);
+    }
+  CHECK_BOOL(volumeNode->GetModifiedSinceRead(), false);
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), false);
+
+  // Voxels are read at the first request
+  vtkImageData* imageData = volumeNode->GetImageData();
+  CHECK_NOT_NULL(imageData);
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), true);
+  vtkImageData* referenceImageData = referenceVolumeNode->GetImageData();
+  int dims[3] = { 0 };
+  imageData->GetDimensions(dims);
+  int referenceDims[3] = { 0 };
+  referenceImageData->GetDimensions(referenceDims);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_INT(dims[i], referenceDims[i]);
+    }
+  CHECK_INT(imageData->GetScalarType(), referenceImageData->GetScalarType());
+  double range[2] = { 0.0, 0.0 };
+  imageData->GetScalarRange(range);
+  double referenceRange[2] = { 0.0, 0.0 };
+  referenceImageData->GetScalarRange(referenceRange);
+  CHECK_DOUBLE(range[0], referenceRange[0]);
+  CHECK_DOUBLE(range[1], referenceRange[1]);
+  CHECK_BOOL(volumeNode->GetModifiedSinceRead(), false);
+
+  // Release and read again
+  CHECK_BOOL(volumeNode->ReleaseDeferredImageData(), true);
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), false);
+  CHECK_BOOL(volumeNode->ReleaseDeferredImageData(), false);
+  imageData = volumeNode->GetImageData();
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), true);
+  imageData->GetDimensions(dims);
+  for (int i = 0; i < 3; i++)
+    {
+    CHECK_INT(dims[i], referenceDims[i]);
+    }
+
+  // Modified voxels are not released
+  imageData->Modified();
+  CHECK_BOOL(volumeNode->GetModifiedSinceRead(), true);
+  CHECK_BOOL(volumeNode->ReleaseDeferredImageData(), false);
+  CHECK_BOOL(volumeNode->IsImageDataLoaded(), true);
+
+  // Setting image data directly disables deferred mode
+  vtkNew<vtkImageData> newImageData;
+  newImageData->DeepCopy(imageData);
+  volumeNode->SetAndObserveImageData(newImageData.GetPointer());
+  CHECK_BOOL(volumeNode->GetImageDataDeferred(), false);
+  CHECK_BOOL(volumeNode->ReleaseDeferredImageData(), false);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestDetachedWrite(const std::string& tempDir)
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(10, 8, 6);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxelPtr = static_cast<short*>(imageData->GetScalarPointer());
+  for (vtkIdType voxelIndex = 0; voxelIndex < imageData->GetNumberOfPoints(); voxelIndex++)
+    {
+    *(voxelPtr++) = static_cast<short>(voxelIndex % 100);
+    }
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  volumeNode->SetOrigin(10.0, 20.0, 30.0);
+  volumeNode->SetSpacing(1.0, 2.0, 3.0);
+  scene->AddNode(volumeNode.GetPointer());
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+  scene->AddNode(storageNode.GetPointer());
+
+  // Only formats that write a single file are written detached
+  std::string fileName = tempDir + "/vtkMRMLVolumeArchetypeStorageNodeTest1Detached.nrrd";
+  storageNode->SetFileName((tempDir + "/vtkMRMLVolumeArchetypeStorageNodeTest1Detached.nhdr").c_str());
+  CHECK_BOOL(storageNode->CanWriteDataDetached(volumeNode.GetPointer()), false);
+  storageNode->SetFileName(fileName.c_str());
+  CHECK_BOOL(storageNode->CanWriteDataDetached(volumeNode.GetPointer()), true);
+  vtksys::SystemTools::RemoveFile(fileName.c_str());
+
+  CHECK_BOOL(storageNode->PrepareWriteDataDetached(volumeNode.GetPointer()), true);
+  CHECK_BOOL(storageNode->GetDetachedDataActualMemorySize() > 0, true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileName.c_str(), true), false);
+  CHECK_BOOL(storageNode->WriteDataDetached(), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(fileName.c_str(), true), true);
+  CHECK_BOOL(volumeNode->GetModifiedSinceRead(), true);
+  storageNode->EndWriteDataDetached(volumeNode.GetPointer(), true);
+  CHECK_BOOL(storageNode->HasDetachedData(), false);
+  CHECK_BOOL(volumeNode->GetModifiedSinceRead(), false);
+
+  // Read the written file
+  vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+  scene->AddNode(readVolumeNode.GetPointer());
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> readStorageNode;
+  scene->AddNode(readStorageNode.GetPointer());
+  readStorageNode->SetFileName(fileName.c_str());
+  CHECK_INT(readStorageNode->ReadData(readVolumeNode.GetPointer()), 1);
+  vtkImageData* readImageData = readVolumeNode->GetImageData();
+  CHECK_NOT_NULL(readImageData);
+  int dims[3] = { 0, 0, 0 };
+  readImageData->GetDimensions(dims);
+  CHECK_INT(dims[0], 10);
+  CHECK_INT(dims[1], 8);
+  CHECK_INT(dims[2], 6);
+  CHECK_INT(readImageData->GetScalarType(), VTK_SHORT);
+  CHECK_DOUBLE(readImageData->GetScalarComponentAsDouble(3, 2, 1, 0), imageData->GetScalarComponentAsDouble(3, 2, 1, 0));
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  readVolumeNode->GetOrigin(origin);
+  CHECK_DOUBLE_TOLERANCE(origin[0], 10.0, 1e-6);
+  CHECK_DOUBLE_TOLERANCE(origin[1], 20.0, 1e-6);
+  CHECK_DOUBLE_TOLERANCE(origin[2], 30.0, 1e-6);
+  double spacing[3] = { 0.0, 0.0, 0.0 };
+  readVolumeNode->GetSpacing(spacing);
+  CHECK_DOUBLE_TOLERANCE(spacing[2], 3.0, 1e-6);
+
+  // Write into a directory that does not exist: errors are reported when the write is ended
+  storageNode->SetFileName((tempDir + "/NonExistingDirectory/vtkMRMLVolumeArchetypeStorageNodeTest1Detached.nrrd").c_str());
+  CHECK_BOOL(storageNode->PrepareWriteDataDetached(volumeNode.GetPointer()), true);
+  CHECK_BOOL(storageNode->WriteDataDetached(), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  storageNode->EndWriteDataDetached(volumeNode.GetPointer(), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
   return EXIT_SUCCESS;
 }
@@ -23,6 +23,9 @@
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 
+// STD includes
+#include <vector>
+
 typedef double itkVectorComponentType;
 typedef itk::Vector<itkVectorComponentType, 3> itkVectorPixelType;
 typedef itk::Image<itkVectorPixelType,  3> itkDisplacementFieldType;
@@ -286,6 +289,37 @@ double getInverseErrorVtk(const double inputPoint[3], vtkOrientedGridTransform*
   return errorOfInverseComputation;
 }
 
+//----------------------------------------------------------------------------
+// Compute the number of points where the batch (point array) transform result
+// differs from the result of transforming the points one by one
+int getPointArrayMismatchesVtk(const std::vector<double>& inputPoints, vtkOrientedGridTransform* gridVtk)
+{
+  int numberOfPoints = static_cast<int>(inputPoints.size() / 3);
+  if (numberOfPoints == 0)
+    {
+    return 0;
+    }
+  std::vector<double> outputPoints(inputPoints.size());
+  gridVtk->TransformPointArray(&(inputPoints[0]), &(outputPoints[0]), numberOfPoints);
+
+  int numberOfMismatches = 0;
+  for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+    {
+    double outputPoint[3] = { 0.0, 0.0, 0.0 };
+    gridVtk->TransformPoint(&(inputPoints[pointIndex * 3]), outputPoint);
+    itk::Point<double,3> outputPointVtk( outputPoint );
+    itk::Point<double,3> outputPointArrayVtk( &(outputPoints[pointIndex * 3]) );
+    double difference = outputPointVtk.EuclideanDistanceTo( outputPointArrayVtk );
+    if (difference > 1e-6)
+      {
+      std::cout << "ERROR: Point array transform result mismatch at point " << pointIndex
+        << ", difference: " << difference << std::endl;
+      numberOfMismatches++;
+      }
+    }
+  return numberOfMismatches;
+}
+
 //----------------------------------------------------------------------------
 int vtkOrientedGridTransformTest1(int , char * [] )
 {
@@ -324,6 +358,8 @@ int vtkOrientedGridTransformTest1(int , char * [] )
   int numberOfSingleDoubleVtkPointMismatches=0;
   int numberOfDerivativeMismatches=0;
   int numberOfInverseMismatches=0;
+  int numberOfPointArrayMismatches=0;
+  std::vector<double> pointArray;
 
   // We take samples in the grid region (first node + 2 < node < last node - 1)
   // because the boundaries are handled differently in ITK and VTK (in ITK there is an
@@ -388,6 +424,9 @@ int vtkOrientedGridTransformTest1(int , char * [] )
           std::cout << "ERROR: Point transfom result mismatch between ITK and VTK at grid point ("<<i<<","<<j<<","<<k<<") with cubic interpolation"<< std::endl;
           numberOfItkVtkPointMismatches++;
           }
+        pointArray.push_back(inputPoint[0]);
+        pointArray.push_back(inputPoint[1]);
+        pointArray.push_back(inputPoint[2]);
         // Verify single/double-precision computation difference
         double differenceSingleDoubleVtk = getTransformedPointDifferenceSingleDoubleVtk(inputPoint, gridVtk.GetPointer(), false);
         if ( differenceSingleDoubleVtk > 1e-4 )
@@ -418,13 +457,21 @@ int vtkOrientedGridTransformTest1(int , char * [] )
       }
     }
 
+  // Verify batch evaluation of forward and inverse transform
+  numberOfPointArrayMismatches += getPointArrayMismatchesVtk(pointArray, gridVtk.GetPointer());
+  gridVtk->Inverse();
+  numberOfPointArrayMismatches += getPointArrayMismatchesVtk(pointArray, gridVtk.GetPointer());
+  gridVtk->Inverse();
+
   std::cout << "Number of points tested: " << numberOfPointsTested << std::endl;
   std::cout << "Number of ITK/VTK mismatches: " << numberOfItkVtkPointMismatches << std::endl;
   std::cout << "Number of single/double precision mismatches: " << numberOfSingleDoubleVtkPointMismatches << std::endl;
   std::cout << "Number of derivative mismatches: " << numberOfDerivativeMismatches << std::endl;
   std::cout << "Number of inverse mismatches: " << numberOfInverseMismatches << std::endl;
+  std::cout << "Number of point array mismatches: " << numberOfPointArrayMismatches << std::endl;
 
-  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0)
+  if (numberOfItkVtkPointMismatches==0 && numberOfDerivativeMismatches==0 && numberOfInverseMismatches==0
+    && numberOfPointArrayMismatches==0)
     {
     std::cout << "Test result: PASSED" << std::endl;
     return EXIT_SUCCESS;
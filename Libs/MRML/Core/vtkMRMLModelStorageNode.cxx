@@ -30,6 +30,8 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkPLYReader.h>
 #include <vtkPLYWriter.h>
+#include <vtkPointSet.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataReader.h>
 #include <vtkPolyDataWriter.h>
 #include <vtkProperty.h>
@@ -40,6 +42,7 @@
 #include <vtkStringArray.h>
 #include <vtksys/SystemTools.hxx>
 #include <vtkTriangleFilter.h>
+#include <vtkTrivialProducer.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkUnstructuredGridReader.h>
 #include <vtkUnstructuredGridWriter.h>
@@ -125,6 +128,55 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
   vtkMRMLModelNode *modelNode = dynamic_cast <vtkMRMLModelNode *> (refNode);
 
+  vtkSmartPointer<vtkAlgorithm> meshReader;
+  int result = this->ReadMeshFromFile(meshReader);
+  if (meshReader.GetPointer())
+    {
+    this->SetMeshToModelNode(modelNode, meshReader);
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::CanReadDataDetached(vtkMRMLNode *refNode)
+{
+  // Remote files are downloaded by ReadData() and subclasses
+  // (e.g., FreeSurfer model storage nodes) read the data differently.
+  return this->GetURI() == NULL
+    && strcmp(this->GetClassName(), "vtkMRMLModelStorageNode") == 0
+    && this->CanReadInReferenceNode(refNode);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadDataDetachedInternal(vtkMRMLNode *vtkNotUsed(refNode))
+{
+  vtkSmartPointer<vtkAlgorithm> meshReader;
+  if (!this->ReadMeshFromFile(meshReader) || meshReader.GetPointer() == NULL)
+    {
+    return 0;
+    }
+  this->DetachedData = meshReader;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::AttachDetachedDataInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  vtkAlgorithm* meshReader = vtkAlgorithm::SafeDownCast(this->DetachedData);
+  if (modelNode == NULL || meshReader == NULL)
+    {
+    return 0;
+    }
+  this->SetMeshToModelNode(modelNode, meshReader);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadMeshFromFile(vtkSmartPointer<vtkAlgorithm>& meshReader)
+{
+  meshReader = NULL;
+
   std::string fullName = this->GetFullNameFromFileName();
   if (fullName.empty())
     {
@@ -157,7 +209,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       vtkNew<vtkBYUReader> reader;
       reader->SetGeometryFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".vtk"))
       {
@@ -168,7 +220,6 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
       if (reader->IsFilePolyData())
         {
-        reader->Update();
         reader->ReadAllScalarsOn();
         reader->ReadAllVectorsOn();
         reader->ReadAllNormalsOn();
@@ -176,7 +227,8 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         reader->ReadAllColorScalarsOn();
         reader->ReadAllTCoordsOn();
         reader->ReadAllFieldsOn();
-        modelNode->SetPolyDataConnection(reader->GetOutputPort());
+        reader->Update();
+        meshReader = reader.GetPointer();
         }
       else if (unstructuredGridReader->IsFileUnstructuredGrid())
         {
@@ -188,7 +240,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         unstructuredGridReader->ReadAllTCoordsOn();
         unstructuredGridReader->ReadAllFieldsOn();
         unstructuredGridReader->Update();
-        modelNode->SetUnstructuredGridConnection(unstructuredGridReader->GetOutputPort());
+        meshReader = unstructuredGridReader.GetPointer();
         }
       else
         {
@@ -201,35 +253,35 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       vtkNew<vtkXMLPolyDataReader> reader;
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".vtu"))
       {
       vtkNew<vtkXMLUnstructuredGridReader> reader;
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetUnstructuredGridConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".stl"))
       {
       vtkNew<vtkSTLReader> reader;
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".ply"))
       {
       vtkNew<vtkPLYReader> reader;
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".obj"))
       {
       vtkNew<vtkOBJReader> reader;
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetPolyDataConnection(reader->GetOutputPort());
+      meshReader = reader.GetPointer();
       }
     else if (extension == std::string(".meta"))  // model in meta format
       {
@@ -290,7 +342,9 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
         vtkMesh->SetPolys(cells.GetPointer());
 
-        modelNode->SetAndObservePolyData(vtkMesh.GetPointer());
+        vtkNew<vtkTrivialProducer> meshProducer;
+        meshProducer->SetOutput(vtkMesh.GetPointer());
+        meshReader = meshProducer.GetPointer();
       }
     else
     {
@@ -302,22 +356,40 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     {
       result = 0;
     }
+    return result;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::SetMeshToModelNode(vtkMRMLModelNode* modelNode, vtkAlgorithm* meshReader)
+{
+  vtkTrivialProducer* meshProducer = vtkTrivialProducer::SafeDownCast(meshReader);
+  if (meshProducer)
+    {
+    // Mesh is not generated by a reader, observe the mesh itself
+    modelNode->SetAndObserveMesh(vtkPointSet::SafeDownCast(meshProducer->GetOutputDataObject(0)));
+    }
+  else if (vtkUnstructuredGrid::SafeDownCast(meshReader->GetOutputDataObject(0)))
+    {
+    modelNode->SetUnstructuredGridConnection(meshReader->GetOutputPort());
+    }
+  else
+    {
+    modelNode->SetPolyDataConnection(meshReader->GetOutputPort());
+    }
 
-    if (modelNode->GetMesh() != NULL)
+  if (modelNode->GetMesh() != NULL)
     {
-      // is there an active scalar array?
-      if (modelNode->GetDisplayNode())
+    // is there an active scalar array?
+    if (modelNode->GetDisplayNode())
       {
-        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
-        if (scalarRange)
+      double *scalarRange = modelNode->GetMesh()->GetScalarRange();
+      if (scalarRange)
         {
-          vtkDebugMacro("ReadDataInternal: setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
-          modelNode->GetDisplayNode()->SetScalarRange(scalarRange);
+        vtkDebugMacro("SetMeshToModelNode: setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
+        modelNode->GetDisplayNode()->SetScalarRange(scalarRange);
         }
       }
-      //modelNode->GetMesh()->Modified();
     }
-    return result;
 }
 
 //----------------------------------------------------------------------------
@@ -334,6 +406,106 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 
   std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
 
+  int result = 1;
+  if (extension == ".obj")
+    {
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputConnection(modelNode->GetPolyDataConnection());
+    vtkNew<vtkActor> actor;
+    actor->SetMapper(mapper.GetPointer());
+    vtkMRMLDisplayNode* displayNode = modelNode->GetDisplayNode();
+    if (displayNode)
+      {
+      actor->GetProperty()->SetColor(displayNode->GetColor());
+      actor->GetProperty()->SetOpacity(displayNode->GetOpacity());
+      }
+    vtkNew<vtkRenderer> renderer;
+    renderer->AddActor(actor.GetPointer());
+    vtkNew<vtkRenderWindow> renderWindow;
+    renderWindow->AddRenderer(renderer.GetPointer());
+    vtkNew<vtkOBJExporter> exporter;
+    exporter->SetRenderWindow(renderWindow.GetPointer());
+    std::string fullNameWithoutExtension = fullName;
+    if (fullNameWithoutExtension.size() > 4)
+      {
+      fullNameWithoutExtension.erase(fullNameWithoutExtension.size() - 4);
+      }
+    exporter->SetFilePrefix(fullNameWithoutExtension.c_str());
+    // TODO: write coordinate system name in file header comment
+    // Need to add API for that into VTK.
+    try
+      {
+      exporter->Write();
+      this->ResetFileNameList();
+      std::string materialFileName = fullNameWithoutExtension + ".mtl";
+      this->AddFileName(materialFileName.c_str());
+      }
+    catch (...)
+      {
+      result = 0;
+      }
+    }
+  else
+    {
+    result = this->WriteMeshToFile(modelNode->GetMesh(), fullName, this->GetUseCompression() != 0);
+    }
+
+  return result;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::CanWriteDataDetached(vtkMRMLNode *refNode)
+{
+  vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  if (this->GetURI() != NULL
+    || strcmp(this->GetClassName(), "vtkMRMLModelStorageNode") != 0
+    || modelNode == NULL || modelNode->GetMesh() == NULL)
+    {
+    return false;
+    }
+  // OBJ files are written with a material file, using a render window
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(
+    this->GetFullNameFromFileName());
+  return extension == ".vtk" || extension == ".vtp" || extension == ".vtu"
+    || extension == ".stl" || extension == ".ply";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::PrepareWriteDataDetachedInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  vtkPointSet* mesh = modelNode ? modelNode->GetMesh() : NULL;
+  if (mesh == NULL)
+    {
+    vtkErrorMacro("PrepareWriteDataDetachedInternal: no mesh to write");
+    return 0;
+    }
+  vtkSmartPointer<vtkPointSet> meshCopy = vtkSmartPointer<vtkPointSet>::Take(mesh->NewInstance());
+  meshCopy->ShallowCopy(mesh);
+  this->DetachedData = meshCopy;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::WriteDataDetachedInternal(const std::string& fullName)
+{
+  return this->WriteMeshToFile(vtkPointSet::SafeDownCast(this->DetachedData), fullName,
+    this->DetachedWriteUseCompression != 0);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::WriteMeshToFile(vtkPointSet* mesh, const std::string& fullName, bool useCompression)
+{
+  if (mesh == NULL)
+    {
+    vtkErrorMacro("WriteMeshToFile: no mesh to write in " << fullName);
+    return 0;
+    }
+  vtkPolyData* polyData = vtkPolyData::SafeDownCast(mesh);
+  vtkUnstructuredGrid* unstructuredGrid = vtkUnstructuredGrid::SafeDownCast(mesh);
+
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
+
   // We explicitly write the coordinate system into the file header.
   // For now, if space is not defined in a file then we assume that it is in the RAS
   // space (for backward compatibility) but in the future we will switch to LPS by default
@@ -346,24 +518,21 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   const std::string coordinateSytemSpecification = coordinateSystemTag + "=" + coordinateSystemValue;
 
   int result = 1;
-  if (extension == ".vtk" &&
-    (modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType
-    || modelNode->GetMeshType() == vtkMRMLModelNode::UnstructuredGridMeshType))
+  if (extension == ".vtk" && (polyData || unstructuredGrid))
     {
     vtkSmartPointer<vtkDataWriter> writer;
-    if (modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType)
+    if (polyData)
       {
       writer = vtkSmartPointer<vtkPolyDataWriter>::New();
-      writer->SetInputConnection(modelNode->GetPolyDataConnection());
       }
     else
       {
       writer = vtkSmartPointer<vtkUnstructuredGridWriter>::New();
-      writer->SetInputConnection(modelNode->GetMeshConnection());
       }
+    writer->SetInputData(mesh);
 
     writer->SetFileName(fullName.c_str());
-    writer->SetFileType(this->GetUseCompression() ? VTK_BINARY : VTK_ASCII );
+    writer->SetFileType(useCompression ? VTK_BINARY : VTK_ASCII );
 
     std::string header = std::string("vtk output ") + coordinateSytemSpecification;
     writer->SetHeader(header.c_str());
@@ -376,7 +545,7 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       result = 0;
       }
     }
-  else if (extension == ".vtu" || extension == ".vtp")
+  else if ((extension == ".vtu" && unstructuredGrid) || (extension == ".vtp" && polyData))
     {
     vtkSmartPointer<vtkXMLUnstructuredDataWriter> writer;
     // We make a shallow copy of the input data and store in inputData
@@ -386,20 +555,20 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       {
       writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
       inputData = vtkSmartPointer<vtkUnstructuredGrid>::New();
-      inputData->ShallowCopy(modelNode->GetUnstructuredGrid());
+      inputData->ShallowCopy(unstructuredGrid);
       }
     else
       {
       writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
       inputData = vtkSmartPointer<vtkPolyData>::New();
-      inputData->ShallowCopy(modelNode->GetPolyData());
+      inputData->ShallowCopy(polyData);
       }
     writer->SetInputData(inputData);
     writer->SetFileName(fullName.c_str());
     writer->SetCompressorType(
-      this->GetUseCompression() ? vtkXMLWriter::ZLIB : vtkXMLWriter::NONE);
+      useCompression ? vtkXMLWriter::ZLIB : vtkXMLWriter::NONE);
     writer->SetDataMode(
-      this->GetUseCompression() ? vtkXMLWriter::Appended : vtkXMLWriter::Ascii);
+      useCompression ? vtkXMLWriter::Appended : vtkXMLWriter::Ascii);
 
     // Write coordinate system space (RAS) to field data
     // In the future (when Slicer switches to VTK8) array metadata may be used instead of separate field data.
@@ -419,7 +588,7 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       }
     else
       {
-      vtkWarningMacro("vtkMRMLModelStorageNode::WriteDataInternal 'space' field already exists, cannot write coordinate system name into file");
+      vtkWarningMacro("vtkMRMLModelStorageNode::WriteMeshToFile 'space' field already exists, cannot write coordinate system name into file");
       }
 
     try
@@ -432,13 +601,13 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       }
 
     }
-  else if (extension == ".stl")
+  else if (extension == ".stl" && polyData)
     {
     vtkNew<vtkTriangleFilter> triangulator;
     vtkNew<vtkSTLWriter> writer;
     writer->SetFileName(fullName.c_str());
-    writer->SetFileType(this->GetUseCompression() ? VTK_BINARY : VTK_ASCII );
-    triangulator->SetInputConnection( modelNode->GetPolyDataConnection() );
+    writer->SetFileType(useCompression ? VTK_BINARY : VTK_ASCII );
+    triangulator->SetInputData( polyData );
     writer->SetInputConnection( triangulator->GetOutputPort() );
     std::string header = std::string("Visualization Toolkit generated SLA File ") + coordinateSytemSpecification;
     // STL header must be 80 characters long, otherwise VTK adds a char(0) in the header string
@@ -453,13 +622,13 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       result = 0;
       }
     }
-  else if (extension == ".ply")
+  else if (extension == ".ply" && polyData)
     {
     vtkNew<vtkTriangleFilter> triangulator;
     vtkNew<vtkPLYWriter> writer;
     writer->SetFileName(fullName.c_str());
-    writer->SetFileType(this->GetUseCompression() ? VTK_BINARY : VTK_ASCII );
-    triangulator->SetInputConnection( modelNode->GetPolyDataConnection() );
+    writer->SetFileType(useCompression ? VTK_BINARY : VTK_ASCII );
+    triangulator->SetInputData( polyData );
     writer->SetInputConnection( triangulator->GetOutputPort() );
     writer->AddComment(coordinateSytemSpecification);
     try
@@ -471,44 +640,6 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       result = 0;
       }
     }
-  else if (extension == ".obj")
-    {
-    vtkNew<vtkPolyDataMapper> mapper;
-    mapper->SetInputConnection(modelNode->GetPolyDataConnection());
-    vtkNew<vtkActor> actor;
-    actor->SetMapper(mapper.GetPointer());
-    vtkMRMLDisplayNode* displayNode = modelNode->GetDisplayNode();
-    if (displayNode)
-      {
-      actor->GetProperty()->SetColor(displayNode->GetColor());
-      actor->GetProperty()->SetOpacity(displayNode->GetOpacity());
-      }
-    vtkNew<vtkRenderer> renderer;
-    renderer->AddActor(actor.GetPointer());
-    vtkNew<vtkRenderWindow> renderWindow;
-    renderWindow->AddRenderer(renderer.GetPointer());
-    vtkNew<vtkOBJExporter> exporter;
-    exporter->SetRenderWindow(renderWindow.GetPointer());
-    std::string fullNameWithoutExtension = fullName;
-    if (fullNameWithoutExtension.size() > 4)
-      {
-      fullNameWithoutExtension.erase(fullNameWithoutExtension.size() - 4);
-      }
-    exporter->SetFilePrefix(fullNameWithoutExtension.c_str());
-    // TODO: write coordinate system name in file header comment
-    // Need to add API for that into VTK.
-    try
-      {
-      exporter->Write();
-      this->ResetFileNameList();
-      std::string materialFileName = fullNameWithoutExtension + ".mtl";
-      this->AddFileName(materialFileName.c_str());
-      }
-    catch (...)
-      {
-      result = 0;
-      }
-    }
   else
     {
     result = 0;
@@ -17,7 +17,9 @@
 
 #include "vtkMRMLStorageNode.h"
 
+class vtkAlgorithm;
 class vtkMRMLModelNode;
+class vtkPointSet;
 
 /// \brief MRML node for model storage on disk.
 ///
@@ -41,6 +43,12 @@ public:
   /// Return true if the reference node can be read in
   virtual bool CanReadInReferenceNode(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Return true if the model file is local
+  virtual bool CanReadDataDetached(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Return true if the model file is local and stored in a single file
+  virtual bool CanWriteDataDetached(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
 protected:
   vtkMRMLModelStorageNode();
   ~vtkMRMLModelStorageNode();
@@ -59,9 +67,36 @@ protected:
   /// Read data and set it in the referenced node
   virtual int ReadDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Read the mesh into DetachedData (the reader algorithm)
+  virtual int ReadDataDetachedInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Set the mesh of DetachedData in the referenced node
+  virtual int AttachDetachedDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Read the mesh from file. \a meshReader is set to an up-to-date algorithm
+  /// that has the mesh as output (NULL if no mesh was read).
+  /// Neither the scene nor any node is modified.
+  /// Returns 1 on success, 0 otherwise.
+  int ReadMeshFromFile(vtkSmartPointer<vtkAlgorithm>& meshReader);
+
+  /// Set the output of \a meshReader as mesh of \a modelNode and
+  /// update the scalar range of its display node.
+  void SetMeshToModelNode(vtkMRMLModelNode* modelNode, vtkAlgorithm* meshReader);
+
   /// Write data from a  referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Keep a shallow copy of the mesh in DetachedData
+  virtual int PrepareWriteDataDetachedInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Write the mesh of DetachedData
+  virtual int WriteDataDetachedInternal(const std::string& fullName) VTK_OVERRIDE;
+
+  /// Write \a mesh in a file format that only needs the mesh (all but OBJ).
+  /// Neither the scene nor any node is modified, and storage node properties are not read.
+  /// Returns 1 on success, 0 otherwise.
+  int WriteMeshToFile(vtkPointSet* mesh, const std::string& fullName, bool useCompression);
+
 };
 
 #endif
@@ -136,7 +136,16 @@ void vtkMRMLNode::Copy(vtkMRMLNode *node)
 
   vtkMRMLCopyEndMacro();
 
-  this->Attributes = node->Attributes;
+  if (this->Scene)
+    {
+    AttributesType oldAttributes = this->Attributes;
+    this->Attributes = node->Attributes;
+    this->Scene->UpdateNodeAttributeIndex(this, oldAttributes);
+    }
+  else
+    {
+    this->Attributes = node->Attributes;
+    }
 
   this->CopyReferences(node);
 
@@ -786,6 +795,11 @@ void vtkMRMLNode::SetAttribute(const char* name, const char* value)
     {
     return;
     }
+  if (this->Scene)
+    {
+    // oldValue points to the stored value, so it is updated before the value changes
+    this->Scene->UpdateNodeAttributeIndex(this, std::string(name), oldValue, value);
+    }
   if (value != 0)
     {
     this->Attributes[std::string(name)] = std::string(value);
@@ -114,20 +114,7 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
     return;
     }
 
-  const char* tmp = this->MRMLScene->GetClassNameByTag(tagName);
-  std::string className = tmp ? tmp : "";
-
-  // CreateNodeByClass should have a chance to instantiate non-registered node
-  if (className.empty())
-    {
-    className = "vtkMRML";
-    className += tagName;
-    // Append 'Node' prefix only if required
-    if (className.find("Node") != className.size() - 4)
-      {
-      className += "Node";
-      }
-    }
+  const std::string& className = this->GetClassNameForTag(tagName);
 
   vtkMRMLNode* node = this->MRMLScene->CreateNodeByClass( className.c_str() );
   if (!node)
@@ -217,7 +204,6 @@ void vtkMRMLParser::StartElement(const char* tagName, const char** atts)
 }
 
 //-----------------------------------------------------------------------------
-
 void vtkMRMLParser::EndElement(const char *name)
 {
   if ( !strcmp(name, "MRML") || this->NodeStack.empty() )
@@ -225,19 +211,13 @@ void vtkMRMLParser::EndElement(const char *name)
     return;
     }
 
-  const char* className = this->MRMLScene->GetClassNameByTag(name);
-  if (className == NULL)
+  // Only elements of registered node classes (or renamed SceneSnapshot nodes)
+  // have been pushed on the stack.
+  if (!this->MRMLScene->GetClassNameByTag(name))
     {
     // check for a renamed node
-    if (strcmp(name, "SceneSnapshot") == 0)
-      {
-      className = this->MRMLScene->GetClassNameByTag("SceneView");
-      if (className == NULL)
-        {
-        return;
-        }
-      }
-    else
+    if (strcmp(name, "SceneSnapshot") != 0
+      || this->MRMLScene->GetClassNameByTag("SceneView") == NULL)
       {
       return;
       }
@@ -245,3 +225,38 @@ void vtkMRMLParser::EndElement(const char *name)
 
   this->NodeStack.pop();
 }
+
+//-----------------------------------------------------------------------------
+int vtkMRMLParser::InitializeParser()
+{
+  // Registered node classes may have changed since the last parse
+  this->ClassNameByTag.clear();
+  return this->Superclass::InitializeParser();
+}
+
+//-----------------------------------------------------------------------------
+const std::string& vtkMRMLParser::GetClassNameForTag(const char* tagName)
+{
+  std::map<std::string, std::string>::iterator it = this->ClassNameByTag.find(tagName);
+  if (it != this->ClassNameByTag.end())
+    {
+    return it->second;
+    }
+
+  const char* tmp = this->MRMLScene->GetClassNameByTag(tagName);
+  std::string className = tmp ? tmp : "";
+
+  // CreateNodeByClass should have a chance to instantiate non-registered node
+  if (className.empty())
+    {
+    className = "vtkMRML";
+    className += tagName;
+    // Append 'Node' prefix only if required
+    if (className.find("Node") != className.size() - 4)
+      {
+      className += "Node";
+      }
+    }
+  return this->ClassNameByTag.insert(
+    std::pair<std::string, std::string>(tagName, className)).first->second;
+}
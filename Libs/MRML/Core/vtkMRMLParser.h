@@ -25,9 +25,17 @@ class vtkMRMLScene;
 class vtkCollection;
 
 // STD includes
+#include <map>
 #include <stack>
+#include <string>
 
 /// \brief Parse XML scene file.
+///
+/// The scene file is streamed through the SAX parser of vtkXMLParser, each
+/// element being turned into a node as soon as it is started. Only the
+/// resolution of element tags into node classes is indexed and cached (see
+/// GetClassNameForTag()); attributes are passed as-is to the
+/// ReadXMLAttributes() method of each node, which compares them by name.
 class VTK_MRML_EXPORT vtkMRMLParser : public vtkXMLParser
 {
 public:
@@ -48,11 +56,20 @@ protected:
 
   virtual void StartElement(const char* name, const char** atts) VTK_OVERRIDE;
   virtual void EndElement (const char *name) VTK_OVERRIDE;
+  virtual int InitializeParser() VTK_OVERRIDE;
+
+  /// Return the node class name to instantiate for an element tag.
+  /// Class names are resolved once per tag and parse, so that the same tag
+  /// string found in thousands of elements is looked up only once.
+  /// Attribute names are not interned: it only speeds up node instantiation.
+  const std::string& GetClassNameForTag(const char* tagName);
 
 private:
   vtkMRMLScene* MRMLScene;
   vtkCollection* NodeCollection;
   std::stack< vtkMRMLNode *> NodeStack;
+  /// Tag to class name cache, cleared each time parsing starts.
+  std::map< std::string, std::string > ClassNameByTag;
 };
 
 #endif
@@ -54,6 +54,8 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLSliceCompositeNode.h"
 #include "vtkMRMLSliceNode.h"
 #include "vtkMRMLSnapshotClipNode.h"
+#include "vtkMRMLStorableNode.h"
+#include "vtkMRMLStorageNode.h"
 #include "vtkMRMLSubjectHierarchyNode.h"
 #include "vtkMRMLTableNode.h"
 #include "vtkMRMLTableStorageNode.h"
@@ -84,8 +86,10 @@ Version:   $Revision: 1.18 $
 #include <vtkCollection.h>
 #include <vtkDebugLeaks.h>
 #include <vtkErrorCode.h>
+#include <vtkMultiThreader.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
+#include <vtkSMPTools.h>
 
 // VTKSYS includes
 #include <vtksys/RegularExpression.hxx>
@@ -136,6 +140,7 @@ vtkMRMLScene::vtkMRMLScene()
   this->SaveToXMLString = 0;
 
   this->ReadDataOnLoad = 1;
+  this->ConcurrentReadDataOnLoad = false;
 
   this->LastLoadedVersion = NULL;
   this->Version = NULL;
@@ -446,13 +451,11 @@ vtkMRMLNode* vtkMRMLScene::CreateNodeByClass(const char* className)
     return NULL;
     }
   vtkMRMLNode* node = NULL;
-  for (unsigned int i=0; i<RegisteredNodeClasses.size(); i++)
+  std::map<std::string, vtkMRMLNode*>::const_iterator registeredNodeIt =
+    this->RegisteredNodeClassesByClassName.find(className);
+  if (registeredNodeIt != this->RegisteredNodeClassesByClassName.end())
     {
-    if (!strcmp(RegisteredNodeClasses[i]->GetClassName(), className))
-      {
-      node = RegisteredNodeClasses[i]->CreateNodeInstance();
-      break;
-      }
+    node = registeredNodeIt->second->CreateNodeInstance();
     }
   // non-registered nodes can have a registered factory
   if (node == NULL)
@@ -516,7 +519,8 @@ void vtkMRMLScene::RegisterNodeClass(vtkMRMLNode* node, const char* tagName)
   // By doing so we make sure there is no more than 1 node matching a given
   // XML tag. It allows plugins to MRML to overide default behavior when
   // instantiating nodes via XML tags.
-  for (unsigned int i = 0; i < this->RegisteredNodeTags.size(); ++i)
+  bool replaced = (this->RegisteredNodeClassesByTag.find(xmlTag) != this->RegisteredNodeClassesByTag.end());
+  for (unsigned int i = 0; replaced && i < this->RegisteredNodeTags.size(); ++i)
     {
     if (this->RegisteredNodeTags[i] == xmlTag)
       {
@@ -543,6 +547,31 @@ void vtkMRMLScene::RegisterNodeClass(vtkMRMLNode* node, const char* tagName)
   node->Register(this);
   this->RegisteredNodeClasses.push_back(node);
   this->RegisteredNodeTags.push_back(xmlTag);
+  if (replaced)
+    {
+    this->UpdateRegisteredNodeClassIndices();
+    }
+  else
+    {
+    this->RegisteredNodeClassesByTag[xmlTag] = node;
+    this->RegisteredNodeClassesByClassName.insert(
+      std::pair<std::string, vtkMRMLNode*>(node->GetClassName(), node));
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::UpdateRegisteredNodeClassIndices()
+{
+  this->RegisteredNodeClassesByTag.clear();
+  this->RegisteredNodeClassesByClassName.clear();
+  for (unsigned int i = 0; i < this->RegisteredNodeClasses.size(); ++i)
+    {
+    vtkMRMLNode* node = this->RegisteredNodeClasses[i];
+    this->RegisteredNodeClassesByTag[this->RegisteredNodeTags[i]] = node;
+    // keep the first registered node if a class is registered with multiple tags
+    this->RegisteredNodeClassesByClassName.insert(
+      std::pair<std::string, vtkMRMLNode*>(node->GetClassName(), node));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -594,14 +623,13 @@ const char* vtkMRMLScene::GetClassNameByTag(const char *tagName)
     vtkErrorMacro("GetClassNameByTag: tagname is null");
     return NULL;
     }
-  for (unsigned int i=0; i<RegisteredNodeTags.size(); i++)
+  std::map<std::string, vtkMRMLNode*>::const_iterator registeredNodeIt =
+    this->RegisteredNodeClassesByTag.find(tagName);
+  if (registeredNodeIt == this->RegisteredNodeClassesByTag.end())
     {
-    if (!strcmp(RegisteredNodeTags[i].c_str(), tagName))
-      {
-      return (RegisteredNodeClasses[i])->GetClassName();
-      }
+    return NULL;
     }
-  return NULL;
+  return registeredNodeIt->second->GetClassName();
 }
 
 //------------------------------------------------------------------------------
@@ -612,14 +640,13 @@ const char* vtkMRMLScene::GetTagByClassName(const char *className)
     vtkErrorMacro("GetTagByClassName: className is null");
     return NULL;
     }
-  for (unsigned int i=0; i<this->RegisteredNodeClasses.size(); i++)
+  std::map<std::string, vtkMRMLNode*>::const_iterator registeredNodeIt =
+    this->RegisteredNodeClassesByClassName.find(className);
+  if (registeredNodeIt == this->RegisteredNodeClassesByClassName.end())
     {
-    if (!strcmp(this->RegisteredNodeClasses[i]->GetClassName(), className))
-      {
-      return (this->RegisteredNodeClasses[i])->GetNodeTagName();
-      }
+    return NULL;
     }
-  return NULL;
+  return registeredNodeIt->second->GetNodeTagName();
 }
 
 //------------------------------------------------------------------------------
@@ -738,6 +765,77 @@ int vtkMRMLScene::Connect()
   return res;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+
+//------------------------------------------------------------------------------
+/// Storage node that reads its data on a worker thread during import.
+struct DetachedRead
+{
+  vtkMRMLStorableNode* StorableNode;
+  vtkMRMLStorageNode* StorageNode;
+};
+
+//------------------------------------------------------------------------------
+/// Get the storage nodes of \a nodes that can read their data detached,
+/// in the order of the nodes. A storage node is listed at most once.
+void GetDetachedReads(vtkCollection* nodes, std::vector<DetachedRead>& detachedReads)
+{
+  std::set<vtkMRMLStorageNode*> storageNodes;
+  vtkMRMLNode* node = NULL;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+    {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+    if (!storableNode || !storableNode->GetAddToScene())
+      {
+      continue;
+      }
+    for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); ++i)
+      {
+      vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(i);
+      if (!storageNode || !storageNode->CanReadDataDetached(storableNode)
+        || !storageNodes.insert(storageNode).second)
+        {
+        continue;
+        }
+      DetachedRead read;
+      read.StorableNode = storableNode;
+      read.StorageNode = storageNode;
+      detachedReads.push_back(read);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Read the data of a range of detached reads, starting at \a firstRead.
+class ReadDataDetachedFunctor
+{
+public:
+  ReadDataDetachedFunctor(std::vector<DetachedRead>& detachedReads, size_t firstRead)
+    : DetachedReads(detachedReads)
+    , FirstRead(firstRead)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      DetachedRead& read = this->DetachedReads[this->FirstRead + i];
+      read.StorageNode->ReadDataDetached(read.StorableNode);
+      }
+  }
+
+private:
+  std::vector<DetachedRead>& DetachedReads;
+  size_t FirstRead;
+};
+
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLScene::Import()
 {
@@ -798,19 +896,52 @@ int vtkMRMLScene::Import()
 
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, NULL);
 
+    // Data of storage nodes that support it is read on worker threads,
+    // in batches (to limit the memory used by data that is not attached
+    // yet) that start at the first node that is not updated yet.
+    std::vector<DetachedRead> detachedReads;
+    if (this->ConcurrentReadDataOnLoad && this->ReadDataOnLoad)
+      {
+      GetDetachedReads(addedNodes, detachedReads);
+      }
+    const size_t detachedReadBatchSize =
+      2 * static_cast<size_t>(std::max(1, vtkMultiThreader::GetGlobalDefaultNumberOfThreads()));
+    size_t nextDetachedRead = 0; // first read of the nodes that are not updated yet
+    size_t detachedReadsEnd = 0; // end of the reads that have been done
+
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
     for (addedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)addedNodes->GetNextItemAsObject(it)) ;)
       {
-      //double progress = n / (1. * nnodes);
-      //this->InvokeEvent(vtkCommand::ProgressEvent,(void *)&progress);
+      bool hasDetachedReads = (nextDetachedRead < detachedReads.size()
+        && detachedReads[nextDetachedRead].StorableNode == node);
+      if (hasDetachedReads && nextDetachedRead >= detachedReadsEnd)
+        {
+        detachedReadsEnd = std::min(detachedReads.size(), nextDetachedRead + detachedReadBatchSize);
+        ReadDataDetachedFunctor readDataDetached(detachedReads, nextDetachedRead);
+        vtkSMPTools::For(0, static_cast<vtkIdType>(detachedReadsEnd - nextDetachedRead), 1, readDataDetached);
+        }
+
       vtkDebugMacro("Adding Node: " << node->GetName());
       if (node->GetAddToScene())
         {
+        // Storable nodes set the detached data or read it now
         node->UpdateScene(this);
         }
+
+      if (hasDetachedReads)
+        {
+        while (nextDetachedRead < detachedReads.size()
+          && detachedReads[nextDetachedRead].StorableNode == node)
+          {
+          ++nextDetachedRead;
+          }
+        // Percentage of the concurrently read data that is in the scene
+        this->ProgressState(vtkMRMLScene::ImportState,
+          static_cast<int>(100 * nextDetachedRead / detachedReads.size()));
+        }
       if (this->GetErrorCode() == 1)
         {
         //vtkErrorMacro("Import: error updating node " << node->GetID());
@@ -822,6 +953,13 @@ int vtkMRMLScene::Import()
         }
       }
 
+    // Release data that was read but not set in a node
+    for (std::vector<DetachedRead>::iterator readIt = detachedReads.begin();
+         readIt != detachedReads.end(); ++readIt)
+      {
+      readIt->StorageNode->DiscardDetachedData();
+      }
+
     this->Modified();
     this->RemoveUnusedNodeReferences();
 #ifdef MRMLSCENE_VERBOSE
@@ -924,7 +1062,10 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
   int result = 0; // 0 means failure
   if (this->GetLoadFromXMLString())
     {
-    result = parser->Parse(this->GetSceneXMLString().c_str());
+    // Pass the length so that the string is streamed to the parser as is,
+    // without being scanned for its terminating character first.
+    const std::string& sceneXMLString = this->GetSceneXMLString();
+    result = parser->Parse(sceneXMLString.c_str(), static_cast<unsigned int>(sceneXMLString.size()));
     }
   else
     {
@@ -1349,6 +1490,7 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
 
   std::string nid=n->GetID();
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeAttributesFromIndex(n);
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1584,6 +1726,81 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
   return nodes;
 }
 
+//------------------------------------------------------------------------------
+int vtkMRMLScene::GetNodesByAttribute(const char* attributeName, const char* attributeValue,
+                                      std::vector<vtkMRMLNode*>& nodes)
+{
+  nodes.clear();
+  if (attributeName == NULL)
+    {
+    vtkErrorMacro("GetNodesByAttribute: attribute name is null.");
+    return 0;
+    }
+  // Make sure the index is in sync with the node collection
+  this->UpdateNodeIDs();
+
+  std::map< std::string, NodesByAttributeValueType >::iterator nameIt =
+    this->NodesByAttribute.find(std::string(attributeName));
+  if (nameIt == this->NodesByAttribute.end())
+    {
+    return 0;
+    }
+  std::set<vtkMRMLNode*> foundNodes;
+  if (attributeValue)
+    {
+    NodesByAttributeValueType::iterator valueIt = nameIt->second.find(std::string(attributeValue));
+    if (valueIt != nameIt->second.end())
+      {
+      foundNodes = valueIt->second;
+      }
+    }
+  else
+    {
+    for (NodesByAttributeValueType::iterator valueIt = nameIt->second.begin();
+         valueIt != nameIt->second.end(); ++valueIt)
+      {
+      foundNodes.insert(valueIt->second.begin(), valueIt->second.end());
+      }
+    }
+  if (foundNodes.size() == 1)
+    {
+    nodes.push_back(*foundNodes.begin());
+    }
+  else if (foundNodes.size() > 1)
+    {
+    // Return the nodes in the same order as in the scene
+    vtkMRMLNode *node;
+    vtkCollectionSimpleIterator it;
+    for (this->Nodes->InitTraversal(it);
+         (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+      {
+      if (foundNodes.find(node) != foundNodes.end())
+        {
+        nodes.push_back(node);
+        }
+      }
+    }
+  return static_cast<int>(nodes.size());
+}
+
+//------------------------------------------------------------------------------
+vtkCollection* vtkMRMLScene::GetNodesByAttribute(const char* attributeName, const char* attributeValue)
+{
+  if (attributeName == NULL)
+    {
+    vtkErrorMacro("GetNodesByAttribute: attribute name is null.");
+    return 0;
+    }
+  std::vector<vtkMRMLNode*> foundNodes;
+  this->GetNodesByAttribute(attributeName, attributeValue, foundNodes);
+  vtkCollection* nodes = vtkCollection::New();
+  for (std::vector<vtkMRMLNode*>::iterator it = foundNodes.begin(); it != foundNodes.end(); ++it)
+    {
+    nodes->AddItem(*it);
+    }
+  return nodes;
+}
+
 //------------------------------------------------------------------------------
 std::list< std::string > vtkMRMLScene::GetNodeClassesList()
 {
@@ -3115,6 +3332,7 @@ void vtkMRMLScene::AddNodeID(vtkMRMLNode *node)
     {
     this->NodeIDs[std::string(node->GetID())] = node;
     this->NodeIDsMTime = this->Nodes->GetMTime();
+    this->AddNodeAttributesToIndex(node);
     }
 }
 
@@ -3136,6 +3354,112 @@ void vtkMRMLScene::ClearNodeIDs()
     this->NodeIDs.clear();
     this->NodeIDsMTime = this->Nodes->GetMTime();
   }
+  this->NodesByAttribute.clear();
+  this->AttributeIndexedNodes.clear();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeAttributesToIndex(vtkMRMLNode* node)
+{
+  if (!node || !this->AttributeIndexedNodes.insert(node).second)
+    {
+    // already indexed
+    return;
+    }
+  for (vtkMRMLNode::AttributesType::const_iterator it = node->Attributes.begin();
+       it != node->Attributes.end(); ++it)
+    {
+    this->NodesByAttribute[it->first][it->second].insert(node);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeAttributesFromIndex(vtkMRMLNode* node)
+{
+  if (!node || this->AttributeIndexedNodes.erase(node) == 0)
+    {
+    // not indexed
+    return;
+    }
+  for (vtkMRMLNode::AttributesType::const_iterator it = node->Attributes.begin();
+       it != node->Attributes.end(); ++it)
+    {
+    std::map< std::string, NodesByAttributeValueType >::iterator nameIt =
+      this->NodesByAttribute.find(it->first);
+    if (nameIt == this->NodesByAttribute.end())
+      {
+      continue;
+      }
+    NodesByAttributeValueType::iterator valueIt = nameIt->second.find(it->second);
+    if (valueIt == nameIt->second.end())
+      {
+      continue;
+      }
+    valueIt->second.erase(node);
+    if (valueIt->second.empty())
+      {
+      nameIt->second.erase(valueIt);
+      if (nameIt->second.empty())
+        {
+        this->NodesByAttribute.erase(nameIt);
+        }
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeAttributeIndex(vtkMRMLNode* node, const std::string& attributeName,
+                                            const char* oldValue, const char* newValue)
+{
+  if (this->AttributeIndexedNodes.find(node) == this->AttributeIndexedNodes.end())
+    {
+    return;
+    }
+  if (oldValue)
+    {
+    std::map< std::string, NodesByAttributeValueType >::iterator nameIt =
+      this->NodesByAttribute.find(attributeName);
+    if (nameIt != this->NodesByAttribute.end())
+      {
+      NodesByAttributeValueType::iterator valueIt = nameIt->second.find(oldValue);
+      if (valueIt != nameIt->second.end())
+        {
+        valueIt->second.erase(node);
+        if (valueIt->second.empty())
+          {
+          nameIt->second.erase(valueIt);
+          if (nameIt->second.empty())
+            {
+            this->NodesByAttribute.erase(nameIt);
+            }
+          }
+        }
+      }
+    }
+  if (newValue)
+    {
+    this->NodesByAttribute[attributeName][newValue].insert(node);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeAttributeIndex(vtkMRMLNode* node,
+                                            const std::map<std::string, std::string>& oldAttributes)
+{
+  if (this->AttributeIndexedNodes.find(node) == this->AttributeIndexedNodes.end())
+    {
+    return;
+    }
+  for (std::map<std::string, std::string>::const_iterator it = oldAttributes.begin();
+       it != oldAttributes.end(); ++it)
+    {
+    this->UpdateNodeAttributeIndex(node, it->first, it->second.c_str(), NULL);
+    }
+  for (vtkMRMLNode::AttributesType::const_iterator it = node->Attributes.begin();
+       it != node->Attributes.end(); ++it)
+    {
+    this->UpdateNodeAttributeIndex(node, it->first, NULL, it->second.c_str());
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -56,8 +56,10 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   ///
   /// make the vtkMRMLSceneViewNode a friend since it has internal vtkMRMLScene
   /// so that it can call protected methods, for example UpdateNodeIDs()
-  /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// make the vtkMRMLNode a friend so that it can keep the node attribute
+  /// index up-to-date (see UpdateNodeAttributeIndex())
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -286,6 +288,20 @@ public:
   /// \warning You are responsible for deleting the returned collection.
   vtkCollection* GetNodesByClass(const char *className);
 
+  /// Get vector of nodes having the attribute \a attributeName with the value
+  /// \a attributeValue. If \a attributeValue is NULL, then the nodes having the
+  /// attribute with any value are returned.
+  /// The scene maintains an index of the node attributes, so the nodes are
+  /// not traversed (except for sorting the nodes in scene order if there are
+  /// multiple matches).
+  /// Return the number of found nodes.
+  /// \sa vtkMRMLNode::SetAttribute()
+  int GetNodesByAttribute(const char* attributeName, const char* attributeValue,
+                          std::vector<vtkMRMLNode*>& nodes);
+
+  /// \warning You are responsible for deleting the returned collection.
+  vtkCollection* GetNodesByAttribute(const char* attributeName, const char* attributeValue);
+
   /// \brief Search and return the singleton of type className with a
   /// \a singletonTag tag.
   ///
@@ -468,6 +484,24 @@ public:
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
+  /// \brief This property controls whether Import() reads the data of the
+  /// storage nodes concurrently.
+  ///
+  /// If enabled, the storage nodes that support it
+  /// (see vtkMRMLStorageNode::CanReadDataDetached()) read their files on
+  /// worker threads into detached data objects, in batches of a few files
+  /// per thread. The data is set in the nodes on the main thread, in scene
+  /// order, when the nodes are updated. Percentage of the data that is set in
+  /// the nodes is reported by ProgressImportEvent after each node.
+  /// Storage nodes also invoke a progress event when their data is set.
+  /// Errors of the concurrent reads are reported on the main thread, once,
+  /// when the data would be set in the node.
+  /// Disabled by default.
+  /// \sa Import(), SetReadDataOnLoad(), vtkMRMLStorageNode::ReadDataDetached()
+  vtkSetMacro(ConcurrentReadDataOnLoad,bool);
+  vtkGetMacro(ConcurrentReadDataOnLoad,bool);
+  vtkBooleanMacro(ConcurrentReadDataOnLoad,bool);
+
   void SetErrorMessage(const std::string &error);
   std::string GetErrorMessage();
 
@@ -646,7 +680,7 @@ public:
 
     StartImportEvent = StateEvent | StartEvent | ImportState,
     EndImportEvent = StateEvent | EndEvent | ImportState,
-    ProgressImportEvent = StateEvent | EndEvent | ImportState,
+    ProgressImportEvent = StateEvent | ProgressEvent | ImportState,
 
     StartRestoreEvent = StateEvent | StartEvent | RestoreState,
     EndRestoreEvent = StateEvent | EndEvent | RestoreState,
@@ -752,9 +786,29 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// Add/remove all the attributes of a node to/from \a NodesByAttribute
+  /// index used to speedup GetNodesByAttribute() method.
+  /// Nodes are indexed when their ID is cached in the NodeIDs map.
+  void AddNodeAttributesToIndex(vtkMRMLNode* node);
+  void RemoveNodeAttributesFromIndex(vtkMRMLNode* node);
+
+  /// Update \a NodesByAttribute index when an attribute of a node changes.
+  /// NULL value means that the attribute is not set. No-op if the node is not
+  /// indexed. Called by vtkMRMLNode.
+  void UpdateNodeAttributeIndex(vtkMRMLNode* node, const std::string& attributeName,
+                                const char* oldValue, const char* newValue);
+  /// Update \a NodesByAttribute index when all the attributes of a node
+  /// change at once (e.g. when the node is copied). Called by vtkMRMLNode.
+  void UpdateNodeAttributeIndex(vtkMRMLNode* node,
+                                const std::map<std::string, std::string>& oldAttributes);
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
+  /// Synchronize RegisteredNodeClassesByTag and RegisteredNodeClassesByClassName
+  /// with the registered node classes.
+  void UpdateRegisteredNodeClassIndices();
+
   vtkCollection*  Nodes;
   vtkMTimeType    SceneModifiedTime;
 
@@ -782,11 +836,23 @@ protected:
 
   std::vector< vtkMRMLNode* > RegisteredNodeClasses;
   std::vector< std::string >  RegisteredNodeTags;
+  /// Registered node classes indexed by XML tag and by class name, to avoid
+  /// searching the registered node classes for each element of a parsed scene.
+  /// \sa UpdateRegisteredNodeClassIndices()
+  std::map< std::string, vtkMRMLNode* > RegisteredNodeClassesByTag;
+  std::map< std::string, vtkMRMLNode* > RegisteredNodeClassesByClassName;
 
   NodeReferencesType NodeReferences; // ReferencedIDs (string), ReferencingNodes (node pointer)
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
 
+  /// Nodes indexed by attribute name then by attribute value.
+  /// \sa GetNodesByAttribute()
+  typedef std::map< std::string, std::set<vtkMRMLNode*> > NodesByAttributeValueType;
+  std::map< std::string, NodesByAttributeValueType > NodesByAttribute;
+  /// Nodes whose attributes are in \a NodesByAttribute
+  std::set<vtkMRMLNode*> AttributeIndexedNodes;
+
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
   // a default node is defined for it then the content of the default node will be used to initialize
   // the class. It is useful for overriding default values that are set in a node's constructor.
@@ -802,6 +868,8 @@ protected:
 
   int ReadDataOnLoad;
 
+  bool ConcurrentReadDataOnLoad;
+
   vtkMTimeType  NodeIDsMTime;
 
   void RemoveAllNodes(bool removeSingletons);
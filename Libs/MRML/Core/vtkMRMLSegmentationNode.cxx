@@ -47,6 +47,7 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
 #include <vtkMatrix4x4.h>
@@ -54,6 +55,88 @@
 
 // STD includes
 #include <algorithm>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Segment labelmap that is painted into the merged labelmap
+struct MergedSegmentLabelmap
+{
+  vtkOrientedImageData* Labelmap;
+  /// Intersection of the segment labelmap effective extent and merged labelmap extent
+  int Extent[6];
+  short LabelValue;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void PaintMergedLabelmapRow(vtkImageData* labelmap, const int extent[6], int j, int k,
+  short labelValue, short* mergedRowPtr)
+{
+  T* labelmapPtr = static_cast<T*>(labelmap->GetScalarPointer(extent[0], j, k));
+  const int numberOfComponents = labelmap->GetNumberOfScalarComponents();
+  for (int i = extent[0]; i <= extent[1]; ++i, labelmapPtr += numberOfComponents, ++mergedRowPtr)
+    {
+    if (*labelmapPtr > 0)
+      {
+      *mergedRowPtr = labelValue;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Writes all segments into the merged labelmap in a single pass.
+/// Rows of the merged labelmap are processed in parallel. Each row is filled with background
+/// then segments are painted in order, so later segments overwrite earlier ones
+/// (same result as merging the segments one by one).
+class MergeSegmentLabelmapsFunctor
+{
+public:
+  MergeSegmentLabelmapsFunctor(vtkImageData* mergedImage, const std::vector<MergedSegmentLabelmap>& segmentLabelmaps, short backgroundValue)
+    : MergedImage(mergedImage)
+    , SegmentLabelmaps(segmentLabelmaps)
+    , BackgroundValue(backgroundValue)
+  {
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow) const
+  {
+    const int* mergedExtent = this->MergedImage->GetExtent();
+    const int rowLength = mergedExtent[1] - mergedExtent[0] + 1;
+    const int numberOfRowsInSlice = mergedExtent[3] - mergedExtent[2] + 1;
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+      {
+      int j = mergedExtent[2] + static_cast<int>(row % numberOfRowsInSlice);
+      int k = mergedExtent[4] + static_cast<int>(row / numberOfRowsInSlice);
+      short* mergedRowPtr = static_cast<short*>(this->MergedImage->GetScalarPointer(mergedExtent[0], j, k));
+      std::fill(mergedRowPtr, mergedRowPtr + rowLength, this->BackgroundValue);
+      for (std::vector<MergedSegmentLabelmap>::const_iterator segmentIt = this->SegmentLabelmaps.begin();
+        segmentIt != this->SegmentLabelmaps.end(); ++segmentIt)
+        {
+        const int* extent = segmentIt->Extent;
+        if (j < extent[2] || j > extent[3] || k < extent[4] || k > extent[5])
+          {
+          continue;
+          }
+        short* segmentRowPtr = mergedRowPtr + (extent[0] - mergedExtent[0]);
+        switch (segmentIt->Labelmap->GetScalarType())
+          {
+          vtkTemplateMacro(PaintMergedLabelmapRow<VTK_TT>(segmentIt->Labelmap, extent, j, k, segmentIt->LabelValue, segmentRowPtr));
+          default:
+            break;
+          }
+        }
+      }
+  }
+
+  vtkImageData* MergedImage;
+  const std::vector<MergedSegmentLabelmap>& SegmentLabelmaps;
+  short BackgroundValue;
+};
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSegmentationNode);
@@ -575,15 +658,17 @@ bool vtkMRMLSegmentationNode::GenerateMergedLabelmap(
     }
 
   const short backgroundColorIndex = 0;
-  vtkOrientedImageDataResample::FillImage(mergedImageData, backgroundColorIndex);
 
   // Skip the rest if there are no segments
   if (this->Segmentation->GetNumberOfSegments() == 0)
     {
+    vtkOrientedImageDataResample::FillImage(mergedImageData, backgroundColorIndex);
     return true;
     }
 
-  // Create merged labelmap
+  // Collect segment labelmaps (resampled if needed) and the region where they overlap the merged labelmap
+  std::vector<MergedSegmentLabelmap> segmentLabelmaps;
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > resampledBinaryLabelmaps; // keeps resampled labelmaps in memory
   short colorIndex = backgroundColorIndex + 1;
   for (std::vector<std::string>::iterator segmentIdIt = mergedSegmentIDs.begin(); segmentIdIt != mergedSegmentIDs.end(); ++segmentIdIt, ++colorIndex)
     {
@@ -621,18 +706,46 @@ bool vtkMRMLSegmentationNode::GenerateMergedLabelmap(
 
       // Use resampled labelmap for merging
       binaryLabelmap = resampledBinaryLabelmap;
+      resampledBinaryLabelmaps.push_back(resampledBinaryLabelmap);
       }
 
-    // Copy image data voxels into merged labelmap with the proper color index
-    vtkOrientedImageDataResample::ModifyImage(
-          mergedImageData,
-          binaryLabelmap,
-          vtkOrientedImageDataResample::OPERATION_MASKING,
-          NULL,
-          0,
-          colorIndex);
+    if (!binaryLabelmap->GetPointData() || !binaryLabelmap->GetPointData()->GetScalars())
+      {
+      continue;
+      }
+    MergedSegmentLabelmap segmentLabelmap;
+    segmentLabelmap.Labelmap = binaryLabelmap;
+    segmentLabelmap.LabelValue = colorIndex;
+    // Only the region that contains foreground voxels is painted. The effective extent is cached
+    // by the segment labelmap if slice extent tracking is enabled, so it is typically not rescanned.
+    int labelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    if (!vtkOrientedImageDataResample::CalculateEffectiveExtent(binaryLabelmap, labelmapExtent))
+      {
+      continue;
+      }
+    bool emptyIntersection = false;
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      segmentLabelmap.Extent[axis * 2] = std::max(labelmapExtent[axis * 2], referenceExtent[axis * 2]);
+      segmentLabelmap.Extent[axis * 2 + 1] = std::min(labelmapExtent[axis * 2 + 1], referenceExtent[axis * 2 + 1]);
+      if (segmentLabelmap.Extent[axis * 2] > segmentLabelmap.Extent[axis * 2 + 1])
+        {
+        emptyIntersection = true;
+        }
+      }
+    if (emptyIntersection)
+      {
+      continue;
+      }
+    segmentLabelmaps.push_back(segmentLabelmap);
     }
 
+  // Copy image data voxels of all segments into merged labelmap with the proper color index
+  MergeSegmentLabelmapsFunctor mergeFunctor(mergedImageData, segmentLabelmaps, backgroundColorIndex);
+  vtkIdType numberOfRows = static_cast<vtkIdType>(referenceExtent[3] - referenceExtent[2] + 1) * (referenceExtent[5] - referenceExtent[4] + 1);
+  vtkSMPTools::For(0, numberOfRows, mergeFunctor);
+  mergedImageData->Modified();
+
   return true;
 }
 
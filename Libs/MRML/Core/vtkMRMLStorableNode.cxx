@@ -295,7 +295,10 @@ void vtkMRMLStorableNode::UpdateScene(vtkMRMLScene *scene)
         fname = std::string(pnode->GetURI());
         }
       vtkDebugMacro("UpdateScene: calling ReadData, fname = " << fname.c_str());
-      if (pnode->ReadData(this) == 0)
+      // Data may have already been read on a worker thread by the scene
+      int success = (pnode->HasDetachedData() || pnode->HasDetachedReadError()) ?
+        pnode->AttachDetachedData(this) : pnode->ReadData(this);
+      if (success == 0)
         {
         scene->SetErrorCode(1);
         std::string msg = std::string("Error reading file ") + fname;
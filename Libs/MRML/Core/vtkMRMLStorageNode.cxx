@@ -23,6 +23,7 @@ Version:   $Revision: 1.1.1.1 $
 
 // VTK includes
 #include <vtkCommand.h>
+#include <vtkDataObject.h>
 #include <vtkNew.h>
 #include <vtkStringArray.h>
 #include <vtkURIHandler.h>
@@ -56,6 +57,8 @@ vtkMRMLStorageNode::vtkMRMLStorageNode()
   this->SupportedWriteFileTypes = vtkStringArray::New();
   this->WriteFileFormat = NULL;
   this->StoredTime = vtkTimeStamp::New();
+  this->DetachedReadFailed = false;
+  this->DetachedWriteUseCompression = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -1198,6 +1201,147 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
   return res;
 }
 
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::CanReadDataDetached(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+namespace
+{
+
+//------------------------------------------------------------------------------
+/// Collect the error messages of a storage node instead of displaying them,
+/// as they must not be displayed from a worker thread.
+class vtkMRMLStorageNodeErrorCollector : public vtkCommand
+{
+public:
+  static vtkMRMLStorageNodeErrorCollector* New() { return new vtkMRMLStorageNodeErrorCollector; }
+  virtual void Execute(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eventId), void* callData) VTK_OVERRIDE
+  {
+    const char* message = reinterpret_cast<const char*>(callData);
+    if (message)
+      {
+      if (!this->ErrorMessage.empty())
+        {
+        this->ErrorMessage += "\n";
+        }
+      this->ErrorMessage += message;
+      }
+    // other observers are not notified from the worker thread
+    this->AbortFlagOn();
+  }
+  std::string ErrorMessage;
+};
+
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::ReadDataDetached(vtkMRMLNode* refNode)
+{
+  this->DiscardDetachedData();
+  if (refNode == NULL)
+    {
+    this->DetachedReadFailed = true;
+    this->DetachedReadErrorMessage = "ReadDataDetached: can't read for a null node";
+    return 0;
+    }
+  if (this->GetFileName() == NULL)
+    {
+    this->DetachedReadFailed = true;
+    this->DetachedReadErrorMessage = "ReadDataDetached: filename is null.";
+    return 0;
+    }
+  vtkNew<vtkMRMLStorageNodeErrorCollector> errorCollector;
+  unsigned long errorObserverTag = this->AddObserver(vtkCommand::ErrorEvent, errorCollector.GetPointer(), 1000.0);
+  int res = this->ReadDataDetachedInternal(refNode);
+  this->RemoveObserver(errorObserverTag);
+  if (!res || this->DetachedData.GetPointer() == NULL)
+    {
+    this->DetachedData = NULL;
+    this->DetachedReadFailed = true;
+    this->DetachedReadErrorMessage = errorCollector->ErrorMessage;
+    return 0;
+    }
+  return res;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::HasDetachedData()
+{
+  return this->DetachedData.GetPointer() != NULL;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::HasDetachedReadError()
+{
+  return this->DetachedReadFailed;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::AttachDetachedData(vtkMRMLNode* refNode, bool temporary)
+{
+  if (refNode == NULL)
+    {
+    vtkErrorMacro("AttachDetachedData: can't attach data to a null node");
+    return 0;
+    }
+  if (this->HasDetachedReadError())
+    {
+    // errors of the read on the worker thread are reported here, only once
+    if (this->DetachedReadErrorMessage.empty())
+      {
+      vtkErrorMacro("AttachDetachedData: failed to read file " << this->GetFileName());
+      }
+    else
+      {
+      vtkErrorMacro(<< this->DetachedReadErrorMessage);
+      }
+    this->DiscardDetachedData();
+    return 0;
+    }
+  if (!this->HasDetachedData())
+    {
+    vtkErrorMacro("AttachDetachedData: no data has been read by ReadDataDetached");
+    return 0;
+    }
+  if (!this->CanReadInReferenceNode(refNode))
+    {
+    this->DiscardDetachedData();
+    return 0;
+    }
+
+  this->StageReadData(refNode);
+  int res = this->AttachDetachedDataInternal(refNode);
+  this->DetachedData = NULL;
+  if (res)
+    {
+    // the file was read on a worker thread, where progress could not be reported
+    double progress = 1.0;
+    this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(refNode);
+    if (storableNode)
+      {
+      storableNode->SetAndObserveStorageNodeID(this->GetID());
+      }
+    this->SetReadStateIdle();
+    if (!temporary)
+      {
+      this->StoredTime->Modified();
+      }
+    }
+  return res;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::DiscardDetachedData()
+{
+  this->DetachedData = NULL;
+  this->DetachedReadFailed = false;
+  this->DetachedReadErrorMessage.clear();
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
 {
@@ -1224,18 +1368,146 @@ int vtkMRMLStorageNode::WriteData(vtkMRMLNode* refNode)
   return res;
 }
 
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::CanWriteDataDetached(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::PrepareWriteDataDetached(vtkMRMLNode* refNode)
+{
+  this->DetachedData = NULL;
+  this->DetachedWriteFullName.clear();
+  this->DetachedWriteErrorMessage.clear();
+  if (refNode == NULL)
+    {
+    vtkErrorMacro("PrepareWriteDataDetached: can't write, input node is null");
+    return 0;
+    }
+  if (!this->CanWriteFromReferenceNode(refNode))
+    {
+    return 0;
+    }
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+    {
+    vtkErrorMacro("PrepareWriteDataDetached: File name not specified");
+    return 0;
+    }
+  this->DetachedWriteUseCompression = this->UseCompression;
+  this->DetachedWriteFileFormat = this->WriteFileFormat ? this->WriteFileFormat : "";
+  int res = this->PrepareWriteDataDetachedInternal(refNode);
+  if (!res)
+    {
+    this->DetachedData = NULL;
+    return 0;
+    }
+  this->DetachedWriteFullName = fullName;
+  return res;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::WriteDataDetached()
+{
+  this->DetachedWriteErrorMessage.clear();
+  if (!this->HasDetachedData() || this->DetachedWriteFullName.empty())
+    {
+    this->DetachedWriteErrorMessage = "WriteDataDetached: no data has been prepared by PrepareWriteDataDetached";
+    return 0;
+    }
+  vtkNew<vtkMRMLStorageNodeErrorCollector> errorCollector;
+  unsigned long errorObserverTag = this->AddObserver(vtkCommand::ErrorEvent, errorCollector.GetPointer(), 1000.0);
+  // The temporary file keeps the extension, as writers may rely on it
+  std::string temporaryFullName = vtksys::SystemTools::GetFilenamePath(this->DetachedWriteFullName)
+    + "/.tmp-" + vtksys::SystemTools::GetFilenameName(this->DetachedWriteFullName);
+  int res = this->WriteDataDetachedInternal(temporaryFullName);
+  if (res && !vtksys::SystemTools::RenameFile(temporaryFullName.c_str(), this->DetachedWriteFullName.c_str()))
+    {
+    vtkErrorMacro("WriteDataDetached: failed to rename " << temporaryFullName
+      << " to " << this->DetachedWriteFullName);
+    res = 0;
+    }
+  if (!res && vtksys::SystemTools::FileExists(temporaryFullName.c_str(), true))
+    {
+    vtksys::SystemTools::RemoveFile(temporaryFullName.c_str());
+    }
+  this->RemoveObserver(errorObserverTag);
+  if (!res)
+    {
+    this->DetachedWriteErrorMessage = errorCollector->ErrorMessage;
+    }
+  return res;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::EndWriteDataDetached(vtkMRMLNode* refNode, bool written)
+{
+  if (!written)
+    {
+    // errors of the write on the worker thread are reported here, only once
+    if (this->DetachedWriteErrorMessage.empty())
+      {
+      vtkErrorMacro("EndWriteDataDetached: failed to write file " << this->DetachedWriteFullName);
+      }
+    else
+      {
+      vtkErrorMacro(<< this->DetachedWriteErrorMessage);
+      }
+    }
+  this->DetachedData = NULL;
+  this->DetachedWriteFullName.clear();
+  this->DetachedWriteErrorMessage.clear();
+  if (written && refNode != NULL)
+    {
+    this->StageWriteData(refNode);
+    this->StoredTime->Modified();
+    }
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLStorageNode::GetDetachedDataActualMemorySize()
+{
+  vtkDataObject* dataObject = vtkDataObject::SafeDownCast(this->DetachedData);
+  return dataObject ? dataObject->GetActualMemorySize() : 0;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::ReadDataInternal(vtkMRMLNode* vtkNotUsed(refNode))
 {
   return 0;
 }
 
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::ReadDataDetachedInternal(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::AttachDetachedDataInternal(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteDataInternal(vtkMRMLNode* vtkNotUsed(refNode))
 {
   return 0;
 }
 
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::PrepareWriteDataDetachedInternal(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLStorageNode::WriteDataDetachedInternal(const std::string& vtkNotUsed(fullName))
+{
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 std::string vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(const std::string& filename)
 {
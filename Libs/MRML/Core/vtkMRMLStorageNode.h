@@ -20,9 +20,11 @@
 class vtkURIHandler;
 
 // VTK includes
+#include <vtkSmartPointer.h>
 class vtkStringArray;
 
 // STD includes
+#include <string>
 #include <vector>
 
 /// \brief A supercalss for other storage nodes.
@@ -51,12 +53,89 @@ public:
   /// \sa SetFileName(), ReadDataInternal(), GetStoredTime()
   virtual int ReadData(vtkMRMLNode *refNode, bool temporaryFile = false);
 
+  /// Return true if the data of \a refNode can be read by ReadDataDetached(),
+  /// on a worker thread, concurrently with other storage nodes.
+  /// Only local files can be read detached, remote files are downloaded by ReadData().
+  /// Returns false by default, subclasses that implement ReadDataDetachedInternal()
+  /// and AttachDetachedDataInternal() must reimplement the method.
+  /// \sa ReadDataDetached(), vtkMRMLScene::SetConcurrentReadDataOnLoad()
+  virtual bool CanReadDataDetached(vtkMRMLNode* refNode);
+
+  /// Read data from \a FileName and keep it in the storage node, detached from
+  /// any node, until AttachDetachedData() is called.
+  /// \a refNode is only used to know what kind of data to read, it is not modified.
+  /// Neither the scene nor the storage node properties are modified and no events
+  /// are invoked (errors are stored and reported by AttachDetachedData()),
+  /// therefore it can be called on a worker thread as long as the storage node
+  /// is not used anywhere else in the meantime.
+  /// Return 1 on success, 0 on failure.
+  /// \sa CanReadDataDetached(), AttachDetachedData(), DiscardDetachedData()
+  int ReadDataDetached(vtkMRMLNode* refNode);
+
+  /// Return true if data has been read by ReadDataDetached() but not attached yet.
+  bool HasDetachedData();
+
+  /// Return true if ReadDataDetached() failed and its errors have not been
+  /// reported by AttachDetachedData() yet.
+  bool HasDetachedReadError();
+
+  /// Set the data read by ReadDataDetached() in the referenced node.
+  /// It must be called on the main thread and it is the equivalent of ReadData()
+  /// for data that has already been read: errors of the detached read are
+  /// reported here and a progress event is invoked when the data is set in the node.
+  /// Return 1 on success, 0 on failure.
+  /// \sa ReadDataDetached(), ReadData()
+  int AttachDetachedData(vtkMRMLNode* refNode, bool temporaryFile = false);
+
+  /// Release the data (or errors) of ReadDataDetached() if it has not been attached.
+  void DiscardDetachedData();
+
   ///
   /// Write data from a  referenced node
   /// Return 1 on success, 0 on failure.
   /// NOTE: Subclasses should implement this method
   virtual int WriteData(vtkMRMLNode *refNode);
 
+  /// Return true if the data of \a refNode can be written by WriteDataDetached(),
+  /// on a worker thread, concurrently with other storage nodes.
+  /// Only local files stored in a single file can be written detached.
+  /// Returns false by default, subclasses that implement PrepareWriteDataDetachedInternal()
+  /// and WriteDataDetachedInternal() must reimplement the method.
+  /// \sa PrepareWriteDataDetached(), WriteDataDetached(), EndWriteDataDetached()
+  virtual bool CanWriteDataDetached(vtkMRMLNode* refNode);
+
+  /// Keep a shallow copy of the data of \a refNode in the storage node so that
+  /// it can be written by WriteDataDetached().
+  /// The file name, write file format and compression setting are captured as well,
+  /// therefore WriteDataDetached() does not read the storage node properties.
+  /// It must be called on the main thread. The data of the node must not be
+  /// modified in place until EndWriteDataDetached() is called.
+  /// The storage node properties must not be modified until EndWriteDataDetached() is called.
+  /// Return 1 on success, 0 on failure.
+  /// \sa CanWriteDataDetached(), WriteDataDetached()
+  int PrepareWriteDataDetached(vtkMRMLNode* refNode);
+
+  /// Write the data kept by PrepareWriteDataDetached() into \a FileName.
+  /// The data is written into a temporary file of the same directory, that
+  /// replaces the file only if writing succeeded: an existing file is never
+  /// left partially written.
+  /// Neither the scene, the nodes nor the storage node properties are modified
+  /// and no events are invoked (errors are stored and reported by EndWriteDataDetached()),
+  /// therefore it can be called on a worker thread.
+  /// Return 1 on success, 0 on failure.
+  /// \sa PrepareWriteDataDetached(), EndWriteDataDetached()
+  int WriteDataDetached();
+
+  /// Release the data kept by PrepareWriteDataDetached().
+  /// If \a written is true, the node is marked as stored, as WriteData() does,
+  /// otherwise the errors of WriteDataDetached() are reported.
+  /// It must be called on the main thread.
+  void EndWriteDataDetached(vtkMRMLNode* refNode, bool written);
+
+  /// Return the memory size (in kibibytes) of the data kept by
+  /// PrepareWriteDataDetached(), 0 if there is no such data.
+  unsigned long GetDetachedDataActualMemorySize();
+
   ///
   /// Write this node's information to a MRML file in XML format.
   virtual void WriteXML(ostream& of, int indent) VTK_OVERRIDE;
@@ -313,11 +392,37 @@ protected:
   /// To be reimplemented in subclass.
   virtual int ReadDataInternal(vtkMRMLNode* refNode);
 
+  /// Reads the data into a new object that is stored in DetachedData.
+  /// \a refNode must not be modified. Returns 1 on success, 0 otherwise.
+  /// Returns 0 by default (detached read not supported).
+  /// \sa CanReadDataDetached(), AttachDetachedDataInternal()
+  virtual int ReadDataDetachedInternal(vtkMRMLNode* refNode);
+
+  /// Sets DetachedData in the referenced node. Returns 1 on success, 0 otherwise.
+  /// Returns 0 by default (detached read not supported).
+  /// \sa ReadDataDetachedInternal()
+  virtual int AttachDetachedDataInternal(vtkMRMLNode* refNode);
+
   /// Does the actual writing. Returns 1 on success, 0 otherwise.
   /// Returns 0 by default (write not supported).
   /// To be reimplemented in subclass.
   virtual int WriteDataInternal(vtkMRMLNode* refNode);
 
+  /// Keeps a shallow copy of the data of \a refNode in DetachedData.
+  /// Any other information that WriteDataDetachedInternal() needs from \a refNode
+  /// or from the scene must be captured as well.
+  /// \a refNode must not be modified. Returns 1 on success, 0 otherwise.
+  /// Returns 0 by default (detached write not supported).
+  /// \sa CanWriteDataDetached(), WriteDataDetachedInternal()
+  virtual int PrepareWriteDataDetachedInternal(vtkMRMLNode* refNode);
+
+  /// Writes DetachedData into \a fullName. Returns 1 on success, 0 otherwise.
+  /// Storage node properties must not be read, use DetachedWriteUseCompression and
+  /// DetachedWriteFileFormat instead.
+  /// Returns 0 by default (detached write not supported).
+  /// \sa PrepareWriteDataDetachedInternal()
+  virtual int WriteDataDetachedInternal(const std::string& fullName);
+
   ///
   /// If the URI is not null, fetch it and save it to the node's FileName location or
   /// load directly into the reference node.
@@ -363,6 +468,22 @@ protected:
   /// Can be reset with InvalidateFile.
   /// \sa InvalidateFile
   vtkTimeStamp* StoredTime;
+
+  /// Data read by ReadDataDetached() that is not set in the referenced node yet,
+  /// or data kept by PrepareWriteDataDetached() that is not written yet.
+  vtkSmartPointer<vtkObject> DetachedData;
+
+  /// Errors logged by a failed ReadDataDetached(), reported by AttachDetachedData()
+  std::string DetachedReadErrorMessage;
+  bool DetachedReadFailed;
+
+  /// Full path of the file written by WriteDataDetached()
+  std::string DetachedWriteFullName;
+  /// UseCompression and WriteFileFormat when PrepareWriteDataDetached() was called
+  int DetachedWriteUseCompression;
+  std::string DetachedWriteFileFormat;
+  /// Errors logged by a failed WriteDataDetached(), reported by EndWriteDataDetached()
+  std::string DetachedWriteErrorMessage;
 };
 
 #endif
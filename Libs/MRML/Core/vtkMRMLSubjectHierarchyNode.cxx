@@ -107,6 +107,23 @@ public:
   /// It can be static as the item IDs are unique in one application session.
   static std::map<vtkIdType, vtkSubjectHierarchyItem*> ItemCache;
 
+  /// Index of the items in the tree by data node and UID, to speed up the lookups performed
+  /// every time a node is added, modified or removed. Unlike item IDs, data nodes and UIDs are
+  /// not unique across trees, so the index is owned by the root item of the tree.
+  /// Only created for the scene item, NULL otherwise. \sa CreateLookupIndex
+  struct LookupIndexType
+    {
+    typedef std::pair<std::string, std::string> UIDType;
+    std::multimap<vtkMRMLNode*, vtkSubjectHierarchyItem*> ItemsByDataNode;
+    /// Data node each item is indexed with. Needed because the data node pointer of the item
+    /// is nulled when the data node is deleted, before the item is removed from the index.
+    std::map<vtkSubjectHierarchyItem*, vtkMRMLNode*> IndexedDataNodes;
+    std::multimap<UIDType, vtkSubjectHierarchyItem*> ItemsByUID;
+    /// Items by each entry of their UID values that are lists of UIDs (e.g. instance UIDs of a series)
+    std::multimap<UIDType, vtkSubjectHierarchyItem*> ItemsByUIDListEntry;
+    };
+  LookupIndexType* LookupIndex;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -125,6 +142,12 @@ public:
   /// Get name of the item. If has data node associated then return name of data node, \sa Name member otherwise
   std::string GetName();
 
+  /// Create lookup index for the tree of which this item is the root.
+  /// Must be called before any child is added. \sa LookupIndex
+  void CreateLookupIndex();
+  /// Get root item of the tree containing this item (the ancestor without parent)
+  vtkSubjectHierarchyItem* GetRootItem();
+
   /// Set UID to the item
   void SetUID(std::string uidName, std::string uidValue);
   /// Get a UID with a given name
@@ -238,10 +261,50 @@ private:
   /// Incremental ID used to uniquely identify subject hierarchy items
   static vtkIdType NextSubjectHierarchyItemID;
 
+  /// Add/remove data node and UIDs of an item in the tree to/from the lookup index.
+  /// No-op if this item does not have lookup index.
+  void AddToLookupIndex(vtkSubjectHierarchyItem* item);
+  void RemoveFromLookupIndex(vtkSubjectHierarchyItem* item);
+  /// Add/remove one UID of an item in the tree to/from the lookup index
+  void AddUIDToLookupIndex(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue);
+  void RemoveUIDFromLookupIndex(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue);
+
   vtkSubjectHierarchyItem(const vtkSubjectHierarchyItem&); // Not implemented
   void operator=(const vtkSubjectHierarchyItem&);          // Not implemented
 };
 
+namespace
+{
+
+//---------------------------------------------------------------------------
+template<class KeyType>
+void RemoveItemFromMultimap(std::multimap<KeyType, vtkSubjectHierarchyItem*>& itemMap,
+                            const KeyType& key, vtkSubjectHierarchyItem* item)
+{
+  typedef typename std::multimap<KeyType, vtkSubjectHierarchyItem*>::iterator ItemIteratorType;
+  std::pair<ItemIteratorType, ItemIteratorType> range = itemMap.equal_range(key);
+  for (ItemIteratorType itemIt = range.first; itemIt != range.second; ++itemIt)
+    {
+    if (itemIt->second == item)
+      {
+      itemMap.erase(itemIt);
+      return;
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void GetBranchItems(vtkSubjectHierarchyItem* item, std::vector<vtkSubjectHierarchyItem*>& branchItems)
+{
+  branchItems.push_back(item);
+  for (vtkSubjectHierarchyItem::ChildVector::iterator childIt=item->Children.begin(); childIt!=item->Children.end(); ++childIt)
+    {
+    GetBranchItems(childIt->GetPointer(), branchItems);
+    }
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSubjectHierarchyItem);
 
@@ -263,6 +326,7 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
   , TemporaryID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
   , TemporaryDataNodeID("")
   , TemporaryParentItemID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  , LookupIndex(NULL)
 {
   this->Children.clear();
   this->Attributes.clear();
@@ -276,6 +340,9 @@ vtkSubjectHierarchyItem::~vtkSubjectHierarchyItem()
 
   this->Attributes.clear();
   this->UIDs.clear();
+
+  delete this->LookupIndex;
+  this->LookupIndex = NULL;
 }
 
 //---------------------------------------------------------------------------
@@ -301,8 +368,9 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
     vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
     this->Parent->Children.push_back(childPointer);
 
-    // Add to cache
+    // Add to cache and lookup index
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    parent->GetRootItem()->AddToLookupIndex(this);
     }
   else
     {
@@ -338,8 +406,9 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
     vtkSmartPointer<vtkSubjectHierarchyItem> childPointer(this);
     this->Parent->Children.push_back(childPointer);
 
-    // Add to cache
+    // Add to cache and lookup index
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+    parent->GetRootItem()->AddToLookupIndex(this);
     }
   else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
             || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
@@ -685,6 +754,102 @@ std::string vtkSubjectHierarchyItem::GetName()
   return this->Name;
 }
 
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::CreateLookupIndex()
+{
+  if (this->LookupIndex)
+    {
+    return;
+    }
+  this->LookupIndex = new LookupIndexType();
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::GetRootItem()
+{
+  vtkSubjectHierarchyItem* rootItem = this;
+  while (rootItem->Parent)
+    {
+    rootItem = rootItem->Parent;
+    }
+  return rootItem;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddToLookupIndex(vtkSubjectHierarchyItem* item)
+{
+  if (!this->LookupIndex || !item)
+    {
+    return;
+    }
+  if (item->DataNode.GetPointer())
+    {
+    this->LookupIndex->ItemsByDataNode.insert(std::make_pair(item->DataNode.GetPointer(), item));
+    this->LookupIndex->IndexedDataNodes[item] = item->DataNode.GetPointer();
+    }
+  for (std::map<std::string, std::string>::iterator uidIt=item->UIDs.begin(); uidIt!=item->UIDs.end(); ++uidIt)
+    {
+    this->AddUIDToLookupIndex(item, uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveFromLookupIndex(vtkSubjectHierarchyItem* item)
+{
+  if (!this->LookupIndex || !item)
+    {
+    return;
+    }
+  std::map<vtkSubjectHierarchyItem*, vtkMRMLNode*>::iterator dataNodeIt = this->LookupIndex->IndexedDataNodes.find(item);
+  if (dataNodeIt != this->LookupIndex->IndexedDataNodes.end())
+    {
+    RemoveItemFromMultimap(this->LookupIndex->ItemsByDataNode, dataNodeIt->second, item);
+    this->LookupIndex->IndexedDataNodes.erase(dataNodeIt);
+    }
+  for (std::map<std::string, std::string>::iterator uidIt=item->UIDs.begin(); uidIt!=item->UIDs.end(); ++uidIt)
+    {
+    this->RemoveUIDFromLookupIndex(item, uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddUIDToLookupIndex(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+{
+  if (!this->LookupIndex || uidValue.empty())
+    {
+    return;
+    }
+  this->LookupIndex->ItemsByUID.insert(std::make_pair(LookupIndexType::UIDType(uidName, uidValue), item));
+  if (uidValue.find(' ') != std::string::npos)
+    {
+    std::vector<std::string> uidListEntries;
+    vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidListEntries);
+    for (std::vector<std::string>::iterator entryIt=uidListEntries.begin(); entryIt!=uidListEntries.end(); ++entryIt)
+      {
+      this->LookupIndex->ItemsByUIDListEntry.insert(std::make_pair(LookupIndexType::UIDType(uidName, *entryIt), item));
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveUIDFromLookupIndex(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+{
+  if (!this->LookupIndex || uidValue.empty())
+    {
+    return;
+    }
+  RemoveItemFromMultimap(this->LookupIndex->ItemsByUID, LookupIndexType::UIDType(uidName, uidValue), item);
+  if (uidValue.find(' ') != std::string::npos)
+    {
+    std::vector<std::string> uidListEntries;
+    vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidListEntries);
+    for (std::vector<std::string>::iterator entryIt=uidListEntries.begin(); entryIt!=uidListEntries.end(); ++entryIt)
+      {
+      RemoveItemFromMultimap(this->LookupIndex->ItemsByUIDListEntry, LookupIndexType::UIDType(uidName, *entryIt), item);
+      }
+    }
+}
+
 //---------------------------------------------------------------------------
 bool vtkSubjectHierarchyItem::HasChildren()
 {
@@ -747,6 +912,21 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByDataNode(vtkMRMLNod
     return NULL;
     }
 
+  if (recursive && this->LookupIndex)
+    {
+    // Data node pointers of removed nodes are nulled, so make sure the item still refers to the node
+    typedef std::multimap<vtkMRMLNode*, vtkSubjectHierarchyItem*>::iterator ItemIteratorType;
+    std::pair<ItemIteratorType, ItemIteratorType> range = this->LookupIndex->ItemsByDataNode.equal_range(dataNode);
+    for (ItemIteratorType itemIt = range.first; itemIt != range.second; ++itemIt)
+      {
+      if (itemIt->second->DataNode.GetPointer() == dataNode)
+        {
+        return itemIt->second;
+        }
+      }
+    return NULL;
+    }
+
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
@@ -774,6 +954,12 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
     {
     return NULL;
     }
+  if (recursive && this->LookupIndex)
+    {
+    std::multimap<LookupIndexType::UIDType, vtkSubjectHierarchyItem*>::iterator itemIt =
+      this->LookupIndex->ItemsByUID.find(LookupIndexType::UIDType(uidName, uidValue));
+    return (itemIt != this->LookupIndex->ItemsByUID.end() ? itemIt->second : NULL);
+    }
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
@@ -801,6 +987,23 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
     {
     return NULL;
     }
+  if (recursive && this->LookupIndex)
+    {
+    // Look for the value as a whole UID then as an entry of a UID list. If not found, then the
+    // tree is traversed, as the value may also be any other substring of a UID (list) value
+    LookupIndexType::UIDType uid(uidName, uidValue);
+    std::multimap<LookupIndexType::UIDType, vtkSubjectHierarchyItem*>::iterator itemIt =
+      this->LookupIndex->ItemsByUID.find(uid);
+    if (itemIt != this->LookupIndex->ItemsByUID.end())
+      {
+      return itemIt->second;
+      }
+    itemIt = this->LookupIndex->ItemsByUIDListEntry.find(uid);
+    if (itemIt != this->LookupIndex->ItemsByUIDListEntry.end())
+      {
+      return itemIt->second;
+      }
+    }
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
     {
@@ -961,9 +1164,23 @@ bool vtkSubjectHierarchyItem::Reparent(vtkSubjectHierarchyItem* newParentItem)
   formerParentItem->Children.erase(childIt);
 
   // Add item to new parent
+  vtkSubjectHierarchyItem* formerRootItem = formerParentItem->GetRootItem();
   this->Parent = newParentItem;
   newParentItem->Children.push_back(thisPointer);
 
+  // Move branch to the lookup index of the new tree if the item was moved to another tree
+  vtkSubjectHierarchyItem* newRootItem = newParentItem->GetRootItem();
+  if (formerRootItem != newRootItem)
+    {
+    std::vector<vtkSubjectHierarchyItem*> branchItems;
+    GetBranchItems(this, branchItems);
+    for (std::vector<vtkSubjectHierarchyItem*>::iterator itemIt=branchItems.begin(); itemIt!=branchItems.end(); ++itemIt)
+      {
+      formerRootItem->RemoveFromLookupIndex(*itemIt);
+      newRootItem->AddToLookupIndex(*itemIt);
+      }
+    }
+
   // Invoke modified events on all affected items
   formerParentItem->Modified();
   newParentItem->Modified();
@@ -1115,8 +1332,9 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
   removedItem->ReparentChildrenToParent();
 
-  // Remove from cache
+  // Remove from cache and lookup index
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
+  this->GetRootItem()->RemoveFromLookupIndex(removedItem);
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, item);
@@ -1159,8 +1377,9 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   // Reparent children to parent node (to avoid them becoming orphans and thus lost to the hierarchy)
   removedItem->ReparentChildrenToParent();
 
-  // Remove from cache
+  // Remove from cache and lookup index
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
+  this->GetRootItem()->RemoveFromLookupIndex(removedItem);
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, removedItem.GetPointer());
@@ -1264,7 +1483,10 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
       return; // Do nothing if the UID values match
       }
     }
+  vtkSubjectHierarchyItem* rootItem = this->GetRootItem();
+  rootItem->RemoveUIDFromLookupIndex(this, uidName, this->GetUID(uidName));
   this->UIDs[uidName] = uidValue;
+  rootItem->AddUIDToLookupIndex(this, uidName, uidValue);
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -1464,6 +1686,7 @@ vtkMRMLSubjectHierarchyNode::vtkInternal::vtkInternal(vtkMRMLSubjectHierarchyNod
 {
   // Create scene item
   this->SceneItem = vtkSubjectHierarchyItem::New();
+  this->SceneItem->CreateLookupIndex();
   this->SceneItemID = this->SceneItem->AddToTree(NULL, "Scene", "Scene");
 
   // Create mock item containing unresolved items
@@ -31,17 +31,227 @@ Version:   $Revision: 1.14 $
 #include <vtkGeneralTransform.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkHomogeneousTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPoints.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
+#include <vtkWarpTransform.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <stack>
 
+//----------------------------------------------------------------------------
+class vtkMRMLTransformNode::vtkInternal
+{
+public:
+  vtkInternal();
+
+  /// Cached displacement field, computed from the transform chain
+  /// to (or from) world on a specific grid.
+  struct DisplacementFieldCacheItem
+  {
+    DisplacementFieldCacheItem();
+    bool IsGeometryMatching(vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld);
+
+    vtkSmartPointer<vtkImageData> DisplacementField;
+    double IJKToRAS[4][4];
+    int Extent[6];
+    bool TransformToWorld;
+    std::vector<vtkObject*> Chain;
+    vtkMTimeType ChainMTime;
+    unsigned long LastUsed;
+  };
+
+  /// Displacement fields can be large, therefore only a few of them are kept.
+  /// When the cache is full then the least recently used item is replaced.
+  static const unsigned int MaximumNumberOfCachedDisplacementFields = 2;
+
+  std::vector<DisplacementFieldCacheItem> DisplacementFieldCache;
+  unsigned long DisplacementFieldCacheUseCounter;
+
+  /// Inverse displacement fields computed at the points of the grids requested by
+  /// GetTransformFromWorldUsingCachedInverse (typically slice views).
+  /// An item without displacement field records the first request of a grid with the current
+  /// transform chain, the field is only computed if the same grid is requested again.
+  static const unsigned int MaximumNumberOfCachedInverseGrids = 4;
+  std::vector<DisplacementFieldCacheItem> InverseGridCache;
+
+  /// Get the cache item of the specified grid. If there is no such item then a new item is added
+  /// (or the least recently used item is replaced if the cache is full), with the specified geometry
+  /// and without displacement field.
+  DisplacementFieldCacheItem* GetCacheItem(std::vector<DisplacementFieldCacheItem>& cache,
+    unsigned int maximumNumberOfItems, vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld);
+
+  /// Flattened transform to world. Matrices are only valid if the transform to world is linear.
+  vtkNew<vtkMatrix4x4> MatrixTransformToWorld;
+  vtkNew<vtkMatrix4x4> MatrixTransformFromWorld;
+  bool TransformToWorldLinear;
+  bool TransformToWorldCacheValid;
+
+  /// Version stamp of the cached transform to world, updated each time the cache is recomputed.
+  /// Child nodes store the version of their parent's cache when they compute their own cache,
+  /// therefore a change anywhere above in the hierarchy invalidates the cache of all descendants.
+  vtkTimeStamp TransformToWorldCacheVersion;
+
+  /// State of the transform chain that the cache was computed from.
+  /// Pointers are only used for comparison (never dereferenced), as together with
+  /// the globally unique version and modification time stamps they identify the state.
+  vtkMRMLTransformNode* CachedParentTransformNode;
+  vtkMTimeType CachedParentTransformToWorldCacheVersion;
+  vtkAbstractTransform* CachedTransformToParent;
+  vtkMTimeType CachedTransformToParentMTime;
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformNode::vtkInternal::vtkInternal()
+{
+  this->DisplacementFieldCacheUseCounter = 0;
+  this->TransformToWorldLinear = true;
+  this->TransformToWorldCacheValid = false;
+  this->CachedParentTransformNode = NULL;
+  this->CachedParentTransformToWorldCacheVersion = 0;
+  this->CachedTransformToParent = NULL;
+  this->CachedTransformToParentMTime = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformNode::vtkInternal::DisplacementFieldCacheItem::DisplacementFieldCacheItem()
+{
+  for (int row = 0; row < 4; row++)
+    {
+    for (int col = 0; col < 4; col++)
+      {
+      this->IJKToRAS[row][col] = (row == col ? 1.0 : 0.0);
+      }
+    }
+  for (int i = 0; i < 6; i++)
+    {
+    this->Extent[i] = 0;
+    }
+  this->TransformToWorld = true;
+  this->ChainMTime = 0;
+  this->LastUsed = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTransformNode::vtkInternal::DisplacementFieldCacheItem* vtkMRMLTransformNode::vtkInternal::GetCacheItem(
+  std::vector<DisplacementFieldCacheItem>& cache, unsigned int maximumNumberOfItems,
+  vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld)
+{
+  DisplacementFieldCacheItem* cacheItem = NULL;
+  for (std::vector<DisplacementFieldCacheItem>::iterator cacheIt = cache.begin(); cacheIt != cache.end(); ++cacheIt)
+    {
+    if (cacheIt->IsGeometryMatching(ijkToRAS, extent, transformToWorld))
+      {
+      cacheItem = &(*cacheIt);
+      cacheItem->LastUsed = ++this->DisplacementFieldCacheUseCounter;
+      return cacheItem;
+      }
+    }
+
+  if (cache.size() < maximumNumberOfItems)
+    {
+    cache.push_back(DisplacementFieldCacheItem());
+    cacheItem = &(cache.back());
+    }
+  else
+    {
+    // replace the least recently used item
+    cacheItem = &(cache[0]);
+    for (std::vector<DisplacementFieldCacheItem>::iterator cacheIt = cache.begin(); cacheIt != cache.end(); ++cacheIt)
+      {
+      if (cacheIt->LastUsed < cacheItem->LastUsed)
+        {
+        cacheItem = &(*cacheIt);
+        }
+      }
+    *cacheItem = DisplacementFieldCacheItem();
+    }
+
+  for (int row = 0; row < 4; row++)
+    {
+    for (int col = 0; col < 4; col++)
+      {
+      cacheItem->IJKToRAS[row][col] = ijkToRAS->Element[row][col];
+      }
+    }
+  for (int i = 0; i < 6; i++)
+    {
+    cacheItem->Extent[i] = extent[i];
+    }
+  cacheItem->TransformToWorld = transformToWorld;
+  cacheItem->LastUsed = ++this->DisplacementFieldCacheUseCounter;
+  return cacheItem;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformNode::vtkInternal::DisplacementFieldCacheItem::IsGeometryMatching(
+  vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld)
+{
+  if (this->TransformToWorld != transformToWorld)
+    {
+    return false;
+    }
+  for (int i = 0; i < 6; i++)
+    {
+    if (this->Extent[i] != extent[i])
+      {
+      return false;
+      }
+    }
+  for (int row = 0; row < 4; row++)
+    {
+    for (int col = 0; col < 4; col++)
+      {
+      if (this->IJKToRAS[row][col] != ijkToRAS->Element[row][col])
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Evaluates an arbitrary transform on a range of points of a contiguous point array.
+// The transform must be updated before the functor is used.
+class vtkMRMLTransformNodePointArrayFunctor
+{
+public:
+  vtkMRMLTransformNodePointArrayFunctor(vtkAbstractTransform* transform, const double* inPoints, double* outPoints)
+    : Transform(transform), InPoints(inPoints), OutPoints(outPoints)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double inPoint[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+      {
+      const double* inPointPtr = this->InPoints + 3 * pointIndex;
+      inPoint[0] = inPointPtr[0];
+      inPoint[1] = inPointPtr[1];
+      inPoint[2] = inPointPtr[2];
+      this->Transform->InternalTransformPoint(inPoint, this->OutPoints + 3 * pointIndex);
+      }
+  }
+
+private:
+  vtkAbstractTransform* Transform;
+  const double* InPoints;
+  double* OutPoints;
+};
+
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLTransformNode);
 
@@ -54,6 +264,8 @@ vtkMRMLTransformNode::vtkMRMLTransformNode()
 
   this->CachedMatrixTransformToParent=vtkMatrix4x4::New();
   this->CachedMatrixTransformFromParent=vtkMatrix4x4::New();
+
+  this->Internal = new vtkInternal();
 }
 
 //----------------------------------------------------------------------------
@@ -66,6 +278,9 @@ vtkMRMLTransformNode::~vtkMRMLTransformNode()
   this->CachedMatrixTransformToParent=NULL;
   this->CachedMatrixTransformFromParent->Delete();
   this->CachedMatrixTransformFromParent=NULL;
+
+  delete this->Internal;
+  this->Internal = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -368,15 +583,60 @@ vtkAbstractTransform* vtkMRMLTransformNode::GetTransformFromParent()
 //----------------------------------------------------------------------------
 int  vtkMRMLTransformNode::IsTransformToWorldLinear()
 {
-  for (vtkMRMLTransformNode* current = this; current != NULL; current = current->GetParentTransformNode())
+  this->UpdateTransformToWorldCache();
+  return this->Internal->TransformToWorldLinear ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::UpdateTransformToWorldCache()
+{
+  vtkInternal* internal = this->Internal;
+
+  // Make sure the parent's cache is up-to-date (this recursively checks the whole chain)
+  vtkMRMLTransformNode* parentTransformNode = this->GetParentTransformNode();
+  vtkMTimeType parentCacheVersion = 0;
+  if (parentTransformNode)
+    {
+    parentTransformNode->UpdateTransformToWorldCache();
+    parentCacheVersion = parentTransformNode->Internal->TransformToWorldCacheVersion.GetMTime();
+    }
+  vtkAbstractTransform* transformToParent = this->GetTransformToParent();
+  vtkMTimeType transformToParentMTime = (transformToParent ? transformToParent->GetMTime() : 0);
+
+  if (internal->TransformToWorldCacheValid
+    && internal->CachedParentTransformNode == parentTransformNode
+    && internal->CachedParentTransformToWorldCacheVersion == parentCacheVersion
+    && internal->CachedTransformToParent == transformToParent
+    && internal->CachedTransformToParentMTime == transformToParentMTime)
     {
-    if (!current->IsLinear())
+    // cache is up-to-date
+    return;
+    }
+
+  internal->TransformToWorldLinear = (this->IsLinear()
+    && (parentTransformNode == NULL || parentTransformNode->Internal->TransformToWorldLinear));
+  if (internal->TransformToWorldLinear)
+    {
+    this->GetMatrixTransformToParent(internal->MatrixTransformToWorld.GetPointer());
+    if (parentTransformNode)
       {
-      return 0;
+      vtkMatrix4x4::Multiply4x4(parentTransformNode->Internal->MatrixTransformToWorld.GetPointer(),
+        internal->MatrixTransformToWorld.GetPointer(), internal->MatrixTransformToWorld.GetPointer());
       }
+    vtkMatrix4x4::Invert(internal->MatrixTransformToWorld.GetPointer(), internal->MatrixTransformFromWorld.GetPointer());
     }
-  // not found non-linear transform component, therefore it's a linear transform
-  return 1;
+  else
+    {
+    internal->MatrixTransformToWorld->Identity();
+    internal->MatrixTransformFromWorld->Identity();
+    }
+
+  internal->CachedParentTransformNode = parentTransformNode;
+  internal->CachedParentTransformToWorldCacheVersion = parentCacheVersion;
+  internal->CachedTransformToParent = transformToParent;
+  internal->CachedTransformToParentMTime = transformToParentMTime;
+  internal->TransformToWorldCacheValid = true;
+  internal->TransformToWorldCacheVersion.Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -862,6 +1122,18 @@ int  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(vtkMRMLTransformNode*
     return 1;
     }
 
+  // Use precomputed matrices for transforms to and from world
+  if (targetNode == NULL && sourceNode->IsTransformToWorldLinear())
+    {
+    transformSourceToTarget->DeepCopy(sourceNode->Internal->MatrixTransformToWorld.GetPointer());
+    return 1;
+    }
+  if (sourceNode == NULL && targetNode->IsTransformToWorldLinear())
+    {
+    transformSourceToTarget->DeepCopy(targetNode->Internal->MatrixTransformFromWorld.GetPointer());
+    return 1;
+    }
+
   if (sourceNode && sourceNode->IsTransformNodeMyParent(targetNode))
     {
     transformSourceToTarget->Identity();
@@ -1112,11 +1384,15 @@ void vtkMRMLTransformNode::ProcessMRMLEvents ( vtkObject *caller,
     {
     if (caller == this->TransformToParent)
       {
+      this->Internal->TransformToWorldCacheValid = false;
+      this->ClearDisplacementFieldCache();
       this->TransformModified();
       this->StorableModifiedTime.Modified();
       }
     else if (caller == this->TransformFromParent)
       {
+      this->Internal->TransformToWorldCacheValid = false;
+      this->ClearDisplacementFieldCache();
       this->TransformModified();
       this->StorableModifiedTime.Modified();
       }
@@ -1135,6 +1411,7 @@ void vtkMRMLTransformNode::Inverse()
   vtkAbstractTransform* oldTransformFromParent=this->TransformFromParent;
   this->TransformToParent=oldTransformFromParent;
   this->TransformFromParent=oldTransformToParent;
+  this->Internal->TransformToWorldCacheValid = false;
 
   this->StorableModifiedTime.Modified();
   this->Modified();
@@ -1163,6 +1440,797 @@ vtkMTimeType vtkMRMLTransformNode::GetTransformToWorldMTime()
   return latestMTime;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::GetTransformToWorldChain(std::vector<vtkObject*>& chain, vtkMTimeType& chainMTime)
+{
+  chain.clear();
+  chainMTime = 0;
+  for (vtkMRMLTransformNode* current = this; current != NULL; current = current->GetParentTransformNode())
+    {
+    chain.push_back(current);
+    // Node modification time is taken into account to detect inversion of the transform
+    if (current->GetMTime() > chainMTime)
+      {
+      chainMTime = current->GetMTime();
+      }
+    vtkAbstractTransform* transformToParent = current->GetTransformToParent();
+    chain.push_back(transformToParent);
+    if (transformToParent != NULL && transformToParent->GetMTime() > chainMTime)
+      {
+      chainMTime = transformToParent->GetMTime();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::TransformPointArray(vtkAbstractTransform* transform,
+  const double* inPoints, double* outPoints, vtkIdType numberOfPoints)
+{
+  if (transform == NULL || inPoints == NULL || outPoints == NULL)
+    {
+    vtkGenericWarningMacro("vtkMRMLTransformNode::TransformPointArray failed: invalid input");
+    return;
+    }
+  if (numberOfPoints <= 0)
+    {
+    return;
+    }
+
+  // Concatenated transforms are applied one after the other, in the order
+  // of the flattened transform list. Grid and b-spline transforms use their
+  // specialized batch evaluation, which does not modify the transform
+  // (convergence failures of the inverse are reported from the calling thread).
+  vtkNew<vtkCollection> transformList;
+  FlattenGeneralTransform(transformList.GetPointer(), transform);
+  const double* currentInPoints = inPoints;
+  vtkCollectionSimpleIterator it;
+  vtkAbstractTransform* concatenatedTransform = NULL;
+  for (transformList->InitTraversal(it);
+    (concatenatedTransform = vtkAbstractTransform::SafeDownCast(transformList->GetNextItemAsObject(it)));)
+    {
+    vtkOrientedGridTransform* gridTransform = vtkOrientedGridTransform::SafeDownCast(concatenatedTransform);
+    vtkOrientedBSplineTransform* bsplineTransform = vtkOrientedBSplineTransform::SafeDownCast(concatenatedTransform);
+    if (gridTransform)
+      {
+      gridTransform->TransformPointArray(currentInPoints, outPoints, numberOfPoints);
+      }
+    else if (bsplineTransform)
+      {
+      bsplineTransform->TransformPointArray(currentInPoints, outPoints, numberOfPoints);
+      }
+    else
+      {
+      // Update the transform once, after that worker threads only read the transform.
+      concatenatedTransform->Update();
+      vtkMRMLTransformNodePointArrayFunctor functor(concatenatedTransform, currentInPoints, outPoints);
+      vtkSMPTools::For(0, numberOfPoints, functor);
+      }
+    currentInPoints = outPoints;
+    }
+  if (currentInPoints != outPoints)
+    {
+    // empty transform list (identity transform)
+    std::copy(inPoints, inPoints + 3 * numberOfPoints, outPoints);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Evaluates a transform at each grid point and stores the displacements in a 3-component float image.
+// Points are transformed slice by slice to limit the size of temporary buffers.
+static void ComputeDisplacementFieldOnGrid(vtkAbstractTransform* transform, const double ijkToRAS[4][4],
+  const int extent[6], vtkImageData* displacementField)
+{
+  const vtkIdType numberOfPointsInSlice = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1);
+  std::vector<double> points_RAS(3 * numberOfPointsInSlice);
+  std::vector<double> transformedPoints_RAS(3 * numberOfPointsInSlice);
+  float* voxelPtr = static_cast<float*>(displacementField->GetScalarPointer());
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    double* pointPtr = &(points_RAS[0]);
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++)
+        {
+        *(pointPtr++) = ijkToRAS[0][0] * i + ijkToRAS[0][1] * j + ijkToRAS[0][2] * k + ijkToRAS[0][3];
+        *(pointPtr++) = ijkToRAS[1][0] * i + ijkToRAS[1][1] * j + ijkToRAS[1][2] * k + ijkToRAS[1][3];
+        *(pointPtr++) = ijkToRAS[2][0] * i + ijkToRAS[2][1] * j + ijkToRAS[2][2] * k + ijkToRAS[2][3];
+        }
+      }
+    vtkMRMLTransformNode::TransformPointArray(transform, &(points_RAS[0]), &(transformedPoints_RAS[0]), numberOfPointsInSlice);
+    for (vtkIdType pointIndex = 0; pointIndex < 3 * numberOfPointsInSlice; pointIndex++)
+      {
+      *(voxelPtr++) = static_cast<float>(transformedPoints_RAS[pointIndex] - points_RAS[pointIndex]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Returns true if the transform contains a non-linear component that can only be computed
+// by iterative inversion (for example inverse of a grid or b-spline transform).
+static bool IsIterativeInverseRequired(vtkAbstractTransform* transform)
+{
+  vtkNew<vtkCollection> transformList;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformList.GetPointer(), transform);
+  vtkCollectionSimpleIterator it;
+  vtkAbstractTransform* transformComponent = NULL;
+  for (transformList->InitTraversal(it); (transformComponent = vtkAbstractTransform::SafeDownCast(transformList->GetNextItemAsObject(it))) ;)
+    {
+    vtkWarpTransform* warpTransformComponent = vtkWarpTransform::SafeDownCast(transformComponent);
+    if (warpTransformComponent && vtkMRMLTransformNode::IsAbstractTransformComputedFromInverse(warpTransformComponent))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+// Computes inverse displacements for rows of a grid using fixed-point iteration.
+// The inverse found at the previous point of the row is used as initial guess,
+// which is usually very close to the solution, as displacement fields are smooth.
+// Indices of voxels where the iteration does not converge are collected in
+// NonConvergedVoxels (in Reduce, on the calling thread).
+class vtkMRMLTransformNodeInverseDisplacementFunctor
+{
+public:
+  vtkMRMLTransformNodeInverseDisplacementFunctor(vtkAbstractTransform* forwardTransform,
+    vtkMatrix4x4* ijkToRAS, const int extent[6], float* inverseDisplacements, int maximumNumberOfIterations, double tolerance)
+    : ForwardTransform(forwardTransform)
+    , IJKToRAS(ijkToRAS)
+    , Extent(extent)
+    , InverseDisplacements(inverseDisplacements)
+    , MaximumNumberOfIterations(maximumNumberOfIterations)
+    , ToleranceSquared(tolerance * tolerance)
+  {
+  }
+
+  void Initialize()
+  {
+    this->LocalNonConvergedVoxels.Local().clear();
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow)
+  {
+    std::vector<vtkIdType>& nonConvergedVoxels = this->LocalNonConvergedVoxels.Local();
+    const double (*m)[4] = this->IJKToRAS->Element;
+    const int numberOfRowsInSlice = this->Extent[3] - this->Extent[2] + 1;
+    const int rowLength = this->Extent[1] - this->Extent[0] + 1;
+    double point_RAS[3] = { 0.0, 0.0, 0.0 };
+    double inverse_RAS[3] = { 0.0, 0.0, 0.0 };
+    double forward_RAS[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType rowIndex = beginRow; rowIndex < endRow; ++rowIndex)
+      {
+      int j = this->Extent[2] + static_cast<int>(rowIndex % numberOfRowsInSlice);
+      int k = this->Extent[4] + static_cast<int>(rowIndex / numberOfRowsInSlice);
+      float* voxelPtr = this->InverseDisplacements + 3 * rowIndex * rowLength;
+      bool previousPointConverged = false;
+      for (int i = this->Extent[0]; i <= this->Extent[1]; i++, voxelPtr += 3)
+        {
+        point_RAS[0] = m[0][0] * i + m[0][1] * j + m[0][2] * k + m[0][3];
+        point_RAS[1] = m[1][0] * i + m[1][1] * j + m[1][2] * k + m[1][3];
+        point_RAS[2] = m[2][0] * i + m[2][1] * j + m[2][2] * k + m[2][3];
+
+        // Initial guess
+        if (previousPointConverged)
+          {
+          // inverse displacement at the previous grid point
+          inverse_RAS[0] = point_RAS[0] + voxelPtr[-3];
+          inverse_RAS[1] = point_RAS[1] + voxelPtr[-2];
+          inverse_RAS[2] = point_RAS[2] + voxelPtr[-1];
+          }
+        else
+          {
+          // subtract the forward displacement
+          this->ForwardTransform->InternalTransformPoint(point_RAS, forward_RAS);
+          inverse_RAS[0] = 2.0 * point_RAS[0] - forward_RAS[0];
+          inverse_RAS[1] = 2.0 * point_RAS[1] - forward_RAS[1];
+          inverse_RAS[2] = 2.0 * point_RAS[2] - forward_RAS[2];
+          }
+
+        // Fixed-point iteration: inverse = inverse + (point - forward(inverse))
+        bool converged = false;
+        for (int iteration = 0; iteration < this->MaximumNumberOfIterations; iteration++)
+          {
+          this->ForwardTransform->InternalTransformPoint(inverse_RAS, forward_RAS);
+          double residual[3] =
+            {
+            point_RAS[0] - forward_RAS[0],
+            point_RAS[1] - forward_RAS[1],
+            point_RAS[2] - forward_RAS[2]
+            };
+          if (residual[0] * residual[0] + residual[1] * residual[1] + residual[2] * residual[2] < this->ToleranceSquared)
+            {
+            converged = true;
+            break;
+            }
+          inverse_RAS[0] += residual[0];
+          inverse_RAS[1] += residual[1];
+          inverse_RAS[2] += residual[2];
+          }
+        if (!converged)
+          {
+          // Fixed-point iteration does not converge if the transform is locally expansive,
+          // the (slower but more robust) inverse computation of the transform will be used.
+          nonConvergedVoxels.push_back(rowIndex * rowLength + (i - this->Extent[0]));
+          }
+        previousPointConverged = converged;
+
+        voxelPtr[0] = static_cast<float>(inverse_RAS[0] - point_RAS[0]);
+        voxelPtr[1] = static_cast<float>(inverse_RAS[1] - point_RAS[1]);
+        voxelPtr[2] = static_cast<float>(inverse_RAS[2] - point_RAS[2]);
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    this->NonConvergedVoxels.clear();
+    for (vtkSMPThreadLocal<std::vector<vtkIdType> >::iterator localIt = this->LocalNonConvergedVoxels.begin();
+      localIt != this->LocalNonConvergedVoxels.end(); ++localIt)
+      {
+      this->NonConvergedVoxels.insert(this->NonConvergedVoxels.end(), localIt->begin(), localIt->end());
+      }
+  }
+
+  std::vector<vtkIdType> NonConvergedVoxels;
+
+private:
+  vtkAbstractTransform* ForwardTransform;
+  vtkMatrix4x4* IJKToRAS;
+  const int* Extent;
+  float* InverseDisplacements;
+  int MaximumNumberOfIterations;
+  double ToleranceSquared;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > LocalNonConvergedVoxels;
+};
+
+//----------------------------------------------------------------------------
+// Set origin and spacing of a grid image from its IJK to RAS matrix.
+// Axis directions cannot be stored in the image, they are returned in gridDirection (if not NULL).
+static void SetGridGeometry(vtkImageData* grid, vtkMatrix4x4* ijkToRAS, vtkMatrix4x4* gridDirection)
+{
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  if (gridDirection)
+    {
+    gridDirection->Identity();
+    }
+  for (int c = 0; c < 3; c++)
+    {
+    origin[c] = ijkToRAS->Element[c][3];
+    double columnLength = sqrt(ijkToRAS->Element[0][c] * ijkToRAS->Element[0][c]
+      + ijkToRAS->Element[1][c] * ijkToRAS->Element[1][c]
+      + ijkToRAS->Element[2][c] * ijkToRAS->Element[2][c]);
+    if (columnLength == 0)
+      {
+      continue;
+      }
+    spacing[c] = columnLength;
+    if (gridDirection)
+      {
+      for (int row = 0; row < 3; row++)
+        {
+        gridDirection->SetElement(row, c, ijkToRAS->Element[row][c] / columnLength);
+        }
+      }
+    }
+  grid->SetOrigin(origin);
+  grid->SetSpacing(spacing);
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLTransformNode::GetCachedDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld /* = true */)
+{
+  if (ijkToRAS == NULL || extent == NULL)
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::GetCachedDisplacementField failed: invalid geometry");
+    return NULL;
+    }
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::GetCachedDisplacementField failed: empty extent");
+    return NULL;
+    }
+
+  std::vector<vtkObject*> chain;
+  vtkMTimeType chainMTime = 0;
+  this->GetTransformToWorldChain(chain, chainMTime);
+
+  // Find cache item with matching geometry
+  vtkInternal::DisplacementFieldCacheItem* cacheItem = this->Internal->GetCacheItem(this->Internal->DisplacementFieldCache,
+    vtkInternal::MaximumNumberOfCachedDisplacementFields, ijkToRAS, extent, transformToWorld);
+  if (cacheItem->DisplacementField.GetPointer() != NULL
+    && cacheItem->ChainMTime == chainMTime && cacheItem->Chain == chain)
+    {
+    // cached displacement field is up-to-date
+    return cacheItem->DisplacementField;
+    }
+  cacheItem->Chain = chain;
+  cacheItem->ChainMTime = chainMTime;
+
+  // Compute displacement field.
+  // A new image is created (instead of reusing the previous one) because the previously
+  // returned image may still be in use with its original geometry (e.g., in a grid transform).
+  cacheItem->DisplacementField = vtkSmartPointer<vtkImageData>::New();
+  if (!this->ComputeDisplacementField(ijkToRAS, extent, cacheItem->DisplacementField, transformToWorld))
+    {
+    cacheItem->DisplacementField = NULL;
+    return NULL;
+    }
+  return cacheItem->DisplacementField;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformNode::ComputeDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6],
+  vtkImageData* displacementField, bool transformToWorld /* = true */)
+{
+  if (ijkToRAS == NULL || extent == NULL || displacementField == NULL)
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::ComputeDisplacementField failed: invalid input");
+    return false;
+    }
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::ComputeDisplacementField failed: empty extent");
+    return false;
+    }
+  displacementField->SetExtent(const_cast<int*>(extent));
+  displacementField->AllocateScalars(VTK_FLOAT, 3);
+
+  // Image data cannot store axis directions, only origin and spacing is set
+  // (it is enough for axis-aligned grids, otherwise the direction has to be stored separately)
+  SetGridGeometry(displacementField, ijkToRAS, NULL);
+
+  vtkNew<vtkGeneralTransform> nodeToWorldTransform;
+  this->GetTransformToWorld(nodeToWorldTransform.GetPointer());
+  if (transformToWorld)
+    {
+    ComputeDisplacementFieldOnGrid(nodeToWorldTransform.GetPointer(), ijkToRAS->Element, extent, displacementField);
+    }
+  else
+    {
+    vtkNew<vtkGeneralTransform> worldToNodeTransform;
+    this->GetTransformFromWorld(worldToNodeTransform.GetPointer());
+    if (IsIterativeInverseRequired(worldToNodeTransform.GetPointer())
+      && !IsIterativeInverseRequired(nodeToWorldTransform.GetPointer()))
+      {
+      // Computing the transform from world would require iterative inversion at each point.
+      // It is much faster to compute the inverse displacement field on the whole grid at once.
+      if (!vtkMRMLTransformNode::ComputeInverseDisplacementField(nodeToWorldTransform.GetPointer(), worldToNodeTransform.GetPointer(),
+        ijkToRAS, extent, displacementField))
+        {
+        return false;
+        }
+      }
+    else
+      {
+      ComputeDisplacementFieldOnGrid(worldToNodeTransform.GetPointer(), ijkToRAS->Element, extent, displacementField);
+      }
+    }
+  displacementField->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTransformNode::ComputeInverseDisplacementField(vtkAbstractTransform* forwardTransform,
+  vtkAbstractTransform* inverseTransform, vtkMatrix4x4* ijkToRAS, const int extent[6], vtkImageData* inverseDisplacementField,
+  int maximumNumberOfIterations /* =20 */, double tolerance /* =0.001 */)
+{
+  if (forwardTransform == NULL || inverseTransform == NULL || ijkToRAS == NULL || extent == NULL || inverseDisplacementField == NULL)
+    {
+    vtkGenericWarningMacro("vtkMRMLTransformNode::ComputeInverseDisplacementField failed: invalid inputs");
+    return false;
+    }
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    vtkGenericWarningMacro("vtkMRMLTransformNode::ComputeInverseDisplacementField failed: empty extent");
+    return false;
+    }
+
+  inverseDisplacementField->SetExtent(const_cast<int*>(extent));
+  inverseDisplacementField->AllocateScalars(VTK_FLOAT, 3);
+
+  // Update transforms once, after that worker threads only read the transforms
+  forwardTransform->Update();
+  inverseTransform->Update();
+
+  // Each thread processes complete rows, so that the solution at the previous point
+  // can be used as initial guess
+  vtkIdType numberOfRows = static_cast<vtkIdType>(extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+  float* inverseDisplacements = static_cast<float*>(inverseDisplacementField->GetScalarPointer());
+  vtkMRMLTransformNodeInverseDisplacementFunctor functor(forwardTransform, ijkToRAS, extent,
+    inverseDisplacements, maximumNumberOfIterations, tolerance);
+  vtkSMPTools::For(0, numberOfRows, functor);
+
+  // Compute the inverse using inverseTransform where the fixed-point iteration did not converge.
+  // TransformPointArray reports convergence failures of the inverse from this thread.
+  const std::vector<vtkIdType>& nonConvergedVoxels = functor.NonConvergedVoxels;
+  if (!nonConvergedVoxels.empty())
+    {
+    const double (*m)[4] = ijkToRAS->Element;
+    const vtkIdType rowLength = extent[1] - extent[0] + 1;
+    const vtkIdType numberOfRowsInSlice = extent[3] - extent[2] + 1;
+    vtkIdType numberOfPoints = static_cast<vtkIdType>(nonConvergedVoxels.size());
+    std::vector<double> points_RAS(3 * numberOfPoints);
+    std::vector<double> inversePoints_RAS(3 * numberOfPoints);
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+      {
+      vtkIdType voxelIndex = nonConvergedVoxels[pointIndex];
+      vtkIdType rowIndex = voxelIndex / rowLength;
+      int i = extent[0] + static_cast<int>(voxelIndex % rowLength);
+      int j = extent[2] + static_cast<int>(rowIndex % numberOfRowsInSlice);
+      int k = extent[4] + static_cast<int>(rowIndex / numberOfRowsInSlice);
+      for (int row = 0; row < 3; row++)
+        {
+        points_RAS[3 * pointIndex + row] = m[row][0] * i + m[row][1] * j + m[row][2] * k + m[row][3];
+        }
+      }
+    vtkMRMLTransformNode::TransformPointArray(inverseTransform, &(points_RAS[0]), &(inversePoints_RAS[0]), numberOfPoints);
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+      {
+      float* voxelPtr = inverseDisplacements + 3 * nonConvergedVoxels[pointIndex];
+      for (int row = 0; row < 3; row++)
+        {
+        voxelPtr[row] = static_cast<float>(inversePoints_RAS[3 * pointIndex + row] - points_RAS[3 * pointIndex + row]);
+        }
+      }
+    }
+
+  inverseDisplacementField->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Transform that interpolates a cached displacement field inside its grid and
+// evaluates the exact transform outside of it. The inverse is always the exact inverse.
+// It is used for replacing a transform that would require iterative inversion at each point.
+class vtkMRMLTransformNodeCachedGridTransform : public vtkWarpTransform
+{
+public:
+  static vtkMRMLTransformNodeCachedGridTransform* New();
+  vtkTypeMacro(vtkMRMLTransformNodeCachedGridTransform, vtkWarpTransform);
+
+  void SetTransforms(vtkOrientedGridTransform* gridTransform, vtkAbstractTransform* exactTransform,
+    vtkMatrix4x4* gridIJKToRAS, const int gridExtent[6])
+  {
+    this->GridTransform = gridTransform;
+    this->ExactTransform = exactTransform;
+    this->ExactInverseTransform = (exactTransform ? exactTransform->GetInverse() : NULL);
+    vtkNew<vtkMatrix4x4> rasToGridIJK;
+    vtkMatrix4x4::Invert(gridIJKToRAS, rasToGridIJK.GetPointer());
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->RASToGridIJK[row][col] = rasToGridIJK->GetElement(row, col);
+        }
+      }
+    for (int i = 0; i < 6; i++)
+      {
+      this->GridExtent[i] = gridExtent[i];
+      }
+    this->Modified();
+  }
+
+  vtkAbstractTransform* MakeTransform() VTK_OVERRIDE
+  {
+    return vtkMRMLTransformNodeCachedGridTransform::New();
+  }
+
+  vtkMTimeType GetMTime() VTK_OVERRIDE
+  {
+    vtkMTimeType mtime = this->Superclass::GetMTime();
+    if (this->GridTransform.GetPointer() && this->GridTransform->GetMTime() > mtime)
+      {
+      mtime = this->GridTransform->GetMTime();
+      }
+    if (this->ExactTransform.GetPointer() && this->ExactTransform->GetMTime() > mtime)
+      {
+      mtime = this->ExactTransform->GetMTime();
+      }
+    return mtime;
+  }
+
+protected:
+  vtkMRMLTransformNodeCachedGridTransform()
+  {
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->RASToGridIJK[row][col] = (row == col ? 1.0 : 0.0);
+        }
+      }
+    for (int i = 0; i < 6; i++)
+      {
+      this->GridExtent[i] = (i % 2 == 0 ? 0 : -1);
+      }
+  }
+
+  void InternalUpdate() VTK_OVERRIDE
+  {
+    if (this->GridTransform.GetPointer())
+      {
+      this->GridTransform->Update();
+      }
+    if (this->ExactTransform.GetPointer())
+      {
+      this->ExactTransform->Update();
+      this->ExactInverseTransform->Update();
+      }
+  }
+
+  void InternalDeepCopy(vtkAbstractTransform* transform) VTK_OVERRIDE
+  {
+    vtkMRMLTransformNodeCachedGridTransform* cachedGridTransform = static_cast<vtkMRMLTransformNodeCachedGridTransform*>(transform);
+    this->GridTransform = cachedGridTransform->GridTransform;
+    this->ExactTransform = cachedGridTransform->ExactTransform;
+    this->ExactInverseTransform = cachedGridTransform->ExactInverseTransform;
+    for (int row = 0; row < 4; row++)
+      {
+      for (int col = 0; col < 4; col++)
+        {
+        this->RASToGridIJK[row][col] = cachedGridTransform->RASToGridIJK[row][col];
+        }
+      }
+    for (int i = 0; i < 6; i++)
+      {
+      this->GridExtent[i] = cachedGridTransform->GridExtent[i];
+      }
+    this->Superclass::InternalDeepCopy(transform);
+  }
+
+  bool IsInsideGrid(const double point_RAS[3])
+  {
+    // Tolerance allows points that are computed from the grid geometry with rounding errors
+    // (for example, points of a single-slice grid)
+    const double tolerance = 1e-3;
+    for (int axis = 0; axis < 3; axis++)
+      {
+      double index = this->RASToGridIJK[axis][0] * point_RAS[0] + this->RASToGridIJK[axis][1] * point_RAS[1]
+        + this->RASToGridIJK[axis][2] * point_RAS[2] + this->RASToGridIJK[axis][3];
+      if (index < this->GridExtent[axis * 2] - tolerance || index > this->GridExtent[axis * 2 + 1] + tolerance)
+        {
+        return false;
+        }
+      }
+    return true;
+  }
+
+  void ForwardTransformPoint(const double in[3], double out[3]) VTK_OVERRIDE
+  {
+    if (this->GridTransform.GetPointer() && this->IsInsideGrid(in))
+      {
+      this->GridTransform->InternalTransformPoint(in, out);
+      }
+    else if (this->ExactTransform.GetPointer())
+      {
+      this->ExactTransform->InternalTransformPoint(in, out);
+      }
+    else
+      {
+      out[0] = in[0];
+      out[1] = in[1];
+      out[2] = in[2];
+      }
+  }
+
+  void ForwardTransformDerivative(const double in[3], double out[3], double derivative[3][3]) VTK_OVERRIDE
+  {
+    if (this->GridTransform.GetPointer() && this->IsInsideGrid(in))
+      {
+      this->GridTransform->InternalTransformDerivative(in, out, derivative);
+      }
+    else if (this->ExactTransform.GetPointer())
+      {
+      this->ExactTransform->InternalTransformDerivative(in, out, derivative);
+      }
+    else
+      {
+      out[0] = in[0];
+      out[1] = in[1];
+      out[2] = in[2];
+      vtkMath::Identity3x3(derivative);
+      }
+  }
+
+  void InverseTransformPoint(const double in[3], double out[3]) VTK_OVERRIDE
+  {
+    if (this->ExactInverseTransform.GetPointer())
+      {
+      this->ExactInverseTransform->InternalTransformPoint(in, out);
+      }
+    else
+      {
+      out[0] = in[0];
+      out[1] = in[1];
+      out[2] = in[2];
+      }
+  }
+
+  void InverseTransformDerivative(const double in[3], double out[3], double derivative[3][3]) VTK_OVERRIDE
+  {
+    if (this->ExactInverseTransform.GetPointer())
+      {
+      this->ExactInverseTransform->InternalTransformDerivative(in, out, derivative);
+      }
+    else
+      {
+      out[0] = in[0];
+      out[1] = in[1];
+      out[2] = in[2];
+      vtkMath::Identity3x3(derivative);
+      }
+  }
+
+  // Single-precision versions are computed using the double-precision versions
+  void ForwardTransformPoint(const float in[3], float out[3]) VTK_OVERRIDE
+  {
+    double inDouble[3] = { in[0], in[1], in[2] };
+    double outDouble[3] = { 0.0, 0.0, 0.0 };
+    this->ForwardTransformPoint(inDouble, outDouble);
+    CopyPointToFloat(outDouble, out);
+  }
+
+  void ForwardTransformDerivative(const float in[3], float out[3], float derivative[3][3]) VTK_OVERRIDE
+  {
+    double inDouble[3] = { in[0], in[1], in[2] };
+    double outDouble[3] = { 0.0, 0.0, 0.0 };
+    double derivativeDouble[3][3];
+    this->ForwardTransformDerivative(inDouble, outDouble, derivativeDouble);
+    CopyPointToFloat(outDouble, out);
+    CopyDerivativeToFloat(derivativeDouble, derivative);
+  }
+
+  void InverseTransformPoint(const float in[3], float out[3]) VTK_OVERRIDE
+  {
+    double inDouble[3] = { in[0], in[1], in[2] };
+    double outDouble[3] = { 0.0, 0.0, 0.0 };
+    this->InverseTransformPoint(inDouble, outDouble);
+    CopyPointToFloat(outDouble, out);
+  }
+
+  void InverseTransformDerivative(const float in[3], float out[3], float derivative[3][3]) VTK_OVERRIDE
+  {
+    double inDouble[3] = { in[0], in[1], in[2] };
+    double outDouble[3] = { 0.0, 0.0, 0.0 };
+    double derivativeDouble[3][3];
+    this->InverseTransformDerivative(inDouble, outDouble, derivativeDouble);
+    CopyPointToFloat(outDouble, out);
+    CopyDerivativeToFloat(derivativeDouble, derivative);
+  }
+
+  static void CopyPointToFloat(const double in[3], float out[3])
+  {
+    out[0] = static_cast<float>(in[0]);
+    out[1] = static_cast<float>(in[1]);
+    out[2] = static_cast<float>(in[2]);
+  }
+
+  static void CopyDerivativeToFloat(double in[3][3], float out[3][3])
+  {
+    for (int row = 0; row < 3; row++)
+      {
+      CopyPointToFloat(in[row], out[row]);
+      }
+  }
+
+  vtkSmartPointer<vtkOrientedGridTransform> GridTransform;
+  vtkSmartPointer<vtkAbstractTransform> ExactTransform;
+  vtkSmartPointer<vtkAbstractTransform> ExactInverseTransform;
+  double RASToGridIJK[4][4];
+  int GridExtent[6];
+
+private:
+  vtkMRMLTransformNodeCachedGridTransform(const vtkMRMLTransformNodeCachedGridTransform&);  // Not implemented.
+  void operator=(const vtkMRMLTransformNodeCachedGridTransform&);  // Not implemented.
+};
+
+vtkStandardNewMacro(vtkMRMLTransformNodeCachedGridTransform);
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::GetTransformFromWorldUsingCachedInverse(vtkGeneralTransform* transformFromWorld,
+  vtkMatrix4x4* gridIJKToRAS, const int gridExtent[6])
+{
+  if (transformFromWorld == NULL)
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::GetTransformFromWorldUsingCachedInverse failed: transformFromWorld is invalid");
+    return;
+    }
+  this->GetTransformFromWorld(transformFromWorld);
+  if (gridIJKToRAS == NULL || gridExtent == NULL
+    || gridExtent[0] > gridExtent[1] || gridExtent[2] > gridExtent[3] || gridExtent[4] > gridExtent[5])
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::GetTransformFromWorldUsingCachedInverse failed: invalid grid");
+    return;
+    }
+  if (!IsIterativeInverseRequired(transformFromWorld))
+    {
+    return;
+    }
+  vtkNew<vtkGeneralTransform> transformToWorld;
+  this->GetTransformToWorld(transformToWorld.GetPointer());
+  if (IsIterativeInverseRequired(transformToWorld.GetPointer()))
+    {
+    // both directions require inversion, caching would not make computation faster
+    return;
+    }
+
+  std::vector<vtkObject*> chain;
+  vtkMTimeType chainMTime = 0;
+  this->GetTransformToWorldChain(chain, chainMTime);
+  vtkInternal::DisplacementFieldCacheItem* cacheItem = this->Internal->GetCacheItem(this->Internal->InverseGridCache,
+    vtkInternal::MaximumNumberOfCachedInverseGrids, gridIJKToRAS, gridExtent, false);
+  if (cacheItem->ChainMTime != chainMTime || cacheItem->Chain != chain)
+    {
+    // First request of this grid since the transform has been modified (e.g., the transform is
+    // being edited or the view has changed). Computing the inverse at each grid point would not
+    // be faster than using the exact inverse once, so the inverse is only computed if the grid is
+    // requested again with the same transform.
+    cacheItem->Chain = chain;
+    cacheItem->ChainMTime = chainMTime;
+    cacheItem->DisplacementField = NULL;
+    return;
+    }
+
+  vtkNew<vtkGeneralTransform> exactTransformFromWorld;
+  this->GetTransformFromWorld(exactTransformFromWorld.GetPointer());
+  if (cacheItem->DisplacementField.GetPointer() == NULL)
+    {
+    vtkSmartPointer<vtkImageData> inverseDisplacementField = vtkSmartPointer<vtkImageData>::New();
+    if (!vtkMRMLTransformNode::ComputeInverseDisplacementField(transformToWorld.GetPointer(),
+      exactTransformFromWorld.GetPointer(), gridIJKToRAS, gridExtent, inverseDisplacementField))
+      {
+      return;
+      }
+    cacheItem->DisplacementField = inverseDisplacementField;
+    }
+
+  // The grid may be oblique (e.g., a rotated slice view), therefore the grid direction
+  // is stored in the grid transform
+  vtkNew<vtkMatrix4x4> gridDirection;
+  SetGridGeometry(cacheItem->DisplacementField, gridIJKToRAS, gridDirection.GetPointer());
+  vtkNew<vtkOrientedGridTransform> inverseGridTransform;
+  inverseGridTransform->SetGridDirectionMatrix(gridDirection.GetPointer());
+  inverseGridTransform->SetDisplacementGridData(cacheItem->DisplacementField);
+  inverseGridTransform->SetInterpolationModeToLinear();
+
+  // Away from the grid points the exact transform from world is used
+  vtkNew<vtkMRMLTransformNodeCachedGridTransform> cachedGridTransform;
+  cachedGridTransform->SetTransforms(inverseGridTransform.GetPointer(), exactTransformFromWorld.GetPointer(),
+    gridIJKToRAS, gridExtent);
+
+  transformFromWorld->Identity();
+  transformFromWorld->PostMultiply();
+  transformFromWorld->Concatenate(cachedGridTransform.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::RemoveCachedDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld /* = true */)
+{
+  if (ijkToRAS == NULL || extent == NULL)
+    {
+    vtkErrorMacro("vtkMRMLTransformNode::RemoveCachedDisplacementField failed: invalid geometry");
+    return;
+    }
+  std::vector<vtkInternal::DisplacementFieldCacheItem>& cache = this->Internal->DisplacementFieldCache;
+  for (std::vector<vtkInternal::DisplacementFieldCacheItem>::iterator cacheIt = cache.begin(); cacheIt != cache.end(); ++cacheIt)
+    {
+    if (cacheIt->IsGeometryMatching(ijkToRAS, extent, transformToWorld))
+      {
+      cache.erase(cacheIt);
+      return;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::ClearDisplacementFieldCache()
+{
+  this->Internal->DisplacementFieldCache.clear();
+  this->Internal->InverseGridCache.clear();
+}
+
 //----------------------------------------------------------------------------
 const char* vtkMRMLTransformNode::GetTransformToParentInfo()
 {
@@ -20,6 +20,7 @@
 class vtkCollection;
 class vtkAbstractTransform;
 class vtkGeneralTransform;
+class vtkImageData;
 class vtkMatrix4x4;
 class vtkTransform;
 
@@ -341,6 +342,77 @@ public:
   /// Get the latest modification time of the stored transform
   vtkMTimeType GetTransformToWorldMTime();
 
+  ///
+  /// Transform a contiguous array of points (x0, y0, z0, x1, y1, z1, ...) concurrently.
+  /// Composite transforms are flattened and the concatenated transforms are applied one after
+  /// the other. Grid and b-spline transforms use their batch evaluation API, other transforms
+  /// are evaluated point by point in parallel.
+  /// inPoints and outPoints may point to the same array.
+  static void TransformPointArray(vtkAbstractTransform* transform, const double* inPoints, double* outPoints, vtkIdType numberOfPoints);
+
+  ///
+  /// Get the displacement field of the transform to world (or from world, if transformToWorld is false)
+  /// sampled at the voxel positions of a grid. Grid geometry is specified by ijkToRAS and extent.
+  /// The returned image has 3 float components, each voxel containing the displacement vector in RAS.
+  /// Origin and spacing of the returned image are set from ijkToRAS, but axis directions cannot be stored
+  /// in the image (geometry is defined by ijkToRAS).
+  /// The displacement field is computed using ComputeDisplacementField.
+  /// The displacement field is cached in the node and reused until the transform chain or
+  /// the requested geometry changes. The returned image is owned by the node and must not be modified.
+  /// Returns NULL on failure.
+  vtkImageData* GetCachedDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld = true);
+
+  ///
+  /// Compute the displacement field of the transform to world (or from world, if transformToWorld is false)
+  /// at the voxel positions of a grid, without caching the result.
+  /// Grid geometry is specified by ijkToRAS and extent. Extent of displacementField is set to the grid extent
+  /// and a 3-component float scalar array is allocated. The same image can be used for computing the field
+  /// of consecutive parts of a large grid, to limit memory usage.
+  /// If the transform from world would require iterative inversion at each point then the inverse
+  /// displacement field is computed using ComputeInverseDisplacementField.
+  /// Returns true on success.
+  bool ComputeDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6], vtkImageData* displacementField,
+    bool transformToWorld = true);
+
+  ///
+  /// Compute the displacement field of the inverse of forwardTransform on a grid.
+  /// Inverse is computed for all the grid points at once, in parallel, using fixed-point iteration.
+  /// The inverse found at the neighbor grid point is used as initial guess, therefore usually
+  /// only a few forward transform evaluations are needed at each point.
+  /// At points where the fixed-point iteration does not converge inverseTransform is used
+  /// (typically it computes the inverse point by point, using Newton's method).
+  /// Grid geometry is specified by ijkToRAS and extent, output is a 3-component float image.
+  /// Returns true on success.
+  static bool ComputeInverseDisplacementField(vtkAbstractTransform* forwardTransform, vtkAbstractTransform* inverseTransform,
+    vtkMatrix4x4* ijkToRAS, const int extent[6], vtkImageData* inverseDisplacementField,
+    int maximumNumberOfIterations = 20, double tolerance = 0.001);
+
+  ///
+  /// Get transform from world, optimized for repeated evaluation at the points of a grid
+  /// (typically the pixels of a slice view, specified by gridIJKToRAS and gridExtent).
+  /// If computing the transform from world requires iterative inversion of a non-linear transform
+  /// then the inverse is computed at the grid points (using ComputeInverseDisplacementField) and cached.
+  /// The returned transform uses this inverse at the grid points and the exact transform from world
+  /// everywhere else.
+  /// The inverse is only computed when the same grid is requested again without the transform being
+  /// modified in the meantime. Until then (e.g., while the transform is being edited) the returned
+  /// transform is the same as the one returned by GetTransformFromWorld.
+  /// \sa GetTransformFromWorld, GetCachedDisplacementField
+  void GetTransformFromWorldUsingCachedInverse(vtkGeneralTransform* transformFromWorld,
+    vtkMatrix4x4* gridIJKToRAS, const int gridExtent[6]);
+
+  ///
+  /// Remove the cached displacement field of the specified grid to release memory.
+  /// Displacement fields cached for other grids are kept.
+  /// \sa GetCachedDisplacementField, ClearDisplacementFieldCache
+  void RemoveCachedDisplacementField(vtkMatrix4x4* ijkToRAS, const int extent[6], bool transformToWorld = true);
+
+  ///
+  /// Remove all cached displacement fields to release memory.
+  /// The cache is automatically invalidated when the transform is modified.
+  /// \sa GetCachedDisplacementField
+  void ClearDisplacementFieldCache();
+
   /// Get a human-readable description of the transformation
   /// The returned string is stored in a shared buffer therefore the text has to be copied. This is a
   /// static-style function (the contents of the owner transform node is not used), but the returned
@@ -383,6 +455,23 @@ protected:
   /// GetMatrixTransformToParent and GetMatrixFromParent methods
   vtkMatrix4x4* CachedMatrixTransformToParent;
   vtkMatrix4x4* CachedMatrixTransformFromParent;
+
+  ///
+  /// Get the list of transform nodes (and their transforms to parent) from this node to the world
+  /// and the latest modification time of all the nodes and transforms in the chain.
+  /// Used for detecting if a cached result computed from the transform chain is still valid.
+  void GetTransformToWorldChain(std::vector<vtkObject*>& chain, vtkMTimeType& chainMTime);
+
+  ///
+  /// Recompute the cached flattened transform to world if this node's transform
+  /// or any of the parent transforms changed since the last update.
+  /// If the transform to world is linear then the cache contains the matrix to and from world,
+  /// which is returned by IsTransformToWorldLinear, GetMatrixTransformToWorld, etc. without
+  /// traversing and concatenating the transforms of the whole chain.
+  void UpdateTransformToWorldCache();
+
+  class vtkInternal;
+  vtkInternal* Internal;
 };
 
 #endif
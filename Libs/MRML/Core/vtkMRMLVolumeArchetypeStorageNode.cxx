@@ -37,9 +37,13 @@ Version:   $Revision: 1.6 $
 #include <vtkDataArray.h>
 #include <vtkErrorCode.h>
 #include <vtkImageChangeInformation.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkStringArray.h>
 #include <vtksys/Directory.hxx>
 
@@ -56,6 +60,7 @@ vtkMRMLVolumeArchetypeStorageNode::vtkMRMLVolumeArchetypeStorageNode()
   this->CenterImage = 0;
   this->SingleFile  = 0;
   this->UseOrientationFromFile = 1;
+  this->DeferredRead = false;
   this->DefaultWriteFileExtension = "nrrd";
 }
 
@@ -131,6 +136,7 @@ void vtkMRMLVolumeArchetypeStorageNode::Copy(vtkMRMLNode *anode)
   this->SetCenterImage(node->CenterImage);
   this->SetSingleFile(node->SingleFile);
   this->SetUseOrientationFromFile(node->UseOrientationFromFile);
+  this->SetDeferredRead(node->DeferredRead);
 
   this->EndModify(disabledModify);
 }
@@ -142,6 +148,7 @@ void vtkMRMLVolumeArchetypeStorageNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "CenterImage:   " << this->CenterImage << "\n";
   os << indent << "SingleFile:   " << this->SingleFile << "\n";
   os << indent << "UseOrientationFromFile:   " << this->UseOrientationFromFile << "\n";
+  os << indent << "DeferredRead:   " << (this->DeferredRead ? "true" : "false") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -258,6 +265,149 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
 
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLScalarVolumeNode * volNode = vtkMRMLScalarVolumeNode::SafeDownCast(refNode);
+  if (volNode && volNode->GetImageDataConnection())
+    {
+    // Release the current voxels before reading the new ones
+    volNode->SetAndObserveImageData(NULL);
+    }
+
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  // In deferred mode the reader is executed after this storage node returns
+  // (and it may be deleted by then), so progress is not reported.
+  if (!this->ReadImageFromFile(refNode, reader, !this->DeferredRead))
+    {
+    return 0;
+    }
+  return this->SetReaderOutputToVolumeNode(volNode, reader);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::CanReadDataDetached(vtkMRMLNode *refNode)
+{
+  // Remote files are downloaded by ReadData() and subclasses may read
+  // the data differently.
+  return this->GetURI() == NULL
+    && strcmp(this->GetClassName(), "vtkMRMLVolumeArchetypeStorageNode") == 0
+    && this->CanReadInReferenceNode(refNode);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::ReadDataDetachedInternal(vtkMRMLNode *refNode)
+{
+  // Progress events must not be invoked from worker threads
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  if (!this->ReadImageFromFile(refNode, reader, false))
+    {
+    return 0;
+    }
+  this->DetachedData = reader;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::AttachDetachedDataInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLScalarVolumeNode * volNode = vtkMRMLScalarVolumeNode::SafeDownCast(refNode);
+  vtkITKArchetypeImageSeriesReader* reader =
+    vtkITKArchetypeImageSeriesReader::SafeDownCast(this->DetachedData);
+  if (volNode == NULL || reader == NULL)
+    {
+    return 0;
+    }
+  return this->SetReaderOutputToVolumeNode(volNode, reader);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::CanWriteDataDetached(vtkMRMLNode *refNode)
+{
+  // Remote files are uploaded by WriteData() and subclasses may write
+  // the data differently.
+  vtkMRMLVolumeNode* volNode = vtkMRMLVolumeNode::SafeDownCast(refNode);
+  if (this->GetURI() != NULL
+    || strcmp(this->GetClassName(), "vtkMRMLVolumeArchetypeStorageNode") != 0
+    || volNode == NULL || !this->CanWriteFromReferenceNode(volNode)
+    || volNode->GetImageData() == NULL)
+    {
+    return false;
+    }
+  // Formats that may write multiple files (e.g., detached header, image series)
+  // are written by WriteData(), which updates the list of written files.
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(
+    this->GetFullNameFromFileName());
+  return extension == ".nrrd" || extension == ".nii" || extension == ".nii.gz"
+    || extension == ".mha";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::PrepareWriteDataDetachedInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLVolumeNode* volNode = vtkMRMLVolumeNode::SafeDownCast(refNode);
+  vtkImageData* imageData = volNode ? volNode->GetImageData() : NULL;
+  if (imageData == NULL)
+    {
+    vtkErrorMacro("PrepareWriteDataDetachedInternal: cannot write ImageData, it's NULL");
+    return 0;
+    }
+  vtkSmartPointer<vtkImageData> imageDataCopy = vtkSmartPointer<vtkImageData>::New();
+  imageDataCopy->ShallowCopy(imageData);
+  this->DetachedData = imageDataCopy;
+
+  this->DetachedWriteRASToIJK = vtkSmartPointer<vtkMatrix4x4>::New();
+  volNode->GetRASToIJKMatrix(this->DetachedWriteRASToIJK);
+
+  // The file format helper of the scene is not used from the worker thread
+  this->DetachedWriteImageIOClassName.clear();
+  if (!this->DetachedWriteFileFormat.empty()
+    && this->GetScene()
+    && this->GetScene()->GetDataIOManager()
+    && this->GetScene()->GetDataIOManager()->GetFileFormatHelper())
+    {
+    const char* imageIOClassName = this->GetScene()->GetDataIOManager()->GetFileFormatHelper()->
+      GetClassNameFromFormatString(this->DetachedWriteFileFormat.c_str());
+    this->DetachedWriteImageIOClassName = imageIOClassName ? imageIOClassName : "";
+    }
+
+  // A single file is written, as if the file name was just set
+  this->ResetFileNameList();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::WriteDataDetachedInternal(const std::string& fullName)
+{
+  vtkImageData* imageData = vtkImageData::SafeDownCast(this->DetachedData);
+  if (imageData == NULL || this->DetachedWriteRASToIJK.GetPointer() == NULL)
+    {
+    vtkErrorMacro("WriteDataDetachedInternal: no image to write in " << fullName);
+    return 0;
+    }
+  vtkNew<vtkITKImageWriter> writer;
+  writer->SetFileName(fullName.c_str());
+  writer->SetInputData(imageData);
+  writer->SetUseCompression(this->DetachedWriteUseCompression);
+  if (!this->DetachedWriteImageIOClassName.empty())
+    {
+    writer->SetImageIOClassName(this->DetachedWriteImageIOClassName.c_str());
+    }
+  writer->SetRasToIJKMatrix(this->DetachedWriteRASToIJK);
+
+  int result = 1;
+  try
+    {
+    writer->Write();
+    }
+  catch (...)
+    {
+    result = 0;
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::ReadImageFromFile(vtkMRMLNode *refNode,
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader>& reader, bool reportProgress)
 {
   std::string fullName = this->GetFullNameFromFileName();
   vtkDebugMacro("ReadData: got full archetype name " << fullName);
@@ -291,8 +441,6 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
-
   if (refNode->IsA("vtkMRMLVectorVolumeNode"))
     {
     reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
@@ -316,11 +464,9 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
-  reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
-
-  if (volNode->GetImageData())
+  if (reportProgress)
     {
-    volNode->SetAndObserveImageData(NULL);
+    reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
     }
 
   // Set the list of file names on the reader
@@ -347,7 +493,15 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   try
     {
     vtkDebugMacro("ReadData: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
-    reader->Update();
+    if (this->DeferredRead)
+      {
+      // Only read the image header now
+      reader->UpdateInformation();
+      }
+    else
+      {
+      reader->Update();
+      }
     if (reader->GetErrorCode() != vtkErrorCode::NoError)
       {
       readingWorked = false;
@@ -387,7 +541,11 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
 
   vtkPointData * pointData = reader->GetOutput()->GetPointData();
-  if (volNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+  if (this->DeferredRead)
+    {
+    // Voxels are not read yet, nothing to check
+    }
+  else if (volNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
     {
     if (pointData->GetTensors() == NULL || pointData->GetTensors()->GetNumberOfTuples() == 0)
       {
@@ -412,6 +570,15 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::SetReaderOutputToVolumeNode(
+  vtkMRMLScalarVolumeNode* volNode, vtkITKArchetypeImageSeriesReader* reader)
+{
+  std::string fullName = this->GetFullNameFromFileName();
+
   // Set volume attributes
   vtkMRMLVolumeArchetypeStorageNode::SetMetaDataDictionaryFromReader(volNode, reader);
 
@@ -446,23 +613,43 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   ici->SetInputConnection(reader->GetOutputPort());
   ici->SetOutputSpacing( 1, 1, 1 );
   ici->SetOutputOrigin( 0, 0, 0 );
-  ici->Update();
 
-  if (ici->GetOutput() == NULL)
+  if (this->DeferredRead)
     {
-    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode: Cannot read file: " << fullName);
-    return 0;
+    // The pipeline is kept in the volume node and executed when the image data is first requested.
+    // Reader output is released after it is passed downstream so that voxels are only stored
+    // once and vtkMRMLVolumeNode::ReleaseDeferredImageData can free all of them.
+    reader->ReleaseDataFlagOn();
+    volNode->SetDeferredImageDataConnection(ici->GetOutputPort());
+
+    vtkInformation* outInfo = ici->GetOutputInformation(0);
+    int extent[6] = { 0, -1, 0, -1, 0, -1 };
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    vtkInfoMacro(<<"Deferred loading of volume from file: "<<fullName \
+      <<". Dimensions: "<<extent[1]-extent[0]+1<<"x"<<extent[3]-extent[2]+1<<"x"<<extent[5]-extent[4]+1 \
+      <<". Number of components: "<<vtkImageData::GetNumberOfScalarComponents(outInfo) \
+      <<". Pixel type: "<<vtkImageScalarTypeNameMacro(vtkImageData::GetScalarType(outInfo))<<".");
     }
+  else
+    {
+    ici->Update();
+    if (ici->GetOutput() == NULL)
+      {
+      vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode: Cannot read file: " << fullName);
+      return 0;
+      }
+
+    vtkNew<vtkImageData> iciOutputCopy;
+    iciOutputCopy->ShallowCopy(ici->GetOutput());
+    volNode->SetAndObserveImageData(iciOutputCopy.GetPointer());
 
-  vtkNew<vtkImageData> iciOutputCopy;
-  iciOutputCopy->ShallowCopy(ici->GetOutput());
-  volNode->SetAndObserveImageData(iciOutputCopy.GetPointer());
+    // Log volume size to the application log. It helps to identify potential out-of-memory issues.
+    vtkInfoMacro(<<"Loaded volume from file: "<<fullName \
+      <<". Dimensions: "<<iciOutputCopy->GetDimensions()[0]<<"x"<<iciOutputCopy->GetDimensions()[1]<<"x"<<iciOutputCopy->GetDimensions()[2] \
+      <<". Number of components: "<<iciOutputCopy->GetNumberOfScalarComponents() \
+      <<". Pixel type: "<<vtkImageScalarTypeNameMacro(iciOutputCopy->GetScalarType())<<".");
+    }
 
-  // Log volume size to the application log. It helps to identify potential out-of-memory issues.
-  vtkInfoMacro(<<"Loaded volume from file: "<<fullName \
-    <<". Dimensions: "<<iciOutputCopy->GetDimensions()[0]<<"x"<<iciOutputCopy->GetDimensions()[1]<<"x"<<iciOutputCopy->GetDimensions()[2] \
-    <<". Number of components: "<<iciOutputCopy->GetNumberOfScalarComponents() \
-    <<". Pixel type: "<<vtkImageScalarTypeNameMacro(iciOutputCopy->GetScalarType())<<".");
 
   vtkMatrix4x4* mat = reader->GetRasToIjkMatrix();
   if ( mat == NULL )
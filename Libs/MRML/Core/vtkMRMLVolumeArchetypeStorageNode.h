@@ -19,6 +19,8 @@
 
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
+class vtkMatrix4x4;
+class vtkMRMLScalarVolumeNode;
 class vtkMRMLVolumeNode;
 
 /// \brief MRML node for representing a volume storage.
@@ -73,10 +75,31 @@ public:
   vtkSetMacro(UseOrientationFromFile, int);
   vtkGetMacro(UseOrientationFromFile, int);
 
+  ///
+  /// Defer reading of the voxels. If enabled, only the image header is read
+  /// when the data is read and the voxels are read from file when the image
+  /// data of the volume node is first requested (e.g., it is displayed or
+  /// processed). Voxels can be released by vtkMRMLVolumeNode::ReleaseDeferredImageData
+  /// and they are read again when requested next time.
+  /// The file must remain available while the volume node is in use.
+  /// Disabled by default. The value is not saved in the scene, it can be
+  /// enabled for all volumes by setting it in the scene's default storage node.
+  /// \sa vtkMRMLVolumeNode::SetDeferredImageDataConnection()
+  vtkGetMacro(DeferredRead, bool);
+  vtkSetMacro(DeferredRead, bool);
+  vtkBooleanMacro(DeferredRead, bool);
+
   /// Return true if the reference node is supported by the storage node
   virtual bool CanReadInReferenceNode(vtkMRMLNode* refNode) VTK_OVERRIDE;
   virtual bool CanWriteFromReferenceNode(vtkMRMLNode* refNode) VTK_OVERRIDE;
 
+  /// Return true if the volume file is local
+  virtual bool CanReadDataDetached(vtkMRMLNode* refNode) VTK_OVERRIDE;
+
+  /// Return true if the volume is written into a local file, in a format
+  /// that stores the image in a single file (NRRD, NIFTI, MetaImage).
+  virtual bool CanWriteDataDetached(vtkMRMLNode* refNode) VTK_OVERRIDE;
+
   ///
   /// Configure the storage node for data exchange. This is an
   /// opportunity to optimize the storage node's settings, for
@@ -104,13 +127,44 @@ protected:
   /// Read data and set it in the referenced node
   virtual int ReadDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Read the image into DetachedData (the executed reader)
+  virtual int ReadDataDetachedInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Set the image read in DetachedData in the referenced node
+  virtual int AttachDetachedDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Create a reader for the type of \a refNode and read the image
+  /// (only the header in deferred mode). Neither the scene nor any node is modified.
+  /// If \a reportProgress is true then the reader progress is forwarded as
+  /// progress event of the storage node.
+  /// Returns 1 on success, 0 otherwise.
+  int ReadImageFromFile(vtkMRMLNode *refNode,
+    vtkSmartPointer<vtkITKArchetypeImageSeriesReader>& reader, bool reportProgress);
+
+  /// Set the image, geometry and meta data read by \a reader in the volume node
+  /// and the list of files read in the storage node.
+  /// Returns 1 on success, 0 otherwise.
+  int SetReaderOutputToVolumeNode(vtkMRMLScalarVolumeNode* volNode,
+    vtkITKArchetypeImageSeriesReader* reader);
+
   /// Write data from a referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
 
+  /// Keep a shallow copy of the image in DetachedData, with the image geometry
+  /// and the image IO class of the write file format.
+  virtual int PrepareWriteDataDetachedInternal(vtkMRMLNode *refNode) VTK_OVERRIDE;
+
+  /// Write the image of DetachedData
+  virtual int WriteDataDetachedInternal(const std::string& fullName) VTK_OVERRIDE;
+
   int CenterImage;
   int SingleFile;
   int UseOrientationFromFile;
+  bool DeferredRead;
 
+  /// RAS to IJK matrix and image IO class name kept by PrepareWriteDataDetachedInternal()
+  vtkSmartPointer<vtkMatrix4x4> DetachedWriteRASToIJK;
+  std::string DetachedWriteImageIOClassName;
 };
 
 #endif
@@ -29,10 +29,12 @@ Version:   $Revision: 1.14 $
 #include <vtkImageData.h>
 #include <vtkImageDataGeometryFilter.h>
 #include <vtkImageReslice.h>
+#include <vtkInformation.h>
 #include <vtkMathUtilities.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTransform.h>
 #include <vtkTrivialProducer.h>
 
@@ -66,6 +68,7 @@ vtkMRMLVolumeNode::vtkMRMLVolumeNode()
     }
 
   this->ImageDataConnection = NULL;
+  this->ImageDataDeferred = false;
   this->DataEventForwarder = NULL;
 }
 
@@ -189,7 +192,12 @@ void vtkMRMLVolumeNode::Copy(vtkMRMLNode *anode)
     this->CopyOrientation(node);
     }
 
-  if (node->GetImageData() != NULL)
+  if (node->GetImageDataDeferred())
+    {
+    // Share the deferred pipeline, voxels are not read by copying the node
+    this->SetImageDataConnectionInternal(node->GetImageDataConnection(), true);
+    }
+  else if (node->GetImageData() != NULL)
     {
     // Only copy bulk data if it exists - this handles the case
     // of restoring from SceneViews, where the nodes will not
@@ -247,7 +255,12 @@ void vtkMRMLVolumeNode::PrintSelf(ostream& os, vtkIndent indent)
     }
   os << "\n";
 
-  if (this->GetImageData() != NULL)
+  os << indent << "ImageDataDeferred: " << (this->ImageDataDeferred ? "true" : "false") << "\n";
+  if (this->ImageDataDeferred && !this->IsImageDataLoaded())
+    {
+    os << indent << "ImageData: (not loaded)\n";
+    }
+  else if (this->GetImageData() != NULL)
     {
     os << indent << "ImageData:\n";
     this->GetImageData()->PrintSelf(os, indent.GetNextIndent());
@@ -740,6 +753,17 @@ void vtkMRMLVolumeNode::SetAndObserveImageData(vtkImageData *imageData)
 
 //---------------------------------------------------------------------------
 vtkImageData* vtkMRMLVolumeNode::GetImageData()
+{
+  if (this->ImageDataDeferred && !this->IsImageDataLoaded())
+    {
+    // Voxels are read now, at the first request
+    this->ImageDataConnection->GetProducer()->Update(this->ImageDataConnection->GetIndex());
+    }
+  return this->GetImageDataWithoutUpdate();
+}
+
+//---------------------------------------------------------------------------
+vtkImageData* vtkMRMLVolumeNode::GetImageDataWithoutUpdate()
 {
   vtkAlgorithm* producer = this->ImageDataConnection ?
     this->ImageDataConnection->GetProducer() : 0;
@@ -748,15 +772,70 @@ vtkImageData* vtkMRMLVolumeNode::GetImageData()
       this->ImageDataConnection->GetIndex()) : 0);
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeNode::IsImageDataLoaded()
+{
+  vtkImageData* imageData = this->GetImageDataWithoutUpdate();
+  if (!imageData)
+    {
+    return false;
+    }
+  if (!this->ImageDataDeferred)
+    {
+    return true;
+    }
+  // Update time is only set when the pipeline has generated the data
+  return imageData->GetUpdateTime() > 0 && !imageData->GetDataReleased();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeNode::ReleaseDeferredImageData()
+{
+  if (!this->ImageDataDeferred || !this->IsImageDataLoaded())
+    {
+    return false;
+    }
+  vtkImageData* imageData = this->GetImageDataWithoutUpdate();
+  if (imageData->GetMTime() > imageData->GetUpdateTime())
+    {
+    // Voxels have been modified since they were read, the changes would be lost
+    return false;
+    }
+  imageData->ReleaseData();
+  return true;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeNode
 ::SetImageDataConnection(vtkAlgorithmOutput *newImageDataConnection)
+{
+  this->SetImageDataConnectionInternal(newImageDataConnection, false);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeNode
+::SetDeferredImageDataConnection(vtkAlgorithmOutput *newImageDataConnection)
+{
+  if (newImageDataConnection)
+    {
+    // Only the information is needed now, the data is requested later
+    newImageDataConnection->GetProducer()->UpdateInformation();
+    }
+  this->SetImageDataConnectionInternal(newImageDataConnection, newImageDataConnection != NULL);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeNode
+::SetImageDataConnectionInternal(vtkAlgorithmOutput *newImageDataConnection, bool deferred)
 {
   if (newImageDataConnection == this->ImageDataConnection)
     {
+    this->ImageDataDeferred = (newImageDataConnection != NULL && deferred);
     return;
     }
 
+  this->ImageDataDeferred = deferred;
+
   vtkAlgorithm* oldImageDataAlgorithm = this->ImageDataConnection ?
     this->ImageDataConnection->GetProducer() : 0;
 
@@ -838,6 +917,11 @@ void vtkMRMLVolumeNode::UpdateScene(vtkMRMLScene *scene)
 {
   Superclass::UpdateScene(scene);
 
+  if (this->ImageDataDeferred)
+    {
+    // Keep the deferred pipeline, voxels are read when they are needed
+    return;
+    }
   this->SetAndObserveImageData(this->GetImageData());
 }
 
@@ -917,10 +1001,32 @@ void vtkMRMLVolumeNode::GetBoundsInternal(double bounds[6],
                                           bool useTransform)
 {
   vtkMath::UninitializeBounds(bounds);
-  vtkImageData *volumeImage = this->GetImageData();
-  if (!volumeImage)
+  int dimensions[3] = { 0 };
+  if (this->ImageDataDeferred && !this->IsImageDataLoaded())
     {
-    return;
+    // Get dimensions from the pipeline information to avoid reading the voxels
+    vtkAlgorithm* producer = this->ImageDataConnection->GetProducer();
+    producer->UpdateInformation();
+    vtkInformation* outInfo = producer->GetOutputInformation(this->ImageDataConnection->GetIndex());
+    if (!outInfo || !outInfo->Has(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+      {
+      return;
+      }
+    int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+    for (int i = 0; i < 3; i++)
+      {
+      dimensions[i] = std::max(wholeExtent[2 * i + 1] - wholeExtent[2 * i] + 1, 0);
+      }
+    }
+  else
+    {
+    vtkImageData *volumeImage = this->GetImageData();
+    if (!volumeImage)
+      {
+      return;
+      }
+    volumeImage->GetDimensions(dimensions);
     }
 
   //
@@ -952,8 +1058,6 @@ void vtkMRMLVolumeNode::GetBoundsInternal(double bounds[6],
     transform->Concatenate(rasToSlice);
     }
 
-  int dimensions[3] = { 0 };
-  volumeImage->GetDimensions(dimensions);
   double doubleDimensions[4] = { 0, 0, 0, 1 };
   vtkBoundingBox boundingBox;
   for (int i=0; i<2; i++)
@@ -976,6 +1080,13 @@ void vtkMRMLVolumeNode::GetBoundsInternal(double bounds[6],
 //---------------------------------------------------------------------------
 bool vtkMRMLVolumeNode::GetModifiedSinceRead()
 {
+  if (this->ImageDataDeferred)
+    {
+    // Voxels that have not been loaded cannot be modified
+    return this->Superclass::GetModifiedSinceRead() ||
+      (this->IsImageDataLoaded() &&
+       this->GetImageDataWithoutUpdate()->GetMTime() > this->GetImageDataWithoutUpdate()->GetUpdateTime());
+    }
   return this->Superclass::GetModifiedSinceRead() ||
     (this->GetImageData() && this->GetImageData()->GetMTime() > this->GetStoredTime());
 }
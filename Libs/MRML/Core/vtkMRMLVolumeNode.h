@@ -179,6 +179,28 @@ public:
   /// Return the input image data pipeline.
   vtkGetObjectMacro(ImageDataConnection, vtkAlgorithmOutput);
 
+  /// Set and observe an image data pipeline that is only executed when the
+  /// image data is requested (e.g., by GetImageData() or by a display pipeline).
+  /// Information (extent, scalar type, number of components) must be available
+  /// without executing the pipeline. This is used by storage nodes to defer
+  /// reading of the voxels until they are first needed.
+  /// \sa GetImageDataDeferred(), ReleaseDeferredImageData()
+  void SetDeferredImageDataConnection(vtkAlgorithmOutput *inputPort);
+  /// Return true if the image data is provided by a deferred pipeline.
+  /// \sa SetDeferredImageDataConnection()
+  vtkGetMacro(ImageDataDeferred, bool);
+  /// Return true if the voxels are available in memory.
+  /// Always true for image data that is not deferred and not NULL.
+  bool IsImageDataLoaded();
+  /// Free the voxels of a deferred image data (e.g., to reduce memory usage).
+  /// The voxels are read again when the image data is requested next time.
+  /// Image data that has been modified since it was read is not released.
+  /// Note that image data pointers that were previously retrieved by GetImageData()
+  /// remain valid but the object becomes empty.
+  /// Returns true if the voxels were released.
+  /// \sa SetDeferredImageDataConnection()
+  bool ReleaseDeferredImageData();
+
   ///
   /// Make sure image data of a volume node has extents that start at zero.
   /// This needs to be done for compatibility reasons, as many components assume the extent has a form of
@@ -245,6 +267,13 @@ protected:
   /// the useTransform parameter and the rasToSlice transform
   virtual void GetBoundsInternal(double bounds[6], vtkMatrix4x4* rasToSlice, bool useTransform);
 
+  /// Set image data connection and deferred flag. The flag is set before
+  /// any event is invoked so that observers can tell whether the voxels are loaded.
+  void SetImageDataConnectionInternal(vtkAlgorithmOutput *inputPort, bool deferred);
+
+  /// Return the output of the image data pipeline without updating it.
+  vtkImageData* GetImageDataWithoutUpdate();
+
   /// these are unit length direction cosines
   double IJKToRASDirections[3][3];
 
@@ -253,6 +282,7 @@ protected:
   double Origin[3];
 
   vtkAlgorithmOutput* ImageDataConnection;
+  bool ImageDataDeferred;
   vtkEventForwarderCommand* DataEventForwarder;
 
   itk::MetaDataDictionary Dictionary;
@@ -519,7 +519,19 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       {
       vtkNew<vtkGeneralTransform> worldTransform;
       worldTransform->Identity();
-      transformNode->GetTransformFromWorld(worldTransform.GetPointer());
+      if (this->SliceNode)
+        {
+        // If the transform from world has to be computed by inverting a non-linear transform
+        // then get a transform that reuses the inverse computed at the slice pixels, as inverting
+        // the transform at each resliced pixel would be very slow.
+        int sliceExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
+        transformNode->GetTransformFromWorldUsingCachedInverse(worldTransform.GetPointer(),
+          this->SliceNode->GetXYToRAS(), sliceExtent);
+        }
+      else
+        {
+        transformNode->GetTransformFromWorld(worldTransform.GetPointer());
+        }
       //worldTransform->Inverse();
 
       this->XYToIJKTransform->Concatenate(worldTransform.GetPointer());
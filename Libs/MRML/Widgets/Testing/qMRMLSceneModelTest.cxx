@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QApplication>
+#include <QSignalSpy>
 #include <QTimer>
 
 // CTK includes
@@ -33,6 +34,7 @@
 
 // VTK includes
 #include <vtkNew.h>
+#include <vtkSmartPointer.h>
 
 // ----------------------------------------------------------------------------
 class qMRMLSceneModelTester: public QObject
@@ -47,6 +49,8 @@ private slots:
   void testSetColumns_data();
   void testSetColumnsWithScene();
   void testSetColumnsWithScene_data();
+  void testLazyUpdateBatchProcess();
+  void testDeferNodeModifiedUpdate();
 };
 
 // ----------------------------------------------------------------------------
@@ -55,6 +59,7 @@ void qMRMLSceneModelTester::testDefaults()
   qMRMLSceneModel sceneModel;
   QCOMPARE(sceneModel.listenNodeModifiedEvent(), qMRMLSceneModel::OnlyVisibleNodes);
   QCOMPARE(sceneModel.lazyUpdate(), false);
+  QCOMPARE(sceneModel.deferNodeModifiedUpdate(), false);
   QCOMPARE(sceneModel.nameColumn(), 0);
   QCOMPARE(sceneModel.idColumn(), -1);
   QCOMPARE(sceneModel.checkableColumn(), -1);
@@ -192,6 +197,109 @@ void qMRMLSceneModelTester::testSetColumnsWithScene_data()
   this->testSetColumns_data();
 }
 
+// ----------------------------------------------------------------------------
+void qMRMLSceneModelTester::testLazyUpdateBatchProcess()
+{
+  qMRMLSceneModel sceneModel;
+  sceneModel.setLazyUpdate(true);
+  sceneModel.setListenNodeModifiedEvent(qMRMLSceneModel::AllNodes);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLViewNode> viewNode1;
+  scene->AddNode(viewNode1.GetPointer());
+  vtkNew<vtkMRMLViewNode> viewNode2;
+  scene->AddNode(viewNode2.GetPointer());
+  vtkNew<vtkMRMLViewNode> viewNode3;
+  scene->AddNode(viewNode3.GetPointer());
+  sceneModel.setMRMLScene(scene.GetPointer());
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 3);
+
+  // Added and modified nodes are updated without repopulating the model
+  QSignalSpy rowsRemovedSpy(&sceneModel, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+  QSignalSpy rowsInsertedSpy(&sceneModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  vtkNew<vtkMRMLViewNode> addedNode;
+  scene->AddNode(addedNode.GetPointer());
+  viewNode1->SetName("Renamed");
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 3);
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 4);
+  QCOMPARE(rowsRemovedSpy.count(), 0);
+  QCOMPARE(rowsInsertedSpy.count(), 1);
+  QCOMPARE(sceneModel.indexFromNode(addedNode.GetPointer()).row(), 3);
+  QCOMPARE(sceneModel.indexFromNode(viewNode1.GetPointer()).data().toString(), QString("Renamed"));
+
+  // Removed nodes are synchronized as well
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  scene->RemoveNode(viewNode2.GetPointer());
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 3);
+  QVERIFY(!sceneModel.indexFromNode(viewNode2.GetPointer()).isValid());
+  QCOMPARE(sceneModel.indexFromNode(addedNode.GetPointer()).row(), 2);
+
+  // The model is repopulated if many nodes are added
+  QList<vtkSmartPointer<vtkMRMLViewNode> > manyAddedNodes;
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (int i = 0; i < 100; ++i)
+    {
+    manyAddedNodes << vtkSmartPointer<vtkMRMLViewNode>::New();
+    scene->AddNode(manyAddedNodes.last());
+    }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 103);
+  QCOMPARE(sceneModel.indexFromNode(addedNode.GetPointer()).row(), 2);
+  QCOMPARE(sceneModel.indexFromNode(manyAddedNodes.last()).row(), 102);
+}
+
+// ----------------------------------------------------------------------------
+void qMRMLSceneModelTester::testDeferNodeModifiedUpdate()
+{
+  // Node items are updated once per event loop iteration by default
+  QCOMPARE(qMRMLSceneModel::defaultDeferNodeModifiedUpdate(), true);
+  qMRMLSceneModel sceneModel;
+  QCOMPARE(sceneModel.deferNodeModifiedUpdate(), true);
+
+  // Immediate mode can be set for the models created afterward
+  qMRMLSceneModel::setDefaultDeferNodeModifiedUpdate(false);
+  qMRMLSceneModel immediateSceneModel;
+  qMRMLSceneModel::setDefaultDeferNodeModifiedUpdate(true);
+  QCOMPARE(immediateSceneModel.deferNodeModifiedUpdate(), false);
+  sceneModel.setListenNodeModifiedEvent(qMRMLSceneModel::AllNodes);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLViewNode> viewNode1;
+  viewNode1->SetName("View1");
+  scene->AddNode(viewNode1.GetPointer());
+  vtkNew<vtkMRMLViewNode> viewNode2;
+  viewNode2->SetName("View2");
+  scene->AddNode(viewNode2.GetPointer());
+  sceneModel.setMRMLScene(scene.GetPointer());
+
+  // Node items are updated once control returns to the event loop
+  viewNode1->SetName("Renamed1");
+  viewNode1->SetName("Renamed2");
+  viewNode2->SetName("Renamed3");
+  QCOMPARE(sceneModel.indexFromNode(viewNode1.GetPointer()).data().toString(), QString("View1"));
+  QCOMPARE(sceneModel.indexFromNode(viewNode2.GetPointer()).data().toString(), QString("View2"));
+  QCoreApplication::processEvents();
+  QCOMPARE(sceneModel.indexFromNode(viewNode1.GetPointer()).data().toString(), QString("Renamed2"));
+  QCOMPARE(sceneModel.indexFromNode(viewNode2.GetPointer()).data().toString(), QString("Renamed3"));
+
+  // Removed nodes are not updated
+  viewNode1->SetName("Removed");
+  scene->RemoveNode(viewNode1.GetPointer());
+  QCoreApplication::processEvents();
+  QCOMPARE(sceneModel.mrmlSceneItem()->rowCount(), 1);
+
+  // Pending updates are applied when switching to immediate mode
+  viewNode2->SetName("Renamed4");
+  sceneModel.setDeferNodeModifiedUpdate(false);
+  QCOMPARE(sceneModel.indexFromNode(viewNode2.GetPointer()).data().toString(), QString("Renamed4"));
+  viewNode2->SetName("Renamed5");
+  QCOMPARE(sceneModel.indexFromNode(viewNode2.GetPointer()).data().toString(), QString("Renamed5"));
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(qMRMLSceneModelTest)
 #include "moc_qMRMLSceneModelTest.cxx"
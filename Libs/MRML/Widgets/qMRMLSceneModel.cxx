@@ -37,6 +37,15 @@
 
 // STD includes
 
+//------------------------------------------------------------------------------
+bool qMRMLSceneModelPrivate::DefaultDeferNodeModifiedUpdate = true;
+
+//------------------------------------------------------------------------------
+// Inserting a node requires a scene traversal to find its row (see nodeIndex()),
+// at the end of a batch processing the model is repopulated (one traversal)
+// if more nodes have been added.
+static const int MaximumNumberOfNodesToInsert = 16;
+
 //------------------------------------------------------------------------------
 qMRMLSceneModelPrivate::qMRMLSceneModelPrivate(qMRMLSceneModel& object)
   : q_ptr(&object)
@@ -47,6 +56,8 @@ qMRMLSceneModelPrivate::qMRMLSceneModelPrivate(qMRMLSceneModel& object)
   this->LazyUpdate = false;
   this->ListenNodeModifiedEvent = qMRMLSceneModel::NoNodes;
   this->PendingItemModified = -1; // -1 means not updating
+  this->PendingFullUpdate = false;
+  this->DeferNodeModifiedUpdate = qMRMLSceneModelPrivate::DefaultDeferNodeModifiedUpdate;
 
   this->NameColumn = -1;
   this->IDColumn = -1;
@@ -648,6 +659,40 @@ bool qMRMLSceneModel::lazyUpdate()const
   return d->LazyUpdate;
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::setDeferNodeModifiedUpdate(bool defer)
+{
+  Q_D(qMRMLSceneModel);
+  if (d->DeferNodeModifiedUpdate == defer)
+    {
+    return;
+    }
+  d->DeferNodeModifiedUpdate = defer;
+  if (!defer)
+    {
+    this->updateDeferredNodeItems();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::deferNodeModifiedUpdate()const
+{
+  Q_D(const qMRMLSceneModel);
+  return d->DeferNodeModifiedUpdate;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::setDefaultDeferNodeModifiedUpdate(bool defer)
+{
+  qMRMLSceneModelPrivate::DefaultDeferNodeModifiedUpdate = defer;
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::defaultDeferNodeModifiedUpdate()
+{
+  return qMRMLSceneModelPrivate::DefaultDeferNodeModifiedUpdate;
+}
+
 //------------------------------------------------------------------------------
 QMimeData* qMRMLSceneModel::mimeData(const QModelIndexList& indexes)const
 {
@@ -699,6 +744,9 @@ void qMRMLSceneModel::updateScene()
                  this, SLOT(onMRMLNodeIDChanged(vtkObject*,void*)));
 
   d->RowCache.clear();
+  d->clearPendingChanges();
+  d->DeferredModifiedNodes.clear();
+  d->DeferredModifiedNodeSet.clear();
 
   // Enabled so it can be interacted with
   this->invisibleRootItem()->setFlags(Qt::ItemIsEnabled);
@@ -781,10 +829,18 @@ void qMRMLSceneModel::populateScene()
     }
   foreach(vtkMRMLNode* misplacedNode, d->MisplacedNodes)
     {
-    this->onMRMLNodeModified(misplacedNode);
+    this->updateNodeItems(misplacedNode, QString(misplacedNode->GetID()));
     }
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneModelPrivate::clearPendingChanges()
+{
+  this->PendingAddedNodes.clear();
+  this->PendingModifiedNodes.clear();
+  this->PendingFullUpdate = false;
+}
+
 //------------------------------------------------------------------------------
 QStandardItem* qMRMLSceneModel::insertNode(vtkMRMLNode* node)
 {
@@ -1221,6 +1277,7 @@ void qMRMLSceneModel::onMRMLSceneNodeAdded(vtkMRMLScene* scene, vtkMRMLNode* nod
 
   if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
     {
+    d->PendingAddedNodes << node;
     return;
     }
   this->insertNode(node);
@@ -1234,8 +1291,17 @@ void qMRMLSceneModel::onMRMLSceneNodeAboutToBeRemoved(vtkMRMLScene* scene, vtkMR
   Q_UNUSED(scene);
   Q_ASSERT(scene == d->MRMLScene);
 
+  // The node pointer must not be used by a deferred update
+  if (d->DeferredModifiedNodeSet.remove(node))
+    {
+    d->DeferredModifiedNodes.removeOne(node);
+    }
+
   if (d->MRMLScene->IsClosing() || (d->LazyUpdate && d->MRMLScene->IsBatchProcessing()))
     {
+    // The node pointer may become invalid before the end of the batch
+    // processing, so the model is fully updated then.
+    d->PendingFullUpdate = true;
     return;
     }
 
@@ -1370,10 +1436,41 @@ void qMRMLSceneModel::updateNodeItems()
 //------------------------------------------------------------------------------
 void qMRMLSceneModel::onMRMLNodeModified(vtkObject* node)
 {
+  Q_D(qMRMLSceneModel);
   vtkMRMLNode* modifiedNode = vtkMRMLNode::SafeDownCast(node);
+  // During batch processing in lazy update mode, modified nodes are already
+  // collected and updated at the end of the batch processing.
+  if (d->DeferNodeModifiedUpdate
+      && !(d->LazyUpdate && d->MRMLScene && d->MRMLScene->IsBatchProcessing()))
+    {
+    if (d->DeferredModifiedNodeSet.contains(modifiedNode))
+      {
+      return;
+      }
+    if (d->DeferredModifiedNodes.isEmpty())
+      {
+      QTimer::singleShot(0, this, SLOT(updateDeferredNodeItems()));
+      }
+    d->DeferredModifiedNodes << modifiedNode;
+    d->DeferredModifiedNodeSet.insert(modifiedNode);
+    return;
+    }
   this->updateNodeItems(modifiedNode, QString(modifiedNode->GetID()));
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::updateDeferredNodeItems()
+{
+  Q_D(qMRMLSceneModel);
+  QList<vtkMRMLNode*> modifiedNodes = d->DeferredModifiedNodes;
+  d->DeferredModifiedNodes.clear();
+  d->DeferredModifiedNodeSet.clear();
+  foreach(vtkMRMLNode* modifiedNode, modifiedNodes)
+    {
+    this->updateNodeItems(modifiedNode, QString(modifiedNode->GetID()));
+    }
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSceneModel::onMRMLNodeIDChanged(vtkObject* node, void* callData)
 {
@@ -1386,8 +1483,20 @@ void qMRMLSceneModel::updateNodeItems(vtkMRMLNode* node, const QString& nodeUID)
 {
   Q_D(qMRMLSceneModel);
 
-  if (d->MRMLScene->IsClosing() || (d->LazyUpdate && d->MRMLScene->IsBatchProcessing()))
+  if (d->MRMLScene->IsClosing())
+    {
+    return;
+    }
+  if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
     {
+    if (node && nodeUID == QString(node->GetID()))
+      {
+      d->PendingModifiedNodes.insert(node);
+      }
+    else
+      {
+      d->PendingFullUpdate = true;
+      }
     return;
     }
 
@@ -1545,11 +1654,38 @@ void qMRMLSceneModel::onMRMLSceneEndBatchProcess(vtkMRMLScene* scene)
 {
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
-  if (d->LazyUpdate)
+  if (!d->LazyUpdate)
+    {
+    return;
+    }
+  // Inserting a node requires a scene traversal to find its index, so
+  // repopulating is faster if more than a few nodes have been added.
+  if (d->PendingFullUpdate || !this->mrmlSceneItem()
+      || d->PendingAddedNodes.count() > MaximumNumberOfNodesToInsert)
     {
     this->updateScene();
-    emit sceneUpdated();
     }
+  else
+    {
+    QList<vtkMRMLNode*> addedNodes = d->PendingAddedNodes;
+    QSet<vtkMRMLNode*> modifiedNodes = d->PendingModifiedNodes;
+    d->clearPendingChanges();
+    d->MisplacedNodes.clear();
+    foreach(vtkMRMLNode* addedNode, addedNodes)
+      {
+      this->insertNode(addedNode);
+      modifiedNodes.remove(addedNode);
+      }
+    foreach(vtkMRMLNode* misplacedNode, d->MisplacedNodes)
+      {
+      this->updateNodeItems(misplacedNode, QString(misplacedNode->GetID()));
+      }
+    foreach(vtkMRMLNode* modifiedNode, modifiedNodes)
+      {
+      this->updateNodeItems(modifiedNode, QString(modifiedNode->GetID()));
+      }
+    }
+  emit sceneUpdated();
 }
 
 //------------------------------------------------------------------------------
@@ -72,8 +72,30 @@ class QMRML_WIDGETS_EXPORT qMRMLSceneModel : public QStandardItemModel
   /// If LazyUpdate is true, the model ignores added node events when the
   /// scene is importing/restoring, but synchronize with the scene once its
   /// imported/restored.
+  /// At the end of a batch processing, only the nodes added or modified in
+  /// the meantime are updated (with fine-grained row insertions), the model is
+  /// repopulated only if nodes were removed or more than a few nodes were
+  /// added (finding the row of an added node requires a scene traversal).
+  /// \todo Replace the QStandardItemModel base by a virtual model that reads
+  /// the scene on demand and can be shared between widgets.
   Q_PROPERTY (bool lazyUpdate READ lazyUpdate WRITE setLazyUpdate)
 
+  /// Control whether the node items are updated as soon as a node is modified
+  /// or once per event loop iteration.
+  /// If true, the nodes modified (possibly many times) while control is not
+  /// returned to the event loop are collected and their items updated once,
+  /// later. It prevents views and proxy models from being refreshed for each
+  /// node modification when a script modifies many nodes.
+  /// If false, items are updated immediately (e.g. for code that reads the
+  /// model data right after modifying a node without processing events).
+  /// Added and removed nodes are always processed immediately: widgets select
+  /// nodes right after adding them (e.g. qMRMLNodeComboBox::addNode()) and
+  /// the item of a removed node must not outlive the node. In lazy update
+  /// mode, additions are already batched during scene batch processing.
+  /// Value of defaultDeferNodeModifiedUpdate() (true) by default.
+  /// \sa setDefaultDeferNodeModifiedUpdate()
+  Q_PROPERTY (bool deferNodeModifiedUpdate READ deferNodeModifiedUpdate WRITE setDeferNodeModifiedUpdate)
+
   /// Control in which column vtkMRMLNode names are displayed (Qt::DisplayRole).
   /// A value of -1 hides it. First column (0) by default.
   /// If no property is set in a column, nothing is displayed.
@@ -151,6 +173,17 @@ public:
   bool lazyUpdate()const;
   void setLazyUpdate(bool lazy);
 
+  bool deferNodeModifiedUpdate()const;
+  void setDeferNodeModifiedUpdate(bool defer);
+
+  /// Value of deferNodeModifiedUpdate for the scene models created afterward.
+  /// It allows to switch all the node selectors of an application at once.
+  /// True by default. Slicer sets it from the "Developer/DeferNodeModifiedUpdate"
+  /// application setting before module widgets are created.
+  /// \sa deferNodeModifiedUpdate
+  static bool defaultDeferNodeModifiedUpdate();
+  static void setDefaultDeferNodeModifiedUpdate(bool defer);
+
   int nameColumn()const;
   void setNameColumn(int column);
 
@@ -237,6 +270,9 @@ protected slots:
   /// The node has its ID changed. The scene model needs to update the UIDRole
   /// associated with the node in order to keep being in sync.
   void onMRMLNodeIDChanged(vtkObject* node, void* callData);
+  /// Update the items of the nodes modified since the last call.
+  /// \sa deferNodeModifiedUpdate
+  void updateDeferredNodeItems();
   virtual void onItemChanged(QStandardItem * item);
   virtual void delayedItemChanged();
 
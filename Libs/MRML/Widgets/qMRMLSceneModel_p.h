@@ -36,6 +36,7 @@
 class QStandardItemModel;
 #include <QFlags>
 #include <QMap>
+#include <QSet>
 
 // qMRML includes
 #include "qMRMLSceneModel.h"
@@ -77,11 +78,29 @@ public:
   /// qMRMLSceneModel::nodeIndex(vtkMRMLNode*).
   QStandardItem* insertNode(vtkMRMLNode* node, int index);
 
+  /// Forget about the scene changes that were ignored during batch processing
+  /// in lazy update mode.
+  void clearPendingChanges();
+
   vtkSmartPointer<vtkCallbackCommand> CallBack;
   qMRMLSceneModel::NodeTypes ListenNodeModifiedEvent;
   bool LazyUpdate;
   int PendingItemModified;
 
+  // Scene changes ignored during batch processing in lazy update mode. At the
+  // end of the batch processing, the added and modified nodes are updated
+  // incrementally instead of repopulating the whole model, unless a change
+  // can't be applied incrementally (e.g. node removal or ID change).
+  QList<vtkMRMLNode*> PendingAddedNodes;
+  QSet<vtkMRMLNode*> PendingModifiedNodes;
+  bool PendingFullUpdate;
+
+  // Nodes modified since the last deferred update (in modification order).
+  bool DeferNodeModifiedUpdate;
+  QList<vtkMRMLNode*> DeferredModifiedNodes;
+  QSet<vtkMRMLNode*> DeferredModifiedNodeSet;
+  static bool DefaultDeferNodeModifiedUpdate;
+
   int NameColumn;
   int IDColumn;
   int CheckableColumn;
@@ -13,6 +13,8 @@
 #include "vtkMath.h"
 #include "vtkMatrix4x4.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 #include <math.h>
 
@@ -230,16 +232,37 @@ void vtkOrientedBSplineTransform::ForwardTransformDerivative(const double inPoin
   outPoint[2] += displacement[2]*scale;
 }
 
+//----------------------------------------------------------------------------
+void vtkOrientedBSplineTransform::InverseTransformDerivative(const double inPointTemp[3],
+                                                     double outPoint[3],
+                                                     double derivative[3][3])
+{
+  // inPointTemp and outPoint may be the same vector, so make a copy of the
+  // input for the warning message
+  double inPoint[3] = {inPointTemp[0],inPointTemp[1],inPointTemp[2]};
+  double error = 0.0;
+  if (!this->InternalInverseTransformDerivative(inPoint, outPoint, derivative, error))
+    {
+    vtkWarningMacro("InverseTransformPoint: no convergence (" <<
+                    inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
+                    ") error = " << error << " after " <<
+                    this->InverseIterations << " iterations.");
+    }
+}
+
 //----------------------------------------------------------------------------
 // We use Newton's method to iteratively invert the transformation.
 // This is actally quite robust as long as the Jacobian matrix is never
 // singular.
 // Note that this is similar to vtkWarpTransform::InverseTransformPoint()
 // but has been optimized specifically for uniform grid transforms.
-void vtkOrientedBSplineTransform::InverseTransformDerivative(const double inPointTemp[3],
+bool vtkOrientedBSplineTransform::InternalInverseTransformDerivative(const double inPointTemp[3],
                                                      double outPoint[3],
-                                                     double derivative[3][3])
+                                                     double derivative[3][3],
+                                                     double& error)
 {
+  error = 0.0;
+
   // inPointTemp and outPoint may be the same vector, so make a copy of the
   // input before modifying the output
   double inPoint[3] = {inPointTemp[0],inPointTemp[1],inPointTemp[2]};
@@ -260,7 +283,7 @@ void vtkOrientedBSplineTransform::InverseTransformDerivative(const double inPoin
 
   if (!this->GridPointer || !this->CalculateSpline)
     {
-    return;
+    return true;
     }
 
   void *gridPtr = this->GridPointer;
@@ -418,17 +441,14 @@ void vtkOrientedBSplineTransform::InverseTransformDerivative(const double inPoin
     inverse[2] = lastInverse[2] - f*deltaI[2];
     }
 
-  if (iteration >= maxNumberOfIterations)
+  bool converged = (iteration < maxNumberOfIterations);
+  if (!converged)
     {
     // didn't converge: back up to last good result
     inverse[0] = lastInverse[0];
     inverse[1] = lastInverse[1];
     inverse[2] = lastInverse[2];
-
-    vtkWarningMacro("InverseTransformPoint: no convergence (" <<
-                    inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
-                    ") error = " << sqrt(errorSquared) << " after " <<
-                    iteration << " iterations.");
+    error = sqrt(errorSquared);
     }
 
   // Convert the inPoint to i,j,k indices into the deformation grid
@@ -436,6 +456,8 @@ void vtkOrientedBSplineTransform::InverseTransformDerivative(const double inPoin
   outPoint[0] = inverse[0];
   outPoint[1] = inverse[1];
   outPoint[2] = inverse[2];
+
+  return converged;
 }
 
 //----------------------------------------------------------------------------
@@ -492,3 +514,83 @@ vtkAbstractTransform *vtkOrientedBSplineTransform::MakeTransform()
 {
   return vtkOrientedBSplineTransform::New();
 }
+
+//----------------------------------------------------------------------------
+// Evaluates the transform on a range of points of a contiguous point array.
+// Used by vtkSMPTools, therefore it must not modify the transform.
+// Convergence failures of the inverse are counted per thread and reported
+// once, in Reduce(), which is called from the calling thread.
+class vtkOrientedBSplineTransformPointArrayFunctor
+{
+public:
+  vtkOrientedBSplineTransformPointArrayFunctor(vtkOrientedBSplineTransform* transform, const double* inPoints, double* outPoints)
+    : Transform(transform), InPoints(inPoints), OutPoints(outPoints)
+  {
+  }
+
+  void Initialize()
+  {
+    this->NumberOfNonConvergedPoints.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType& numberOfNonConvergedPoints = this->NumberOfNonConvergedPoints.Local();
+    bool inverse = (this->Transform->GetInverseFlag() != 0);
+    double derivative[3][3];
+    double error = 0.0;
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+      {
+      // ForwardTransformPoint and InverseTransformPoint make a copy of the input point,
+      // therefore input and output arrays may be the same
+      const double* inPointPtr = this->InPoints + 3 * pointIndex;
+      double* outPointPtr = this->OutPoints + 3 * pointIndex;
+      if (inverse)
+        {
+        if (!this->Transform->InternalInverseTransformDerivative(inPointPtr, outPointPtr, derivative, error))
+          {
+          ++numberOfNonConvergedPoints;
+          }
+        }
+      else
+        {
+        this->Transform->vtkOrientedBSplineTransform::ForwardTransformPoint(inPointPtr, outPointPtr);
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    vtkIdType numberOfNonConvergedPoints = 0;
+    for (vtkSMPThreadLocal<vtkIdType>::iterator it = this->NumberOfNonConvergedPoints.begin();
+      it != this->NumberOfNonConvergedPoints.end(); ++it)
+      {
+      numberOfNonConvergedPoints += *it;
+      }
+    if (numberOfNonConvergedPoints > 0)
+      {
+      vtkWarningWithObjectMacro(this->Transform, "TransformPointArray: no convergence of inverse for "
+        << numberOfNonConvergedPoints << " points after " << this->Transform->InverseIterations << " iterations.");
+      }
+  }
+
+private:
+  vtkOrientedBSplineTransform* Transform;
+  const double* InPoints;
+  double* OutPoints;
+  vtkSMPThreadLocal<vtkIdType> NumberOfNonConvergedPoints;
+};
+
+//----------------------------------------------------------------------------
+void vtkOrientedBSplineTransform::TransformPointArray(const double* inPoints, double* outPoints, vtkIdType numberOfPoints)
+{
+  if (inPoints == NULL || outPoints == NULL || numberOfPoints <= 0)
+    {
+    return;
+    }
+  // Update the transform once, before the parallel evaluation starts,
+  // so that worker threads only read the cached spline parameters.
+  this->Update();
+  vtkOrientedBSplineTransformPointArrayFunctor functor(this, inPoints, outPoints);
+  vtkSMPTools::For(0, numberOfPoints, functor);
+}
@@ -56,6 +56,13 @@ public:
   virtual void SetBulkTransformMatrix(vtkMatrix4x4*);
   vtkGetObjectMacro(BulkTransformMatrix,vtkMatrix4x4);
 
+  // Description:
+  // Transform a contiguous array of points (x0, y0, z0, x1, y1, z1, ...).
+  // Points are processed concurrently, using all available threads.
+  // The transform is updated only once, before processing starts.
+  // inPoints and outPoints may point to the same array.
+  void TransformPointArray(const double* inPoints, double* outPoints, vtkIdType numberOfPoints);
+
 protected:
   vtkOrientedBSplineTransform();
   ~vtkOrientedBSplineTransform();
@@ -81,6 +88,14 @@ protected:
                                   double derivative[3][3]) VTK_OVERRIDE;
   using Superclass::InverseTransformDerivative; // Inherit the float version from parent
 
+  // Description:
+  // Compute the inverse without reporting convergence failures.
+  // Returns false if the iteration did not converge, in this case error
+  // is set to the remaining error. It does not modify the transform,
+  // therefore it can be called concurrently from multiple threads.
+  bool InternalInverseTransformDerivative(const double in[3], double out[3],
+                                          double derivative[3][3], double& error);
+
   // Description:
   // Grid axis direction vectors (i, j, k) in the output space
   vtkMatrix4x4* GridDirectionMatrix;
@@ -93,6 +108,8 @@ protected:
   vtkMatrix4x4* OutputToGridIndexTransformMatrixCached;
   vtkMatrix4x4* InverseBulkTransformMatrixCached;
 
+  friend class vtkOrientedBSplineTransformPointArrayFunctor;
+
 private:
   vtkOrientedBSplineTransform(const vtkOrientedBSplineTransform&);  // Not implemented.
   void operator=(const vtkOrientedBSplineTransform&);  // Not implemented.
@@ -13,6 +13,8 @@
 #include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 
 vtkStandardNewMacro(vtkOrientedGridTransform);
 
@@ -179,11 +181,40 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
                                                   double outPoint[3],
                                                   double derivative[3][3])
 {
-  if (this->GridDirectionMatrix == NULL || this->GridPointer == NULL)
+  double error = 0.0;
+  if (this->InternalInverseTransformDerivative(inPoint, outPoint, derivative, error))
     {
-    this->Superclass::InverseTransformDerivative(inPoint,outPoint,derivative);
     return;
     }
+  if (this->MTime > this->LastWarningMTime)
+    {
+    vtkWarningMacro("InverseTransformPoint: no convergence (" <<
+                    inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
+                    ") error = " << error << " after " <<
+                    this->InverseIterations << " iterations."
+                    "  Further convergence warnings suppressed until transform is modified.");
+    this->LastWarningMTime = this->MTime;
+    }
+  this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
+}
+
+//----------------------------------------------------------------------------
+bool vtkOrientedGridTransform::InternalInverseTransformDerivative(const double inPoint[3],
+                                                  double outPoint[3],
+                                                  double derivative[3][3],
+                                                  double& error)
+{
+  error = 0.0;
+  // Superclass::InverseTransformDerivative is not thread-safe, therefore it is not used as fallback.
+  // The cached output to grid index matrix is valid without grid direction matrix as well.
+  if (this->GridPointer == NULL)
+    {
+    outPoint[0] = inPoint[0];
+    outPoint[1] = inPoint[1];
+    outPoint[2] = inPoint[2];
+    vtkMath::Identity3x3(derivative);
+    return true;
+    }
 
   void *gridPtr = this->GridPointer;
   int gridType = this->GridScalarType;
@@ -317,29 +348,22 @@ void vtkOrientedGridTransform::InverseTransformDerivative(const double inPoint[3
 
   vtkDebugMacro("Inverse Iterations: " << (i+1));
 
-  if (i >= n)
+  bool converged = (i < n);
+  if (!converged)
     {
     // didn't converge: back up to last good result
     inverse[0] = lastInverse[0];
     inverse[1] = lastInverse[1];
     inverse[2] = lastInverse[2];
-
-    if (this->MTime > this->LastWarningMTime)
-      {
-      vtkWarningMacro("InverseTransformPoint: no convergence (" <<
-                      inPoint[0] << ", " << inPoint[1] << ", " << inPoint[2] <<
-                      ") error = " << sqrt(errorSquared) << " after " <<
-                      i << " iterations."
-                      "  Further convergence warnings suppressed until transform is modified.");
-      this->LastWarningMTime = this->MTime;
-      }
-    this->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
+    error = sqrt(errorSquared);
     }
 
   // convert point
   outPoint[0] = inverse[0];
   outPoint[1] = inverse[1];
   outPoint[2] = inverse[2];
+
+  return converged;
 }
 
 //----------------------------------------------------------------------------
@@ -387,6 +411,96 @@ void vtkOrientedGridTransform::InternalUpdate()
 
 }
 
+//----------------------------------------------------------------------------
+// Evaluates the transform on a range of points of a contiguous point array.
+// Used by vtkSMPTools, therefore it must not modify the transform.
+// Convergence failures of the inverse are counted per thread and reported
+// once, in Reduce(), which is called from the calling thread.
+class vtkOrientedGridTransformPointArrayFunctor
+{
+public:
+  vtkOrientedGridTransformPointArrayFunctor(vtkOrientedGridTransform* transform, const double* inPoints, double* outPoints)
+    : Transform(transform), InPoints(inPoints), OutPoints(outPoints)
+  {
+  }
+
+  void Initialize()
+  {
+    this->NumberOfNonConvergedPoints.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType& numberOfNonConvergedPoints = this->NumberOfNonConvergedPoints.Local();
+    bool inverse = (this->Transform->GetInverseFlag() != 0);
+    double derivative[3][3];
+    double error = 0.0;
+    double inPoint[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+      {
+      // input and output arrays may be the same, so make a copy of the input point
+      const double* inPointPtr = this->InPoints + 3 * pointIndex;
+      inPoint[0] = inPointPtr[0];
+      inPoint[1] = inPointPtr[1];
+      inPoint[2] = inPointPtr[2];
+      double* outPointPtr = this->OutPoints + 3 * pointIndex;
+      if (inverse)
+        {
+        if (!this->Transform->InternalInverseTransformDerivative(inPoint, outPointPtr, derivative, error))
+          {
+          ++numberOfNonConvergedPoints;
+          }
+        }
+      else
+        {
+        this->Transform->vtkOrientedGridTransform::ForwardTransformPoint(inPoint, outPointPtr);
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    vtkIdType numberOfNonConvergedPoints = 0;
+    for (vtkSMPThreadLocal<vtkIdType>::iterator it = this->NumberOfNonConvergedPoints.begin();
+      it != this->NumberOfNonConvergedPoints.end(); ++it)
+      {
+      numberOfNonConvergedPoints += *it;
+      }
+    if (numberOfNonConvergedPoints == 0)
+      {
+      return;
+      }
+    if (this->Transform->MTime > this->Transform->LastWarningMTime)
+      {
+      vtkWarningWithObjectMacro(this->Transform, "TransformPointArray: no convergence of inverse for "
+        << numberOfNonConvergedPoints << " points after " << this->Transform->InverseIterations << " iterations."
+        "  Further convergence warnings suppressed until transform is modified.");
+      this->Transform->LastWarningMTime = this->Transform->MTime;
+      }
+    this->Transform->InvokeEvent(vtkOrientedGridTransform::ConvergenceFailureEvent);
+  }
+
+private:
+  vtkOrientedGridTransform* Transform;
+  const double* InPoints;
+  double* OutPoints;
+  vtkSMPThreadLocal<vtkIdType> NumberOfNonConvergedPoints;
+};
+
+//----------------------------------------------------------------------------
+void vtkOrientedGridTransform::TransformPointArray(const double* inPoints, double* outPoints, vtkIdType numberOfPoints)
+{
+  if (inPoints == NULL || outPoints == NULL || numberOfPoints <= 0)
+    {
+    return;
+    }
+  // Update the transform once, before the parallel evaluation starts,
+  // so that worker threads only read the cached grid parameters.
+  this->Update();
+  vtkOrientedGridTransformPointArrayFunctor functor(this, inPoints, outPoints);
+  vtkSMPTools::For(0, numberOfPoints, functor);
+}
+
 //----------------------------------------------------------------------------
 vtkAbstractTransform *vtkOrientedGridTransform::MakeTransform()
 {
@@ -36,6 +36,15 @@ public:
   virtual void SetGridDirectionMatrix(vtkMatrix4x4*);
   vtkGetObjectMacro(GridDirectionMatrix,vtkMatrix4x4);
 
+  // Description:
+  // Transform a contiguous array of points (x0, y0, z0, x1, y1, z1, ...).
+  // Points are processed concurrently, using all available threads.
+  // This is much faster than calling TransformPoint for each point,
+  // as the transform is updated only once and the grid lookup is not
+  // performed through virtual calls.
+  // inPoints and outPoints may point to the same array.
+  void TransformPointArray(const double* inPoints, double* outPoints, vtkIdType numberOfPoints);
+
   // Description:
   // Make another transform of the same type.
   vtkAbstractTransform *MakeTransform() VTK_OVERRIDE;
@@ -77,6 +86,14 @@ protected:
   void InverseTransformDerivative(const double in[3], double out[3],
                                   double derivative[3][3]) VTK_OVERRIDE;
 
+  // Description:
+  // Compute the inverse without reporting convergence failures.
+  // Returns false if the iteration did not converge, in this case error
+  // is set to the remaining error. It does not modify the transform,
+  // therefore it can be called concurrently from multiple threads.
+  bool InternalInverseTransformDerivative(const double in[3], double out[3],
+                                          double derivative[3][3], double& error);
+
   // Description:
   // Grid axis direction vectors (i, j, k) in the output space
   vtkMatrix4x4* GridDirectionMatrix;
@@ -92,6 +109,8 @@ protected:
   // by keeping track of the MTime when the last warning was issued.
   vtkMTimeType LastWarningMTime;
 
+  friend class vtkOrientedGridTransformPointArrayFunctor;
+
 private:
   vtkOrientedGridTransform(const vtkOrientedGridTransform&);  // Not implemented.
   void operator=(const vtkOrientedGridTransform&);  // Not implemented.
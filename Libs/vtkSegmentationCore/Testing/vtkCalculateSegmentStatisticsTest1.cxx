@@ -0,0 +1,201 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTransform.h>
+
+// SegmentationCore includes
+#include "vtkCalculateSegmentStatistics.h"
+#include "vtkOrientedImageData.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void AddBoxSegment(vtkSegmentation* segmentation, const char* segmentID, const int boxExtent[6])
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, 9, 0, 9, 0, 1);
+  labelmap->SetSpacing(1.0, 1.0, 2.0);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  for (int k = 0; k <= 1; ++k)
+    {
+    for (int j = 0; j <= 9; ++j)
+      {
+      for (int i = 0; i <= 9; ++i)
+        {
+        bool inside = (i >= boxExtent[0] && i <= boxExtent[1] && j >= boxExtent[2] && j <= boxExtent[3]
+          && k >= boxExtent[4] && k <= boxExtent[5]);
+        *static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) = (inside ? 1 : 0);
+        }
+      }
+    }
+  vtkNew<vtkSegment> segment;
+  segment->AddRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName(), labelmap.GetPointer());
+  segmentation->AddSegment(segment.GetPointer(), segmentID);
+}
+
+//----------------------------------------------------------------------------
+bool IsEqual(double a, double b)
+{
+  return fabs(a - b) < 1e-4;
+}
+
+//----------------------------------------------------------------------------
+int CheckValue(int line, const char* name, double actual, double expected)
+{
+  if (!IsEqual(actual, expected))
+    {
+    std::cerr << line << ": " << name << " mismatch: " << actual << " (expected " << expected << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkCalculateSegmentStatisticsTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
+  // 8 voxels, scalar values: 2, 2, 3, 3, 4, 4, 5, 5
+  const int boxExtentA[6] = { 2, 5, 0, 1, 0, 0 };
+  AddBoxSegment(segmentation.GetPointer(), "A", boxExtentA);
+  // 20 voxels, scalar values: 9
+  const int boxExtentB[6] = { 9, 9, 0, 9, 1, 1 };
+  AddBoxSegment(segmentation.GetPointer(), "B", boxExtentB);
+  const int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  AddBoxSegment(segmentation.GetPointer(), "Empty", emptyExtent);
+
+  // Scalar image with the same geometry as the segments, value is the I index
+  vtkNew<vtkOrientedImageData> scalarImage;
+  scalarImage->SetExtent(0, 9, 0, 9, 0, 1);
+  scalarImage->SetSpacing(1.0, 1.0, 2.0);
+  scalarImage->AllocateScalars(VTK_SHORT, 1);
+  for (int k = 0; k <= 1; ++k)
+    {
+    for (int j = 0; j <= 9; ++j)
+      {
+      for (int i = 0; i <= 9; ++i)
+        {
+        *static_cast<short*>(scalarImage->GetScalarPointer(i, j, k)) = i;
+        }
+      }
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Labelmap statistics
+
+  vtkNew<vtkCalculateSegmentStatistics> calculator;
+  calculator->SetSegmentation(segmentation.GetPointer());
+  if (!calculator->CalculateStatistics())
+    {
+    std::cerr << __LINE__ << ": Failed to calculate labelmap statistics!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (calculator->GetVoxelCount("A") != 8 || calculator->GetVoxelCount("B") != 20
+    || calculator->GetVoxelCount("Empty") != 0 || !calculator->HasStatistics("Empty"))
+    {
+    std::cerr << __LINE__ << ": Voxel count mismatch: A=" << calculator->GetVoxelCount("A")
+      << ", B=" << calculator->GetVoxelCount("B") << ", Empty=" << calculator->GetVoxelCount("Empty") << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (CheckValue(__LINE__, "A volume", calculator->GetVolumeMm3("A"), 16.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "B volume", calculator->GetVolumeMm3("B"), 40.0) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (calculator->HasScalarStatistics("A"))
+    {
+    std::cerr << __LINE__ << ": Scalar statistics are computed without scalar image!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Scalar statistics of selected segments
+
+  calculator->SetScalarImage(scalarImage.GetPointer());
+  calculator->AddSegmentID("A");
+  calculator->AddSegmentID("B");
+  if (!calculator->CalculateStatistics())
+    {
+    std::cerr << __LINE__ << ": Failed to calculate scalar statistics!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (calculator->HasStatistics("Empty") || !calculator->HasScalarStatistics("A") || !calculator->HasScalarStatistics("B"))
+    {
+    std::cerr << __LINE__ << ": Statistics computed for the wrong segments!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (calculator->GetVoxelCount("A") != 8
+    || CheckValue(__LINE__, "A minimum", calculator->GetMinimum("A"), 2.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A maximum", calculator->GetMaximum("A"), 5.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A mean", calculator->GetMean("A"), 3.5) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A standard deviation", calculator->GetStandardDeviation("A"), sqrt(10.0 / 7.0)) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A median", calculator->GetMedian("A"), 3.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A 0th percentile", calculator->GetPercentile("A", 0.0), 2.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A 75th percentile", calculator->GetPercentile("A", 75.0), 4.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "A 100th percentile", calculator->GetPercentile("A", 100.0), 5.0) != EXIT_SUCCESS)
+    {
+    std::cerr << __LINE__ << ": Scalar statistics mismatch for segment A (voxel count: " << calculator->GetVoxelCount("A") << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (calculator->GetVoxelCount("B") != 20
+    || CheckValue(__LINE__, "B mean", calculator->GetMean("B"), 9.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "B standard deviation", calculator->GetStandardDeviation("B"), 0.0) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "B median", calculator->GetMedian("B"), 9.0) != EXIT_SUCCESS)
+    {
+    std::cerr << __LINE__ << ": Scalar statistics mismatch for segment B (voxel count: " << calculator->GetVoxelCount("B") << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Scalar statistics with transformed segmentation (shifted by one voxel along I axis)
+
+  vtkNew<vtkTransform> segmentationToScalarImageTransform;
+  segmentationToScalarImageTransform->Translate(1.0, 0.0, 0.0);
+  calculator->SetSegmentationToScalarImageTransform(segmentationToScalarImageTransform.GetPointer());
+  calculator->RemoveAllSegmentIDs();
+  if (!calculator->CalculateStatistics())
+    {
+    std::cerr << __LINE__ << ": Failed to calculate scalar statistics of transformed segmentation!" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (calculator->GetVoxelCount("A") != 8
+    || CheckValue(__LINE__, "transformed A mean", calculator->GetMean("A"), 4.5) != EXIT_SUCCESS
+    || CheckValue(__LINE__, "transformed A median", calculator->GetMedian("A"), 4.0) != EXIT_SUCCESS)
+    {
+    std::cerr << __LINE__ << ": Scalar statistics mismatch for transformed segment A" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Segment B is moved outside of the scalar image
+  if (calculator->GetVoxelCount("B") != 0 || calculator->HasScalarStatistics("B"))
+    {
+    std::cerr << __LINE__ << ": Transformed segment B is expected to be empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Segment statistics test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
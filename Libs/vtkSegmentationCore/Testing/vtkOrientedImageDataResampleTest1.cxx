@@ -0,0 +1,319 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+
+// Results of vtkOrientedImageDataResample::MergeImage and ModifyImage are compared
+// to results computed voxel by voxel. Computation times are printed. The volume size
+// can be specified as first argument (e.g., run with 512 to benchmark on a 512^3 volume).
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Create image filled with a box of the specified value (background is 0)
+void CreateBoxImage(vtkOrientedImageData* image, const int extent[6], const int boxExtent[6], unsigned char value)
+{
+  image->SetExtent(const_cast<int*>(extent));
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      unsigned char* voxelPtr = static_cast<unsigned char*>(image->GetScalarPointer(extent[0], j, k));
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        bool inside = (i >= boxExtent[0] && i <= boxExtent[1] && j >= boxExtent[2] && j <= boxExtent[3]
+          && k >= boxExtent[4] && k <= boxExtent[5]);
+        *(voxelPtr++) = (inside ? value : 0);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Get voxel value, 0 if outside of the image extent
+int GetVoxel(vtkOrientedImageData* image, int i, int j, int k)
+{
+  int* extent = image->GetExtent();
+  if (i < extent[0] || i > extent[1] || j < extent[2] || j > extent[3] || k < extent[4] || k > extent[5])
+    {
+    return 0;
+    }
+  return *static_cast<unsigned char*>(image->GetScalarPointer(i, j, k));
+}
+
+//----------------------------------------------------------------------------
+/// Returns the number of voxels that differ from the expected value in the result image
+int CountMismatches(vtkOrientedImageData* result, vtkOrientedImageData* base, vtkOrientedImageData* modifier, int operation)
+{
+  int numberOfMismatches = 0;
+  int* extent = result->GetExtent();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        int baseValue = GetVoxel(base, i, j, k);
+        int modifierValue = GetVoxel(modifier, i, j, k);
+        int expectedValue = baseValue;
+        if (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
+          {
+          expectedValue = std::max(baseValue, modifierValue);
+          }
+        else if (operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
+          {
+          expectedValue = std::min(baseValue, modifierValue);
+          }
+        else if (operation == vtkOrientedImageDataResample::OPERATION_MASKING)
+          {
+          expectedValue = (modifierValue > 0 ? 3 : baseValue);
+          }
+        if (GetVoxel(result, i, j, k) != expectedValue)
+          {
+          numberOfMismatches++;
+          }
+        }
+      }
+    }
+  return numberOfMismatches;
+}
+
+//----------------------------------------------------------------------------
+bool TestModifyImage(int size, int operation, const char* operationName, bool modifierSliceExtentTracking = false)
+{
+  const int extent[6] = { 0, size - 1, 0, size - 1, 0, size - 1 };
+  const int baseBoxExtent[6] = { size / 4, size / 2, size / 4, size / 2, size / 4, size / 2 };
+  const int modifierBoxExtent[6] = { size / 3, 2 * size / 3, size / 3, 2 * size / 3, size / 3, 2 * size / 3 };
+
+  vtkNew<vtkOrientedImageData> base;
+  CreateBoxImage(base.GetPointer(), extent, baseBoxExtent, 1);
+  vtkNew<vtkOrientedImageData> modifier;
+  CreateBoxImage(modifier.GetPointer(), extent, modifierBoxExtent, 2);
+  if (modifierSliceExtentTracking)
+    {
+    // Add a voxel in the first slice so that the non-zero region differs between slices
+    *static_cast<unsigned char*>(modifier->GetScalarPointer(size - 1, 1, 0)) = 2;
+    modifier->SetSliceExtentTracking(true);
+    }
+  vtkNew<vtkOrientedImageData> result;
+  result->DeepCopy(base.GetPointer());
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  if (!vtkOrientedImageDataResample::ModifyImage(result.GetPointer(), modifier.GetPointer(), operation, NULL, 0, 3))
+    {
+    std::cerr << "Line " << __LINE__ << ": ModifyImage (" << operationName << ") failed" << std::endl;
+    return false;
+    }
+  timer->StopTimer();
+  std::cout << "  ModifyImage (" << operationName << (modifierSliceExtentTracking ? ", modifier slice extent tracking" : "")
+    << "): " << timer->GetElapsedTime() << "s" << std::endl;
+
+  int numberOfMismatches = CountMismatches(result.GetPointer(), base.GetPointer(), modifier.GetPointer(), operation);
+  if (numberOfMismatches > 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": ModifyImage (" << operationName << ") result mismatch in "
+      << numberOfMismatches << " voxels" << std::endl;
+    return false;
+    }
+
+  // Modifying with an empty image must not change the image
+  vtkNew<vtkOrientedImageData> emptyModifier;
+  const int emptyBoxExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  CreateBoxImage(emptyModifier.GetPointer(), extent, emptyBoxExtent, 1);
+  if (operation != vtkOrientedImageDataResample::OPERATION_MINIMUM)
+    {
+    vtkMTimeType mtimeBefore = result->GetMTime();
+    vtkOrientedImageDataResample::ModifyImage(result.GetPointer(), emptyModifier.GetPointer(), operation, NULL, 0, 3);
+    if (result->GetMTime() != mtimeBefore)
+      {
+      std::cerr << "Line " << __LINE__ << ": ModifyImage (" << operationName << ") with empty modifier changed the image" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestMergeImage(int size)
+{
+  // Modifier is partially outside of the base image, result is the union of the two extents
+  const int baseExtent[6] = { 0, size - 1, 0, size - 1, 0, size - 1 };
+  const int modifierExtent[6] = { size / 2, size + size / 2, 0, size - 1, 0, size - 1 };
+  const int baseBoxExtent[6] = { size / 4, size / 2, size / 4, size / 2, size / 4, size / 2 };
+  const int modifierBoxExtent[6] = { size - 2, size + 2, size / 3, 2 * size / 3, size / 3, 2 * size / 3 };
+
+  vtkNew<vtkOrientedImageData> base;
+  CreateBoxImage(base.GetPointer(), baseExtent, baseBoxExtent, 1);
+  vtkNew<vtkOrientedImageData> modifier;
+  CreateBoxImage(modifier.GetPointer(), modifierExtent, modifierBoxExtent, 2);
+  vtkNew<vtkOrientedImageData> result;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  bool modified = false;
+  if (!vtkOrientedImageDataResample::MergeImage(base.GetPointer(), modifier.GetPointer(), result.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MAXIMUM, NULL, 0, 1, &modified))
+    {
+    std::cerr << "Line " << __LINE__ << ": MergeImage failed" << std::endl;
+    return false;
+    }
+  timer->StopTimer();
+  std::cout << "  MergeImage (maximum): " << timer->GetElapsedTime() << "s" << std::endl;
+
+  int* resultExtent = result->GetExtent();
+  if (!modified || resultExtent[0] != 0 || resultExtent[1] != size + size / 2)
+    {
+    std::cerr << "Line " << __LINE__ << ": MergeImage result extent or modified flag is incorrect" << std::endl;
+    return false;
+    }
+  int numberOfMismatches = CountMismatches(result.GetPointer(), base.GetPointer(), modifier.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MAXIMUM);
+  if (numberOfMismatches > 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": MergeImage result mismatch in " << numberOfMismatches << " voxels" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CheckExtent(int line, const int actual[6], const int expected[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+    if (actual[i] != expected[i])
+      {
+      std::cerr << "Line " << line << ": extent mismatch: (" << actual[0] << ", " << actual[1] << ", " << actual[2] << ", "
+        << actual[3] << ", " << actual[4] << ", " << actual[5] << ") expected: (" << expected[0] << ", " << expected[1] << ", "
+        << expected[2] << ", " << expected[3] << ", " << expected[4] << ", " << expected[5] << ")" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestCalculateEffectiveExtent(int size)
+{
+  const int extent[6] = { 0, size - 1, 0, size - 1, 0, size - 1 };
+  const int boxExtent[6] = { size / 4, size / 2, size / 3, size / 2, size / 4, size / 3 };
+  vtkNew<vtkOrientedImageData> image;
+  CreateBoxImage(image.GetPointer(), extent, boxExtent, 1);
+  image->SetSliceExtentTracking(true);
+
+  vtkNew<vtkTimerLog> timer;
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  timer->StartTimer();
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(image.GetPointer(), effectiveExtent);
+  timer->StopTimer();
+  std::cout << "  CalculateEffectiveExtent: " << timer->GetElapsedTime() << "s" << std::endl;
+  if (!CheckExtent(__LINE__, effectiveExtent, boxExtent))
+    {
+    return false;
+    }
+
+  // Add voxels in a few slices
+  const int addedBoxExtent[6] = { 1, 2, size - 2, size - 2, size - 3, size - 2 };
+  vtkNew<vtkOrientedImageData> modifier;
+  CreateBoxImage(modifier.GetPointer(), extent, addedBoxExtent, 1);
+  vtkOrientedImageDataResample::ModifyImage(image.GetPointer(), modifier.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MAXIMUM, addedBoxExtent);
+  timer->StartTimer();
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(image.GetPointer(), effectiveExtent);
+  timer->StopTimer();
+  std::cout << "  CalculateEffectiveExtent after modifying a few slices: " << timer->GetElapsedTime() << "s" << std::endl;
+  const int expectedExtent[6] = { 1, size / 2, size / 3, size - 2, size / 4, size - 2 };
+  if (!CheckExtent(__LINE__, effectiveExtent, expectedExtent))
+    {
+    return false;
+    }
+
+  // Remove the added voxels
+  vtkOrientedImageDataResample::ModifyImage(image.GetPointer(), modifier.GetPointer(),
+    vtkOrientedImageDataResample::OPERATION_MASKING, addedBoxExtent, 0, 0);
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(image.GetPointer(), effectiveExtent);
+  if (!CheckExtent(__LINE__, effectiveExtent, boxExtent))
+    {
+    return false;
+    }
+
+  // Modification without using vtkOrientedImageDataResample
+  *static_cast<unsigned char*>(image->GetScalarPointer(size - 1, 0, 0)) = 1;
+  image->Modified();
+  vtkOrientedImageDataResample::CalculateEffectiveExtent(image.GetPointer(), effectiveExtent);
+  const int expectedExtent2[6] = { size / 4, size - 1, 0, size / 2, 0, size / 3 };
+  if (!CheckExtent(__LINE__, effectiveExtent, expectedExtent2))
+    {
+    return false;
+    }
+
+  // Empty image
+  vtkNew<vtkOrientedImageData> emptyImage;
+  const int emptyBoxExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  CreateBoxImage(emptyImage.GetPointer(), extent, emptyBoxExtent, 1);
+  if (vtkOrientedImageDataResample::CalculateEffectiveExtent(emptyImage.GetPointer(), effectiveExtent))
+    {
+    std::cerr << "Line " << __LINE__ << ": effective extent of an empty image is expected to be invalid" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkOrientedImageDataResampleTest1(int argc, char* argv[])
+{
+  int size = 40;
+  if (argc > 1)
+    {
+    size = atoi(argv[1]);
+    }
+  if (size < 10)
+    {
+    std::cerr << "Invalid volume size: " << size << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Combining " << size << "^3 images" << std::endl;
+  if (!TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MAXIMUM, "maximum")
+    || !TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MINIMUM, "minimum")
+    || !TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MASKING, "masking")
+    || !TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MAXIMUM, "maximum", true)
+    || !TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MINIMUM, "minimum", true)
+    || !TestModifyImage(size, vtkOrientedImageDataResample::OPERATION_MASKING, "masking", true)
+    || !TestMergeImage(size)
+    || !TestCalculateEffectiveExtent(size))
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Image merge test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
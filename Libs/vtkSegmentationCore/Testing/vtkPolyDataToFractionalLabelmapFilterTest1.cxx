@@ -0,0 +1,184 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VTK includes
+#include <vtkCubeSource.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// SegmentationCore includes
+#include "vtkOrientedImageData.h"
+#include "vtkPolyDataToFractionalLabelmapFilter.h"
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+
+// A box surface is converted to fractional labelmap and the result is compared to the
+// exact number of oversampled positions inside the box in each voxel. A sphere is converted
+// as well, its volume is checked and the computation time is printed. The sphere radius (in voxels)
+// can be specified as first argument (e.g., run with 200 to benchmark on a large surface).
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Number of the oversampled positions of voxel index along one axis
+/// that are inside the [-halfSize, halfSize] range.
+int GetNumberOfPositionsInside(int index, double halfSize, int numberOfOffsets)
+{
+  double offsetStepSize = (numberOfOffsets - 1.0) / (2 * numberOfOffsets);
+  int count = 0;
+  for (int offsetIndex = 0; offsetIndex < numberOfOffsets; ++offsetIndex)
+    {
+    double position = index + (double)offsetIndex / numberOfOffsets - offsetStepSize;
+    if (fabs(position) <= halfSize)
+      {
+      ++count;
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int TestBox()
+{
+  const int numberOfOffsets = 6;
+  const double halfSize = 2.2;
+
+  vtkNew<vtkCubeSource> cube;
+  cube->SetXLength(2 * halfSize);
+  cube->SetYLength(2 * halfSize);
+  cube->SetZLength(2 * halfSize);
+  cube->Update();
+
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  vtkNew<vtkPolyDataToFractionalLabelmapFilter> filter;
+  filter->SetInputData(cube->GetOutput());
+  filter->SetOutputImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  filter->SetNumberOfOffsets(numberOfOffsets);
+  filter->SetOutputWholeExtent(-4, 4, -4, 4, -4, 4);
+  filter->Update();
+
+  vtkOrientedImageData* fractionalLabelmap = filter->GetOutput();
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  fractionalLabelmap->GetExtent(extent);
+  if (extent[0] != -4 || extent[1] != 4 || extent[4] != -4 || extent[5] != 4
+    || fractionalLabelmap->GetScalarType() != VTK_FRACTIONAL_DATA_TYPE)
+    {
+    std::cerr << "Line " << __LINE__ << ": Invalid fractional labelmap extent or scalar type" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        int numberOfPositionsInside = GetNumberOfPositionsInside(i, halfSize, numberOfOffsets)
+          * GetNumberOfPositionsInside(j, halfSize, numberOfOffsets)
+          * GetNumberOfPositionsInside(k, halfSize, numberOfOffsets);
+        double expectedValue = FRACTIONAL_MIN + numberOfPositionsInside * FRACTIONAL_STEP_SIZE;
+        double actualValue = fractionalLabelmap->GetScalarComponentAsDouble(i, j, k, 0);
+        if (fabs(actualValue - expectedValue) > 1e-6)
+          {
+          std::cerr << "Line " << __LINE__ << ": Fractional value mismatch at voxel (" << i << ", " << j << ", " << k
+            << "): " << actualValue << " (expected " << expectedValue << ")" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestSphere(double radius)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(radius);
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  sphere->Update();
+
+  int size = static_cast<int>(ceil(radius)) + 1;
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  vtkNew<vtkPolyDataToFractionalLabelmapFilter> filter;
+  filter->SetInputData(sphere->GetOutput());
+  filter->SetOutputImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  filter->SetOutputWholeExtent(-size, size, -size, size, -size, size);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  filter->Update();
+  timer->StopTimer();
+  std::cout << "Sphere of radius " << radius << " converted to fractional labelmap in "
+    << timer->GetElapsedTime() << " seconds" << std::endl;
+
+  // Sum of fractions is the volume of the surface (in voxels)
+  vtkOrientedImageData* fractionalLabelmap = filter->GetOutput();
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  fractionalLabelmap->GetExtent(extent);
+  double volume = 0.0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+      {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+        {
+        volume += (fractionalLabelmap->GetScalarComponentAsDouble(i, j, k, 0) - FRACTIONAL_MIN)
+          / (FRACTIONAL_MAX - FRACTIONAL_MIN);
+        }
+      }
+    }
+
+  // The polygonal sphere is slightly smaller than the ideal sphere
+  double expectedVolume = 4.0 / 3.0 * vtkMath::Pi() * radius * radius * radius;
+  if (fabs(volume - expectedVolume) > 0.05 * expectedVolume)
+    {
+    std::cerr << "Line " << __LINE__ << ": Sphere volume mismatch: " << volume << " (expected " << expectedVolume << ")" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkPolyDataToFractionalLabelmapFilterTest1(int argc, char* argv[])
+{
+  double radius = 10.0;
+  if (argc > 1)
+    {
+    radius = atof(argv[1]);
+    }
+
+  if (TestBox() != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+  if (TestSphere(radius) != EXIT_SUCCESS)
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Fractional labelmap conversion test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
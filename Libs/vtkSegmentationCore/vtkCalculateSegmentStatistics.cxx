@@ -0,0 +1,679 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkCalculateSegmentStatistics.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
+#include "vtkSegment.h"
+#include "vtkSegmentation.h"
+#include "vtkSegmentationConverter.h"
+
+// VTK includes
+#include <vtkAbstractTransform.h>
+#include <vtkDataArray.h>
+#include <vtkGeneralTransform.h>
+#include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkCalculateSegmentStatistics);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Binary mask of a segment (unsigned char, nonzero inside) in the geometry where statistics are computed
+struct SegmentMask
+{
+  std::string SegmentID;
+  vtkSmartPointer<vtkImageData> Mask;
+  int Extent[6];
+  double VoxelVolume;
+};
+
+//----------------------------------------------------------------------------
+struct StatisticsAccumulator
+{
+  StatisticsAccumulator()
+    : VoxelCount(0)
+    , Sum(0.0)
+    , SumOfSquares(0.0)
+    , Minimum(VTK_DOUBLE_MAX)
+    , Maximum(VTK_DOUBLE_MIN)
+    , HistogramFirstBin(0)
+  {
+  }
+
+  /// Extend the histogram so that it contains the specified bin.
+  /// Only the range of bins that actually occur is allocated. The range is grown
+  /// geometrically (up to numberOfBins) to avoid reallocating for each new bin.
+  void ExtendHistogram(int bin, int numberOfBins)
+  {
+    const int size = static_cast<int>(this->Histogram.size());
+    if (size == 0)
+      {
+      this->HistogramFirstBin = bin;
+      this->Histogram.resize(1, 0);
+      }
+    else if (bin < this->HistogramFirstBin)
+      {
+      int newFirstBin = std::max(0, std::min(bin, this->HistogramFirstBin - size));
+      this->Histogram.insert(this->Histogram.begin(), this->HistogramFirstBin - newFirstBin, 0);
+      this->HistogramFirstBin = newFirstBin;
+      }
+    else if (bin >= this->HistogramFirstBin + size)
+      {
+      int newLastBin = std::min(numberOfBins - 1, std::max(bin, this->HistogramFirstBin + 2 * size - 1));
+      this->Histogram.resize(newLastBin - this->HistogramFirstBin + 1, 0);
+      }
+  }
+
+  void Merge(StatisticsAccumulator& other)
+  {
+    this->VoxelCount += other.VoxelCount;
+    this->Sum += other.Sum;
+    this->SumOfSquares += other.SumOfSquares;
+    this->Minimum = std::min(this->Minimum, other.Minimum);
+    this->Maximum = std::max(this->Maximum, other.Maximum);
+    if (other.Histogram.empty())
+      {
+      return;
+      }
+    if (this->Histogram.empty())
+      {
+      this->Histogram.swap(other.Histogram);
+      this->HistogramFirstBin = other.HistogramFirstBin;
+      return;
+      }
+    const int firstBin = std::min(this->HistogramFirstBin, other.HistogramFirstBin);
+    const int lastBin = std::max(this->HistogramFirstBin + static_cast<int>(this->Histogram.size()),
+      other.HistogramFirstBin + static_cast<int>(other.Histogram.size())) - 1;
+    this->Histogram.insert(this->Histogram.begin(), this->HistogramFirstBin - firstBin, 0);
+    this->Histogram.resize(lastBin - firstBin + 1, 0);
+    this->HistogramFirstBin = firstBin;
+    const int offset = other.HistogramFirstBin - firstBin;
+    for (size_t bin = 0; bin < other.Histogram.size(); ++bin)
+      {
+      this->Histogram[offset + bin] += other.Histogram[bin];
+      }
+  }
+
+  vtkIdType VoxelCount;
+  double Sum;
+  double SumOfSquares;
+  double Minimum;
+  double Maximum;
+  /// Histogram of the bins between HistogramFirstBin and HistogramFirstBin + Histogram.size() - 1
+  std::vector<vtkIdType> Histogram;
+  int HistogramFirstBin;
+};
+
+typedef std::map<int, StatisticsAccumulator> StatisticsAccumulatorMap;
+
+//----------------------------------------------------------------------------
+/// Each work item is one slice of one segment: (segment mask index, slice index)
+typedef std::vector<std::pair<int, int> > SegmentSliceList;
+
+//----------------------------------------------------------------------------
+/// Accumulate voxel count and scalar statistics for all segments.
+/// If no scalar image is specified then only voxels are counted.
+template <class T> class AccumulateStatisticsFunctor
+{
+public:
+  AccumulateStatisticsFunctor(const std::vector<SegmentMask>& masks, const SegmentSliceList& slices,
+    vtkImageData* scalarImage, double histogramOrigin, double histogramSpacing, int numberOfHistogramBins)
+    : Masks(masks)
+    , Slices(slices)
+    , ScalarImage(scalarImage)
+    , HistogramOrigin(histogramOrigin)
+    , HistogramSpacing(histogramSpacing)
+    , NumberOfHistogramBins(numberOfHistogramBins)
+  {
+  }
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType beginSlice, vtkIdType endSlice)
+  {
+    StatisticsAccumulatorMap& accumulators = this->LocalAccumulators.Local();
+    const int numberOfComponents = this->ScalarImage ? this->ScalarImage->GetNumberOfScalarComponents() : 1;
+    for (vtkIdType sliceIndex = beginSlice; sliceIndex < endSlice; ++sliceIndex)
+      {
+      const int maskIndex = this->Slices[sliceIndex].first;
+      const int k = this->Slices[sliceIndex].second;
+      const SegmentMask& mask = this->Masks[maskIndex];
+      StatisticsAccumulator& accumulator = accumulators[maskIndex];
+      const int* extent = mask.Extent;
+      const int rowLength = extent[1] - extent[0] + 1;
+      for (int j = extent[2]; j <= extent[3]; ++j)
+        {
+        const unsigned char* maskPtr = static_cast<unsigned char*>(mask.Mask->GetScalarPointer(extent[0], j, k));
+        if (!this->ScalarImage)
+          {
+          for (int i = 0; i < rowLength; ++i)
+            {
+            if (maskPtr[i])
+              {
+              ++accumulator.VoxelCount;
+              }
+            }
+          continue;
+          }
+        const T* scalarPtr = static_cast<T*>(this->ScalarImage->GetScalarPointer(extent[0], j, k));
+        for (int i = 0; i < rowLength; ++i, scalarPtr += numberOfComponents)
+          {
+          if (!maskPtr[i])
+            {
+            continue;
+            }
+          double value = static_cast<double>(*scalarPtr);
+          if (value != value)
+            {
+            // NaN
+            continue;
+            }
+          ++accumulator.VoxelCount;
+          accumulator.Sum += value;
+          accumulator.SumOfSquares += value * value;
+          accumulator.Minimum = std::min(accumulator.Minimum, value);
+          accumulator.Maximum = std::max(accumulator.Maximum, value);
+          int bin = static_cast<int>(floor((value - this->HistogramOrigin) / this->HistogramSpacing + 0.5));
+          bin = std::max(0, std::min(this->NumberOfHistogramBins - 1, bin));
+          if (bin < accumulator.HistogramFirstBin
+            || bin >= accumulator.HistogramFirstBin + static_cast<int>(accumulator.Histogram.size()))
+            {
+            accumulator.ExtendHistogram(bin, this->NumberOfHistogramBins);
+            }
+          ++accumulator.Histogram[bin - accumulator.HistogramFirstBin];
+          }
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    this->Accumulators.clear();
+    this->Accumulators.resize(this->Masks.size());
+    for (vtkSMPThreadLocal<StatisticsAccumulatorMap>::iterator localIt = this->LocalAccumulators.begin();
+      localIt != this->LocalAccumulators.end(); ++localIt)
+      {
+      StatisticsAccumulatorMap& localAccumulators = *localIt;
+      for (StatisticsAccumulatorMap::iterator accumulatorIt = localAccumulators.begin();
+        accumulatorIt != localAccumulators.end(); ++accumulatorIt)
+        {
+        this->Accumulators[accumulatorIt->first].Merge(accumulatorIt->second);
+        }
+      }
+  }
+
+  const std::vector<SegmentMask>& Masks;
+  const SegmentSliceList& Slices;
+  vtkImageData* ScalarImage;
+  double HistogramOrigin;
+  double HistogramSpacing;
+  int NumberOfHistogramBins;
+  vtkSMPThreadLocal<StatisticsAccumulatorMap> LocalAccumulators;
+  std::vector<StatisticsAccumulator> Accumulators;
+};
+
+//----------------------------------------------------------------------------
+template <class T> void AccumulateStatistics(const std::vector<SegmentMask>& masks, const SegmentSliceList& slices,
+  vtkImageData* scalarImage, double histogramOrigin, double histogramSpacing, int numberOfHistogramBins,
+  std::vector<StatisticsAccumulator>& accumulators)
+{
+  AccumulateStatisticsFunctor<T> functor(masks, slices, scalarImage, histogramOrigin, histogramSpacing, numberOfHistogramBins);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(slices.size()), functor);
+  accumulators.swap(functor.Accumulators);
+}
+
+//----------------------------------------------------------------------------
+/// Get labelmap as an unsigned char image that is nonzero inside the segment
+vtkSmartPointer<vtkImageData> GetUnsignedCharMask(vtkImageData* labelmap)
+{
+  if (labelmap->GetScalarType() == VTK_UNSIGNED_CHAR && labelmap->GetNumberOfScalarComponents() == 1)
+    {
+    return labelmap;
+    }
+  vtkNew<vtkImageThreshold> threshold;
+  threshold->SetInputData(labelmap);
+  threshold->ThresholdByLower(0);
+  threshold->SetInValue(0);
+  threshold->SetOutValue(1);
+  threshold->SetOutputScalarTypeToUnsignedChar();
+  threshold->Update();
+  return threshold->GetOutput();
+}
+
+//----------------------------------------------------------------------------
+bool IsTransformIdentity(vtkAbstractTransform* transform)
+{
+  if (transform == NULL)
+    {
+    return true;
+    }
+  vtkGeneralTransform* generalTransform = vtkGeneralTransform::SafeDownCast(transform);
+  return (generalTransform && generalTransform->GetNumberOfConcatenatedTransforms() == 0);
+}
+
+//----------------------------------------------------------------------------
+bool IntersectExtent(int extent[6], const int otherExtent[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    extent[axis * 2] = std::max(extent[axis * 2], otherExtent[axis * 2]);
+    extent[axis * 2 + 1] = std::min(extent[axis * 2 + 1], otherExtent[axis * 2 + 1]);
+    if (extent[axis * 2] > extent[axis * 2 + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkCalculateSegmentStatistics::SegmentStatistics::SegmentStatistics()
+  : VoxelCount(0)
+  , VolumeMm3(0.0)
+  , ScalarStatisticsValid(false)
+  , Minimum(0.0)
+  , Maximum(0.0)
+  , Mean(0.0)
+  , StandardDeviation(0.0)
+  , HistogramFirstBin(0)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkCalculateSegmentStatistics::vtkCalculateSegmentStatistics()
+{
+  this->Segmentation = NULL;
+  this->ScalarImage = NULL;
+  this->SegmentationToScalarImageTransform = NULL;
+  this->MaximumNumberOfHistogramBins = 65536;
+  this->HistogramOrigin = 0.0;
+  this->HistogramSpacing = 1.0;
+}
+
+//----------------------------------------------------------------------------
+vtkCalculateSegmentStatistics::~vtkCalculateSegmentStatistics()
+{
+  this->SetSegmentation(NULL);
+  this->SetScalarImage(NULL);
+  this->SetSegmentationToScalarImageTransform(NULL);
+}
+
+//----------------------------------------------------------------------------
+void vtkCalculateSegmentStatistics::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Segmentation: " << this->Segmentation << "\n";
+  os << indent << "ScalarImage: " << this->ScalarImage << "\n";
+  os << indent << "SegmentationToScalarImageTransform: " << this->SegmentationToScalarImageTransform << "\n";
+  os << indent << "MaximumNumberOfHistogramBins: " << this->MaximumNumberOfHistogramBins << "\n";
+  os << indent << "Number of selected segments: " << this->SegmentIDs.size() << "\n";
+  os << indent << "Number of computed segments: " << this->Statistics.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkCalculateSegmentStatistics::AddSegmentID(const char* segmentID)
+{
+  if (!segmentID)
+    {
+    return;
+    }
+  this->SegmentIDs.push_back(segmentID);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkCalculateSegmentStatistics::RemoveAllSegmentIDs()
+{
+  if (this->SegmentIDs.empty())
+    {
+    return;
+    }
+  this->SegmentIDs.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkCalculateSegmentStatistics::CalculateStatistics()
+{
+  this->Statistics.clear();
+
+  if (!this->Segmentation)
+    {
+    vtkErrorMacro("CalculateStatistics: Invalid segmentation!");
+    return false;
+    }
+  std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+  if (!this->Segmentation->ContainsRepresentation(labelmapRepresentationName))
+    {
+    vtkErrorMacro("CalculateStatistics: Segmentation does not contain binary labelmap representation!");
+    return false;
+    }
+
+  std::vector<std::string> segmentIDs = this->SegmentIDs;
+  if (segmentIDs.empty())
+    {
+    this->Segmentation->GetSegmentIDs(segmentIDs);
+    }
+
+  // Determine histogram binning from the scalar range. Integer images get one bin per value
+  // (if the range is not too large) so that median and percentiles are exact.
+  vtkDataArray* scalars = NULL;
+  int scalarExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  double scalarVoxelVolume = 1.0;
+  int numberOfHistogramBins = 0;
+  vtkNew<vtkMatrix4x4> scalarImageToWorldMatrix;
+  vtkNew<vtkMatrix4x4> worldToScalarImageMatrix;
+  if (this->ScalarImage)
+    {
+    scalars = this->ScalarImage->GetPointData() ? this->ScalarImage->GetPointData()->GetScalars() : NULL;
+    if (!scalars)
+      {
+      vtkErrorMacro("CalculateStatistics: Scalar image does not contain scalars!");
+      return false;
+      }
+    if (this->MaximumNumberOfHistogramBins < 1)
+      {
+      vtkErrorMacro("CalculateStatistics: Invalid maximum number of histogram bins: " << this->MaximumNumberOfHistogramBins);
+      return false;
+      }
+    this->ScalarImage->GetExtent(scalarExtent);
+    double* scalarSpacing = this->ScalarImage->GetSpacing();
+    scalarVoxelVolume = scalarSpacing[0] * scalarSpacing[1] * scalarSpacing[2];
+    this->ScalarImage->GetImageToWorldMatrix(scalarImageToWorldMatrix.GetPointer());
+    vtkMatrix4x4::Invert(scalarImageToWorldMatrix.GetPointer(), worldToScalarImageMatrix.GetPointer());
+
+    double scalarRange[2] = { 0.0, 0.0 };
+    scalars->GetRange(scalarRange, 0);
+    bool integerScalars = (scalars->GetDataType() != VTK_FLOAT && scalars->GetDataType() != VTK_DOUBLE);
+    if (integerScalars && scalarRange[1] - scalarRange[0] + 1.0 <= this->MaximumNumberOfHistogramBins)
+      {
+      numberOfHistogramBins = static_cast<int>(scalarRange[1] - scalarRange[0] + 1.0);
+      this->HistogramSpacing = 1.0;
+      this->HistogramOrigin = scalarRange[0];
+      }
+    else if (scalarRange[1] > scalarRange[0])
+      {
+      numberOfHistogramBins = this->MaximumNumberOfHistogramBins;
+      this->HistogramSpacing = (scalarRange[1] - scalarRange[0]) / numberOfHistogramBins;
+      this->HistogramOrigin = scalarRange[0] + this->HistogramSpacing / 2.0;
+      }
+    else
+      {
+      numberOfHistogramBins = 1;
+      this->HistogramSpacing = 1.0;
+      this->HistogramOrigin = scalarRange[0];
+      }
+    }
+
+  bool transformIsIdentity = IsTransformIdentity(this->SegmentationToScalarImageTransform);
+
+  // Get the mask of each segment, restricted to the segment's extent
+  std::vector<SegmentMask> masks;
+  for (std::vector<std::string>::iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    vtkSegment* segment = this->Segmentation->GetSegment(*segmentIdIt);
+    if (!segment)
+      {
+      vtkWarningMacro("CalculateStatistics: Segment not found: " << *segmentIdIt);
+      continue;
+      }
+    // Empty segments have zero voxel count
+    this->Statistics[*segmentIdIt] = SegmentStatistics();
+
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segment->GetRepresentation(labelmapRepresentationName));
+    if (!labelmap || !labelmap->GetPointData() || !labelmap->GetPointData()->GetScalars())
+      {
+      continue;
+      }
+    SegmentMask mask;
+    mask.SegmentID = *segmentIdIt;
+    labelmap->GetExtent(mask.Extent);
+    if (mask.Extent[0] > mask.Extent[1] || mask.Extent[2] > mask.Extent[3] || mask.Extent[4] > mask.Extent[5])
+      {
+      continue;
+      }
+    vtkSmartPointer<vtkImageData> labelmapInStatisticsGeometry = labelmap;
+    if (this->ScalarImage)
+      {
+      if (!transformIsIdentity || !vtkOrientedImageDataResample::DoGeometriesMatch(labelmap, this->ScalarImage))
+        {
+        // Resample only the region of the scalar image that the segment covers
+        vtkNew<vtkGeneralTransform> labelmapToScalarImageTransform;
+        labelmapToScalarImageTransform->PostMultiply();
+        vtkNew<vtkMatrix4x4> labelmapToWorldMatrix;
+        labelmap->GetImageToWorldMatrix(labelmapToWorldMatrix.GetPointer());
+        labelmapToScalarImageTransform->Concatenate(labelmapToWorldMatrix.GetPointer());
+        if (this->SegmentationToScalarImageTransform)
+          {
+          labelmapToScalarImageTransform->Concatenate(this->SegmentationToScalarImageTransform);
+          }
+        labelmapToScalarImageTransform->Concatenate(worldToScalarImageMatrix.GetPointer());
+        int labelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
+        labelmap->GetExtent(labelmapExtent);
+        vtkOrientedImageDataResample::TransformExtent(labelmapExtent, labelmapToScalarImageTransform.GetPointer(), mask.Extent);
+        if (!IntersectExtent(mask.Extent, scalarExtent))
+          {
+          continue;
+          }
+        vtkNew<vtkOrientedImageData> referenceGeometry;
+        referenceGeometry->SetExtent(mask.Extent);
+        referenceGeometry->SetGeometryFromImageToWorldMatrix(scalarImageToWorldMatrix.GetPointer());
+        vtkSmartPointer<vtkOrientedImageData> resampledLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+        if (!vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(labelmap, referenceGeometry.GetPointer(),
+          resampledLabelmap, false, false, this->SegmentationToScalarImageTransform))
+          {
+          vtkErrorMacro("CalculateStatistics: Failed to resample labelmap of segment " << *segmentIdIt);
+          continue;
+          }
+        labelmapInStatisticsGeometry = resampledLabelmap.GetPointer();
+        }
+      if (!IntersectExtent(mask.Extent, labelmapInStatisticsGeometry->GetExtent())
+        || !IntersectExtent(mask.Extent, scalarExtent))
+        {
+        continue;
+        }
+      mask.VoxelVolume = scalarVoxelVolume;
+      }
+    else
+      {
+      double* labelmapSpacing = labelmap->GetSpacing();
+      mask.VoxelVolume = labelmapSpacing[0] * labelmapSpacing[1] * labelmapSpacing[2];
+      }
+    mask.Mask = GetUnsignedCharMask(labelmapInStatisticsGeometry);
+    masks.push_back(mask);
+    }
+
+  // Single multi-threaded pass over the slices of all segments
+  SegmentSliceList slices;
+  for (size_t maskIndex = 0; maskIndex < masks.size(); ++maskIndex)
+    {
+    for (int k = masks[maskIndex].Extent[4]; k <= masks[maskIndex].Extent[5]; ++k)
+      {
+      slices.push_back(std::make_pair(static_cast<int>(maskIndex), k));
+      }
+    }
+  std::vector<StatisticsAccumulator> accumulators;
+  if (this->ScalarImage)
+    {
+    switch (scalars->GetDataType())
+      {
+      vtkTemplateMacro(AccumulateStatistics<VTK_TT>(masks, slices, this->ScalarImage,
+        this->HistogramOrigin, this->HistogramSpacing, numberOfHistogramBins, accumulators));
+      default:
+        vtkErrorMacro("CalculateStatistics: Unknown scalar type: " << scalars->GetDataType());
+        return false;
+      }
+    }
+  else
+    {
+    AccumulateStatistics<unsigned char>(masks, slices, NULL, 0.0, 1.0, 0, accumulators);
+    }
+
+  for (size_t maskIndex = 0; maskIndex < masks.size(); ++maskIndex)
+    {
+    StatisticsAccumulator& accumulator = accumulators[maskIndex];
+    SegmentStatistics& statistics = this->Statistics[masks[maskIndex].SegmentID];
+    statistics.VoxelCount = accumulator.VoxelCount;
+    statistics.VolumeMm3 = accumulator.VoxelCount * masks[maskIndex].VoxelVolume;
+    if (!this->ScalarImage || accumulator.VoxelCount == 0)
+      {
+      continue;
+      }
+    statistics.ScalarStatisticsValid = true;
+    statistics.Minimum = accumulator.Minimum;
+    statistics.Maximum = accumulator.Maximum;
+    statistics.Mean = accumulator.Sum / accumulator.VoxelCount;
+    if (accumulator.VoxelCount > 1)
+      {
+      double variance = (accumulator.SumOfSquares - statistics.Mean * accumulator.Sum) / (accumulator.VoxelCount - 1);
+      statistics.StandardDeviation = sqrt(std::max(0.0, variance));
+      }
+    // Only keep the non-empty part of the histogram
+    std::vector<vtkIdType>& histogram = accumulator.Histogram;
+    int firstBin = 0;
+    int lastBin = static_cast<int>(histogram.size()) - 1;
+    while (firstBin < lastBin && histogram[firstBin] == 0)
+      {
+      ++firstBin;
+      }
+    while (lastBin > firstBin && histogram[lastBin] == 0)
+      {
+      --lastBin;
+      }
+    statistics.HistogramFirstBin = accumulator.HistogramFirstBin + firstBin;
+    statistics.Histogram.assign(histogram.begin() + firstBin, histogram.begin() + lastBin + 1);
+    }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkCalculateSegmentStatistics::SegmentStatistics* vtkCalculateSegmentStatistics::GetSegmentStatistics(const char* segmentID)
+{
+  if (!segmentID)
+    {
+    return NULL;
+    }
+  std::map<std::string, SegmentStatistics>::iterator statisticsIt = this->Statistics.find(segmentID);
+  if (statisticsIt == this->Statistics.end())
+    {
+    return NULL;
+    }
+  return &(statisticsIt->second);
+}
+
+//----------------------------------------------------------------------------
+bool vtkCalculateSegmentStatistics::HasStatistics(const char* segmentID)
+{
+  return (this->GetSegmentStatistics(segmentID) != NULL);
+}
+
+//----------------------------------------------------------------------------
+bool vtkCalculateSegmentStatistics::HasScalarStatistics(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics && statistics->ScalarStatisticsValid);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCalculateSegmentStatistics::GetVoxelCount(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->VoxelCount : 0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetVolumeMm3(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->VolumeMm3 : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetMinimum(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->Minimum : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetMaximum(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->Maximum : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetMean(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->Mean : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetStandardDeviation(const char* segmentID)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  return (statistics ? statistics->StandardDeviation : 0.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetMedian(const char* segmentID)
+{
+  return this->GetPercentile(segmentID, 50.0);
+}
+
+//----------------------------------------------------------------------------
+double vtkCalculateSegmentStatistics::GetPercentile(const char* segmentID, double percentile)
+{
+  SegmentStatistics* statistics = this->GetSegmentStatistics(segmentID);
+  if (!statistics || !statistics->ScalarStatisticsValid)
+    {
+    return 0.0;
+    }
+  percentile = std::max(0.0, std::min(100.0, percentile));
+  double targetCount = percentile / 100.0 * statistics->VoxelCount;
+  vtkIdType cumulativeCount = 0;
+  for (size_t bin = 0; bin < statistics->Histogram.size(); ++bin)
+    {
+    cumulativeCount += statistics->Histogram[bin];
+    if (cumulativeCount > 0 && cumulativeCount >= targetCount)
+      {
+      double value = this->HistogramOrigin + (statistics->HistogramFirstBin + bin) * this->HistogramSpacing;
+      return std::max(statistics->Minimum, std::min(statistics->Maximum, value));
+      }
+    }
+  return statistics->Maximum;
+}
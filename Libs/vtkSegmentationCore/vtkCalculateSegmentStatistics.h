@@ -0,0 +1,158 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// .NAME vtkCalculateSegmentStatistics - Calculate labelmap and scalar statistics of segments
+// .SECTION Description
+
+#ifndef __vtkCalculateSegmentStatistics_h
+#define __vtkCalculateSegmentStatistics_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <map>
+#include <string>
+#include <vector>
+
+#include "vtkSegmentationCoreConfigure.h"
+
+class vtkAbstractTransform;
+class vtkOrientedImageData;
+class vtkSegmentation;
+
+/// \ingroup SegmentationCore
+/// \brief Calculate voxel count, volume and scalar statistics of all segments of a segmentation
+///
+/// Binary labelmap representation of the segments is used. If a scalar image is specified then
+/// segment labelmaps are resampled to its geometry (only within the extent of each segment) and
+/// minimum, maximum, mean, standard deviation, median and percentiles of the scalar values inside
+/// the segments are calculated as well. All segments are processed in a single multi-threaded pass,
+/// each segment only within its extent.
+///
+/// Median and percentiles are computed from a histogram. The histogram has one bin for each value
+/// for integer scalar types (if the scalar range is not larger than the maximum number of bins),
+/// therefore the results are exact. For other images the maximum number of bins are used and the
+/// results are accurate up to the bin width.
+class vtkSegmentationCore_EXPORT vtkCalculateSegmentStatistics : public vtkObject
+{
+public:
+  static vtkCalculateSegmentStatistics *New();
+  vtkTypeMacro(vtkCalculateSegmentStatistics, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+public:
+  /// Calculate statistics for the selected segments (all segments if none is selected)
+  /// \return Success flag
+  bool CalculateStatistics();
+
+  /// Select segment for computation. If no segments are selected then all segments are used.
+  void AddSegmentID(const char* segmentID);
+  /// Clear segment selection (all segments will be used)
+  void RemoveAllSegmentIDs();
+
+  /// Returns true if statistics have been calculated for the segment
+  bool HasStatistics(const char* segmentID);
+  /// Returns true if scalar statistics (minimum, maximum, ...) have been calculated for the segment
+  bool HasScalarStatistics(const char* segmentID);
+
+  /// Number of voxels inside the segment.
+  /// If scalar image is specified then voxels are counted in the scalar image geometry.
+  vtkIdType GetVoxelCount(const char* segmentID);
+  /// Volume of the segment in mm3 (cubic millimeters)
+  double GetVolumeMm3(const char* segmentID);
+
+  /// Minimum scalar value inside the segment
+  double GetMinimum(const char* segmentID);
+  /// Maximum scalar value inside the segment
+  double GetMaximum(const char* segmentID);
+  /// Mean scalar value inside the segment
+  double GetMean(const char* segmentID);
+  /// Standard deviation (using N-1 normalization) of scalar values inside the segment
+  double GetStandardDeviation(const char* segmentID);
+  /// Median scalar value inside the segment
+  double GetMedian(const char* segmentID);
+  /// Percentile of scalar values inside the segment
+  /// \param percentile Percentile in the range of [0, 100]
+  double GetPercentile(const char* segmentID, double percentile);
+
+public:
+  /// Segmentation containing the segments. Binary labelmap representation is used.
+  vtkGetObjectMacro(Segmentation, vtkSegmentation);
+  vtkSetObjectMacro(Segmentation, vtkSegmentation);
+
+  /// Optional scalar image. If set then scalar statistics are computed as well.
+  /// Only the first scalar component is used.
+  vtkGetObjectMacro(ScalarImage, vtkOrientedImageData);
+  vtkSetObjectMacro(ScalarImage, vtkOrientedImageData);
+
+  /// Optional transform from the segmentation coordinate system to the scalar image coordinate system
+  vtkGetObjectMacro(SegmentationToScalarImageTransform, vtkAbstractTransform);
+  vtkSetObjectMacro(SegmentationToScalarImageTransform, vtkAbstractTransform);
+
+  /// Maximum number of histogram bins used for median and percentile computation.
+  /// Default is 65536.
+  vtkGetMacro(MaximumNumberOfHistogramBins, int);
+  vtkSetMacro(MaximumNumberOfHistogramBins, int);
+
+protected:
+  /// Statistics calculated for a single segment
+  struct SegmentStatistics
+    {
+    SegmentStatistics();
+    vtkIdType VoxelCount;
+    double VolumeMm3;
+    bool ScalarStatisticsValid;
+    double Minimum;
+    double Maximum;
+    double Mean;
+    double StandardDeviation;
+    /// Histogram of scalar values, trimmed to the bins between the minimum and the maximum
+    std::vector<vtkIdType> Histogram;
+    /// Index of the first bin of Histogram in the full histogram
+    int HistogramFirstBin;
+    };
+
+  /// Get statistics of a segment. Returns NULL if not available.
+  SegmentStatistics* GetSegmentStatistics(const char* segmentID);
+
+protected:
+  vtkSegmentation* Segmentation;
+  vtkOrientedImageData* ScalarImage;
+  vtkAbstractTransform* SegmentationToScalarImageTransform;
+  int MaximumNumberOfHistogramBins;
+
+  /// Segment IDs selected for computation
+  std::vector<std::string> SegmentIDs;
+
+  /// Computed statistics for each segment ID
+  std::map<std::string, SegmentStatistics> Statistics;
+
+  /// Value of the center of the first histogram bin
+  double HistogramOrigin;
+  /// Width of histogram bins
+  double HistogramSpacing;
+
+protected:
+  vtkCalculateSegmentStatistics();
+  virtual ~vtkCalculateSegmentStatistics();
+
+private:
+  vtkCalculateSegmentStatistics(const vtkCalculateSegmentStatistics&); // Not implemented
+  void operator=(const vtkCalculateSegmentStatistics&);               // Not implemented
+};
+
+#endif
@@ -44,6 +44,12 @@ vtkOrientedImageData::vtkOrientedImageData()
       this->Directions[i][j] = (i == j) ? 1.0 : 0.0;
       }
     }
+  this->SliceExtentTracking = false;
+  for (i = 0; i < 6; i++)
+    {
+    this->SliceEffectiveExtentsImageExtent[i] = 0;
+    }
+  this->SliceEffectiveExtentsMTime = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -376,3 +382,33 @@ bool vtkOrientedImageData::IsEmpty()
     }
   return false;
 }
+
+//----------------------------------------------------------------------------
+void vtkOrientedImageData::VoxelsModifiedInExtent(const int extent[6], vtkMTimeType mtimeBeforeModification)
+{
+  if (!this->SliceExtentTracking || this->SliceEffectiveExtentsMTime == 0)
+    {
+    return;
+    }
+  bool sameImageExtent = true;
+  for (int i = 0; i < 6; i++)
+    {
+    if (this->SliceEffectiveExtentsImageExtent[i] != this->Extent[i])
+      {
+      sameImageExtent = false;
+      }
+    }
+  if (this->SliceEffectiveExtentsMTime != mtimeBeforeModification || !sameImageExtent)
+    {
+    // Image was modified since the previous computation, all slices need to be scanned
+    this->SliceEffectiveExtentsMTime = 0;
+    return;
+    }
+  int firstSlice = std::max(extent[4], this->Extent[4]);
+  int lastSlice = std::min(extent[5], this->Extent[5]);
+  for (int k = firstSlice; k <= lastSlice; k++)
+    {
+    this->SliceEffectiveExtentsValid[k - this->Extent[4]] = 0;
+    }
+  this->SliceEffectiveExtentsMTime = this->GetMTime();
+}
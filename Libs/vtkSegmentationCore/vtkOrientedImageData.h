@@ -26,6 +26,9 @@
 
 #include "vtkImageData.h"
 
+// STD includes
+#include <vector>
+
 class vtkMatrix4x4;
 
 /// \ingroup SegmentationCore
@@ -84,6 +87,24 @@ public:
   /// Determines whether the image data is empty (if the extent has 0 voxels then it is)
   bool IsEmpty();
 
+  /// Keep track of the extent of non-zero voxels in each slice of the image.
+  /// If enabled, vtkOrientedImageDataResample::CalculateEffectiveExtent only scans those slices
+  /// that have been modified since the previous computation. Modifications made by
+  /// vtkOrientedImageDataResample::ModifyImage are tracked slice by slice, any other modification
+  /// of the image (that updates its modified time) requires scanning all slices again.
+  /// Disabled by default.
+  vtkGetMacro(SliceExtentTracking, bool);
+  vtkSetMacro(SliceExtentTracking, bool);
+  vtkBooleanMacro(SliceExtentTracking, bool);
+
+  /// Indicate that voxels of the image have been changed within the specified extent.
+  /// Must be called after Modified() has been called for the image.
+  /// Slice extent information is preserved for slices outside the extent if the image has not been
+  /// modified since the previous effective extent computation.
+  /// \param extent Extent of the modified region
+  /// \param mtimeBeforeModification Modified time of the image before the voxels were changed
+  void VoxelsModifiedInExtent(const int extent[6], vtkMTimeType mtimeBeforeModification);
+
 protected:
   vtkOrientedImageData();
   ~vtkOrientedImageData();
@@ -93,6 +114,17 @@ protected:
   /// These are unit length direction cosines
   double Directions[3][3];
 
+  bool SliceExtentTracking;
+  /// Extent of non-zero voxels in each slice (i min, i max, j min, j max). Used by vtkOrientedImageDataResample.
+  std::vector<int> SliceEffectiveExtents;
+  /// Non-zero for slices where SliceEffectiveExtents is up-to-date
+  std::vector<unsigned char> SliceEffectiveExtentsValid;
+  /// Image extent and modified time that SliceEffectiveExtents corresponds to (0 if not computed)
+  int SliceEffectiveExtentsImageExtent[6];
+  vtkMTimeType SliceEffectiveExtentsMTime;
+
+  friend class vtkOrientedImageDataResample;
+
 private:
   vtkOrientedImageData(const vtkOrientedImageData&);  // Not implemented.
   void operator=(const vtkOrientedImageData&);  // Not implemented.
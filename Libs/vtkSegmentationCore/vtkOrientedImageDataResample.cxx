@@ -26,6 +26,7 @@
 // VTK includes
 #include <vtkAppendPolyData.h>
 #include <vtkBoundingBox.h>
+#include <vtkDataArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImageReslice.h>
 #include <vtkImageConstantPad.h>
@@ -34,6 +35,8 @@
 #include <vtkObjectFactory.h>
 #include <vtkPlaneSource.h>
 #include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -42,9 +45,174 @@
 
 // STD includes
 #include <algorithm>
+#include <cstring>
 
 vtkStandardNewMacro(vtkOrientedImageDataResample);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Combine modifier image into base image. Rows of the update extent are processed in parallel.
+/// In each row only the voxels between the first and last voxel that the operation may change are
+/// visited (similarly to how CalculateEffectiveExtent finds the non-empty part of rows), therefore
+/// empty regions are skipped quickly. If the slice effective extents of the modifier image are known
+/// then rows and voxels outside them are not visited at all.
+template <class BaseImageScalarType, class ModifierImageScalarType>
+class MergeImageFunctor
+{
+public:
+  MergeImageFunctor(int operation, BaseImageScalarType* baseImagePtr, ModifierImageScalarType* modifierImagePtr,
+    vtkIdType rowLength, vtkIdType numberOfRowsPerSlice)
+    : Operation(operation)
+    , BaseImagePtr(baseImagePtr)
+    , ModifierImagePtr(modifierImagePtr)
+    , RowLength(rowLength)
+    , NumberOfRowsPerSlice(numberOfRowsPerSlice)
+    , BaseIncY(0)
+    , BaseIncZ(0)
+    , ModifierIncY(0)
+    , ModifierIncZ(0)
+    , ModifierSliceExtents(NULL)
+    , ModifierSliceExtentsOffset(0)
+    , UpdateExtentMinI(0)
+    , UpdateExtentMinJ(0)
+    , NumberOfComponents(1)
+    , BaseMinimum(0)
+    , FillValue(0)
+    , MaskThreshold(0)
+    , Modified(false)
+  {
+  }
+
+  void Initialize()
+  {
+    this->LocalModified.Local() = 0;
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow)
+  {
+    unsigned char& modified = this->LocalModified.Local();
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+      {
+      vtkIdType y = row % this->NumberOfRowsPerSlice;
+      vtkIdType z = row / this->NumberOfRowsPerSlice;
+      BaseImageScalarType* basePtr = this->BaseImagePtr + y * this->BaseIncY + z * this->BaseIncZ;
+      ModifierImageScalarType* modifierPtr = this->ModifierImagePtr + y * this->ModifierIncY + z * this->ModifierIncZ;
+      vtkIdType first = 0;
+      vtkIdType last = this->RowLength - 1;
+      if (this->ModifierSliceExtents)
+        {
+        // Only the non-zero part of the modifier image can change the base image
+        const int* sliceExtent = this->ModifierSliceExtents + 4 * (z + this->ModifierSliceExtentsOffset);
+        vtkIdType j = y + this->UpdateExtentMinJ;
+        if (sliceExtent[0] > sliceExtent[1] || j < sliceExtent[2] || j > sliceExtent[3])
+          {
+          continue;
+          }
+        first = std::max(first, (sliceExtent[0] - this->UpdateExtentMinI) * this->NumberOfComponents);
+        last = std::min(last, (sliceExtent[1] - this->UpdateExtentMinI + 1) * this->NumberOfComponents - 1);
+        }
+      if (this->Operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
+        {
+        // Modifier voxels at the minimum value of the base image type cannot increase the base image
+        while (first <= last && static_cast<BaseImageScalarType>(modifierPtr[first]) <= this->BaseMinimum)
+          {
+          ++first;
+          }
+        while (last > first && static_cast<BaseImageScalarType>(modifierPtr[last]) <= this->BaseMinimum)
+          {
+          --last;
+          }
+        for (vtkIdType i = first; i <= last; ++i)
+          {
+          if (static_cast<BaseImageScalarType>(modifierPtr[i]) > basePtr[i])
+            {
+            basePtr[i] = static_cast<BaseImageScalarType>(modifierPtr[i]);
+            modified = 1;
+            }
+          }
+        }
+      else if (this->Operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
+        {
+        // Base voxels at the minimum value of the base image type cannot be decreased
+        while (first <= last && basePtr[first] <= this->BaseMinimum)
+          {
+          ++first;
+          }
+        while (last > first && basePtr[last] <= this->BaseMinimum)
+          {
+          --last;
+          }
+        for (vtkIdType i = first; i <= last; ++i)
+          {
+          if (static_cast<BaseImageScalarType>(modifierPtr[i]) < basePtr[i])
+            {
+            basePtr[i] = static_cast<BaseImageScalarType>(modifierPtr[i]);
+            modified = 1;
+            }
+          }
+        }
+      else if (this->Operation == vtkOrientedImageDataResample::OPERATION_MASKING)
+        {
+        while (first <= last && modifierPtr[first] <= this->MaskThreshold)
+          {
+          ++first;
+          }
+        while (last > first && modifierPtr[last] <= this->MaskThreshold)
+          {
+          --last;
+          }
+        for (vtkIdType i = first; i <= last; ++i)
+          {
+          if (modifierPtr[i] > this->MaskThreshold)
+            {
+            basePtr[i] = this->FillValue;
+            modified = 1;
+            }
+          }
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    this->Modified = false;
+    for (typename vtkSMPThreadLocal<unsigned char>::iterator localIt = this->LocalModified.begin();
+      localIt != this->LocalModified.end(); ++localIt)
+      {
+      if (*localIt)
+        {
+        this->Modified = true;
+        }
+      }
+  }
+
+  int Operation;
+  BaseImageScalarType* BaseImagePtr;
+  ModifierImageScalarType* ModifierImagePtr;
+  vtkIdType RowLength;
+  vtkIdType NumberOfRowsPerSlice;
+  vtkIdType BaseIncY;
+  vtkIdType BaseIncZ;
+  vtkIdType ModifierIncY;
+  vtkIdType ModifierIncZ;
+  /// Slice effective extents of the modifier image (i min, i max, j min, j max), NULL if not known
+  const int* ModifierSliceExtents;
+  /// Index of the first slice of the update extent in ModifierSliceExtents
+  vtkIdType ModifierSliceExtentsOffset;
+  vtkIdType UpdateExtentMinI;
+  vtkIdType UpdateExtentMinJ;
+  vtkIdType NumberOfComponents;
+  BaseImageScalarType BaseMinimum;
+  BaseImageScalarType FillValue;
+  ModifierImageScalarType MaskThreshold;
+  vtkSMPThreadLocal<unsigned char> LocalModified;
+  bool Modified;
+};
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 template <class BaseImageScalarType, class ModifierImageScalarType>
@@ -54,7 +222,8 @@ void MergeImageGeneric2(
     int operation,
     const int extent[6],
     double maskThreshold,
-    double fillValue)
+    double fillValue,
+    const int* modifierSliceExtents)
 {
   // Compute update extent as intersection of base and modifier image extents (extent can be further reduced by specifying a smaller extent)
   int updateExt[6] = { 0, -1, 0, -1, 0, -1 };
@@ -85,18 +254,6 @@ void MergeImageGeneric2(
     return;
     }
 
-  // Get increments to march through data
-  vtkIdType baseIncX = 0;
-  vtkIdType baseIncY = 0;
-  vtkIdType baseIncZ = 0;
-  vtkIdType modifierIncX = 0;
-  vtkIdType modifierIncY = 0;
-  vtkIdType modifierIncZ = 0;
-  baseImage->GetContinuousIncrements(updateExt, baseIncX, baseIncY, baseIncZ);
-  modifierImage->GetContinuousIncrements(updateExt, modifierIncX, modifierIncY, modifierIncZ);
-  int maxX = (updateExt[1] - updateExt[0]) * baseImage->GetNumberOfScalarComponents();
-  int maxY = updateExt[3] - updateExt[2];
-  int maxZ = updateExt[5] - updateExt[4];
   BaseImageScalarType* baseImagePtr = static_cast<BaseImageScalarType*>(baseImage->GetScalarPointerForExtent(updateExt));
   ModifierImageScalarType* modifierImagePtr = static_cast<ModifierImageScalarType*>(modifierImage->GetScalarPointerForExtent(updateExt));
 
@@ -111,116 +268,65 @@ void MergeImageGeneric2(
     return;
     }
 
-  bool baseImageModified = false;
+  vtkIdType rowLength = static_cast<vtkIdType>(updateExt[1] - updateExt[0] + 1) * baseImage->GetNumberOfScalarComponents();
+  vtkIdType numberOfRowsPerSlice = updateExt[3] - updateExt[2] + 1;
+  vtkIdType numberOfRows = numberOfRowsPerSlice * (updateExt[5] - updateExt[4] + 1);
+  MergeImageFunctor<BaseImageScalarType, ModifierImageScalarType> functor(
+    operation, baseImagePtr, modifierImagePtr, rowLength, numberOfRowsPerSlice);
 
-  // Loop through output pixels
-  // There is difference in only one line between min/max computation but the comparison
-  // is performed for each pixel, so it is faster to make the conditional expression in the outer loop.
-  // Looping is performed in two step: first we just check if any of the pixels have to be changed,
-  // if we find any, then we set baseImageModified flag and to the second loop without need to set
-  // baseImageModified flag again (setting a flag in a hot loop may impact speed).
-  if (operation == vtkOrientedImageDataResample::OPERATION_MAXIMUM)
-    {
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
-      {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
-        {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if (static_cast<BaseImageScalarType>(*modifierImagePtr) > *baseImagePtr)
-            {
-            *baseImagePtr = *modifierImagePtr;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
-          }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
-        }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
-      }
-    }
-  else if (operation == vtkOrientedImageDataResample::OPERATION_MINIMUM)
+  // Get increments to march through data
+  vtkIdType incX = 0;
+  baseImage->GetIncrements(incX, functor.BaseIncY, functor.BaseIncZ);
+  modifierImage->GetIncrements(incX, functor.ModifierIncY, functor.ModifierIncZ);
+  if (modifierSliceExtents)
     {
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
-      {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
-        {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if (static_cast<BaseImageScalarType>(*modifierImagePtr) < *baseImagePtr)
-            {
-            *baseImagePtr = *modifierImagePtr;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
-          }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
-        }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
-      }
+    functor.ModifierSliceExtents = modifierSliceExtents;
+    functor.ModifierSliceExtentsOffset = updateExt[4] - modifierExt[4];
+    functor.UpdateExtentMinI = updateExt[0];
+    functor.UpdateExtentMinJ = updateExt[2];
+    functor.NumberOfComponents = baseImage->GetNumberOfScalarComponents();
     }
-  else if (operation == vtkOrientedImageDataResample::OPERATION_MASKING)
-    {
+  functor.BaseMinimum = static_cast<BaseImageScalarType>(baseImage->GetScalarTypeMin());
 
+  if (operation == vtkOrientedImageDataResample::OPERATION_MASKING)
+    {
     // Make sure the fill value is valid for the base image scalar range
-    BaseImageScalarType fillValueBaseImageType = 0;
     if (fillValue < baseImage->GetScalarTypeMin())
       {
-      fillValueBaseImageType = static_cast<BaseImageScalarType>(baseImage->GetScalarTypeMin());
+      functor.FillValue = static_cast<BaseImageScalarType>(baseImage->GetScalarTypeMin());
       }
     else if (fillValue > baseImage->GetScalarTypeMax())
       {
-      fillValueBaseImageType = static_cast<BaseImageScalarType>(baseImage->GetScalarTypeMax());
+      functor.FillValue = static_cast<BaseImageScalarType>(baseImage->GetScalarTypeMax());
       }
     else
       {
-      fillValueBaseImageType = static_cast<BaseImageScalarType>(fillValue);
+      functor.FillValue = static_cast<BaseImageScalarType>(fillValue);
       }
 
     // Make sure the threshold is valid for the modifier scalar range
-    ModifierImageScalarType maskThresholdModifierType = 0;
     if (maskThreshold < modifierImage->GetScalarTypeMin())
       {
-      maskThresholdModifierType = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMin());
+      functor.MaskThreshold = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMin());
       }
     else if (maskThreshold > modifierImage->GetScalarTypeMax())
       {
-      maskThresholdModifierType = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMax());
+      functor.MaskThreshold = static_cast<ModifierImageScalarType>(modifierImage->GetScalarTypeMax());
       }
     else
       {
-      maskThresholdModifierType = static_cast<ModifierImageScalarType>(maskThreshold);
-      }
-
-    for (vtkIdType idxZ = 0; idxZ <= maxZ; idxZ++)
-      {
-      for (vtkIdType idxY = 0; idxY <= maxY; idxY++)
-        {
-        for (vtkIdType idxX = 0; idxX <= maxX; idxX++)
-          {
-          if ((*modifierImagePtr) > maskThresholdModifierType)
-            {
-            *baseImagePtr = fillValueBaseImageType;
-            baseImageModified = true;
-            }
-          baseImagePtr++;
-          modifierImagePtr++;
-        }
-        baseImagePtr += baseIncY;
-        modifierImagePtr += modifierIncY;
-        }
-      baseImagePtr += baseIncZ;
-      modifierImagePtr += modifierIncZ;
+      functor.MaskThreshold = static_cast<ModifierImageScalarType>(maskThreshold);
       }
     }
-  if (baseImageModified)
+
+  // Process at least about 64k voxels in each work item to keep the threading overhead low for small images
+  vtkIdType grain = std::max(static_cast<vtkIdType>(1), static_cast<vtkIdType>(65536) / rowLength);
+  vtkSMPTools::For(0, numberOfRows, grain, functor);
+
+  if (functor.Modified)
     {
+    // Scalars are marked as modified as well, to let images that share them (shallow copies) know about the change
+    baseImage->GetPointData()->GetScalars()->Modified();
     baseImage->Modified();
     }
 }
@@ -233,7 +339,8 @@ void MergeImageGeneric(
     int operation,
     const int extent[6],
     double maskThreshold,
-    double fillValue)
+    double fillValue,
+    const int* modifierSliceExtents)
 {
   switch (modifierImage->GetScalarType())
     {
@@ -243,7 +350,8 @@ void MergeImageGeneric(
                         operation,
                         extent,
                         maskThreshold,
-                        fillValue)));
+                        fillValue,
+                        modifierSliceExtents)));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
     }
@@ -538,74 +646,174 @@ bool vtkOrientedImageDataResample::IsEqual(vtkMatrix4x4* lhs, vtkMatrix4x4* rhs)
           AreEqualWithTolerance(lhs->GetElement(3,3), rhs->GetElement(3,3));
 }
 
-//----------------------------------------------------------------------------
-template <typename T> void CalculateEffectiveExtentGeneric(vtkOrientedImageData* image, int effectiveExtent[6], T threshold)
+namespace
 {
-  // Get increments to march through image
-  int *wholeExt = image->GetExtent();
 
-  effectiveExtent[0] = wholeExt[1]+1;
-  effectiveExtent[1] = wholeExt[0]-1;
-  effectiveExtent[2] = wholeExt[3]+1;
-  effectiveExtent[3] = wholeExt[2]-1;
-  effectiveExtent[4] = wholeExt[5]+1;
-  effectiveExtent[5] = wholeExt[4]-1;
+//----------------------------------------------------------------------------
+/// Get index of the first value that is above the threshold, count if there is none
+template <typename T> int FindFirstAboveThreshold(const T* values, int count, int stride, T threshold)
+{
+  for (int i = 0; i < count; i++)
+    {
+    if (values[i * stride] > threshold)
+      {
+      return i;
+      }
+    }
+  return count;
+}
 
-  if (image->GetScalarPointer() == NULL)
+//----------------------------------------------------------------------------
+/// Get index of the last value that is above the threshold, -1 if there is none
+template <typename T> int FindLastAboveThreshold(const T* values, int count, int stride, T threshold)
+{
+  for (int i = count - 1; i >= 0; i--)
     {
-    // no image data is allocated, return with empty extent
-    return;
+    if (values[i * stride] > threshold)
+      {
+      return i;
+      }
     }
+  return -1;
+}
 
-  // Loop through output pixels
-  for (int k = wholeExt[4]; k <= wholeExt[5]; k++)
+//----------------------------------------------------------------------------
+/// Binary labelmaps are usually unsigned char images with mostly zero voxels,
+/// so zero voxels are skipped 8 at a time.
+template <> int FindFirstAboveThreshold<unsigned char>(const unsigned char* values, int count, int stride, unsigned char threshold)
+{
+  int i = 0;
+  if (stride == 1 && threshold == 0)
     {
-    for (int j = wholeExt[2]; j <= wholeExt[3]; j++)
+    for (; i + 8 <= count; i += 8)
       {
-      bool currentLineInEffectiveExtent = (k >= effectiveExtent[4] && k <= effectiveExtent[5] && j >= effectiveExtent[2] && j <= effectiveExtent[3]);
-      int i = wholeExt[0];
-      T* imagePtr = static_cast<T*>(image->GetScalarPointer(i,j,k));
-      int firstSegmentEnd = currentLineInEffectiveExtent ? effectiveExtent[0] : wholeExt[1];
-      for (; i <= firstSegmentEnd; i++)
+      vtkTypeUInt64 word = 0;
+      memcpy(&word, values + i, sizeof(word));
+      if (word != 0)
         {
-        if (*(imagePtr++) > threshold)
-          {
-          if (i < effectiveExtent[0]) { effectiveExtent[0] = i; }
-          if (i > effectiveExtent[1]) { effectiveExtent[1] = i; }
-          if (j < effectiveExtent[2]) { effectiveExtent[2] = j; }
-          if (j > effectiveExtent[3]) { effectiveExtent[3] = j; }
-          if (k < effectiveExtent[4]) { effectiveExtent[4] = k; }
-          if (k > effectiveExtent[5]) { effectiveExtent[5] = k; }
-          currentLineInEffectiveExtent = true;
-          break;
-          }
+        break;
         }
-      if (!currentLineInEffectiveExtent)
-        {
-        // We haven't found any non-empty voxel in this line
-        continue;
-        }
-      // Now we need to find the other end of the extent: the last non-empty voxel in the line.
-      // The fastest way to find it is to start backward search from the end of the line.
-      i = wholeExt[1];
-      imagePtr = static_cast<T*>(image->GetScalarPointer(i,j,k));
-      for (; i > effectiveExtent[1]; i--)
+      }
+    }
+  for (; i < count; i++)
+    {
+    if (values[i * stride] > threshold)
+      {
+      return i;
+      }
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+template <> int FindLastAboveThreshold<unsigned char>(const unsigned char* values, int count, int stride, unsigned char threshold)
+{
+  int i = count - 1;
+  if (stride == 1 && threshold == 0)
+    {
+    for (; i >= 7; i -= 8)
+      {
+      vtkTypeUInt64 word = 0;
+      memcpy(&word, values + i - 7, sizeof(word));
+      if (word != 0)
         {
-        if (*(imagePtr--)>threshold)
-          {
-          if (i < effectiveExtent[0]) { effectiveExtent[0] = i; }
-          if (i > effectiveExtent[1]) { effectiveExtent[1] = i; }
-          if (j < effectiveExtent[2]) { effectiveExtent[2] = j; }
-          if (j > effectiveExtent[3]) { effectiveExtent[3] = j; }
-          if (k < effectiveExtent[4]) { effectiveExtent[4] = k; }
-          if (k > effectiveExtent[5]) { effectiveExtent[5] = k; }
-          break;
-          }
+        break;
         }
       }
     }
+  for (; i >= 0; i--)
+    {
+    if (values[i * stride] > threshold)
+      {
+      return i;
+      }
+    }
+  return -1;
 }
 
+//----------------------------------------------------------------------------
+/// Compute extent of voxels above threshold in a slice: (i min, i max, j min, j max).
+/// Only the first component is considered.
+template <typename T> void CalculateSliceEffectiveExtent(vtkImageData* image, int k, T threshold, int sliceExtent[4])
+{
+  int* wholeExt = image->GetExtent();
+  sliceExtent[0] = wholeExt[1] + 1;
+  sliceExtent[1] = wholeExt[0] - 1;
+  sliceExtent[2] = wholeExt[3] + 1;
+  sliceExtent[3] = wholeExt[2] - 1;
+  const int stride = image->GetNumberOfScalarComponents();
+  const int rowLength = wholeExt[1] - wholeExt[0] + 1;
+  for (int j = wholeExt[2]; j <= wholeExt[3]; j++)
+    {
+    const T* rowPtr = static_cast<T*>(image->GetScalarPointer(wholeExt[0], j, k));
+    int first = FindFirstAboveThreshold<T>(rowPtr, rowLength, stride, threshold);
+    if (first >= rowLength)
+      {
+      // empty row
+      continue;
+      }
+    if (sliceExtent[2] > j)
+      {
+      sliceExtent[2] = j;
+      }
+    sliceExtent[3] = j;
+    if (wholeExt[0] + first < sliceExtent[0])
+      {
+      sliceExtent[0] = wholeExt[0] + first;
+      }
+    if (wholeExt[0] + first > sliceExtent[1])
+      {
+      sliceExtent[1] = wholeExt[0] + first;
+      }
+    // Only the part of the row beyond the current maximum needs to be searched
+    int searchStart = sliceExtent[1] - wholeExt[0] + 1;
+    int last = FindLastAboveThreshold<T>(rowPtr + searchStart * stride, rowLength - searchStart, stride, threshold);
+    if (last >= 0)
+      {
+      sliceExtent[1] = wholeExt[0] + searchStart + last;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Compute effective extent of the listed slices in parallel.
+/// Results are written to sliceExtents (4 values for each slice of the image).
+template <typename T> class CalculateSliceEffectiveExtentsFunctor
+{
+public:
+  CalculateSliceEffectiveExtentsFunctor(vtkImageData* image, const std::vector<int>& slices, T threshold, int* sliceExtents)
+    : Image(image)
+    , Slices(slices)
+    , Threshold(threshold)
+    , SliceExtents(sliceExtents)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    int firstSlice = this->Image->GetExtent()[4];
+    for (vtkIdType sliceIndex = begin; sliceIndex < end; sliceIndex++)
+      {
+      int k = this->Slices[sliceIndex];
+      CalculateSliceEffectiveExtent<T>(this->Image, k, this->Threshold, this->SliceExtents + 4 * (k - firstSlice));
+      }
+  }
+
+  vtkImageData* Image;
+  const std::vector<int>& Slices;
+  T Threshold;
+  int* SliceExtents;
+};
+
+//----------------------------------------------------------------------------
+template <typename T> void CalculateSliceEffectiveExtents(vtkImageData* image, const std::vector<int>& slices, T threshold, int* sliceExtents)
+{
+  CalculateSliceEffectiveExtentsFunctor<T> functor(image, slices, threshold, sliceExtents);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(slices.size()), functor);
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::CalculateEffectiveExtent(vtkOrientedImageData* image, int effectiveExtent[6], double threshold /*=0.0*/)
 {
@@ -614,14 +822,92 @@ bool vtkOrientedImageDataResample::CalculateEffectiveExtent(vtkOrientedImageData
     return false;
     }
 
-  switch (image->GetScalarType())
+  int* wholeExt = image->GetExtent();
+  effectiveExtent[0] = wholeExt[1]+1;
+  effectiveExtent[1] = wholeExt[0]-1;
+  effectiveExtent[2] = wholeExt[3]+1;
+  effectiveExtent[3] = wholeExt[2]-1;
+  effectiveExtent[4] = wholeExt[5]+1;
+  effectiveExtent[5] = wholeExt[4]-1;
+
+  if (image->IsEmpty() || image->GetScalarPointer() == NULL)
     {
-    vtkTemplateMacro(CalculateEffectiveExtentGeneric<VTK_TT>(image, effectiveExtent, threshold));
-  default:
-    vtkGenericWarningMacro("vtkOrientedImageDataResample::CalculateEffectiveExtent: Unknown ScalarType");
+    // no image data is allocated, return with empty extent
     return false;
     }
 
+  // Slice extents are only stored for the default threshold.
+  // If the image is not modified then stored slice extents can be used for all slices.
+  const int numberOfSlices = wholeExt[5] - wholeExt[4] + 1;
+  std::vector<int> temporarySliceExtents;
+  std::vector<unsigned char> temporarySliceExtentsValid;
+  std::vector<int>* sliceExtents = &temporarySliceExtents;
+  std::vector<unsigned char>* sliceExtentsValid = &temporarySliceExtentsValid;
+  bool storeSliceExtents = (image->SliceExtentTracking && threshold == 0.0);
+  if (storeSliceExtents)
+    {
+    sliceExtents = &(image->SliceEffectiveExtents);
+    sliceExtentsValid = &(image->SliceEffectiveExtentsValid);
+    bool storedSliceExtentsValid = (image->SliceEffectiveExtentsMTime == image->GetMTime()
+      && static_cast<int>(sliceExtentsValid->size()) == numberOfSlices);
+    for (int i = 0; i < 6 && storedSliceExtentsValid; i++)
+      {
+      storedSliceExtentsValid = (image->SliceEffectiveExtentsImageExtent[i] == wholeExt[i]);
+      }
+    if (!storedSliceExtentsValid)
+      {
+      sliceExtentsValid->clear();
+      }
+    }
+  sliceExtents->resize(4 * numberOfSlices);
+  sliceExtentsValid->resize(numberOfSlices, 0);
+
+  // Scan slices that are not up-to-date
+  std::vector<int> slicesToScan;
+  for (int k = wholeExt[4]; k <= wholeExt[5]; k++)
+    {
+    if (!(*sliceExtentsValid)[k - wholeExt[4]])
+      {
+      slicesToScan.push_back(k);
+      }
+    }
+  if (!slicesToScan.empty())
+    {
+    switch (image->GetScalarType())
+      {
+      vtkTemplateMacro(CalculateSliceEffectiveExtents<VTK_TT>(image, slicesToScan, static_cast<VTK_TT>(threshold), &((*sliceExtents)[0])));
+    default:
+      vtkGenericWarningMacro("vtkOrientedImageDataResample::CalculateEffectiveExtent: Unknown ScalarType");
+      return false;
+      }
+    std::fill(sliceExtentsValid->begin(), sliceExtentsValid->end(), 1);
+    }
+  if (storeSliceExtents)
+    {
+    for (int i = 0; i < 6; i++)
+      {
+      image->SliceEffectiveExtentsImageExtent[i] = wholeExt[i];
+      }
+    image->SliceEffectiveExtentsMTime = image->GetMTime();
+    }
+
+  // Combine slice extents
+  for (int k = wholeExt[4]; k <= wholeExt[5]; k++)
+    {
+    const int* sliceExtent = &((*sliceExtents)[4 * (k - wholeExt[4])]);
+    if (sliceExtent[0] > sliceExtent[1])
+      {
+      // empty slice
+      continue;
+      }
+    effectiveExtent[0] = std::min(effectiveExtent[0], sliceExtent[0]);
+    effectiveExtent[1] = std::max(effectiveExtent[1], sliceExtent[1]);
+    effectiveExtent[2] = std::min(effectiveExtent[2], sliceExtent[2]);
+    effectiveExtent[3] = std::max(effectiveExtent[3], sliceExtent[3]);
+    effectiveExtent[4] = std::min(effectiveExtent[4], k);
+    effectiveExtent[5] = std::max(effectiveExtent[5], k);
+    }
+
   // Return with failure if effective input extent is empty
   if ( effectiveExtent[0] > effectiveExtent[1] || effectiveExtent[2] > effectiveExtent[3] || effectiveExtent[4] > effectiveExtent[5] )
     {
@@ -1044,6 +1330,9 @@ bool vtkOrientedImageDataResample::MergeImage(
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Failed to pad segment labelmap");
     return false;
     }
+  int clippedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  const int* modifierSliceExtents = vtkOrientedImageDataResample::ClipExtentToModifierEffectiveExtent(
+    outputImage, imageToAppend, operation, maskThreshold, extent, clippedExtent);
   vtkMTimeType outputImageMTimeBefore = outputImage->GetMTime();
   switch (inputImage->GetScalarType())
     {
@@ -1051,9 +1340,10 @@ bool vtkOrientedImageDataResample::MergeImage(
                        outputImage,
                        imageToAppend,
                        operation,
-                       extent,
+                       clippedExtent,
                        maskThreshold,
-                       fillValue));
+                       fillValue,
+                       modifierSliceExtents));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::MergeImage: Unknown ScalarType");
     return false;
@@ -1084,6 +1374,11 @@ bool vtkOrientedImageDataResample::ModifyImage(
     vtkGenericWarningMacro("vtkOrientedImageDataResample::ModifyImage failed: geometry mismatch between inputImage and modifierImage");
     return false;
     }
+  int clippedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  const int* modifierSliceExtents = vtkOrientedImageDataResample::ClipExtentToModifierEffectiveExtent(
+    inputImage, modifierImage, operation, maskThreshold, extent, clippedExtent);
+  extent = clippedExtent;
+  vtkMTimeType inputImageMTimeBefore = inputImage->GetMTime();
   switch (inputImage->GetScalarType())
     {
     vtkTemplateMacro(MergeImageGeneric<VTK_TT>(
@@ -1092,14 +1387,77 @@ bool vtkOrientedImageDataResample::ModifyImage(
                        operation,
                        extent,
                        maskThreshold,
-                       fillValue));
+                       fillValue,
+                       modifierSliceExtents));
   default:
     vtkGenericWarningMacro("vtkOrientedImageDataResample::ModifyImage failed: unknown ScalarType");
     return false;
     }
+  if (inputImage->GetMTime() != inputImageMTimeBefore)
+    {
+    // Voxels may only be changed within the modifier image extent (and the specified or the modifier effective extent)
+    int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    modifierImage->GetExtent(modifiedExtent);
+    if (extent)
+      {
+      for (int i = 0; i < 3; i++)
+        {
+        modifiedExtent[i * 2] = std::max(modifiedExtent[i * 2], extent[i * 2]);
+        modifiedExtent[i * 2 + 1] = std::min(modifiedExtent[i * 2 + 1], extent[i * 2 + 1]);
+        }
+      }
+    inputImage->VoxelsModifiedInExtent(modifiedExtent, inputImageMTimeBefore);
+    }
   return true;
 }
 
+//----------------------------------------------------------------------------
+const int* vtkOrientedImageDataResample::ClipExtentToModifierEffectiveExtent(vtkImageData* baseImage,
+  vtkOrientedImageData* modifierImage, int operation, double maskThreshold, const int extent[6], int clippedExtent[6])
+{
+  modifierImage->GetExtent(clippedExtent);
+  for (int i = 0; extent && i < 6; i++)
+    {
+    clippedExtent[i] = extent[i];
+    }
+  if (!modifierImage->GetSliceExtentTracking())
+    {
+    // Computing the effective extent would require scanning the whole modifier image
+    return NULL;
+    }
+  // Zero voxels of the modifier image can only change the base image if negative values are involved
+  bool zeroVoxelsIgnored = false;
+  if (operation == OPERATION_MAXIMUM)
+    {
+    zeroVoxelsIgnored = (baseImage->GetScalarTypeMin() >= 0 && modifierImage->GetScalarTypeMin() >= 0);
+    }
+  else if (operation == OPERATION_MASKING)
+    {
+    zeroVoxelsIgnored = (maskThreshold >= 0);
+    }
+  if (!zeroVoxelsIgnored)
+    {
+    return NULL;
+    }
+  int effectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!vtkOrientedImageDataResample::CalculateEffectiveExtent(modifierImage, effectiveExtent))
+    {
+    // modifier image is empty, it cannot change anything
+    for (int i = 0; i < 3; i++)
+      {
+      clippedExtent[i * 2] = 0;
+      clippedExtent[i * 2 + 1] = -1;
+      }
+    return NULL;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    clippedExtent[i * 2] = std::max(clippedExtent[i * 2], effectiveExtent[i * 2]);
+    clippedExtent[i * 2 + 1] = std::min(clippedExtent[i * 2 + 1], effectiveExtent[i * 2 + 1]);
+    }
+  return &(modifierImage->SliceEffectiveExtents[0]);
+}
+
 //----------------------------------------------------------------------------
 bool vtkOrientedImageDataResample::CopyImage(vtkOrientedImageData* imageToCopy, vtkOrientedImageData* outputImage, const int extent[6]/*=0*/)
 {
@@ -101,7 +101,10 @@ public:
   static void FillImage(vtkImageData* image, double fillValue, const int extent[6]=NULL);
 
 public:
-  /// Calculate effective extent of an image: the IJK extent where non-zero voxels are located
+  /// Calculate effective extent of an image: the IJK extent where non-zero voxels are located.
+  /// Slices are scanned in parallel. If slice extent tracking is enabled in the image
+  /// (see vtkOrientedImageData::SetSliceExtentTracking) then only slices that have been modified
+  /// since the previous computation are scanned.
   static bool CalculateEffectiveExtent(vtkOrientedImageData* image, int effectiveExtent[6], double threshold = 0.0);
 
   /// Determine if geometries of two oriented image data objects match.
@@ -156,6 +159,17 @@ protected:
   vtkOrientedImageDataResample();
   ~vtkOrientedImageDataResample();
 
+  /// Get the extent where voxels of modifierImage can change the base image in the given operation
+  /// (non-zero voxels for maximum and masking operations), clipped to the specified extent.
+  /// It is only computed if it is cheap, i.e., if slice extent tracking is enabled in modifierImage.
+  /// \param extent Extent to clip, the extent of modifierImage is used if NULL
+  /// \param clippedExtent Output extent, it is a copy of the input extent if the effective extent is not computed
+  /// 
+eturn Effective extents of the slices of modifierImage (see vtkOrientedImageData::SliceEffectiveExtents),
+  ///   NULL if the effective extent is not computed.
+  static const int* ClipExtentToModifierEffectiveExtent(vtkImageData* baseImage, vtkOrientedImageData* modifierImage,
+    int operation, double maskThreshold, const int extent[6], int clippedExtent[6]);
+
 private:
   vtkOrientedImageDataResample(const vtkOrientedImageDataResample&);  // Not implemented.
   void operator=(const vtkOrientedImageDataResample&);  // Not implemented.
@@ -37,11 +37,14 @@
 #include <vtkPolyDataNormals.h>
 #include <vtkTriangleFilter.h>
 #include <vtkStripper.h>
-#include <vtkImageStencil.h>
-#include <vtkImageCast.h>
+#include <vtkMath.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
 
 // std includes
+#include <algorithm>
 #include <map>
+#include <vector>
 
 vtkStandardNewMacro(vtkPolyDataToFractionalLabelmapFilter);
 
@@ -50,14 +53,6 @@ vtkPolyDataToFractionalLabelmapFilter::vtkPolyDataToFractionalLabelmapFilter()
 {
   this->NumberOfOffsets = 6;
 
-  this->LinesCache = std::map<double, vtkSmartPointer<vtkCellArray> >();
-  this->SliceCache = std::map<double, vtkSmartPointer<vtkPolyData> >();
-  this->PointIdsCache = std::map<double, vtkIdType*>();
-  this->NptsCache = std::map<double, vtkIdType>();
-  this->PointNeighborCountsCache = std::map<double,  vtkSmartPointer<vtkIdTypeArray> >();
-
-  this->CellLocator = vtkCellLocator::New();
-
   this->OutputImageTransformData = vtkOrientedImageData::New();
 
   vtkOrientedImageData* output = vtkOrientedImageData::New();
@@ -72,7 +67,6 @@ vtkPolyDataToFractionalLabelmapFilter::vtkPolyDataToFractionalLabelmapFilter()
 vtkPolyDataToFractionalLabelmapFilter::~vtkPolyDataToFractionalLabelmapFilter()
 {
   this->OutputImageTransformData->Delete();
-  this->CellLocator->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -368,516 +362,482 @@ vtkOrientedImageData* vtkPolyDataToFractionalLabelmapFilter::AllocateOutputData(
   return outputData;
 }
 
-//----------------------------------------------------------------------------
-int vtkPolyDataToFractionalLabelmapFilter::RequestData(
-  vtkInformation *vtkNotUsed(request),
-  vtkInformationVector **inputVector,
-  vtkInformationVector *outputVector)
-{
-
-  vtkInformation *outInfo = outputVector->GetInformationObject(0);
-  vtkOrientedImageData *outputData = vtkOrientedImageData::SafeDownCast(
-    outInfo->Get(vtkDataObject::DATA_OBJECT()));
-
-    this->AllocateOutputData(
-    outputData,
-    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT()));
-
-  vtkInformation *inputInfo = inputVector[0]->GetInformationObject(0);
-  vtkPolyData *inputData = vtkPolyData::SafeDownCast(
-    inputInfo->Get(vtkDataObject::DATA_OBJECT()));
-
-  vtkSmartPointer<vtkMatrix4x4> outputLabelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  this->OutputImageTransformData->GetImageToWorldMatrix(outputLabelmapImageToWorldMatrix);
-  outputData->SetImageToWorldMatrix(outputLabelmapImageToWorldMatrix);
-  outputData->SetExtent(this->OutputWholeExtent);
-
-  vtkSmartPointer<vtkTransform> inverseOutputLabelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
-  inverseOutputLabelmapGeometryTransform->SetMatrix(outputLabelmapImageToWorldMatrix);
-  inverseOutputLabelmapGeometryTransform->Inverse();
-
-  // Transform the polydata from RAS to IJK space
-  vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter =
-    vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  transformPolyDataFilter->SetInputData(inputData);
-  transformPolyDataFilter->SetTransform(inverseOutputLabelmapGeometryTransform);
-
-  // Compute polydata normals
-  vtkNew<vtkPolyDataNormals> normalFilter;
-  normalFilter->SetInputConnection(transformPolyDataFilter->GetOutputPort());
-  normalFilter->ConsistencyOn();
-
-  // Make sure that we have a clean triangle polydata
-  vtkNew<vtkTriangleFilter> triangle;
-  triangle->SetInputConnection(normalFilter->GetOutputPort());
-
-  // Convert to triangle strip
-  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
-  stripper->SetInputConnection(triangle->GetOutputPort());
-  stripper->Update();
-
-  // PolyData of the closed surface in IJK space
-  vtkSmartPointer<vtkPolyData> transformedClosedSurface = stripper->GetOutput();
-
-  this->CellLocator->SetDataSet(transformedClosedSurface);
-  this->CellLocator->BuildLocator();
-
-  int extent[6];
-  outputData->GetExtent(extent);
-
-  vtkSmartPointer<vtkImageData> emptyImageData = vtkSmartPointer<vtkImageData>::New();
-  emptyImageData->SetExtent(extent);
-  emptyImageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
-
-  void* emptyImageDataPointer = emptyImageData->GetScalarPointerForExtent(emptyImageData->GetExtent());
-  if (!emptyImageDataPointer)
-  {
-    vtkErrorMacro("Convert: Failed to allocate memory for output labelmap image!");
-    return false;
-  }
-  else
-  {
-    memset(emptyImageDataPointer, 0, ((extent[1]-extent[0]+1)*(extent[3]-extent[2]+1)*(extent[5]-extent[4]+1) * emptyImageData->GetScalarSize() * emptyImageData->GetNumberOfScalarComponents()));
-  }
-
-
-  // The magnitude of the offset step size ( n-1 / 2n )
-  double offsetStepSize = (double)(this->NumberOfOffsets-1.0)/(2 * this->NumberOfOffsets);
-
-  vtkSmartPointer<vtkImageStencilData> imageStencilData = vtkSmartPointer<vtkImageStencilData>::New();
-  imageStencilData->SetExtent(extent);
-  imageStencilData->SetSpacing(1.0, 1.0, 1.0);
-
-  vtkNew<vtkImageStencil> imageStencil;
-  imageStencil->SetInputData(emptyImageData);
-  imageStencil->SetStencilData(imageStencilData);
-  imageStencil->ReverseStencilOn();
-  imageStencil->SetBackgroundValue(1); // General foreground value is 1 (background value because of reverse stencil)
-
-  vtkNew<vtkImageCast> imageCast;
-  imageCast->SetInputConnection(imageStencil->GetOutputPort());
-  imageCast->SetOutputScalarTypeToUnsignedChar();
 
-  // Iterate through "NumberOfOffsets" in each of the dimensions and create a binary labelmap at each offset
-  for (int k = 0; k < this->NumberOfOffsets; ++k)
-  {
-    double kOffset = ( (double) k / this->NumberOfOffsets - offsetStepSize );
+namespace {
 
-    for (int j = 0; j < this->NumberOfOffsets; ++j)
+//----------------------------------------------------------------------------
+// Find and connect all the loose ends of the contour lines in a slice.
+// Points of removed spurs are marked by a zero neighbor count.
+// (if the input polydata is closed, there will be no loose ends)
+void ConnectLooseEnds(vtkPolyData* slice, std::vector<vtkIdType>& pointNeighborCounts)
+{
+  vtkIdType numberOfPoints = slice->GetNumberOfPoints();
+  std::vector<vtkIdType> pointNeighbors(numberOfPoints);
+  pointNeighborCounts.assign(numberOfPoints, 0);
+
+  // get the connectivity count for each point
+  vtkCellArray* lines = slice->GetLines();
+  vtkIdType npts = 0;
+  vtkIdType *pointIds = 0;
+  vtkIdType count = lines->GetNumberOfConnectivityEntries();
+  for (vtkIdType loc = 0; loc < count; loc += npts + 1)
     {
-      double jOffset = ( (double) j / this->NumberOfOffsets - offsetStepSize );
-
-      for (int i = 0; i < this->NumberOfOffsets; ++i)
+    lines->GetCell(loc, npts, pointIds);
+    if (npts > 0)
       {
-        double iOffset = ( (double) i / this->NumberOfOffsets - offsetStepSize );
-
-        // Create stencil for the current binary labelmap offset
-        imageStencilData->AllocateExtents();
-        imageStencilData->SetOrigin(iOffset, jOffset, kOffset);
-        this->FillImageStencilData(imageStencilData, transformedClosedSurface, extent);
-
-        // Save result to output
-        imageCast->Update();
-        this->AddBinaryLabelMapToFractionalLabelMap(imageCast->GetOutput(), outputData);
+      pointNeighborCounts[pointIds[0]] += 1;
+      for (vtkIdType j = 1; j < npts-1; j++)
+        {
+        pointNeighborCounts[pointIds[j]] += 2;
+        }
+      pointNeighborCounts[pointIds[npts-1]] += 1;
+      if (pointIds[0] != pointIds[npts-1])
+        {
+        // store the neighbors for end points, because these are
+        // potentially loose ends that will have to be dealt with later
+        pointNeighbors[pointIds[0]] = pointIds[1];
+        pointNeighbors[pointIds[npts-1]] = pointIds[npts-2];
+        }
+      }
+    }
 
-        this->UpdateProgress(((i+1)*(j+1)*(k+1))/(this->NumberOfOffsets*this->NumberOfOffsets*this->NumberOfOffsets));
+  // use connectivity count to identify loose ends and branch points
+  std::vector<vtkIdType> looseEndIds;
+  std::vector<vtkIdType> branchIds;
 
-      } // i
-    } // j
-  } // k
+  for (vtkIdType j = 0; j < numberOfPoints; j++)
+    {
+    if (pointNeighborCounts[j] == 1)
+      {
+      looseEndIds.push_back(j);
+      }
+    else if (pointNeighborCounts[j] > 2)
+      {
+      branchIds.push_back(j);
+      }
+    }
 
-  return 1;
-}
+  // remove any spurs
+  for (size_t b = 0; b < branchIds.size(); b++)
+    {
+    for (size_t i = 0; i < looseEndIds.size(); i++)
+      {
+      if (pointNeighbors[looseEndIds[i]] == branchIds[b])
+        {
+        // mark this pointId as removed
+        pointNeighborCounts[looseEndIds[i]] = 0;
+        looseEndIds.erase(looseEndIds.begin() + i);
+        i--;
+        if (--pointNeighborCounts[branchIds[b]] <= 2)
+          {
+          break;
+          }
+        }
+      }
+    }
 
-//----------------------------------------------------------------------------
-void vtkPolyDataToFractionalLabelmapFilter::AddBinaryLabelMapToFractionalLabelMap(vtkImageData* binaryLabelMap, vtkImageData* fractionalLabelMap)
-{
+  // join any loose ends
+  while (looseEndIds.size() >= 2)
+    {
+    size_t n = looseEndIds.size();
 
-  if (!binaryLabelMap)
-  {
-    vtkErrorMacro("AddBinaryLabelMapToFractionalLabelMap: Invalid vtkImageData!");
-    return;
-  }
+    // search for the two closest loose ends
+    double maxval = -VTK_FLOAT_MAX;
+    vtkIdType firstIndex = 0;
+    vtkIdType secondIndex = 1;
+    bool isCoincident = false;
+    bool isOnHull = false;
 
-  if (!fractionalLabelMap)
-  {
-    vtkErrorMacro("AddBinaryLabelMapToFractionalLabelMap: Invalid vtkImageData!");
-    return;
-  }
+    for (size_t i = 0; i < n && !isCoincident; i++)
+      {
+      // first loose end
+      vtkIdType firstLooseEndId = looseEndIds[i];
+      vtkIdType neighborId = pointNeighbors[firstLooseEndId];
 
-  int binaryExtent[6] = {0,-1,0,-1,0,-1};
-  binaryLabelMap->GetExtent(binaryExtent);
+      double firstLooseEnd[3];
+      slice->GetPoint(firstLooseEndId, firstLooseEnd);
+      double neighbor[3];
+      slice->GetPoint(neighborId, neighbor);
 
-  int fractionalExtent[6] = {0,-1,0,-1,0,-1};
-  fractionalLabelMap->GetExtent(fractionalExtent);
+      for (size_t j = i+1; j < n; j++)
+        {
+        vtkIdType secondLooseEndId = looseEndIds[j];
+        if (secondLooseEndId != neighborId)
+          {
+          double currentLooseEnd[3];
+          slice->GetPoint(secondLooseEndId, currentLooseEnd);
+
+          // When connecting loose ends, use dot product to favor
+          // continuing in same direction as the line already
+          // connected to the loose end, but also favour short
+          // distances by dividing dotprod by square of distance.
+          double v1[2], v2[2];
+          v1[0] = firstLooseEnd[0] - neighbor[0];
+          v1[1] = firstLooseEnd[1] - neighbor[1];
+          v2[0] = currentLooseEnd[0] - firstLooseEnd[0];
+          v2[1] = currentLooseEnd[1] - firstLooseEnd[1];
+          double dotprod = v1[0]*v2[0] + v1[1]*v2[1];
+          double distance2 = v2[0]*v2[0] + v2[1]*v2[1];
+
+          // check if points are coincident
+          if (distance2 == 0)
+            {
+            firstIndex = i;
+            secondIndex = j;
+            isCoincident = true;
+            break;
+            }
 
-  // Get points to the extent in both the binary and fractional labelmaps
-  char* binaryLabelMapPointer = (char*)binaryLabelMap->GetScalarPointerForExtent(binaryExtent);
-  FRACTIONAL_DATA_TYPE* fractionalLabelMapPointer = (FRACTIONAL_DATA_TYPE*)fractionalLabelMap->GetScalarPointerForExtent(fractionalExtent);
+          // prefer adding segments that lie on hull
+          double midpoint[2], normal[2];
+          midpoint[0] = 0.5*(currentLooseEnd[0] + firstLooseEnd[0]);
+          midpoint[1] = 0.5*(currentLooseEnd[1] + firstLooseEnd[1]);
+          normal[0] = currentLooseEnd[1] - firstLooseEnd[1];
+          normal[1] = -(currentLooseEnd[0] - firstLooseEnd[0]);
+          double sidecheck = 0.0;
+          bool checkOnHull = true;
+          for (size_t k = 0; k < n; k++)
+            {
+            if (k != i && k != j)
+              {
+              double checkEnd[3];
+              slice->GetPoint(looseEndIds[k], checkEnd);
+              double dotprod2 = ((checkEnd[0] - midpoint[0])*normal[0] +
+                                 (checkEnd[1] - midpoint[1])*normal[1]);
+              if (dotprod2*sidecheck < 0)
+                {
+                checkOnHull = false;
+                }
+              sidecheck = dotprod2;
+              }
+            }
 
-  int dimensions[6] = {0,0,0};
-  fractionalLabelMap->GetDimensions(dimensions);
+          // check if new candidate is better than previous one
+          if ((checkOnHull && !isOnHull) ||
+              (checkOnHull == isOnHull && dotprod > maxval*distance2))
+            {
+            firstIndex = i;
+            secondIndex = j;
+            isOnHull |= checkOnHull;
+            maxval = dotprod/distance2;
+            }
+          }
+        }
+      }
 
-  int numberOfVoxels = dimensions[0]*dimensions[1]*dimensions[2];
+    // get the two loose ends
+    vtkIdType firstLooseEndId = looseEndIds[firstIndex];
+    vtkIdType secondLooseEndId = looseEndIds[secondIndex];
 
-  for (int i = 0; i < numberOfVoxels; ++i)
-  {
-    (*fractionalLabelMapPointer) += (*binaryLabelMapPointer) * FRACTIONAL_STEP_SIZE;
-    ++binaryLabelMapPointer;
-    ++fractionalLabelMapPointer;
-  }
+    // remove these loose ends from the list
+    looseEndIds.erase(looseEndIds.begin() + secondIndex);
+    looseEndIds.erase(looseEndIds.begin() + firstIndex);
 
+    if (!isCoincident)
+      {
+      // create a new line segment by connecting these two points
+      lines->InsertNextCell(2);
+      lines->InsertCellPoint(firstLooseEndId);
+      lines->InsertCellPoint(secondLooseEndId);
+      }
+    }
 }
 
+} // end anonymous namespace
+
 //----------------------------------------------------------------------------
-void vtkPolyDataToFractionalLabelmapFilter::FillImageStencilData(
-  vtkImageStencilData *data, vtkPolyData* closedSurface,
-  int extent[6])
+// Description of algorithm:
+// 1) cut the polydata at each z offset of the slice to create polylines
+// 2) find all "loose ends" and connect them to make polygons
+// 3) for each x and y offset go through all line segments, and for each
+//    integer y value on a line segment, store the x value at that point
+//    in a bucket
+// 4) use the stored x values to create the stencil of the slice and
+//    add the voxels inside the stencil to the fractional labelmap
+//
+// Each output slice is written by exactly one work item, therefore the
+// slices can be processed in parallel without synchronization. Contours
+// of a z offset are reused for all the x and y offsets.
+class vtkPolyDataToFractionalLabelmapFilter::SliceRasterizer
 {
-  // Description of algorithm:
-  // 1) cut the polydata at each z slice to create polylines
-  // 2) find all "loose ends" and connect them to make polygons
-  //    (if the input polydata is closed, there will be no loose ends)
-  // 3) go through all line segments, and for each integer y value on
-  //    a line segment, store the x value at that point in a bucket
-  // 4) for each z integer index, find all the stored x values
-  //    and use them to create one z slice of the vtkStencilData
-
-  // the spacing and origin of the generated stencil
-  double *spacing = data->GetSpacing();
-  double *origin = data->GetOrigin();
-
-  // if we have no data then return
-  if (!this->GetInput()->GetNumberOfPoints())
+public:
+  SliceRasterizer(vtkPolyDataToFractionalLabelmapFilter* filter, vtkPolyData* closedSurface,
+    const std::vector<std::vector<vtkIdType> >& sliceCellIds, vtkImageData* outputData)
+    : Filter(filter)
+    , ClosedSurface(closedSurface)
+    , SliceCellIds(sliceCellIds)
     {
-    return;
+    outputData->GetExtent(this->Extent);
+    this->OutputPointer = static_cast<FRACTIONAL_DATA_TYPE*>(outputData->GetScalarPointerForExtent(this->Extent));
+    this->RowLength = this->Extent[1] - this->Extent[0] + 1;
+    this->SliceSize = this->RowLength * (this->Extent[3] - this->Extent[2] + 1);
+    this->CutSurface = (closedSurface->GetNumberOfPolys() > 0 || closedSurface->GetNumberOfStrips() > 0);
     }
 
-  // Only divide once
-  double invspacing[3];
-  invspacing[0] = 1.0/spacing[0];
-  invspacing[1] = 1.0/spacing[1];
-  invspacing[2] = 1.0/spacing[2];
-
-  // get the input data
-  vtkPolyData *input = closedSurface;
-
-  // the output produced by cutting the polydata with the Z plane
-  vtkSmartPointer<vtkPolyData> slice;
-
-  // This raster stores all line segments by recording all "x"
-  // positions on the surface for each y integer position.
-  vtkImageStencilRaster raster(&extent[2]);
-  raster.SetTolerance(this->Tolerance);
-
-  // The extent for one slice of the image
-  int sliceExtent[6];
-  sliceExtent[0] = extent[0]; sliceExtent[1] = extent[1];
-  sliceExtent[2] = extent[2]; sliceExtent[3] = extent[3];
-  sliceExtent[4] = extent[4]; sliceExtent[5] = extent[4];
+  void operator()(vtkIdType beginSliceIndex, vtkIdType endSliceIndex)
+    {
+    vtkImageStencilData* stencilData = this->LocalStencilData.Local();
+    for (vtkIdType sliceIndex = beginSliceIndex; sliceIndex < endSliceIndex; ++sliceIndex)
+      {
+      this->RasterizeSlice(stencilData, sliceIndex);
+      }
+    }
 
-  // Loop through the slices
-  for (int idxZ = extent[4]; idxZ <= extent[5]; idxZ++)
+protected:
+  void RasterizeSlice(vtkImageStencilData* stencilData, vtkIdType sliceIndex)
     {
+    int idxZ = this->Extent[4] + static_cast<int>(sliceIndex);
+    FRACTIONAL_DATA_TYPE* slicePointer = this->OutputPointer + sliceIndex * this->SliceSize;
 
-    double z = idxZ*spacing[2] + origin[2];
+    // The extent for one slice of the image
+    int sliceExtent[6] = { this->Extent[0], this->Extent[1], this->Extent[2], this->Extent[3], idxZ, idxZ };
+    stencilData->SetExtent(sliceExtent);
 
-    raster.PrepareForNewData();
+    // This raster stores all line segments by recording all "x"
+    // positions on the surface for each y integer position.
+    vtkImageStencilRaster raster(&sliceExtent[2]);
+    raster.SetTolerance(this->Filter->Tolerance);
 
-    if ( this->SliceCache.count(z) == 0 )
-      {
+    int numberOfOffsets = this->Filter->NumberOfOffsets;
+    // The magnitude of the offset step size ( n-1 / 2n )
+    double offsetStepSize = (double)(numberOfOffsets-1.0)/(2 * numberOfOffsets);
 
-      slice = vtkSmartPointer<vtkPolyData>::New();
+    std::vector<vtkIdType> pointNeighborCounts;
+    for (int k = 0; k < numberOfOffsets; ++k)
+      {
+      double z = idxZ + ( (double) k / numberOfOffsets - offsetStepSize );
 
       // Step 1: Cut the data into slices
-      if (input->GetNumberOfPolys() > 0 || input->GetNumberOfStrips() > 0)
+      vtkNew<vtkPolyData> slice;
+      if (this->CutSurface)
         {
-
-        this->PolyDataCutter(input, slice, z);
+        this->Filter->PolyDataCutter(this->ClosedSurface, this->SliceCellIds[sliceIndex], slice.GetPointer(), z);
         }
       else
         {
         // if no polys, select polylines instead
-        this->PolyDataSelector(input, slice, z, spacing[2]);
+        this->Filter->PolyDataSelector(this->ClosedSurface, slice.GetPointer(), z, 1.0);
         }
-
       if (!slice->GetNumberOfLines())
         {
         continue;
         }
 
-      this->SliceCache.insert(std::pair<double, vtkPolyData*>(z, slice));
-
-      }
-
-    slice = this->SliceCache[z];
-
-    // convert to structured coords via origin and spacing
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    points->DeepCopy(slice->GetPoints());
-    vtkIdType numberOfPoints = points->GetNumberOfPoints();
-
-    for (vtkIdType j = 0; j < numberOfPoints; j++)
-      {
-      double tempPoint[3];
-      points->GetPoint(j, tempPoint);
-      tempPoint[0] = (tempPoint[0] - origin[0])*invspacing[0];
-      tempPoint[1] = (tempPoint[1] - origin[1])*invspacing[1];
-      tempPoint[2] = (tempPoint[2] - origin[2])*invspacing[2];
-      points->SetPoint(j, tempPoint);
-      }
-
-    if (this->LinesCache.count(z) == 0)
-    {
-
       // Step 2: Find and connect all the loose ends
-      std::vector<vtkIdType> pointNeighbors(numberOfPoints);
-      vtkSmartPointer<vtkIdTypeArray> pointNeighborCountsArray = vtkSmartPointer<vtkIdTypeArray>::New();
-      pointNeighborCountsArray->Allocate(numberOfPoints, 1);
-      vtkIdType* pointNeighborCounts = pointNeighborCountsArray->GetPointer(0);
-      memset(pointNeighborCounts, 0, numberOfPoints*sizeof(vtkIdType));
-
-      // get the connectivity count for each point
-      vtkSmartPointer<vtkCellArray> lines = slice->GetLines();
-      vtkIdType npts = 0;
-      vtkIdType *pointIds = 0;
-      vtkIdType count = lines->GetNumberOfConnectivityEntries();
-      for (vtkIdType loc = 0; loc < count; loc += npts + 1)
-        {
-        lines->GetCell(loc, npts, pointIds);
-        if (npts > 0)
-          {
-          pointNeighborCounts[pointIds[0]] += 1;
-          for (vtkIdType j = 1; j < npts-1; j++)
-            {
-            pointNeighborCounts[pointIds[j]] += 2;
-            }
-          pointNeighborCounts[pointIds[npts-1]] += 1;
-          if (pointIds[0] != pointIds[npts-1])
-            {
-            // store the neighbors for end points, because these are
-            // potentially loose ends that will have to be dealt with later
-            pointNeighbors[pointIds[0]] = pointIds[1];
-            pointNeighbors[pointIds[npts-1]] = pointIds[npts-2];
-            }
-          }
-        }
+      ConnectLooseEnds(slice.GetPointer(), pointNeighborCounts);
 
-      // use connectivity count to identify loose ends and branch points
-      std::vector<vtkIdType> looseEndIds;
-      std::vector<vtkIdType> branchIds;
-
-      for (vtkIdType j = 0; j < numberOfPoints; j++)
-        {
-        if (pointNeighborCounts[j] == 1)
-          {
-          looseEndIds.push_back(j);
-          }
-        else if (pointNeighborCounts[j] > 2)
-          {
-          branchIds.push_back(j);
-          }
-        }
+      vtkPoints* points = slice->GetPoints();
+      vtkCellArray* lines = slice->GetLines();
+      vtkIdType count = lines->GetNumberOfConnectivityEntries();
 
-      // remove any spurs
-      for (size_t b = 0; b < branchIds.size(); b++)
+      for (int j = 0; j < numberOfOffsets; ++j)
         {
-        for (size_t i = 0; i < looseEndIds.size(); i++)
+        double jOffset = ( (double) j / numberOfOffsets - offsetStepSize );
+        for (int i = 0; i < numberOfOffsets; ++i)
           {
-          if (pointNeighbors[looseEndIds[i]] == branchIds[b])
+          double iOffset = ( (double) i / numberOfOffsets - offsetStepSize );
+
+          // Step 3: Go through all the line segments for this slice,
+          // and for each integer y position on the line segment,
+          // drop the corresponding x position into the y raster line.
+          raster.PrepareForNewData();
+          vtkIdType npts = 0;
+          vtkIdType *pointIds = 0;
+          for (vtkIdType loc = 0; loc < count; loc += npts + 1)
             {
-            // mark this pointId as removed
-            pointNeighborCounts[looseEndIds[i]] = 0;
-            looseEndIds.erase(looseEndIds.begin() + i);
-            i--;
-            if (--pointNeighborCounts[branchIds[b]] <= 2)
+            lines->GetCell(loc, npts, pointIds);
+            if (npts <= 0)
               {
-              break;
+              continue;
               }
-            }
-          }
-        }
-
-      // join any loose ends
-      while (looseEndIds.size() >= 2)
-        {
-        size_t n = looseEndIds.size();
-
-        // search for the two closest loose ends
-        double maxval = -VTK_FLOAT_MAX;
-        vtkIdType firstIndex = 0;
-        vtkIdType secondIndex = 1;
-        bool isCoincident = false;
-        bool isOnHull = false;
-
-        for (size_t i = 0; i < n && !isCoincident; i++)
-          {
-          // first loose end
-          vtkIdType firstLooseEndId = looseEndIds[i];
-          vtkIdType neighborId = pointNeighbors[firstLooseEndId];
-
-          double firstLooseEnd[3];
-          slice->GetPoint(firstLooseEndId, firstLooseEnd);
-          double neighbor[3];
-          slice->GetPoint(neighborId, neighbor);
-
-          for (size_t j = i+1; j < n; j++)
-            {
-            vtkIdType secondLooseEndId = looseEndIds[j];
-            if (secondLooseEndId != neighborId)
+            vtkIdType pointId0 = pointIds[0];
+            double point0[3];
+            points->GetPoint(pointId0, point0);
+            point0[0] -= iOffset;
+            point0[1] -= jOffset;
+            for (vtkIdType p = 1; p < npts; p++)
               {
-              double currentLooseEnd[3];
-              slice->GetPoint(secondLooseEndId, currentLooseEnd);
-
-              // When connecting loose ends, use dot product to favor
-              // continuing in same direction as the line already
-              // connected to the loose end, but also favour short
-              // distances by dividing dotprod by square of distance.
-              double v1[2], v2[2];
-              v1[0] = firstLooseEnd[0] - neighbor[0];
-              v1[1] = firstLooseEnd[1] - neighbor[1];
-              v2[0] = currentLooseEnd[0] - firstLooseEnd[0];
-              v2[1] = currentLooseEnd[1] - firstLooseEnd[1];
-              double dotprod = v1[0]*v2[0] + v1[1]*v2[1];
-              double distance2 = v2[0]*v2[0] + v2[1]*v2[1];
-
-              // check if points are coincident
-              if (distance2 == 0)
+              vtkIdType pointId1 = pointIds[p];
+              double point1[3];
+              points->GetPoint(pointId1, point1);
+              point1[0] -= iOffset;
+              point1[1] -= jOffset;
+
+              // make sure points aren't flagged for removal
+              if (pointNeighborCounts[pointId0] > 0 &&
+                  pointNeighborCounts[pointId1] > 0)
                 {
-                firstIndex = i;
-                secondIndex = j;
-                isCoincident = true;
-                break;
+                raster.InsertLine(point0, point1);
                 }
 
-              // prefer adding segments that lie on hull
-              double midpoint[2], normal[2];
-              midpoint[0] = 0.5*(currentLooseEnd[0] + firstLooseEnd[0]);
-              midpoint[1] = 0.5*(currentLooseEnd[1] + firstLooseEnd[1]);
-              normal[0] = currentLooseEnd[1] - firstLooseEnd[1];
-              normal[1] = -(currentLooseEnd[0] - firstLooseEnd[0]);
-              double sidecheck = 0.0;
-              bool checkOnHull = true;
-              for (size_t k = 0; k < n; k++)
-                {
-                if (k != i && k != j)
-                  {
-                  double checkEnd[3];
-                  slice->GetPoint(looseEndIds[k], checkEnd);
-                  double dotprod2 = ((checkEnd[0] - midpoint[0])*normal[0] +
-                                     (checkEnd[1] - midpoint[1])*normal[1]);
-                  if (dotprod2*sidecheck < 0)
-                    {
-                    checkOnHull = false;
-                    }
-                  sidecheck = dotprod2;
-                  }
-                }
+              pointId0 = pointId1;
+              point0[0] = point1[0];
+              point0[1] = point1[1];
+              point0[2] = point1[2];
+              }
+            }
 
-              // check if new candidate is better than previous one
-              if ((checkOnHull && !isOnHull) ||
-                  (checkOnHull == isOnHull && dotprod > maxval*distance2))
+          // Step 4: Use the x values stored in the xy raster to create
+          // the stencil of the slice and add it to the fractional labelmap
+          stencilData->AllocateExtents();
+          raster.FillStencilData(stencilData, sliceExtent);
+          FRACTIONAL_DATA_TYPE* rowPointer = slicePointer;
+          for (int idxY = sliceExtent[2]; idxY <= sliceExtent[3]; ++idxY, rowPointer += this->RowLength)
+            {
+            int iter = 0;
+            int r1 = 0;
+            int r2 = 0;
+            while (stencilData->GetNextExtent(r1, r2, sliceExtent[0], sliceExtent[1], idxY, idxZ, iter))
+              {
+              for (int idxX = r1; idxX <= r2; ++idxX)
                 {
-                firstIndex = i;
-                secondIndex = j;
-                isOnHull |= checkOnHull;
-                maxval = dotprod/distance2;
+                rowPointer[idxX - sliceExtent[0]] += FRACTIONAL_STEP_SIZE;
                 }
               }
             }
-          }
+          } // i
+        } // j
+      } // k
+    }
 
-        // get info about the two loose ends and their neighbors
-        vtkIdType firstLooseEndId = looseEndIds[firstIndex];
-        vtkIdType neighborId = pointNeighbors[firstLooseEndId];
-        double firstLooseEnd[3];
-        slice->GetPoint(firstLooseEndId, firstLooseEnd);
-        double neighbor[3];
-        slice->GetPoint(neighborId, neighbor);
-
-        vtkIdType secondLooseEndId = looseEndIds[secondIndex];
-        vtkIdType secondNeighborId = pointNeighbors[secondLooseEndId];
-        double secondLooseEnd[3];
-        slice->GetPoint(secondLooseEndId, secondLooseEnd);
-        double secondNeighbor[3];
-        slice->GetPoint(secondNeighborId, secondNeighbor);
-
-        // remove these loose ends from the list
-        looseEndIds.erase(looseEndIds.begin() + secondIndex);
-        looseEndIds.erase(looseEndIds.begin() + firstIndex);
-
-        if (!isCoincident)
-          {
-          // create a new line segment by connecting these two points
-          lines->InsertNextCell(2);
-          lines->InsertCellPoint(firstLooseEndId);
-          lines->InsertCellPoint(secondLooseEndId);
-          }
-        }
+  vtkPolyDataToFractionalLabelmapFilter* Filter;
+  vtkPolyData* ClosedSurface;
+  const std::vector<std::vector<vtkIdType> >& SliceCellIds;
+  bool CutSurface;
+  int Extent[6];
+  FRACTIONAL_DATA_TYPE* OutputPointer;
+  vtkIdType RowLength;
+  vtkIdType SliceSize;
+
+  /// Stencil buffer of one slice for each thread
+  vtkSMPThreadLocalObject<vtkImageStencilData> LocalStencilData;
+};
 
-        this->LinesCache.insert(std::pair<double, vtkCellArray*>(z, lines));
-        this->NptsCache.insert(std::pair<double, vtkIdType>(z, npts));
-        this->PointNeighborCountsCache.insert(std::pair<double, vtkSmartPointer<vtkIdTypeArray> >(z, pointNeighborCountsArray));
+//----------------------------------------------------------------------------
+int vtkPolyDataToFractionalLabelmapFilter::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
 
-      }
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkOrientedImageData *outputData = vtkOrientedImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+    this->AllocateOutputData(
+    outputData,
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT()));
+
+  vtkInformation *inputInfo = inputVector[0]->GetInformationObject(0);
+  vtkPolyData *inputData = vtkPolyData::SafeDownCast(
+    inputInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-   if (this->LinesCache.count(z) == 0)
+  vtkSmartPointer<vtkMatrix4x4> outputLabelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  this->OutputImageTransformData->GetImageToWorldMatrix(outputLabelmapImageToWorldMatrix);
+  outputData->SetImageToWorldMatrix(outputLabelmapImageToWorldMatrix);
+  outputData->SetExtent(this->OutputWholeExtent);
+
+  // if we have no data then return
+  if (!inputData || !inputData->GetNumberOfPoints())
     {
-     continue;
+    return 1;
     }
 
-    vtkCellArray* lines = this->LinesCache[z];
-    vtkIdType count = lines->GetNumberOfConnectivityEntries();
-    vtkIdType* pointIds = this->PointIdsCache[z];
-    vtkIdType npts = this->NptsCache[z];
-    vtkIdTypeArray* pointNeighborCountsArray = this->PointNeighborCountsCache[z];
-    vtkIdType* pointNeighborCounts = pointNeighborCountsArray->GetPointer(0);
-
-    // Step 3: Go through all the line segments for this slice,
-    // and for each integer y position on the line segment,
-    // drop the corresponding x position into the y raster line.
-    for (vtkIdType loc = 0; loc < count; loc += npts + 1)
-      {
-      lines->GetCell(loc, npts, pointIds);
-      if (npts > 0)
-        {
-        vtkIdType pointId0 = pointIds[0];
-        double point0[3];
-        points->GetPoint(pointId0, point0);
-        for (vtkIdType j = 1; j < npts; j++)
-          {
-          vtkIdType pointId1 = pointIds[j];
-          double point1[3];
-          points->GetPoint(pointId1, point1);
+  vtkSmartPointer<vtkTransform> inverseOutputLabelmapGeometryTransform = vtkSmartPointer<vtkTransform>::New();
+  inverseOutputLabelmapGeometryTransform->SetMatrix(outputLabelmapImageToWorldMatrix);
+  inverseOutputLabelmapGeometryTransform->Inverse();
 
-          // make sure points aren't flagged for removal
-          if (pointNeighborCounts[pointId0] > 0 &&
-              pointNeighborCounts[pointId1] > 0)
-            {
-            raster.InsertLine(point0, point1);
-            }
+  // Transform the polydata from RAS to IJK space
+  vtkSmartPointer<vtkTransformPolyDataFilter> transformPolyDataFilter =
+    vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  transformPolyDataFilter->SetInputData(inputData);
+  transformPolyDataFilter->SetTransform(inverseOutputLabelmapGeometryTransform);
 
-          pointId0 = pointId1;
-          point0[0] = point1[0];
-          point0[1] = point1[1];
-          point0[2] = point1[2];
-          }
-        }
-      }
+  // Compute polydata normals
+  vtkNew<vtkPolyDataNormals> normalFilter;
+  normalFilter->SetInputConnection(transformPolyDataFilter->GetOutputPort());
+  normalFilter->ConsistencyOn();
 
-    // Step 4: Use the x values stored in the xy raster to create
-    // one z slice of the vtkStencilData
-    sliceExtent[4] = idxZ;
-    sliceExtent[5] = idxZ;
-    raster.FillStencilData(data, sliceExtent);
+  // Make sure that we have a clean triangle polydata
+  vtkNew<vtkTriangleFilter> triangle;
+  triangle->SetInputConnection(normalFilter->GetOutputPort());
+
+  // Convert to triangle strip
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputConnection(triangle->GetOutputPort());
+  stripper->Update();
 
+  // PolyData of the closed surface in IJK space
+  vtkSmartPointer<vtkPolyData> transformedClosedSurface = stripper->GetOutput();
+
+  int extent[6];
+  outputData->GetExtent(extent);
+  vtkIdType numberOfSlices = extent[5] - extent[4] + 1;
+  if (numberOfSlices <= 0 || extent[1] < extent[0] || extent[3] < extent[2])
+    {
+    return 1;
+    }
+
+  // Build the cells before the parallel section, as they are created on first access
+  vtkIdType numberOfCells = transformedClosedSurface->GetNumberOfCells();
+  if (numberOfCells > 0)
+    {
+    transformedClosedSurface->BuildCells();
+    }
+
+  // Collect the cells that may intersect any of the cutting planes of each slice.
+  // This replaces the cell locator: the index is only read by the threads and each
+  // cell bounds computation is done only once.
+  double offsetStepSize = (double)(this->NumberOfOffsets-1.0)/(2 * this->NumberOfOffsets);
+  std::vector<std::vector<vtkIdType> > sliceCellIds(numberOfSlices);
+  vtkPoints* points = transformedClosedSurface->GetPoints();
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    int cellType = transformedClosedSurface->GetCellType(cellId);
+    if (cellType != VTK_TRIANGLE && cellType != VTK_TRIANGLE_STRIP)
+      {
+      continue;
+      }
+    vtkIdType npts, *ptIds;
+    transformedClosedSurface->GetCellPoints(cellId, npts, ptIds);
+    if (npts <= 0)
+      {
+      continue;
+      }
+    double zMin = VTK_DOUBLE_MAX;
+    double zMax = VTK_DOUBLE_MIN;
+    for (vtkIdType i = 0; i < npts; ++i)
+      {
+      double point[3];
+      points->GetPoint(ptIds[i], point);
+      zMin = std::min(zMin, point[2]);
+      zMax = std::max(zMax, point[2]);
+      }
+    // Widen the range a little to tolerate the rounding of the offset computation
+    int firstZ = std::max(extent[4], vtkMath::Ceil(zMin - offsetStepSize - 1e-6));
+    int lastZ = std::min(extent[5], vtkMath::Floor(zMax + offsetStepSize + 1e-6));
+    for (int idxZ = firstZ; idxZ <= lastZ; ++idxZ)
+      {
+      sliceCellIds[idxZ - extent[4]].push_back(cellId);
+      }
     }
 
+  // Choose the number of slices processed at once based on the amount of work per slice,
+  // which is proportional to the cube of the oversampling factor
+  const vtkIdType minimumWorkPerThread = 1 << 20;
+  vtkIdType workPerSlice = static_cast<vtkIdType>(this->NumberOfOffsets) * this->NumberOfOffsets * this->NumberOfOffsets
+    * (extent[1] - extent[0] + 1) * (extent[3] - extent[2] + 1);
+  vtkIdType grain = std::max(static_cast<vtkIdType>(1), minimumWorkPerThread / std::max(static_cast<vtkIdType>(1), workPerSlice));
+
+  SliceRasterizer rasterizer(this, transformedClosedSurface, sliceCellIds, outputData);
+  vtkSMPTools::For(0, numberOfSlices, grain, rasterizer);
+
+  return 1;
 }
 
 //----------------------------------------------------------------------------
 void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
-  vtkPolyData *input, vtkPolyData *output, double z)
+  vtkPolyData *input, const std::vector<vtkIdType>& cellIds, vtkPolyData *output, double z)
 {
   vtkPoints *points = input->GetPoints();
   vtkPoints *newPoints = vtkPoints::New();
@@ -889,39 +849,23 @@ void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
   // An edge locator to avoid point duplication while clipping
   EdgeLocator edgeLocator;
 
-  vtkSmartPointer<vtkIdList> cells = vtkSmartPointer<vtkIdList>::New();
-  cells->Initialize();
-
-  double bounds[6] = {0,0,0,0,0,0};
-  input->GetBounds(bounds);
-  bounds[4] = z;
-  bounds[5] = z;
-
-  // Find cells that intersect with the current slice.
-  this->CellLocator->FindCellsWithinBounds(bounds, cells);
-
-  // Go through all cells and clip them.
-  vtkIdType numCells = cells->GetNumberOfIds();
-
-
-  vtkIdType loc = 0;
-  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+  // Go through all cells that may intersect with the current slice and clip them.
+  for (std::vector<vtkIdType>::const_iterator cellIt = cellIds.begin(); cellIt != cellIds.end(); ++cellIt)
     {
+    vtkIdType id = (*cellIt);
 
-    vtkIdType id = cells->GetId(cellId);
-
-    if (input->GetCellType(id) != VTK_TRIANGLE &&
-        input->GetCellType(id) != VTK_TRIANGLE_STRIP)
+    int cellType = input->GetCellType(id);
+    if (cellType != VTK_TRIANGLE &&
+        cellType != VTK_TRIANGLE_STRIP)
       {
         continue;
       }
 
     vtkIdType npts, *ptIds;
     input->GetCellPoints(id, npts, ptIds);
-    loc += npts + 1;
 
     vtkIdType numSubCells = 1;
-    if (input->GetCellType(id) == VTK_TRIANGLE_STRIP)
+    if (cellType == VTK_TRIANGLE_STRIP)
       {
       numSubCells = npts - 2;
       npts = 3;
@@ -986,11 +930,5 @@ void vtkPolyDataToFractionalLabelmapFilter::PolyDataCutter(
 //----------------------------------------------------------------------------
 void vtkPolyDataToFractionalLabelmapFilter::DeleteCache()
 {
-
-  this->SliceCache.clear();
-  this->LinesCache.clear();
-  this->NptsCache.clear();
-  this->PointIdsCache.clear();
-  this->PointNeighborCountsCache.clear();
-
+  // Contours are not cached between slices anymore, nothing to delete
 }
@@ -30,13 +30,12 @@
 #include <vtkCellArray.h>
 #include <vtkSetGet.h>
 #include <vtkMatrix4x4.h>
-#include <vtkCellLocator.h>
 
 // Segmentations includes
 #include <vtkOrientedImageData.h>
 
 // std includes
-#include <map>
+#include <vector>
 
 #include "vtkSegmentationCoreConfigure.h"
 
@@ -64,14 +63,6 @@ class vtkSegmentationCore_EXPORT vtkPolyDataToFractionalLabelmapFilter :
   public vtkPolyDataToImageStencil
 {
 private:
-  std::map<double, vtkSmartPointer<vtkCellArray> > LinesCache;
-  std::map<double, vtkSmartPointer<vtkPolyData> > SliceCache;
-  std::map<double, vtkIdType*> PointIdsCache;
-  std::map<double, vtkIdType> NptsCache;
-  std::map<double,  vtkSmartPointer<vtkIdTypeArray> > PointNeighborCountsCache;
-
-  vtkCellLocator* CellLocator;
-
   vtkOrientedImageData* OutputImageTransformData;
   int NumberOfOffsets;
 
@@ -100,9 +91,13 @@ public:
   void SetOutputSpacing(double x, double y, double z) VTK_OVERRIDE;
 
 
-  /// This method deletes the currently stored cache variables
+  /// Slices are processed independently of each other (in parallel), contours are not
+  /// cached between executions anymore. This method is kept for backward compatibility.
   void DeleteCache();
 
+  /// Number of offsets (oversampling factor) along each axis. The fractional value of each
+  /// voxel is computed from NumberOfOffsets^3 binary labelmaps. It also determines how many
+  /// slices are processed by each thread at once.
   vtkSetMacro(NumberOfOffsets, int);
   vtkGetMacro(NumberOfOffsets, int);
 
@@ -115,27 +110,21 @@ protected:
   vtkOrientedImageData *AllocateOutputData(vtkDataObject *out, int* updateExt);
   virtual int FillOutputPortInformation(int, vtkInformation*) VTK_OVERRIDE;
 
-  /// Create a binary image stencil for the closed surface within the current extent
-  /// This method is a modified version of vtkPolyDataToImageStencil::ThreadedExecute
-  /// \param output Output stencil data
-  /// \param closedSurface The input surface to be converted
-  /// \param extent The extent region that is being converted
-  void FillImageStencilData(vtkImageStencilData *output, vtkPolyData* closedSurface, int extent[6]);
-
-  /// Add the values of the binary labelmap to the fractional labelmap.
-  /// \param binaryLabelMap Binary labelmap that will be added to the fractional labelmap
-  /// \param fractionalLabelMap The fractional labelmap that the binary labelmap is added to
-  void AddBinaryLabelMapToFractionalLabelMap(vtkImageData* binaryLabelMap, vtkImageData* fractionalLabelMap);
-
   /// Clip the polydata at the specified z coordinate to create a planar contour.
-  /// This method is a modified version of vtkPolyDataToImageStencil::PolyDataCutter to decrease execution time
+  /// This method is a modified version of vtkPolyDataToImageStencil::PolyDataCutter to decrease execution time.
+  /// It does not modify the filter or the input, therefore it can be called from multiple threads.
   /// \param input The closed surface that is being cut
+  /// \param cellIds Cells of the input that may intersect the cutting plane
   /// \param output Polydata containing the contour lines
   /// \param z The z coordinate for the cutting plane
-  void PolyDataCutter(vtkPolyData *input, vtkPolyData *output,
-                             double z);
+  void PolyDataCutter(vtkPolyData *input, const std::vector<vtkIdType>& cellIds,
+                      vtkPolyData *output, double z);
 
 private:
+  /// Functor that rasterizes all offsets of a range of output slices
+  class SliceRasterizer;
+  friend class SliceRasterizer;
+
   vtkPolyDataToFractionalLabelmapFilter(const vtkPolyDataToFractionalLabelmapFilter&);  // Not implemented.
   void operator=(const vtkPolyDataToFractionalLabelmapFilter&);  // Not implemented.
 };
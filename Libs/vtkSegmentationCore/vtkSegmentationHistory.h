@@ -53,6 +53,12 @@ public:
 
   /// Saves all master representations of the segmentation in its current state.
   /// States more recent than the last restored state are removed.
+  /// Representations that have not changed since the previous state are shared with it,
+  /// changed ones are copied entirely. Copying only the modified region would require
+  /// storing each state as a difference to the previous one, and restoring or dropping
+  /// a state would then require replaying the chain of differences. As segment labelmaps
+  /// are cropped to their effective extent, the copy is limited to the bounding box of
+  /// the modified segments.
   /// \return Success flag
   bool SaveState();
 
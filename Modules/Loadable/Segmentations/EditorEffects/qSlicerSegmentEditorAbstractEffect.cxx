@@ -74,6 +74,38 @@
 
 #include <vtkOrientedImageDataResample.h>
 
+// STD includes
+#include <algorithm>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+/// Create a labelmap that is filled with fillValue where the input labelmap is empty
+/// and eraseValue elsewhere. If extent is specified then only that region is computed.
+void CreateInvertedLabelmap(vtkOrientedImageData* labelmap, const int* extent,
+  double fillValue, double eraseValue, vtkOrientedImageData* invertedLabelmap)
+{
+  vtkSmartPointer<vtkOrientedImageData> inputLabelmap = labelmap;
+  if (extent)
+    {
+    inputLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    vtkOrientedImageDataResample::CopyImage(labelmap, inputLabelmap, extent);
+    }
+  vtkSmartPointer<vtkImageThreshold> inverter = vtkSmartPointer<vtkImageThreshold>::New();
+  inverter->SetInputData(inputLabelmap);
+  inverter->SetInValue(fillValue);
+  inverter->SetOutValue(eraseValue);
+  inverter->ReplaceInOn();
+  inverter->ThresholdByLower(0);
+  inverter->SetOutputScalarType(VTK_UNSIGNED_CHAR);
+  inverter->Update();
+  invertedLabelmap->ShallowCopy(inverter->GetOutput());
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  labelmap->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  invertedLabelmap->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+}
+} // end of anonymous namespace
+
 //-----------------------------------------------------------------------------
 // qSlicerSegmentEditorAbstractEffectPrivate methods
 
@@ -189,12 +221,16 @@ bool qSlicerSegmentEditorAbstractEffect::active()
 
 //-----------------------------------------------------------------------------
 void qSlicerSegmentEditorAbstractEffect::setCallbackSlots(QObject* receiver, const char* selectEffectSlot,
-  const char* updateVolumeSlot, const char* saveStateForUndoSlot)
+  const char* updateVolumeSlot, const char* saveStateForUndoSlot, const char* updateVolumeInExtentSlot/*=NULL*/)
 {
   Q_D(qSlicerSegmentEditorAbstractEffect);
   QObject::connect(d, SIGNAL(selectEffectSignal(QString)), receiver, selectEffectSlot);
   QObject::connect(d, SIGNAL(updateVolumeSignal(void*,bool&)), receiver, updateVolumeSlot);
   QObject::connect(d, SIGNAL(saveStateForUndoSignal()), receiver, saveStateForUndoSlot);
+  if (updateVolumeInExtentSlot)
+    {
+    QObject::connect(d, SIGNAL(updateVolumeInExtentSignal(void*,const int*,bool&)), receiver, updateVolumeInExtentSlot);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -271,27 +307,75 @@ void qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap(vtkOrie
     return;
     }
 
+  if (!modifierLabelmapInput)
+    {
+    // If per-segment flag is off, then it is not an error (the effect itself has written it back to segmentation)
+    if (this->perSegment())
+      {
+      qCritical() << Q_FUNC_INFO << ": Cannot apply edit operation because modifier labelmap cannot be accessed";
+      }
+    this->defaultModifierLabelmap();
+    return;
+    }
+
+  // All operations (masking, merging, overwriting other segments) are limited to the modification extent.
+  int extentBuffer[6] = { 0, -1, 0, -1, 0, -1 };
+  const int* extent = NULL;
+  if (modificationExtent[0] <= modificationExtent[1]
+    && modificationExtent[2] <= modificationExtent[3]
+    && modificationExtent[4] <= modificationExtent[5])
+    {
+    int* modifierExtent = modifierLabelmapInput->GetExtent();
+    for (int i = 0; i < 3; i++)
+      {
+      extentBuffer[i * 2] = std::max(modificationExtent[i * 2], modifierExtent[i * 2]);
+      extentBuffer[i * 2 + 1] = std::min(modificationExtent[i * 2 + 1], modifierExtent[i * 2 + 1]);
+      }
+    if (extentBuffer[0] > extentBuffer[1] || extentBuffer[2] > extentBuffer[3] || extentBuffer[4] > extentBuffer[5])
+      {
+      // modification extent is outside of the modifier labelmap, nothing to do
+      return;
+      }
+    extent = extentBuffer;
+    }
+  // else: invalid extent, it means we have to work with the entire modifier labelmap
+
   vtkSmartPointer<vtkOrientedImageData> modifierLabelmap = modifierLabelmapInput;
+  if (parameterSetNode->GetMaskMode() != vtkMRMLSegmentEditorNode::PaintAllowedEverywhere
+    || parameterSetNode->GetMasterVolumeIntensityMask())
+    {
+    // Make a copy to not modify the input. Only the modified region is copied.
+    vtkSmartPointer<vtkOrientedImageData> maskedModifierLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    if (extent)
+      {
+      vtkOrientedImageDataResample::CopyImage(modifierLabelmapInput, maskedModifierLabelmap, extent);
+      vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+      modifierLabelmapInput->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+      maskedModifierLabelmap->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+      }
+    else
+      {
+      maskedModifierLabelmap->DeepCopy(modifierLabelmapInput);
+      }
+    modifierLabelmap = maskedModifierLabelmap;
+    }
 
   // Apply mask to modifier labelmap if paint over is turned off
   if (parameterSetNode->GetMaskMode() != vtkMRMLSegmentEditorNode::PaintAllowedEverywhere)
     {
-    vtkOrientedImageData* maskImage = this->maskLabelmap();
-
-    if (modifierLabelmap.GetPointer() == modifierLabelmapInput)
+    vtkOrientedImageData* maskImage = (extent ? this->maskLabelmap(extent) : this->maskLabelmap());
+    // Erase voxels where the mask is set
+    if (!vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, maskImage,
+      vtkOrientedImageDataResample::OPERATION_MASKING, extent, 0.0, this->m_EraseValue))
       {
-      // make a copy to not modify the input
-      vtkNew<vtkOrientedImageData> maskedModifierLabelmap;
-      maskedModifierLabelmap->DeepCopy(modifierLabelmap);
-      modifierLabelmap = maskedModifierLabelmap.GetPointer();
+      qCritical() << Q_FUNC_INFO << ": Failed to apply mask on modifier labelmap";
       }
-    this->applyImageMask(modifierLabelmap, maskImage, this->m_EraseValue, true);
     }
 
   // Apply threshold mask if paint threshold is turned on
   if (parameterSetNode->GetMasterVolumeIntensityMask())
     {
-    vtkOrientedImageData* masterVolumeOrientedImageData = this->masterVolumeImageData();
+    vtkOrientedImageData* masterVolumeOrientedImageData = (extent ? this->masterVolumeImageData(extent) : this->masterVolumeImageData());
     if (!masterVolumeOrientedImageData)
       {
       qCritical() << Q_FUNC_INFO << ": Unable to get master volume image";
@@ -306,29 +390,67 @@ void qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap(vtkOrie
       return;
       }
 
-    // Create threshold image
+    // Only threshold the modified region of the master volume
+    int thresholdExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    modifierLabelmap->GetExtent(thresholdExtent);
+    int* masterVolumeExtent = masterVolumeOrientedImageData->GetExtent();
+    for (int i = 0; i < 3; i++)
+      {
+      thresholdExtent[i * 2] = std::max(thresholdExtent[i * 2], masterVolumeExtent[i * 2]);
+      thresholdExtent[i * 2 + 1] = std::min(thresholdExtent[i * 2 + 1], masterVolumeExtent[i * 2 + 1]);
+      }
+    if (extent)
+      {
+      for (int i = 0; i < 3; i++)
+        {
+        thresholdExtent[i * 2] = std::max(thresholdExtent[i * 2], extent[i * 2]);
+        thresholdExtent[i * 2 + 1] = std::min(thresholdExtent[i * 2 + 1], extent[i * 2 + 1]);
+        }
+      }
+    vtkSmartPointer<vtkOrientedImageData> masterVolumeRegion = masterVolumeOrientedImageData;
+    if (thresholdExtent[0] <= thresholdExtent[1] && thresholdExtent[2] <= thresholdExtent[3] && thresholdExtent[4] <= thresholdExtent[5])
+      {
+      masterVolumeRegion = vtkSmartPointer<vtkOrientedImageData>::New();
+      vtkOrientedImageDataResample::CopyImage(masterVolumeOrientedImageData, masterVolumeRegion, thresholdExtent);
+      }
+
+    // Create threshold image. Voxels outside of the intensity range are set to 1 (these are erased from the modifier),
+    // so that the mask can be applied directly on the modifier labelmap.
     vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
-    threshold->SetInputData(masterVolumeOrientedImageData);
+    threshold->SetInputData(masterVolumeRegion);
     threshold->ThresholdBetween(parameterSetNode->GetMasterVolumeIntensityMaskRange()[0], parameterSetNode->GetMasterVolumeIntensityMaskRange()[1]);
-    threshold->SetInValue(1);
-    threshold->SetOutValue(0);
-    threshold->SetOutputScalarType(modifierLabelmap->GetScalarType());
+    threshold->SetInValue(0);
+    threshold->SetOutValue(1);
+    threshold->SetOutputScalarType(VTK_UNSIGNED_CHAR);
     threshold->Update();
 
     vtkSmartPointer<vtkOrientedImageData> thresholdMask = vtkSmartPointer<vtkOrientedImageData>::New();
-    thresholdMask->DeepCopy(threshold->GetOutput());
+    thresholdMask->ShallowCopy(threshold->GetOutput());
     vtkSmartPointer<vtkMatrix4x4> modifierLabelmapToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
     modifierLabelmap->GetImageToWorldMatrix(modifierLabelmapToWorldMatrix);
     thresholdMask->SetGeometryFromImageToWorldMatrix(modifierLabelmapToWorldMatrix);
 
-    if (modifierLabelmap.GetPointer() == modifierLabelmapInput)
+    // Erase voxels of the modifier that are outside of the master volume, as they are outside of the intensity range
+    int* modifierExtent = modifierLabelmap->GetExtent();
+    int* thresholdMaskExtent = thresholdMask->GetExtent();
+    if (thresholdMaskExtent[0] > modifierExtent[0] || thresholdMaskExtent[1] < modifierExtent[1]
+      || thresholdMaskExtent[2] > modifierExtent[2] || thresholdMaskExtent[3] < modifierExtent[3]
+      || thresholdMaskExtent[4] > modifierExtent[4] || thresholdMaskExtent[5] < modifierExtent[5])
+      {
+      vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
+      padder->SetInputData(thresholdMask);
+      padder->SetOutputWholeExtent(extent ? const_cast<int*>(extent) : modifierExtent);
+      padder->SetConstant(1);
+      padder->Update();
+      thresholdMask->ShallowCopy(padder->GetOutput());
+      thresholdMask->SetGeometryFromImageToWorldMatrix(modifierLabelmapToWorldMatrix);
+      }
+
+    if (!vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, thresholdMask,
+      vtkOrientedImageDataResample::OPERATION_MASKING, extent, 0.0, this->m_EraseValue))
       {
-      // make a copy to not modify the input
-      vtkNew<vtkOrientedImageData> maskedModifierLabelmap;
-      maskedModifierLabelmap->DeepCopy(modifierLabelmap);
-      modifierLabelmap = maskedModifierLabelmap.GetPointer();
+      qCritical() << Q_FUNC_INFO << ": Failed to apply intensity mask on modifier labelmap";
       }
-    this->applyImageMask(modifierLabelmap.GetPointer(), thresholdMask, this->m_EraseValue);
     }
 
   if (!d->ParameterSetNode)
@@ -347,36 +469,11 @@ void qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap(vtkOrie
     return;
     }
 
-  if (!modifierLabelmap)
-    {
-    // If per-segment flag is off, then it is not an error (the effect itself has written it back to segmentation)
-    if (this->perSegment())
-      {
-      qCritical() << Q_FUNC_INFO << ": Cannot apply edit operation because modifier labelmap cannot be accessed";
-      }
-    this->defaultModifierLabelmap();
-    return;
-    }
-
   // Copy the temporary padded modifier labelmap to the segment.
   // Mask and threshold was already applied on modifier labelmap at this point if requested.
-  const int* extent = modificationExtent;
-  if (extent[0]>extent[1] || extent[2]>extent[3] || extent[4]>extent[5])
-    {
-    // invalid extent, it means we have to work with the entire modifier labelmap
-    extent = NULL;
-    }
 
-  // TODO: composite modifierLabelmap with threshold mask
-
-  // Create inverted binary labelmap
-  vtkSmartPointer<vtkImageThreshold> inverter = vtkSmartPointer<vtkImageThreshold>::New();
-  inverter->SetInputData(modifierLabelmap);
-  inverter->SetInValue(m_FillValue);
-  inverter->SetOutValue(m_EraseValue);
-  inverter->ReplaceInOn();
-  inverter->ThresholdByLower(0);
-  inverter->SetOutputScalarType(VTK_UNSIGNED_CHAR);
+  // Inverted binary labelmap, only created if needed
+  vtkSmartPointer<vtkOrientedImageData> invertedModifierLabelmap;
 
   if (modificationMode == qSlicerSegmentEditorAbstractEffect::ModificationModeSet)
     {
@@ -396,14 +493,10 @@ void qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap(vtkOrie
     }
   else if (modificationMode == qSlicerSegmentEditorAbstractEffect::ModificationModeRemove)
     {
-    inverter->Update();
-    vtkNew<vtkOrientedImageData> invertedModifierLabelmap;
-    invertedModifierLabelmap->ShallowCopy(inverter->GetOutput());
-    vtkNew<vtkMatrix4x4> imageToWorldMatrix;
-    modifierLabelmap->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
-    invertedModifierLabelmap->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+    invertedModifierLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    CreateInvertedLabelmap(modifierLabelmap, extent, this->m_FillValue, this->m_EraseValue, invertedModifierLabelmap);
     if (!vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
-      invertedModifierLabelmap.GetPointer(), segmentationNode, selectedSegmentID, vtkSlicerSegmentationsModuleLogic::MODE_MERGE_MIN, extent))
+      invertedModifierLabelmap, segmentationNode, selectedSegmentID, vtkSlicerSegmentationsModuleLogic::MODE_MERGE_MIN, extent))
       {
       qCritical() << Q_FUNC_INFO << ": Failed to remove modifier labelmap from selected segment";
       }
@@ -446,16 +539,15 @@ void qSlicerSegmentEditorAbstractEffect::modifySelectedSegmentByLabelmap(vtkOrie
     if (modificationMode == qSlicerSegmentEditorAbstractEffect::ModificationModeSet
       || modificationMode == qSlicerSegmentEditorAbstractEffect::ModificationModeAdd)
       {
-      inverter->Update();
-      vtkNew<vtkOrientedImageData> invertedModifierLabelmap;
-      invertedModifierLabelmap->ShallowCopy(inverter->GetOutput());
-      vtkNew<vtkMatrix4x4> imageToWorldMatrix;
-      modifierLabelmap->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
-      invertedModifierLabelmap->SetGeometryFromImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+      if (!invertedModifierLabelmap)
+        {
+        invertedModifierLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+        CreateInvertedLabelmap(modifierLabelmap, extent, this->m_FillValue, this->m_EraseValue, invertedModifierLabelmap);
+        }
       for (std::vector<std::string>::iterator segmentIDIt = segmentIDsToOverwrite.begin(); segmentIDIt != segmentIDsToOverwrite.end(); ++segmentIDIt)
         {
         if (!vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
-          invertedModifierLabelmap.GetPointer(), segmentationNode, *segmentIDIt, vtkSlicerSegmentationsModuleLogic::MODE_MERGE_MIN, extent))
+          invertedModifierLabelmap, segmentationNode, *segmentIDIt, vtkSlicerSegmentationsModuleLogic::MODE_MERGE_MIN, extent))
           {
           qCritical() << Q_FUNC_INFO << ": Failed to set modifier labelmap to segment " << (segmentIDIt->c_str());
           }
@@ -972,6 +1064,20 @@ vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::maskLabelmap()
   return d->MaskLabelmap;
 }
 
+//-----------------------------------------------------------------------------
+vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::maskLabelmap(const int extent[6])
+{
+  Q_D(qSlicerSegmentEditorAbstractEffect);
+  bool success = false;
+  emit d->updateVolumeInExtentSignal(d->MaskLabelmap.GetPointer(), extent, success);
+  if (!success)
+    {
+    // update in extent is not available, update the entire volume
+    return this->maskLabelmap();
+    }
+  return d->MaskLabelmap;
+}
+
 //-----------------------------------------------------------------------------
 vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::masterVolumeImageData()
 {
@@ -985,6 +1091,20 @@ vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::masterVolumeImageData(
   return d->AlignedMasterVolume;
 }
 
+//-----------------------------------------------------------------------------
+vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::masterVolumeImageData(const int extent[6])
+{
+  Q_D(qSlicerSegmentEditorAbstractEffect);
+  bool success = false;
+  emit d->updateVolumeInExtentSignal(d->AlignedMasterVolume.GetPointer(), extent, success);
+  if (!success)
+    {
+    // update in extent is not available, update the entire volume
+    return this->masterVolumeImageData();
+    }
+  return d->AlignedMasterVolume;
+}
+
 //-----------------------------------------------------------------------------
 vtkOrientedImageData* qSlicerSegmentEditorAbstractEffect::selectedSegmentLabelmap()
 {
@@ -237,7 +237,10 @@ public:
   /// \param selectEffectSlot called from the active effect to initiate switching to another effect (or de-select).
   /// \param updateVolumeSlot called to request update of a volume (modifierLabelmap, alignedMasterVolume, maskLabelmap).
   /// \param saveStateForUndoSlot called to request saving of segmentation state for undo operation
-  void setCallbackSlots(QObject* receiver, const char* selectEffectSlot, const char* updateVolumeSlot, const char* saveStateForUndoSlot);
+  /// \param updateVolumeInExtentSlot called to request update of a volume (alignedMasterVolume, maskLabelmap)
+  ///   only within an extent. If not specified then the entire volume is updated on each request.
+  void setCallbackSlots(QObject* receiver, const char* selectEffectSlot, const char* updateVolumeSlot, const char* saveStateForUndoSlot,
+    const char* updateVolumeInExtentSlot = NULL);
 
   /// Called by the editor widget.
   void setVolumes(vtkOrientedImageData* alignedMasterVolume, vtkOrientedImageData* modifierLabelmap,
@@ -313,6 +316,9 @@ public:
   Q_INVOKABLE vtkOrientedImageData* defaultModifierLabelmap();
 
   Q_INVOKABLE vtkOrientedImageData* maskLabelmap();
+  /// Get mask labelmap that is only guaranteed to be up-to-date within the specified extent.
+  /// It is faster than getting the entire mask labelmap if only a small region is edited.
+  vtkOrientedImageData* maskLabelmap(const int extent[6]);
 
   Q_INVOKABLE vtkOrientedImageData* selectedSegmentLabelmap();
 
@@ -327,6 +333,9 @@ public:
   /// Get image data of master volume aligned with the modifier labelmap.
   /// \return Pointer to the image data
   Q_INVOKABLE vtkOrientedImageData* masterVolumeImageData();
+  /// Get image data of master volume aligned with the modifier labelmap.
+  /// Voxel values are only guaranteed to be up-to-date within the specified extent.
+  vtkOrientedImageData* masterVolumeImageData(const int extent[6]);
 
   /// Signal to the editor that current state has to be saved (for allowing reverting
   /// to current segmentation state by undo operation)
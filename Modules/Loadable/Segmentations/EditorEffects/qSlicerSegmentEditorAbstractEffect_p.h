@@ -69,6 +69,7 @@ signals:
   // without having any dependency on the editor.
   void selectEffectSignal(QString);
   void updateVolumeSignal(void*,bool&);
+  void updateVolumeInExtentSignal(void*,const int*,bool&);
   void saveStateForUndoSignal();
 public:
   /// Segment editor parameter set node
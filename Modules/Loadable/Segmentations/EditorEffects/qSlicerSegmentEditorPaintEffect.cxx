@@ -24,6 +24,7 @@
 #include "vtkMRMLSegmentationNode.h"
 #include "vtkMRMLSegmentEditorNode.h"
 #include "vtkOrientedImageData.h"
+#include "vtkSlicerSegmentationsModuleLogic.h"
 
 // Qt includes
 #include <QDebug>
@@ -45,10 +46,6 @@
 #include <vtkGlyph2D.h>
 #include <vtkGlyph3D.h>
 #include <vtkIdList.h>
-#include <vtkImageChangeInformation.h>
-#include <vtkImageStencil.h>
-#include <vtkImageStencilData.h>
-#include <vtkImageStencilToImage.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
@@ -59,7 +56,6 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkPolyDataNormals.h>
-#include <vtkPolyDataToImageStencil.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkPropPicker.h>
@@ -92,6 +88,10 @@
 #include "vtkMRMLSliceLayerLogic.h"
 #include "vtkOrientedImageDataResample.h"
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+
 //-----------------------------------------------------------------------------
 /// Visualization objects and pipeline for each slice view for the paint brush
 class BrushPipeline
@@ -217,6 +217,7 @@ public:
 //-----------------------------------------------------------------------------
 qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(qSlicerSegmentEditorPaintEffect& object)
   : q_ptr(&object)
+  , LastPaintPositionValid(false)
   , DelayedPaint(true)
   , IsPainting(false)
   , ActiveViewWidget(NULL)
@@ -229,6 +230,9 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   , BrushPixelModeCheckbox(NULL)
 {
   this->PaintCoordinates_World = vtkSmartPointer<vtkPoints>::New();
+  this->LastPaintPosition_World[0] = 0.0;
+  this->LastPaintPosition_World[1] = 0.0;
+  this->LastPaintPosition_World[2] = 0.0;
   this->FeedbackPointsPolyData = vtkSmartPointer<vtkPolyData>::New();
   this->FeedbackPointsPolyData->SetPoints(this->PaintCoordinates_World);
 
@@ -248,14 +252,6 @@ qSlicerSegmentEditorPaintEffectPrivate::qSlicerSegmentEditorPaintEffectPrivate(q
   this->WorldOriginToWorldTransformer->SetTransform(this->WorldOriginToWorldTransform);
   this->WorldOriginToWorldTransformer->SetInputConnection(this->BrushPolyDataNormals->GetOutputPort());
 
-  this->WorldOriginToModifierLabelmapIjkTransformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  this->WorldOriginToModifierLabelmapIjkTransform = vtkSmartPointer<vtkTransform>::New();
-  this->WorldOriginToModifierLabelmapIjkTransformer->SetTransform(this->WorldOriginToModifierLabelmapIjkTransform);
-  this->WorldOriginToModifierLabelmapIjkTransformer->SetInputConnection(this->BrushPolyDataNormals->GetOutputPort());
-  this->BrushPolyDataToStencil = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
-  this->BrushPolyDataToStencil->SetOutputSpacing(1.0,1.0,1.0);
-  this->BrushPolyDataToStencil->SetInputConnection(this->WorldOriginToModifierLabelmapIjkTransformer->GetOutputPort());
-
   this->FeedbackGlyphFilter = vtkSmartPointer<vtkGlyph3D>::New();
   this->FeedbackGlyphFilter->SetInputData(this->FeedbackPointsPolyData);
   this->FeedbackGlyphFilter->SetSourceConnection(this->BrushPolyDataNormals->GetOutputPort());
@@ -347,81 +343,98 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintApply(qMRMLWidget* viewWidget)
     return;
     }
 
-  q->saveStateForUndo();
-
   QList<int> updateExtentList;
 
   if (q->integerParameter("BrushPixelMode"))
     {
+    q->saveStateForUndo();
     this->paintPixels(viewWidget, this->PaintCoordinates_World);
     }
   else
     {
-    this->updateBrushStencil(viewWidget);
-
-    this->BrushPolyDataToStencil->Update();
-    vtkImageStencilData* stencilData = this->BrushPolyDataToStencil->GetOutput();
-    int stencilExtent[6]={0,-1,0,-1,0,-1};
-    stencilData->GetExtent(stencilExtent);
-
-    vtkNew<vtkTransform> worldToModifierLabelmapIjkTransform;
-
-    vtkNew<vtkMatrix4x4> segmentationToSegmentationIjkTransformMatrix;
-    modifierLabelmap->GetWorldToImageMatrix(segmentationToSegmentationIjkTransformMatrix.GetPointer());
-    worldToModifierLabelmapIjkTransform->Concatenate(segmentationToSegmentationIjkTransformMatrix.GetPointer());
+    // Brush shape in world coordinate system (same as the brush model, see updateBrushModel)
+    this->updateAbsoluteBrushDiameter();
+    double brushRadius = q->doubleParameter("BrushAbsoluteDiameter") / 2.0;
+    bool brushCylinder = false;
+    double brushAxisDirection[3] = { 0.0, 0.0, 1.0 };
+    double brushHalfHeight = 0.0;
+    qMRMLSliceWidget* sliceWidget = qobject_cast<qMRMLSliceWidget*>(viewWidget);
+    if (sliceWidget && !q->integerParameter("BrushSphere"))
+      {
+      vtkMatrix4x4* sliceToRas = sliceWidget->sliceLogic()->GetSliceNode()->GetSliceToRAS();
+      brushCylinder = true;
+      brushAxisDirection[0] = sliceToRas->GetElement(0, 2);
+      brushAxisDirection[1] = sliceToRas->GetElement(1, 2);
+      brushAxisDirection[2] = sliceToRas->GetElement(2, 2);
+      brushHalfHeight = qSlicerSegmentEditorAbstractEffect::sliceSpacing(sliceWidget) / 2.0;
+      }
 
+    vtkNew<vtkMatrix4x4> segmentationToModifierLabelmapIjkMatrix;
+    modifierLabelmap->GetWorldToImageMatrix(segmentationToModifierLabelmapIjkMatrix.GetPointer());
     vtkNew<vtkMatrix4x4> worldToSegmentationTransformMatrix;
     // We don't support painting in non-linearly transformed node (it could be implemented, but would probably slow down things too much)
     // TODO: show a meaningful error message to the user if attempted
     vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(NULL, segmentationNode->GetParentTransformNode(), worldToSegmentationTransformMatrix.GetPointer());
-    worldToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationTransformMatrix.GetPointer());
-
-    vtkNew<vtkPoints> paintCoordinates_Ijk;
-    worldToModifierLabelmapIjkTransform->TransformPoints(this->PaintCoordinates_World, paintCoordinates_Ijk.GetPointer());
-
-    vtkNew<vtkImageStencilToImage> stencilToImage;
-    stencilToImage->SetInputConnection(this->BrushPolyDataToStencil->GetOutputPort());
-    stencilToImage->SetInsideValue(q->m_FillValue);
-    stencilToImage->SetOutsideValue(q->m_EraseValue);
-    stencilToImage->SetOutputScalarType(modifierLabelmap->GetScalarType());
-
-    vtkNew<vtkImageChangeInformation> brushPositioner;
-    brushPositioner->SetInputConnection(stencilToImage->GetOutputPort());
-    brushPositioner->SetOutputSpacing(modifierLabelmap->GetSpacing());
-    brushPositioner->SetOutputOrigin(modifierLabelmap->GetOrigin());
-
-    vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
+    vtkNew<vtkMatrix4x4> worldToModifierLabelmapIjkMatrix;
+    vtkMatrix4x4::Multiply4x4(segmentationToModifierLabelmapIjkMatrix.GetPointer(), worldToSegmentationTransformMatrix.GetPointer(),
+      worldToModifierLabelmapIjkMatrix.GetPointer());
+    vtkNew<vtkMatrix4x4> modifierLabelmapIjkToWorldMatrix;
+    vtkMatrix4x4::Invert(worldToModifierLabelmapIjkMatrix.GetPointer(), modifierLabelmapIjkToWorldMatrix.GetPointer());
+
+    // Stamp the brush directly into the modifier labelmap. Consecutive positions of the stroke
+    // are connected by sweeping the brush between them.
+    int* modifierLabelmapExtent = modifierLabelmap->GetExtent();
     int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
-    for (int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
+    vtkIdType numberOfPoints = this->PaintCoordinates_World->GetNumberOfPoints();
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; pointIndex++)
       {
-      double* shiftDouble = paintCoordinates_Ijk->GetPoint(pointIndex);
-      int shift[3] = {int(shiftDouble[0]+0.5), int(shiftDouble[1]+0.5), int(shiftDouble[2]+0.5)};
-      brushPositioner->SetExtentTranslation(shift);
-      brushPositioner->Update();
-      vtkNew<vtkOrientedImageData> orientedBrushPositionerOutput;
-      orientedBrushPositionerOutput->ShallowCopy(brushPositioner->GetOutput());
-      orientedBrushPositionerOutput->CopyDirections(modifierLabelmap);
-      if (pointIndex == 0)
+      double endPosition_World[3] = { 0.0, 0.0, 0.0 };
+      this->PaintCoordinates_World->GetPoint(pointIndex, endPosition_World);
+      double startPosition_World[3] = { endPosition_World[0], endPosition_World[1], endPosition_World[2] };
+      if (this->LastPaintPositionValid)
+        {
+        startPosition_World[0] = this->LastPaintPosition_World[0];
+        startPosition_World[1] = this->LastPaintPosition_World[1];
+        startPosition_World[2] = this->LastPaintPosition_World[2];
+        }
+      this->LastPaintPosition_World[0] = endPosition_World[0];
+      this->LastPaintPosition_World[1] = endPosition_World[1];
+      this->LastPaintPosition_World[2] = endPosition_World[2];
+      this->LastPaintPositionValid = true;
+
+      int brushExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      if (!vtkSlicerSegmentationsModuleLogic::GetSweptBrushExtent(worldToModifierLabelmapIjkMatrix.GetPointer(), modifierLabelmapExtent,
+        brushRadius, brushCylinder, brushAxisDirection, brushHalfHeight, startPosition_World, endPosition_World, brushExtent))
+        {
+        continue;
+        }
+      if (!vtkSlicerSegmentationsModuleLogic::PaintSweptBrush(modifierLabelmap, modifierLabelmapIjkToWorldMatrix.GetPointer(), brushExtent,
+        brushRadius, brushCylinder, brushAxisDirection, brushHalfHeight, startPosition_World, endPosition_World, q->m_FillValue))
         {
-        orientedBrushPositionerOutput->GetExtent(updateExtent);
+        qCritical() << Q_FUNC_INFO << ": Failed to paint brush into the modifier labelmap";
+        this->PaintCoordinates_World->Reset();
+        return;
+        }
+      if (updateExtent[0] > updateExtent[1])
+        {
+        std::copy(brushExtent, brushExtent + 6, updateExtent);
         }
       else
         {
-        int* brushExtent = orientedBrushPositionerOutput->GetExtent();
         for (int i = 0; i < 3; i++)
           {
-          if (brushExtent[i * 2] < updateExtent[i * 2])
-            {
-            updateExtent[i * 2] = brushExtent[i * 2];
-            }
-          if (brushExtent[i * 2 + 1] > updateExtent[i * 2 + 1])
-            {
-            updateExtent[i * 2 + 1] = brushExtent[i * 2 + 1];
-            }
+          updateExtent[i * 2] = std::min(updateExtent[i * 2], brushExtent[i * 2]);
+          updateExtent[i * 2 + 1] = std::max(updateExtent[i * 2 + 1], brushExtent[i * 2 + 1]);
           }
         }
-      vtkOrientedImageDataResample::ModifyImage(modifierLabelmap, orientedBrushPositionerOutput.GetPointer(), vtkOrientedImageDataResample::OPERATION_MAXIMUM);
       }
+    if (updateExtent[0] > updateExtent[1])
+      {
+      // brush is outside of the segmentation, nothing to modify
+      this->PaintCoordinates_World->Reset();
+      return;
+      }
+    q->saveStateForUndo();
     modifierLabelmap->Modified();
     for (int i = 0; i < 6; i++)
       {
@@ -435,58 +448,6 @@ void qSlicerSegmentEditorPaintEffectPrivate::paintApply(qMRMLWidget* viewWidget)
   q->modifySelectedSegmentByLabelmap(modifierLabelmap, modificationMode, updateExtentList);
 }
 
-//-----------------------------------------------------------------------------
-void qSlicerSegmentEditorPaintEffectPrivate::updateBrushStencil(qMRMLWidget* viewWidget)
-{
-  Q_Q(qSlicerSegmentEditorPaintEffect);
-  Q_UNUSED(viewWidget);
-
-  if (!q->parameterSetNode())
-    {
-    qCritical() << Q_FUNC_INFO << ": Invalid segment editor parameter set node!";
-    return;
-    }
-  vtkMRMLSegmentationNode* segmentationNode = q->parameterSetNode()->GetSegmentationNode();
-  if (!segmentationNode)
-    {
-    qCritical() << Q_FUNC_INFO << ": Invalid segmentationNode";
-    return;
-    }
-  vtkOrientedImageData* modifierLabelmap = q->modifierLabelmap();
-  if (!modifierLabelmap)
-    {
-    qCritical() << Q_FUNC_INFO << ": Invalid modifierLabelmap";
-    return;
-    }
-
-  // Brush stencil transform
-
-  this->WorldOriginToModifierLabelmapIjkTransform->Identity();
-
-  vtkNew<vtkMatrix4x4> segmentationToSegmentationIjkTransformMatrix;
-  modifierLabelmap->GetImageToWorldMatrix(segmentationToSegmentationIjkTransformMatrix.GetPointer());
-  segmentationToSegmentationIjkTransformMatrix->Invert();
-  segmentationToSegmentationIjkTransformMatrix->SetElement(0,3, 0);
-  segmentationToSegmentationIjkTransformMatrix->SetElement(1,3, 0);
-  segmentationToSegmentationIjkTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(segmentationToSegmentationIjkTransformMatrix.GetPointer());
-
-  vtkNew<vtkMatrix4x4> worldToSegmentationTransformMatrix;
-  // We don't support painting in non-linearly transformed node (it could be implemented, but would probably slow down things too much)
-  // TODO: show a meaningful error message to the user if attempted
-  vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(NULL, segmentationNode->GetParentTransformNode(), worldToSegmentationTransformMatrix.GetPointer());
-  worldToSegmentationTransformMatrix->SetElement(0,3, 0);
-  worldToSegmentationTransformMatrix->SetElement(1,3, 0);
-  worldToSegmentationTransformMatrix->SetElement(2,3, 0);
-  this->WorldOriginToModifierLabelmapIjkTransform->Concatenate(worldToSegmentationTransformMatrix.GetPointer());
-
-  this->WorldOriginToModifierLabelmapIjkTransformer->Update();
-  vtkPolyData* brushModel_ModifierLabelmapIjk = this->WorldOriginToModifierLabelmapIjkTransformer->GetOutput();
-  double* boundsIjk = brushModel_ModifierLabelmapIjk->GetBounds();
-  this->BrushPolyDataToStencil->SetOutputWholeExtent(floor(boundsIjk[0])-1, ceil(boundsIjk[1])+1,
-    floor(boundsIjk[2])-1, ceil(boundsIjk[3])+1, floor(boundsIjk[4])-1, ceil(boundsIjk[5])+1);
-}
-
 //-----------------------------------------------------------------------------
 void qSlicerSegmentEditorPaintEffectPrivate::paintPixel(qMRMLWidget* viewWidget, double pixelPosition_World[3])
 {
@@ -698,7 +659,7 @@ void qSlicerSegmentEditorPaintEffectPrivate::updateBrushModel(qMRMLWidget* viewW
     this->BrushCylinderSource->SetResolution(32);
     double sliceSpacingMm = qSlicerSegmentEditorAbstractEffect::sliceSpacing(sliceWidget);
     this->BrushCylinderSource->SetHeight(sliceSpacingMm);
-    this->BrushCylinderSource->SetCenter(0, 0, sliceSpacingMm/2.0);
+    this->BrushCylinderSource->SetCenter(0, 0, 0); // the brush is centered on the slice
     this->BrushToWorldOriginTransformer->SetInputConnection(this->BrushCylinderSource->GetOutputPort());
     }
 
@@ -1075,6 +1036,7 @@ bool qSlicerSegmentEditorPaintEffect::processInteractionEvents(
   if (eid == vtkCommand::LeftButtonPressEvent && !shiftKeyPressed)
     {
     d->IsPainting = true;
+    d->LastPaintPositionValid = false;
     if (!this->integerParameter("BrushPixelMode"))
       {
       //this->cursorOff(sliceWidget);
@@ -64,7 +64,6 @@ class vtkActor2D;
 class vtkGlyph3D;
 class vtkPoints;
 class vtkPolyDataNormals;
-class vtkPolyDataToImageStencil;
 
 /// \ingroup SlicerRt_QtModules_Segmentations
 /// \brief Private implementation of the segment editor paint effect
@@ -92,10 +91,6 @@ public:
   /// Update brush model (shape and position)
   void updateBrushModel(qMRMLWidget* viewWidget, double brushPosition_World[3]);
 
-  /// Updates the brush stencil that can be used to quickly paint the brush shape into
-  /// modifierLabelmap at many different positions.
-  void updateBrushStencil(qMRMLWidget* viewWidget);
-
 protected:
   /// Get brush object for widget. Create if does not exist
   BrushPipeline* brushForWidget(qMRMLWidget* viewWidget);
@@ -134,13 +129,14 @@ public:
   vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToWorldTransformer;
   vtkSmartPointer<vtkTransform> WorldOriginToWorldTransform;
   vtkSmartPointer<vtkPolyDataNormals> BrushPolyDataNormals;
-  vtkSmartPointer<vtkTransformPolyDataFilter> WorldOriginToModifierLabelmapIjkTransformer;
-  vtkSmartPointer<vtkTransform> WorldOriginToModifierLabelmapIjkTransform; // transforms from polydata source to modifierLabelmap's IJK coordinate system (brush origin in IJK origin)
-  vtkSmartPointer<vtkPolyDataToImageStencil> BrushPolyDataToStencil;
 
   vtkSmartPointer<vtkGlyph3D> FeedbackGlyphFilter;
 
   vtkSmartPointer<vtkPoints> PaintCoordinates_World;
+  /// Last painted brush position of the current stroke. Consecutive brush positions
+  /// are connected even if they are painted in separate paintApply calls.
+  double LastPaintPosition_World[3];
+  bool LastPaintPositionValid;
   vtkSmartPointer<vtkPolyData> FeedbackPointsPolyData;
 
   QList<vtkActor2D*> FeedbackActors;
@@ -0,0 +1,191 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkImageGrowCutSegment.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+// The radix heap engine (default) is tested by comparing its result with the result of the
+// Fibonacci heap engine. Intensities are pseudo-random, therefore the distances that are
+// pushed to the queue are not sorted, and seeds of different labels are placed in arbitrary order.
+
+namespace
+{
+
+const int VOLUME_SIZE = 24;
+
+//-----------------------------------------------------------------------------
+class PseudoRandomGenerator
+{
+public:
+  PseudoRandomGenerator() : State(12345) {}
+  /// Returns a value between 0 and 32767
+  int Next()
+  {
+    this->State = this->State * 1103515245u + 12345u;
+    return static_cast<int>((this->State >> 16) & 0x7fff);
+  }
+private:
+  unsigned int State;
+};
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateIntensityVolume(int scalarType)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1);
+  image->AllocateScalars(scalarType, 1);
+  PseudoRandomGenerator generator;
+  for (int k = 0; k < VOLUME_SIZE; k++)
+    {
+    for (int j = 0; j < VOLUME_SIZE; j++)
+      {
+      for (int i = 0; i < VOLUME_SIZE; i++)
+        {
+        // Two regions of different mean intensity with noise
+        double value = (i < VOLUME_SIZE / 2 ? 100.0 : 600.0) + generator.Next() % 400;
+        if (scalarType == VTK_FLOAT)
+          {
+          value += (generator.Next() % 1000) / 1000.0;
+          }
+        image->SetScalarComponentFromDouble(i, j, k, 0, value);
+        }
+      }
+    }
+  return image;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> CreateSeedVolume()
+{
+  vtkSmartPointer<vtkImageData> seeds = vtkSmartPointer<vtkImageData>::New();
+  seeds->SetExtent(0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1);
+  seeds->AllocateScalars(VTK_SHORT, 1);
+  seeds->GetPointData()->GetScalars()->FillComponent(0, 0);
+  // Label values are not in the order of voxel indices
+  seeds->SetScalarComponentFromDouble(VOLUME_SIZE - 3, VOLUME_SIZE - 4, VOLUME_SIZE - 5, 0, 1);
+  seeds->SetScalarComponentFromDouble(2, 3, 4, 0, 3);
+  seeds->SetScalarComponentFromDouble(4, VOLUME_SIZE - 3, 2, 0, 2);
+  seeds->SetScalarComponentFromDouble(VOLUME_SIZE - 5, 2, VOLUME_SIZE / 2, 0, 3);
+  return seeds;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> RunGrowCut(vtkImageGrowCutSegment* growCut)
+{
+  growCut->Update();
+  vtkSmartPointer<vtkImageData> result = vtkSmartPointer<vtkImageData>::New();
+  result->DeepCopy(growCut->GetOutput());
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the number of voxels that are labeled differently in the two label volumes
+// or that are not labeled at all.
+int CompareLabels(vtkImageData* labels, vtkImageData* referenceLabels)
+{
+  int numberOfMismatches = 0;
+  for (int k = 0; k < VOLUME_SIZE; k++)
+    {
+    for (int j = 0; j < VOLUME_SIZE; j++)
+      {
+      for (int i = 0; i < VOLUME_SIZE; i++)
+        {
+        int label = static_cast<int>(labels->GetScalarComponentAsDouble(i, j, k, 0));
+        int referenceLabel = static_cast<int>(referenceLabels->GetScalarComponentAsDouble(i, j, k, 0));
+        if (label == referenceLabel && label != 0)
+          {
+          continue;
+          }
+        if (numberOfMismatches < 10)
+          {
+          std::cerr << "Mismatch at voxel (" << i << ", " << j << ", " << k << "): "
+            << label << " != " << referenceLabel << std::endl;
+          }
+        numberOfMismatches++;
+        }
+      }
+    }
+  return numberOfMismatches;
+}
+
+//-----------------------------------------------------------------------------
+bool TestRadixHeapEngine(int scalarType, int maximumNumberOfMismatches)
+{
+  vtkSmartPointer<vtkImageData> intensities = CreateIntensityVolume(scalarType);
+  vtkSmartPointer<vtkImageData> seeds = CreateSeedVolume();
+
+  vtkNew<vtkImageGrowCutSegment> radixGrowCut;
+  if (radixGrowCut->GetEngine() != vtkImageGrowCutSegment::ENGINE_RADIX_HEAP)
+    {
+    std::cerr << "Line " << __LINE__ << ": radix heap engine is expected to be the default" << std::endl;
+    return false;
+    }
+  radixGrowCut->SetIntensityVolume(intensities);
+  radixGrowCut->SetSeedLabelVolume(seeds);
+
+  vtkNew<vtkImageGrowCutSegment> fibonacciGrowCut;
+  fibonacciGrowCut->SetEngineToFibonacciHeap();
+  fibonacciGrowCut->SetIntensityVolume(intensities);
+  fibonacciGrowCut->SetSeedLabelVolume(seeds);
+
+  int numberOfMismatches = CompareLabels(RunGrowCut(radixGrowCut.GetPointer()), RunGrowCut(fibonacciGrowCut.GetPointer()));
+  if (numberOfMismatches > maximumNumberOfMismatches)
+    {
+    std::cerr << "Line " << __LINE__ << ": initial segmentation of scalar type " << scalarType
+      << " differs in " << numberOfMismatches << " voxels" << std::endl;
+    return false;
+    }
+
+  // Incremental update after adding a seed
+  seeds->SetScalarComponentFromDouble(VOLUME_SIZE / 2, VOLUME_SIZE / 2, VOLUME_SIZE / 2, 0, 2);
+  seeds->Modified();
+  numberOfMismatches = CompareLabels(RunGrowCut(radixGrowCut.GetPointer()), RunGrowCut(fibonacciGrowCut.GetPointer()));
+  if (numberOfMismatches > maximumNumberOfMismatches)
+    {
+    std::cerr << "Line " << __LINE__ << ": updated segmentation of scalar type " << scalarType
+      << " differs in " << numberOfMismatches << " voxels" << std::endl;
+    return false;
+    }
+
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkImageGrowCutSegmentTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Float intensities are quantized in the radix heap, but the processing order does not
+  // affect the computed distances, so the result must be identical.
+  if (!TestRadixHeapEngine(VTK_FLOAT, 0))
+    {
+    return EXIT_FAILURE;
+    }
+  // Integer intensities may lead to equal distances from different seeds, where the label
+  // depends on the processing order. Allow a small number of such voxels.
+  const int numberOfVoxels = VOLUME_SIZE * VOLUME_SIZE * VOLUME_SIZE;
+  if (!TestRadixHeapEngine(VTK_SHORT, numberOfVoxels / 100))
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
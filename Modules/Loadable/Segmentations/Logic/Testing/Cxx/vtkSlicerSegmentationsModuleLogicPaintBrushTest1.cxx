@@ -0,0 +1,276 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkSlicerSegmentationsModuleLogic.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+// The voxels painted by the swept brush (computed analytically for each voxel row) are compared
+// with a brute-force computation of the distance of each voxel center from the brush stroke.
+// Voxels whose center is within a small tolerance of the brush surface are not compared,
+// as rounding errors may put them on either side.
+
+namespace
+{
+
+const int VOLUME_SIZE = 32;
+const double SURFACE_TOLERANCE = 1e-6;
+
+//-----------------------------------------------------------------------------
+/// Brush shape and stroke in world coordinates
+struct BrushStroke
+{
+  double Radius;
+  bool Cylinder;
+  double AxisDirection[3];
+  double HalfHeight;
+  double StartPosition[3];
+  double EndPosition[3];
+};
+
+//-----------------------------------------------------------------------------
+/// Distance of the point from the line segment between (0,0,0) and segmentVector
+double DistanceFromSegment(const double point[3], const double segmentVector[3])
+{
+  double segmentLength2 = vtkMath::Dot(segmentVector, segmentVector);
+  double t = 0.0;
+  if (segmentLength2 > 0.0)
+    {
+    t = vtkMath::Dot(point, segmentVector) / segmentLength2;
+    t = std::max(0.0, std::min(1.0, t));
+    }
+  double closestPoint[3] = { t * segmentVector[0], t * segmentVector[1], t * segmentVector[2] };
+  return sqrt(vtkMath::Distance2BetweenPoints(point, closestPoint));
+}
+
+//-----------------------------------------------------------------------------
+/// Returns 1 if the point is inside the swept brush, 0 if outside, -1 if it is too close to the surface to decide
+int IsInsideSweptBrush(const double point_World[3], const BrushStroke& stroke)
+{
+  double point[3] = { 0.0, 0.0, 0.0 };
+  double segmentVector[3] = { 0.0, 0.0, 0.0 };
+  vtkMath::Subtract(point_World, stroke.StartPosition, point);
+  vtkMath::Subtract(stroke.EndPosition, stroke.StartPosition, segmentVector);
+  bool insideHeight = true;
+  if (stroke.Cylinder)
+    {
+    double axis[3] = { stroke.AxisDirection[0], stroke.AxisDirection[1], stroke.AxisDirection[2] };
+    vtkMath::Normalize(axis);
+    double height = vtkMath::Dot(point, axis);
+    if (fabs(fabs(height) - stroke.HalfHeight) < SURFACE_TOLERANCE)
+      {
+      return -1;
+      }
+    insideHeight = (fabs(height) < stroke.HalfHeight);
+    double segmentHeight = vtkMath::Dot(segmentVector, axis);
+    for (int i = 0; i < 3; i++)
+      {
+      point[i] -= height * axis[i];
+      segmentVector[i] -= segmentHeight * axis[i];
+      }
+    }
+  double distance = DistanceFromSegment(point, segmentVector);
+  if (fabs(distance - stroke.Radius) < SURFACE_TOLERANCE)
+    {
+    return -1;
+    }
+  return (insideHeight && distance < stroke.Radius) ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+bool TestSweptBrush(vtkMatrix4x4* ijkToWorldMatrix, const BrushStroke& stroke, const char* description,
+  int& numberOfPaintedVoxels)
+{
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetExtent(0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->FillComponent(0, 0);
+
+  vtkNew<vtkMatrix4x4> worldToIjkMatrix;
+  vtkMatrix4x4::Invert(ijkToWorldMatrix, worldToIjkMatrix.GetPointer());
+
+  int brushExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (vtkSlicerSegmentationsModuleLogic::GetSweptBrushExtent(worldToIjkMatrix.GetPointer(), labelmap->GetExtent(),
+    stroke.Radius, stroke.Cylinder, stroke.AxisDirection, stroke.HalfHeight, stroke.StartPosition, stroke.EndPosition, brushExtent))
+    {
+    if (!vtkSlicerSegmentationsModuleLogic::PaintSweptBrush(labelmap.GetPointer(), ijkToWorldMatrix, brushExtent,
+      stroke.Radius, stroke.Cylinder, stroke.AxisDirection, stroke.HalfHeight, stroke.StartPosition, stroke.EndPosition, 1.0))
+      {
+      std::cerr << "Line " << __LINE__ << ": " << description << ": PaintSweptBrush failed" << std::endl;
+      return false;
+      }
+    }
+
+  // All voxels are checked, so that voxels missed by the computed brush extent are detected as well
+  int numberOfMismatches = 0;
+  for (int k = 0; k < VOLUME_SIZE; k++)
+    {
+    for (int j = 0; j < VOLUME_SIZE; j++)
+      {
+      for (int i = 0; i < VOLUME_SIZE; i++)
+        {
+        double point_Ijk[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+        double point_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+        ijkToWorldMatrix->MultiplyPoint(point_Ijk, point_World);
+        int expected = IsInsideSweptBrush(point_World, stroke);
+        if (expected < 0)
+          {
+          continue;
+          }
+        numberOfPaintedVoxels += expected;
+        int painted = static_cast<int>(labelmap->GetScalarComponentAsDouble(i, j, k, 0));
+        if (painted == expected)
+          {
+          continue;
+          }
+        if (numberOfMismatches < 10)
+          {
+          std::cerr << description << ": mismatch at voxel (" << i << ", " << j << ", " << k << "): painted="
+            << painted << ", expected=" << expected << std::endl;
+          }
+        numberOfMismatches++;
+        }
+      }
+    }
+  if (numberOfMismatches > 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": " << description << ": " << numberOfMismatches
+      << " voxels differ from the brute-force result" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerSegmentationsModuleLogicPaintBrushTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // IJK to world matrices: identity, anisotropic spacing with oblique axes, and oblique axes with flipped handedness
+  vtkNew<vtkTransform> identityTransform;
+  vtkNew<vtkTransform> obliqueTransform;
+  obliqueTransform->Translate(-12.0, 5.0, 30.0);
+  obliqueTransform->RotateWXYZ(35.0, 1.0, 2.0, 3.0);
+  obliqueTransform->Scale(0.8, 1.2, 1.7);
+  vtkNew<vtkTransform> flippedObliqueTransform;
+  flippedObliqueTransform->Translate(40.0, -20.0, 10.0);
+  flippedObliqueTransform->RotateWXYZ(-60.0, 0.3, -1.0, 0.5);
+  flippedObliqueTransform->Scale(-0.9, 1.1, 0.6);
+  const int numberOfMatrices = 3;
+  vtkTransform* ijkToWorldTransforms[numberOfMatrices] =
+    { identityTransform.GetPointer(), obliqueTransform.GetPointer(), flippedObliqueTransform.GetPointer() };
+
+  const int numberOfRadii = 3;
+  const double radii[numberOfRadii] = { 0.7, 2.5, 5.3 };
+
+  // Stroke vectors in IJK coordinates: single stamp, along a row, along a column, oblique
+  const int numberOfStrokes = 4;
+  const double strokes_Ijk[numberOfStrokes][3] = { { 0.0, 0.0, 0.0 }, { 9.0, 0.0, 0.0 }, { 0.0, 0.0, 7.5 }, { 6.3, -4.1, 5.2 } };
+
+  // Cylinder axes in world coordinates (zero height means sphere brush)
+  const int numberOfBrushShapes = 3;
+  const double axisDirections[numberOfBrushShapes][3] = { { 0.0, 0.0, 1.0 }, { 0.0, 0.0, 1.0 }, { 0.3, 0.2, 0.93 } };
+  const double halfHeights[numberOfBrushShapes] = { 0.0, 1.6, 0.55 };
+
+  for (int matrixIndex = 0; matrixIndex < numberOfMatrices; matrixIndex++)
+    {
+    // Some of the smallest brushes may not contain any voxel center, but all the strokes together must
+    int numberOfPaintedVoxels = 0;
+    vtkMatrix4x4* ijkToWorldMatrix = ijkToWorldTransforms[matrixIndex]->GetMatrix();
+    for (int radiusIndex = 0; radiusIndex < numberOfRadii; radiusIndex++)
+      {
+      for (int strokeIndex = 0; strokeIndex < numberOfStrokes; strokeIndex++)
+        {
+        for (int shapeIndex = 0; shapeIndex < numberOfBrushShapes; shapeIndex++)
+          {
+          BrushStroke stroke;
+          stroke.Radius = radii[radiusIndex];
+          stroke.Cylinder = (halfHeights[shapeIndex] > 0.0);
+          stroke.HalfHeight = halfHeights[shapeIndex];
+          // Stroke is centered in the volume, starting at a non-integer position
+          double start_Ijk[4] = { 0.0, 0.0, 0.0, 1.0 };
+          double end_Ijk[4] = { 0.0, 0.0, 0.0, 1.0 };
+          for (int i = 0; i < 3; i++)
+            {
+            stroke.AxisDirection[i] = axisDirections[shapeIndex][i];
+            start_Ijk[i] = VOLUME_SIZE / 2 + 0.37 * (i + 1) - strokes_Ijk[strokeIndex][i] / 2.0;
+            end_Ijk[i] = start_Ijk[i] + strokes_Ijk[strokeIndex][i];
+            }
+          double start_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+          double end_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+          ijkToWorldMatrix->MultiplyPoint(start_Ijk, start_World);
+          ijkToWorldMatrix->MultiplyPoint(end_Ijk, end_World);
+          for (int i = 0; i < 3; i++)
+            {
+            stroke.StartPosition[i] = start_World[i];
+            stroke.EndPosition[i] = end_World[i];
+            }
+          std::stringstream description;
+          description << "matrix " << matrixIndex << ", radius " << stroke.Radius << ", stroke " << strokeIndex
+            << ", brush shape " << shapeIndex;
+          if (!TestSweptBrush(ijkToWorldMatrix, stroke, description.str().c_str(), numberOfPaintedVoxels))
+            {
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+
+    // Stroke partially outside of the volume, the painted region must be clipped to the labelmap extent
+    BrushStroke stroke;
+    stroke.Radius = 4.0;
+    stroke.Cylinder = false;
+    stroke.AxisDirection[0] = 0.0;
+    stroke.AxisDirection[1] = 0.0;
+    stroke.AxisDirection[2] = 1.0;
+    stroke.HalfHeight = 0.0;
+    double start_Ijk[4] = { -3.0, -2.0, -4.0, 1.0 };
+    double end_Ijk[4] = { 5.0, 3.0, 2.0, 1.0 };
+    double start_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+    double end_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+    ijkToWorldMatrix->MultiplyPoint(start_Ijk, start_World);
+    ijkToWorldMatrix->MultiplyPoint(end_Ijk, end_World);
+    for (int i = 0; i < 3; i++)
+      {
+      stroke.StartPosition[i] = start_World[i];
+      stroke.EndPosition[i] = end_World[i];
+      }
+    std::stringstream description;
+    description << "matrix " << matrixIndex << ", stroke at the volume corner";
+    if (!TestSweptBrush(ijkToWorldMatrix, stroke, description.str().c_str(), numberOfPaintedVoxels))
+      {
+      return EXIT_FAILURE;
+      }
+
+    if (numberOfPaintedVoxels == 0)
+      {
+      std::cerr << "Line " << __LINE__ << ": matrix " << matrixIndex << ": brushes do not cover any voxel" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
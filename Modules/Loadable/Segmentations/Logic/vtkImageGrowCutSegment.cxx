@@ -1,6 +1,9 @@
 #include "vtkImageGrowCutSegment.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <vtkInformation.h>
@@ -22,6 +25,10 @@ const int DistancePixelTypeID = VTK_FLOAT;
 const DistancePixelType DIST_INF = std::numeric_limits<DistancePixelType>::max();
 const DistancePixelType DIST_EPSILON = 1e-3;
 
+// Maximum number of distinct distance keys that an edge weight can span in the radix heap.
+// Distances are quantized to bucket width = (maximum edge weight) / (this value).
+const double MAXIMUM_NUMBER_OF_DISTANCE_KEYS_PER_EDGE = 65536.0;
+
 //----------------------------------------------------------------------------
 class HeapNode : public FibHeapNode
 {
@@ -75,6 +82,117 @@ protected:
   long m_Index;
 };
 
+//----------------------------------------------------------------------------
+// Radix heap (monotone priority queue) over quantized distances.
+// Only voxels at the propagation front are stored, in plain arrays (no per-voxel heap nodes).
+// Instead of decreasing keys, an entry is pushed each time a voxel distance decreases;
+// obsolete entries are recognized when popped, by comparing them to the current voxel distance.
+// Entries that are quantized to the same key are popped in arbitrary order, therefore a popped
+// voxel may be improved later, which simply causes it to be pushed and processed again.
+class DistanceRadixHeap
+{
+public:
+  struct Entry
+    {
+    vtkTypeUInt64 Key;
+    long Index;
+    DistancePixelType Distance;
+    };
+
+  DistanceRadixHeap(double bucketWidth)
+  : InverseBucketWidth(1.0 / bucketWidth)
+  , LastKey(0)
+  , Size(0)
+  {
+  }
+
+  bool IsEmpty()
+  {
+    return this->Size == 0;
+  }
+
+  void Push(long index, DistancePixelType distance)
+  {
+    Entry entry;
+    entry.Key = this->GetKey(distance);
+    entry.Index = index;
+    entry.Distance = distance;
+    this->Buckets[GetBucketIndex(entry.Key, this->LastKey)].push_back(entry);
+    this->Size++;
+  }
+
+  // Get and remove an entry with minimum key. Returns false if the heap is empty.
+  bool Pop(Entry& entry)
+  {
+    if (this->Size == 0)
+      {
+      return false;
+      }
+    if (this->Buckets[0].empty())
+      {
+      // Find the first non-empty bucket and redistribute its entries
+      // into lower buckets, relative to its minimum key.
+      int bucketIndex = 1;
+      while (this->Buckets[bucketIndex].empty())
+        {
+        bucketIndex++;
+        }
+      std::vector<Entry>& bucket = this->Buckets[bucketIndex];
+      vtkTypeUInt64 minimumKey = bucket[0].Key;
+      for (size_t i = 1; i < bucket.size(); i++)
+        {
+        minimumKey = std::min(minimumKey, bucket[i].Key);
+        }
+      this->LastKey = minimumKey;
+      for (size_t i = 0; i < bucket.size(); i++)
+        {
+        this->Buckets[GetBucketIndex(bucket[i].Key, this->LastKey)].push_back(bucket[i]);
+        }
+      bucket.clear();
+      }
+    entry = this->Buckets[0].back();
+    this->Buckets[0].pop_back();
+    this->Size--;
+    return true;
+  }
+
+protected:
+  vtkTypeUInt64 GetKey(DistancePixelType distance)
+  {
+    const double maximumKey = 1e18;
+    double scaledDistance = distance * this->InverseBucketWidth;
+    vtkTypeUInt64 key = static_cast<vtkTypeUInt64>(scaledDistance < maximumKey ? scaledDistance : maximumKey);
+    // Keys must never be smaller than the last popped key
+    return (key < this->LastKey ? this->LastKey : key);
+  }
+
+  // Index of the highest bit that differs between the key and the last popped key (0 if they are equal)
+  static int GetBucketIndex(vtkTypeUInt64 key, vtkTypeUInt64 lastKey)
+  {
+    vtkTypeUInt64 difference = key ^ lastKey;
+    int bucketIndex = 0;
+    for (int shift = 32; shift >= 8; shift /= 2)
+      {
+      if (difference >> shift)
+        {
+        difference >>= shift;
+        bucketIndex += shift;
+        }
+      }
+    while (difference != 0)
+      {
+      difference >>= 1;
+      bucketIndex++;
+      }
+    return bucketIndex;
+  }
+
+  double InverseBucketWidth;
+  vtkTypeUInt64 LastKey;
+  vtkIdType Size;
+  std::vector<Entry> Buckets[65];
+};
+
 //----------------------------------------------------------------------------
 class vtkImageGrowCutSegment::vtkInternal
 {
@@ -84,12 +202,26 @@ public:
 
   void Reset();
 
+  /// Allocate result and distance volumes and compute neighborhood information
+  /// for the current volume dimensions. Previous results are cleared.
+  void AllocateVolumes(vtkImageData *seedLabelVolume);
+
+  /// Save current result to allow incremental update in the next execution
+  void StorePreviousResult();
+
   template<typename IntensityPixelType, typename LabelPixelType>
   bool InitializationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume);
 
   template<typename IntensityPixelType, typename LabelPixelType>
   void DijkstraBasedClassificationAHP(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume);
 
+  template<typename IntensityPixelType, typename LabelPixelType>
+  bool ClassificationRadixHeap(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume);
+
+  template<typename IntensityPixelType, typename LabelPixelType>
+  void InitializeFromCoarseResolution(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume,
+    DistanceRadixHeap& heap, std::vector<unsigned char>& frozen);
+
   template <class SourceVolType>
   bool ExecuteGrowCut(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume, vtkImageData *resultLabelVolume);
 
@@ -110,6 +242,9 @@ public:
   FibHeap *m_Heap;
   HeapNode *m_HeapNodes;
   bool m_bSegInitialized;
+
+  int m_Engine;
+  bool m_MultiResolutionInitialization;
 };
 
 //-----------------------------------------------------------------------------
@@ -118,6 +253,8 @@ vtkImageGrowCutSegment::vtkInternal::vtkInternal()
   m_Heap = NULL;
   m_HeapNodes = NULL;
   m_bSegInitialized = false;
+  m_Engine = vtkImageGrowCutSegment::ENGINE_RADIX_HEAP;
+  m_MultiResolutionInitialization = false;
   m_DistanceVolume = vtkSmartPointer<vtkImageData>::New();
   m_DistanceVolumePre = vtkSmartPointer<vtkImageData>::New();
   m_ResultLabelVolume = vtkSmartPointer<vtkImageData>::New();
@@ -150,6 +287,77 @@ void vtkImageGrowCutSegment::vtkInternal::Reset()
   m_ResultLabelVolumePre->Initialize();
 }
 
+//-----------------------------------------------------------------------------
+void vtkImageGrowCutSegment::vtkInternal::AllocateVolumes(vtkImageData *seedLabelVolume)
+{
+  long dimXYZ = m_DimX * m_DimY * m_DimZ;
+  m_ResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+  m_ResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+  m_ResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
+  m_ResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+  m_DistanceVolume->SetOrigin(seedLabelVolume->GetOrigin());
+  m_DistanceVolume->SetSpacing(seedLabelVolume->GetSpacing());
+  m_DistanceVolume->SetExtent(seedLabelVolume->GetExtent());
+  m_DistanceVolume->AllocateScalars(DistancePixelTypeID, 1);
+  m_ResultLabelVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
+  m_ResultLabelVolumePre->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+  m_DistanceVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
+  m_DistanceVolumePre->AllocateScalars(DistancePixelTypeID, 1);
+
+  // Compute index offset
+  m_NeighborIndexOffsets.clear();
+  // Neighbors are traversed in the order of m_NeighborIndexOffsets,
+  // therefore one would expect that the offsets should
+  // be as continuous as possible (e.g., x coordinate
+  // should change most quickly), but that resulted in
+  // about 5-6% longer computation time. Therefore,
+  // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
+  for (int ix = -1; ix <= 1; ix++)
+    {
+    for (int iy = -1; iy <= 1; iy++)
+      {
+      for (int iz = -1; iz <= 1; iz++)
+        {
+        if (ix == 0 && iy == 0 && iz == 0)
+          {
+          continue;
+          }
+        m_NeighborIndexOffsets.push_back(long(ix) + m_DimX*(long(iy) + m_DimY*long(iz)));
+        }
+      }
+    }
+
+  // Determine neighborhood size for computation at each voxel.
+  // The neighborhood size is everwhere the same (size of m_NeighborIndexOffsets)
+  // except at the edges of the volume, where the neighborhood size is 0.
+  m_NumberOfNeighbors.resize(dimXYZ);
+  const unsigned char numberOfNeighbors = m_NeighborIndexOffsets.size();
+  unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
+  for (int z = 0; z < m_DimZ; z++)
+    {
+    bool zEdge = (z == 0 || z == m_DimZ - 1);
+    for (int y = 0; y < m_DimY; y++)
+      {
+      bool yEdge = (y == 0 || y == m_DimY - 1);
+      *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>0)
+      unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
+      for (int x = m_DimX-2; x > 0; x--)
+        {
+        *(nbSizePtr++) = nbSize;
+        }
+      *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>1)
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkImageGrowCutSegment::vtkInternal::StorePreviousResult()
+{
+  m_ResultLabelVolumePre->DeepCopy(m_ResultLabelVolume);
+  m_DistanceVolumePre->DeepCopy(m_DistanceVolume);
+  m_bSegInitialized = true;
+}
+
 //-----------------------------------------------------------------------------
 template<typename IntensityPixelType, typename LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
@@ -167,66 +375,10 @@ bool vtkImageGrowCutSegment::vtkInternal::InitializationAHP(
 
   if (!m_bSegInitialized)
     {
-    m_ResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
-    m_ResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
-    m_ResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
-    m_ResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
-    m_DistanceVolume->SetOrigin(seedLabelVolume->GetOrigin());
-    m_DistanceVolume->SetSpacing(seedLabelVolume->GetSpacing());
-    m_DistanceVolume->SetExtent(seedLabelVolume->GetExtent());
-    m_DistanceVolume->AllocateScalars(DistancePixelTypeID, 1);
-    m_ResultLabelVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
-    m_ResultLabelVolumePre->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
-    m_DistanceVolumePre->SetExtent(0, -1, 0, -1, 0, -1);
-    m_DistanceVolumePre->AllocateScalars(DistancePixelTypeID, 1);
+    this->AllocateVolumes(seedLabelVolume);
     LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
     DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
 
-    // Compute index offset
-    m_NeighborIndexOffsets.clear();
-    // Neighbors are traversed in the order of m_NeighborIndexOffsets,
-    // therefore one would expect that the offsets should
-    // be as continuous as possible (e.g., x coordinate
-    // should change most quickly), but that resulted in
-    // about 5-6% longer computation time. Therefore,
-    // we put indices in order x1y1z1, x1y1z2, x1y1z3, etc.
-    for (int ix = -1; ix <= 1; ix++)
-      {
-      for (int iy = -1; iy <= 1; iy++)
-        {
-        for (int iz = -1; iz <= 1; iz++)
-          {
-          if (ix == 0 && iy == 0 && iz == 0)
-            {
-            continue;
-            }
-          m_NeighborIndexOffsets.push_back(long(ix) + m_DimX*(long(iy) + m_DimY*long(iz)));
-          }
-        }
-      }
-
-    // Determine neighborhood size for computation at each voxel.
-    // The neighborhood size is everwhere the same (size of m_NeighborIndexOffsets)
-    // except at the edges of the volume, where the neighborhood size is 0.
-    m_NumberOfNeighbors.resize(dimXYZ);
-    const unsigned char numberOfNeighbors = m_NeighborIndexOffsets.size();
-    unsigned char* nbSizePtr = &(m_NumberOfNeighbors[0]);
-    for (int z = 0; z < m_DimZ; z++)
-      {
-      bool zEdge = (z == 0 || z == m_DimZ - 1);
-      for (int y = 0; y < m_DimY; y++)
-        {
-        bool yEdge = (y == 0 || y == m_DimY - 1);
-        *(nbSizePtr++) = 0; // x == 0 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>0)
-        unsigned char nbSize = (zEdge || yEdge) ? 0 : numberOfNeighbors;
-        for (int x = m_DimX-2; x > 0; x--)
-          {
-          *(nbSizePtr++) = nbSize;
-          }
-        *(nbSizePtr++) = 0; // x == m_DimX-1 (there is always padding, so we don'neighborNewDistance need to check if m_DimX>1)
-        }
-      }
-
     for (long index = 0; index < dimXYZ; index++)
       {
       LabelPixelType seedValue = seedLabelVolumePtr[index];
@@ -393,9 +545,7 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
     }
 
   // Update previous labels and distance information
-  m_ResultLabelVolumePre->DeepCopy(m_ResultLabelVolume);
-  m_DistanceVolumePre->DeepCopy(m_DistanceVolume);
-  m_bSegInitialized = true;
+  this->StorePreviousResult();
 
   // Release memory
   if (m_Heap != NULL)
@@ -411,6 +561,312 @@ void vtkImageGrowCutSegment::vtkInternal::DijkstraBasedClassificationAHP(
     }
 }
 
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType, typename LabelPixelType>
+bool vtkImageGrowCutSegment::vtkInternal::ClassificationRadixHeap(
+    vtkImageData *intensityVolume,
+    vtkImageData *seedLabelVolume)
+{
+  long dimXYZ = m_DimX * m_DimY * m_DimZ;
+  IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
+
+  // Distances are quantized for ordering voxels in the heap. Integer intensities result in integer
+  // edge weights, so a bucket width of 1 keeps the exact Dijkstra ordering for them.
+  double* intensityRange = intensityVolume->GetScalarRange();
+  double bucketWidth = (intensityRange[1] - intensityRange[0]) / MAXIMUM_NUMBER_OF_DISTANCE_KEYS_PER_EDGE;
+  if (std::numeric_limits<IntensityPixelType>::is_integer)
+    {
+    bucketWidth = std::max(1.0, ceil(bucketWidth));
+    }
+  else if (bucketWidth <= 0)
+    {
+    bucketWidth = 1.0;
+    }
+  DistanceRadixHeap heap(bucketWidth);
+
+  // Voxels whose label is already determined (by multi-resolution initialization)
+  std::vector<unsigned char> frozen;
+
+  bool incrementalUpdate = m_bSegInitialized;
+  if (!incrementalUpdate)
+    {
+    this->AllocateVolumes(seedLabelVolume);
+    }
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
+
+  if (!incrementalUpdate)
+    {
+    for (long index = 0; index < dimXYZ; index++)
+      {
+      LabelPixelType seedValue = seedLabelVolumePtr[index];
+      resultLabelVolumePtr[index] = seedValue;
+      if (seedValue == 0)
+        {
+        distanceVolumePtr[index] = DIST_INF;
+        }
+      else
+        {
+        distanceVolumePtr[index] = DIST_EPSILON;
+        heap.Push(index, DIST_EPSILON);
+        }
+      }
+    if (m_MultiResolutionInitialization)
+      {
+      this->InitializeFromCoarseResolution<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume, heap, frozen);
+      }
+    }
+  else
+    {
+    for (long index = 0; index < dimXYZ; index++)
+      {
+      if (seedLabelVolumePtr[index] != 0)
+        {
+        // Only grow from new/changed seeds
+        if (resultLabelVolumePtr[index] != seedLabelVolumePtr[index])
+          {
+          distanceVolumePtr[index] = DIST_EPSILON;
+          resultLabelVolumePtr[index] = seedLabelVolumePtr[index];
+          heap.Push(index, DIST_EPSILON);
+          }
+        }
+      else
+        {
+        distanceVolumePtr[index] = DIST_INF;
+        resultLabelVolumePtr[index] = 0;
+        }
+      }
+    }
+
+  LabelPixelType* resultLabelVolumePrePtr = NULL;
+  DistancePixelType* distanceVolumePrePtr = NULL;
+  if (incrementalUpdate)
+    {
+    resultLabelVolumePrePtr = static_cast<LabelPixelType*>(m_ResultLabelVolumePre->GetScalarPointer());
+    distanceVolumePrePtr = static_cast<DistancePixelType*>(m_DistanceVolumePre->GetScalarPointer());
+    }
+  const unsigned char* frozenPtr = (frozen.empty() ? NULL : &(frozen[0]));
+  const long* neighborIndexOffsets = &(m_NeighborIndexOffsets[0]);
+
+  DistanceRadixHeap::Entry entry;
+  while (heap.Pop(entry))
+    {
+    long index = entry.Index;
+    DistancePixelType currentDistance = entry.Distance;
+    if (currentDistance != distanceVolumePtr[index])
+      {
+      // Obsolete entry, the voxel has been reached since then with a shorter distance
+      continue;
+      }
+
+    // Stop propagation when the new distance is larger than the previous one
+    if (incrementalUpdate && currentDistance > distanceVolumePrePtr[index])
+      {
+      distanceVolumePtr[index] = distanceVolumePrePtr[index];
+      resultLabelVolumePtr[index] = resultLabelVolumePrePtr[index];
+      continue;
+      }
+
+    // Update neighbors
+    LabelPixelType currentLabel = resultLabelVolumePtr[index];
+    DistancePixelType pixCenter = imSrc[index];
+    unsigned char nbSize = m_NumberOfNeighbors[index];
+    for (unsigned char i = 0; i < nbSize; i++)
+      {
+      long indexNgbh = index + neighborIndexOffsets[i];
+      if (frozenPtr && frozenPtr[indexNgbh])
+        {
+        continue;
+        }
+      DistancePixelType neighborNewDistance = fabs(pixCenter - imSrc[indexNgbh]) + currentDistance;
+      if (distanceVolumePtr[indexNgbh] > neighborNewDistance)
+        {
+        distanceVolumePtr[indexNgbh] = neighborNewDistance;
+        resultLabelVolumePtr[indexNgbh] = currentLabel;
+        heap.Push(indexNgbh, neighborNewDistance);
+        }
+      }
+    }
+
+  if (incrementalUpdate)
+    {
+    // Voxels that have not been reached keep their previous label
+    for (long index = 0; index < dimXYZ; index++)
+      {
+      if (resultLabelVolumePtr[index] == 0)
+        {
+        resultLabelVolumePtr[index] = resultLabelVolumePrePtr[index];
+        distanceVolumePtr[index] = distanceVolumePrePtr[index];
+        }
+      }
+    }
+
+  // Update previous labels and distance information
+  this->StorePreviousResult();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename IntensityPixelType, typename LabelPixelType>
+void vtkImageGrowCutSegment::vtkInternal::InitializeFromCoarseResolution(
+    vtkImageData *intensityVolume,
+    vtkImageData *seedLabelVolume,
+    DistanceRadixHeap& heap,
+    std::vector<unsigned char>& frozen)
+{
+  const long coarseDimX = (m_DimX + 1) / 2;
+  const long coarseDimY = (m_DimY + 1) / 2;
+  const long coarseDimZ = (m_DimZ + 1) / 2;
+  if (coarseDimX <= 2 || coarseDimY <= 2 || coarseDimZ <= 2)
+    {
+    // Image is too small for multi-resolution computation
+    return;
+    }
+  const long coarseDimXY = coarseDimX * coarseDimY;
+  const long coarseDimXYZ = coarseDimXY * coarseDimZ;
+
+  IntensityPixelType* imSrc = static_cast<IntensityPixelType*>(intensityVolume->GetScalarPointer());
+  LabelPixelType* seedLabelVolumePtr = static_cast<LabelPixelType*>(seedLabelVolume->GetScalarPointer());
+
+  // Downsample the input volumes by a factor of 2 (average intensity, any of the seed labels)
+  vtkNew<vtkImageData> coarseIntensityVolume;
+  coarseIntensityVolume->SetDimensions(coarseDimX, coarseDimY, coarseDimZ);
+  coarseIntensityVolume->AllocateScalars(VTK_FLOAT, 1);
+  float* coarseIntensityPtr = static_cast<float*>(coarseIntensityVolume->GetScalarPointer());
+  std::fill(coarseIntensityPtr, coarseIntensityPtr + coarseDimXYZ, 0.0f);
+  vtkNew<vtkImageData> coarseSeedLabelVolume;
+  coarseSeedLabelVolume->SetDimensions(coarseDimX, coarseDimY, coarseDimZ);
+  coarseSeedLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+  LabelPixelType* coarseSeedLabelPtr = static_cast<LabelPixelType*>(coarseSeedLabelVolume->GetScalarPointer());
+  std::fill(coarseSeedLabelPtr, coarseSeedLabelPtr + coarseDimXYZ, LabelPixelType(0));
+  std::vector<unsigned char> numberOfFineVoxels(coarseDimXYZ, 0);
+  long index = 0;
+  for (long z = 0; z < m_DimZ; z++)
+    {
+    for (long y = 0; y < m_DimY; y++)
+      {
+      long coarseRowIndex = (z / 2) * coarseDimXY + (y / 2) * coarseDimX;
+      for (long x = 0; x < m_DimX; x++, index++)
+        {
+        long coarseIndex = coarseRowIndex + x / 2;
+        coarseIntensityPtr[coarseIndex] += imSrc[index];
+        numberOfFineVoxels[coarseIndex]++;
+        if (coarseSeedLabelPtr[coarseIndex] == 0)
+          {
+          coarseSeedLabelPtr[coarseIndex] = seedLabelVolumePtr[index];
+          }
+        }
+      }
+    }
+  for (long coarseIndex = 0; coarseIndex < coarseDimXYZ; coarseIndex++)
+    {
+    coarseIntensityPtr[coarseIndex] /= numberOfFineVoxels[coarseIndex];
+    }
+
+  // Compute segmentation at coarse resolution
+  vtkInternal coarseSegmenter;
+  if (!coarseSegmenter.ExecuteGrowCut2<float, LabelPixelType>(coarseIntensityVolume.GetPointer(), coarseSeedLabelVolume.GetPointer()))
+    {
+    return;
+    }
+  LabelPixelType* coarseLabelPtr = static_cast<LabelPixelType*>(coarseSegmenter.m_ResultLabelVolume->GetScalarPointer());
+  DistancePixelType* coarseDistancePtr = static_cast<DistancePixelType*>(coarseSegmenter.m_DistanceVolume->GetScalarPointer());
+
+  // Coarse voxels are not reliable if they contain seeds of a different label
+  std::vector<unsigned char> coarseReliable(coarseDimXYZ, 1);
+  index = 0;
+  for (long z = 0; z < m_DimZ; z++)
+    {
+    for (long y = 0; y < m_DimY; y++)
+      {
+      long coarseRowIndex = (z / 2) * coarseDimXY + (y / 2) * coarseDimX;
+      for (long x = 0; x < m_DimX; x++, index++)
+        {
+        long coarseIndex = coarseRowIndex + x / 2;
+        if (seedLabelVolumePtr[index] != 0 && seedLabelVolumePtr[index] != coarseLabelPtr[coarseIndex])
+          {
+          coarseReliable[coarseIndex] = 0;
+          }
+        }
+      }
+    }
+
+  // Label of a coarse voxel is accepted if all its neighbors are reliable and have the same label
+  std::vector<unsigned char> coarseAccepted(coarseDimXYZ, 0);
+  for (long z = 1; z < coarseDimZ - 1; z++)
+    {
+    for (long y = 1; y < coarseDimY - 1; y++)
+      {
+      for (long x = 1; x < coarseDimX - 1; x++)
+        {
+        long coarseIndex = z * coarseDimXY + y * coarseDimX + x;
+        LabelPixelType label = coarseLabelPtr[coarseIndex];
+        if (label == 0)
+          {
+          continue;
+          }
+        bool accepted = true;
+        for (long iz = -1; iz <= 1 && accepted; iz++)
+          {
+          for (long iy = -1; iy <= 1 && accepted; iy++)
+            {
+            for (long ix = -1; ix <= 1 && accepted; ix++)
+              {
+              long neighborIndex = coarseIndex + iz * coarseDimXY + iy * coarseDimX + ix;
+              accepted = (coarseReliable[neighborIndex] && coarseLabelPtr[neighborIndex] == label);
+              }
+            }
+          }
+        coarseAccepted[coarseIndex] = (accepted ? 1 : 0);
+        }
+      }
+    }
+
+  // Freeze voxels of accepted coarse voxels (except seeds and voxels at the edge of the volume)
+  LabelPixelType* resultLabelVolumePtr = static_cast<LabelPixelType*>(m_ResultLabelVolume->GetScalarPointer());
+  DistancePixelType* distanceVolumePtr = static_cast<DistancePixelType*>(m_DistanceVolume->GetScalarPointer());
+  long dimXYZ = m_DimX * m_DimY * m_DimZ;
+  frozen.assign(dimXYZ, 0);
+  index = 0;
+  for (long z = 0; z < m_DimZ; z++)
+    {
+    for (long y = 0; y < m_DimY; y++)
+      {
+      long coarseRowIndex = (z / 2) * coarseDimXY + (y / 2) * coarseDimX;
+      for (long x = 0; x < m_DimX; x++, index++)
+        {
+        long coarseIndex = coarseRowIndex + x / 2;
+        if (!coarseAccepted[coarseIndex] || seedLabelVolumePtr[index] != 0 || m_NumberOfNeighbors[index] == 0)
+          {
+          continue;
+          }
+        frozen[index] = 1;
+        resultLabelVolumePtr[index] = coarseLabelPtr[coarseIndex];
+        distanceVolumePtr[index] = coarseDistancePtr[coarseIndex];
+        }
+      }
+    }
+
+  // Propagate from frozen voxels that are adjacent to voxels that are computed at full resolution
+  const unsigned char numberOfNeighbors = m_NeighborIndexOffsets.size();
+  for (index = 0; index < dimXYZ; index++)
+    {
+    if (!frozen[index])
+      {
+      continue;
+      }
+    for (unsigned char i = 0; i < numberOfNeighbors; i++)
+      {
+      if (!frozen[index + m_NeighborIndexOffsets[i]])
+        {
+        heap.Push(index, distanceVolumePtr[index]);
+        break;
+        }
+      }
+    }
+}
+
 //-----------------------------------------------------------------------------
 template< class IntensityPixelType, class LabelPixelType>
 bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensityVolume, vtkImageData *seedLabelVolume)
@@ -427,6 +883,11 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut2(vtkImageData *intensit
     return false;
     }
 
+  if (m_Engine == vtkImageGrowCutSegment::ENGINE_RADIX_HEAP)
+    {
+    return ClassificationRadixHeap<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume);
+    }
+
   if (!InitializationAHP<IntensityPixelType, LabelPixelType>(intensityVolume, seedLabelVolume))
     {
     return false;
@@ -507,6 +968,8 @@ bool vtkImageGrowCutSegment::vtkInternal::ExecuteGrowCut(vtkImageData *intensity
 vtkImageGrowCutSegment::vtkImageGrowCutSegment()
 {
   this->Internal = new vtkInternal();
+  this->Engine = ENGINE_RADIX_HEAP;
+  this->MultiResolutionInitialization = false;
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(1);
 }
@@ -528,6 +991,9 @@ void vtkImageGrowCutSegment::ExecuteDataWithInformation(
   vtkNew<vtkTimerLog> logger;
   logger->StartTimer();
 
+  this->Internal->m_Engine = this->Engine;
+  this->Internal->m_MultiResolutionInitialization = this->MultiResolutionInitialization;
+
   switch (intensityVolume->GetScalarType())
     {
     vtkTemplateMacro(this->Internal->ExecuteGrowCut<VTK_TT>(intensityVolume, seedLabelVolume, resultLabelVolume));
@@ -561,6 +1027,7 @@ void vtkImageGrowCutSegment::Reset()
 //-----------------------------------------------------------------------------
 void vtkImageGrowCutSegment::PrintSelf(ostream &os, vtkIndent indent)
 {
-  // XXX Implement this function
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "Engine: " << this->Engine << std::endl;
+  os << indent << "MultiResolutionInitialization: " << (this->MultiResolutionInitialization ? "true" : "false") << std::endl;
 }
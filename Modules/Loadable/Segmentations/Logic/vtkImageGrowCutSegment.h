@@ -23,6 +23,32 @@ public:
   // This method has to be called if intensity volume changes or if seeds are deleted after initial computation.
   void Reset();
 
+  // Algorithm used for propagating labels from the seeds.
+  enum
+    {
+    // Dijkstra with Fibonacci heap. Allocates a heap node for each voxel.
+    ENGINE_FIBONACCI_HEAP = 0,
+    // Dijkstra with radix heap over quantized distances (default). Only voxels at the propagation front
+    // are stored in the queue, which makes it faster and requires much less memory than the Fibonacci heap.
+    ENGINE_RADIX_HEAP,
+    ENGINE_LAST // must be last
+    };
+
+  // Set algorithm used for propagating labels from the seeds. Default is ENGINE_RADIX_HEAP.
+  vtkSetClampMacro(Engine, int, 0, ENGINE_LAST - 1);
+  vtkGetMacro(Engine, int);
+  void SetEngineToFibonacciHeap() { this->SetEngine(ENGINE_FIBONACCI_HEAP); }
+  void SetEngineToRadixHeap() { this->SetEngine(ENGINE_RADIX_HEAP); }
+
+  // If enabled then the initial (non-incremental) computation is initialized by a segmentation computed
+  // at half resolution: voxels that are far from label boundaries at coarse resolution get their labels directly
+  // and the full resolution computation is only performed near the boundaries. This makes the initial
+  // computation significantly faster, but the result may slightly differ from the full resolution computation
+  // (thin structures may be missed). Used only by the radix heap engine. Disabled by default.
+  vtkSetMacro(MultiResolutionInitialization, bool);
+  vtkGetMacro(MultiResolutionInitialization, bool);
+  vtkBooleanMacro(MultiResolutionInitialization, bool);
+
 protected:
   vtkImageGrowCutSegment();
   virtual ~vtkImageGrowCutSegment();
@@ -30,6 +56,9 @@ protected:
   virtual void ExecuteDataWithInformation(vtkDataObject *outData, vtkInformation *outInfo) VTK_OVERRIDE;
   virtual int RequestInformation(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
 
+  int Engine;
+  bool MultiResolutionInitialization;
+
 private:
   class vtkInternal;
   vtkInternal * Internal;
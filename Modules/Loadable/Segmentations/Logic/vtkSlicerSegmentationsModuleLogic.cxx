@@ -39,15 +39,19 @@
 #include <vtkDataObject.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImageAccumulate.h>
+#include <vtkImageCast.h>
 #include <vtkImageConstantPad.h>
+#include <vtkImageData.h>
 #include <vtkImageMathematics.h>
-#include <vtkImageThreshold.h>
 #include <vtkLookupTable.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -71,7 +75,205 @@
 #include <vtkEventBroker.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
 #include <sstream>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Brush voxelization helpers
+namespace
+{
+
+/// Value used as infinity for unbounded line intervals
+const double LINE_INTERVAL_INFINITY = 1e30;
+
+//-----------------------------------------------------------------------------
+/// Paint brush shape in world coordinate system
+struct PaintBrushShape
+{
+  double Radius;
+  /// If true then the brush is a cylinder with AxisDirection axis, otherwise a sphere
+  bool Cylinder;
+  double AxisDirection[3];
+  double HalfHeight;
+};
+
+//-----------------------------------------------------------------------------
+/// Get the interval of t values where a*t^2 + b*t + c <= 0.
+/// \return False if there is no such t.
+bool GetQuadraticInequalityInterval(double a, double b, double c, double& tMin, double& tMax)
+{
+  const double epsilon = 1e-12;
+  if (fabs(a) < epsilon)
+    {
+    if (fabs(b) < epsilon)
+      {
+      tMin = -LINE_INTERVAL_INFINITY;
+      tMax = LINE_INTERVAL_INFINITY;
+      return (c <= 0);
+      }
+    tMin = (b > 0 ? -LINE_INTERVAL_INFINITY : -c / b);
+    tMax = (b > 0 ? -c / b : LINE_INTERVAL_INFINITY);
+    return true;
+    }
+  double discriminant = b * b - 4.0 * a * c;
+  if (discriminant < 0)
+    {
+    return false;
+    }
+  double discriminantSqrt = sqrt(discriminant);
+  tMin = (-b - discriminantSqrt) / (2.0 * a);
+  tMax = (-b + discriminantSqrt) / (2.0 * a);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Restrict the [tMin, tMax] interval to t values where minValue <= value + t * valueChange <= maxValue
+/// \return False if the restricted interval is empty.
+bool RestrictLineIntervalToRange(double value, double valueChange, double minValue, double maxValue, double& tMin, double& tMax)
+{
+  if (fabs(valueChange) < 1e-12)
+    {
+    return (value >= minValue && value <= maxValue && tMin <= tMax);
+    }
+  double t0 = (minValue - value) / valueChange;
+  double t1 = (maxValue - value) / valueChange;
+  tMin = std::max(tMin, std::min(t0, t1));
+  tMax = std::min(tMax, std::max(t0, t1));
+  return (tMin <= tMax);
+}
+
+//-----------------------------------------------------------------------------
+/// Get the interval of t values where origin + t * direction is in the sphere of radius centered at (0,0,0)
+bool GetSphereLineInterval(const double origin[3], const double direction[3], double radius, double& tMin, double& tMax)
+{
+  return GetQuadraticInequalityInterval(vtkMath::Dot(direction, direction), 2.0 * vtkMath::Dot(origin, direction),
+    vtkMath::Dot(origin, origin) - radius * radius, tMin, tMax);
+}
+
+//-----------------------------------------------------------------------------
+/// Get the interval of t values where origin + t * direction is within radius distance from
+/// the line segment between (0,0,0) and segmentVector (capsule). As the capsule is convex,
+/// the interval is the union of the intervals of the two end spheres and the cylinder between them.
+bool GetCapsuleLineInterval(const double origin[3], const double direction[3], const double segmentVector[3],
+  double radius, double& tMin, double& tMax)
+{
+  bool found = false;
+  tMin = LINE_INTERVAL_INFINITY;
+  tMax = -LINE_INTERVAL_INFINITY;
+  double t0 = 0.0;
+  double t1 = 0.0;
+  if (GetSphereLineInterval(origin, direction, radius, t0, t1))
+    {
+    found = true;
+    tMin = t0;
+    tMax = t1;
+    }
+  double segmentLength = vtkMath::Norm(segmentVector);
+  if (segmentLength < 1e-6)
+    {
+    return found;
+    }
+  double originToSegmentEnd[3] = { origin[0] - segmentVector[0], origin[1] - segmentVector[1], origin[2] - segmentVector[2] };
+  if (GetSphereLineInterval(originToSegmentEnd, direction, radius, t0, t1))
+    {
+    found = true;
+    tMin = std::min(tMin, t0);
+    tMax = std::max(tMax, t1);
+    }
+  double axis[3] = { segmentVector[0] / segmentLength, segmentVector[1] / segmentLength, segmentVector[2] / segmentLength };
+  double originAlongAxis = vtkMath::Dot(origin, axis);
+  double directionAlongAxis = vtkMath::Dot(direction, axis);
+  double originPerpendicular[3] = { 0.0, 0.0, 0.0 };
+  double directionPerpendicular[3] = { 0.0, 0.0, 0.0 };
+  for (int i = 0; i < 3; i++)
+    {
+    originPerpendicular[i] = origin[i] - originAlongAxis * axis[i];
+    directionPerpendicular[i] = direction[i] - directionAlongAxis * axis[i];
+    }
+  if (GetSphereLineInterval(originPerpendicular, directionPerpendicular, radius, t0, t1)
+    && RestrictLineIntervalToRange(originAlongAxis, directionAlongAxis, 0.0, segmentLength, t0, t1))
+    {
+    found = true;
+    tMin = std::min(tMin, t0);
+    tMax = std::max(tMax, t1);
+    }
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+/// Project vector to the plane that is orthogonal to the (unit length) normal
+void ProjectToPlane(const double vector[3], const double normal[3], double projectedVector[3])
+{
+  double dot = vtkMath::Dot(vector, normal);
+  for (int i = 0; i < 3; i++)
+    {
+    projectedVector[i] = vector[i] - dot * normal[i];
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Paint the swept brush into a labelmap of scalar type T (see vtkSlicerSegmentationsModuleLogic::PaintSweptBrush)
+template <class T> void PaintSweptBrushGeneric(vtkImageData* labelmap, vtkMatrix4x4* ijkToWorldMatrix, const int extent[6],
+  const PaintBrushShape& brush, const double startPosition[3], const double endPosition[3], T fillValue)
+{
+  // Position of voxel (i, j, k) is rowOrigin(j, k) + i * rowDirection
+  double rowDirection[3] = { ijkToWorldMatrix->GetElement(0, 0), ijkToWorldMatrix->GetElement(1, 0), ijkToWorldMatrix->GetElement(2, 0) };
+  double segmentVector[3] = { endPosition[0] - startPosition[0], endPosition[1] - startPosition[1], endPosition[2] - startPosition[2] };
+  double rowDirectionAlongAxis = 0.0;
+  if (brush.Cylinder)
+    {
+    rowDirectionAlongAxis = vtkMath::Dot(rowDirection, brush.AxisDirection);
+    ProjectToPlane(rowDirection, brush.AxisDirection, rowDirection);
+    ProjectToPlane(segmentVector, brush.AxisDirection, segmentVector);
+    }
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      double rowOrigin_Ijk[4] = { 0.0, static_cast<double>(j), static_cast<double>(k), 1.0 };
+      double rowOrigin_World[4] = { 0.0, 0.0, 0.0, 1.0 };
+      ijkToWorldMatrix->MultiplyPoint(rowOrigin_Ijk, rowOrigin_World);
+      double rowOrigin[3] = { rowOrigin_World[0] - startPosition[0], rowOrigin_World[1] - startPosition[1], rowOrigin_World[2] - startPosition[2] };
+      double tMin = 0.0;
+      double tMax = 0.0;
+      if (brush.Cylinder)
+        {
+        double rowOriginAlongAxis = vtkMath::Dot(rowOrigin, brush.AxisDirection);
+        ProjectToPlane(rowOrigin, brush.AxisDirection, rowOrigin);
+        if (!GetCapsuleLineInterval(rowOrigin, rowDirection, segmentVector, brush.Radius, tMin, tMax)
+          || !RestrictLineIntervalToRange(rowOriginAlongAxis, rowDirectionAlongAxis, -brush.HalfHeight, brush.HalfHeight, tMin, tMax))
+          {
+          continue;
+          }
+        }
+      else if (!GetCapsuleLineInterval(rowOrigin, rowDirection, segmentVector, brush.Radius, tMin, tMax))
+        {
+        continue;
+        }
+      // Clamp before converting to int to avoid overflow for unbounded intervals
+      tMin = std::max(tMin, static_cast<double>(extent[0]));
+      tMax = std::min(tMax, static_cast<double>(extent[1]));
+      if (tMin > tMax)
+        {
+        continue;
+        }
+      int iMin = static_cast<int>(ceil(tMin));
+      int iMax = static_cast<int>(floor(tMax));
+      if (iMin > iMax)
+        {
+        continue;
+        }
+      T* voxelPtr = static_cast<T*>(labelmap->GetScalarPointer(iMin, j, k));
+      std::fill(voxelPtr, voxelPtr + (iMax - iMin + 1), fillValue);
+      }
+    }
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerSegmentationsModuleLogic);
@@ -425,6 +627,243 @@ int vtkSlicerSegmentationsModuleLogic::DoesLabelmapContainSingleLabel(vtkMRMLLab
   return lowLabel;
 }
 
+//-----------------------------------------------------------------------------
+namespace
+{
+
+/// Bounding box of the voxels of a label value
+struct LabelExtent
+{
+  int Extent[6];
+};
+typedef std::map<int, LabelExtent> LabelExtentMap;
+
+//-----------------------------------------------------------------------------
+// Returns true and sets label if the voxel value is a non-zero integer label value
+template <class T> bool GetLabelFromVoxelValue(T value, int& label)
+{
+  if (value == 0)
+    {
+    return false;
+    }
+  double doubleValue = static_cast<double>(value);
+  if (doubleValue != floor(doubleValue) || doubleValue < VTK_INT_MIN || doubleValue > VTK_INT_MAX)
+    {
+    // not an integer label value (or NaN)
+    return false;
+    }
+  label = static_cast<int>(doubleValue);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Computes extent of all label values in a multi-label image.
+// Image rows are processed in parallel, each row is traversed as runs of the same value.
+template <class T> class LabelExtentsFunctor
+{
+public:
+  LabelExtentsFunctor(vtkImageData* image)
+    : Image(image)
+  {
+  }
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow)
+  {
+    LabelExtentMap& labelExtents = this->LocalLabelExtents.Local();
+    const int* extent = this->Image->GetExtent();
+    const int numberOfRowsInSlice = extent[3] - extent[2] + 1;
+    const int numberOfComponents = this->Image->GetNumberOfScalarComponents();
+    int lastLabel = 0;
+    LabelExtent* lastLabelExtent = NULL;
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+      {
+      int j = extent[2] + static_cast<int>(row % numberOfRowsInSlice);
+      int k = extent[4] + static_cast<int>(row / numberOfRowsInSlice);
+      T* rowPtr = static_cast<T*>(this->Image->GetScalarPointer(extent[0], j, k));
+      int i = extent[0];
+      while (i <= extent[1])
+        {
+        T value = rowPtr[(i - extent[0]) * numberOfComponents];
+        int runStart = i;
+        for (++i; i <= extent[1] && rowPtr[(i - extent[0]) * numberOfComponents] == value; ++i)
+          {
+          }
+        int label = 0;
+        if (!GetLabelFromVoxelValue(value, label))
+          {
+          continue;
+          }
+        if (!lastLabelExtent || label != lastLabel)
+          {
+          LabelExtentMap::iterator labelExtentIt = labelExtents.find(label);
+          if (labelExtentIt == labelExtents.end())
+            {
+            LabelExtent newLabelExtent = { { runStart, i - 1, j, j, k, k } };
+            labelExtentIt = labelExtents.insert(LabelExtentMap::value_type(label, newLabelExtent)).first;
+            }
+          lastLabel = label;
+          lastLabelExtent = &(labelExtentIt->second);
+          }
+        int* labelExtent = lastLabelExtent->Extent;
+        labelExtent[0] = std::min(labelExtent[0], runStart);
+        labelExtent[1] = std::max(labelExtent[1], i - 1);
+        labelExtent[2] = std::min(labelExtent[2], j);
+        labelExtent[3] = std::max(labelExtent[3], j);
+        labelExtent[4] = std::min(labelExtent[4], k);
+        labelExtent[5] = std::max(labelExtent[5], k);
+        }
+      }
+  }
+
+  void Reduce()
+  {
+    this->LabelExtents.clear();
+    for (vtkSMPThreadLocal<LabelExtentMap>::iterator localIt = this->LocalLabelExtents.begin();
+      localIt != this->LocalLabelExtents.end(); ++localIt)
+      {
+      LabelExtentMap& localLabelExtents = *localIt;
+      for (LabelExtentMap::iterator labelExtentIt = localLabelExtents.begin(); labelExtentIt != localLabelExtents.end(); ++labelExtentIt)
+        {
+        LabelExtentMap::iterator mergedIt = this->LabelExtents.find(labelExtentIt->first);
+        if (mergedIt == this->LabelExtents.end())
+          {
+          this->LabelExtents[labelExtentIt->first] = labelExtentIt->second;
+          continue;
+          }
+        int* mergedExtent = mergedIt->second.Extent;
+        const int* localExtent = labelExtentIt->second.Extent;
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          mergedExtent[axis * 2] = std::min(mergedExtent[axis * 2], localExtent[axis * 2]);
+          mergedExtent[axis * 2 + 1] = std::max(mergedExtent[axis * 2 + 1], localExtent[axis * 2 + 1]);
+          }
+        }
+      }
+  }
+
+  vtkImageData* Image;
+  vtkSMPThreadLocal<LabelExtentMap> LocalLabelExtents;
+  LabelExtentMap LabelExtents;
+};
+
+//-----------------------------------------------------------------------------
+// Sets voxels of each label to 1 in the corresponding binary labelmap.
+// Binary labelmaps must be zero-filled and contain the extent of the label.
+template <class T> class FillBinaryLabelmapsFunctor
+{
+public:
+  FillBinaryLabelmapsFunctor(vtkImageData* image, const std::map<int, vtkImageData*>& binaryLabelmaps)
+    : Image(image)
+    , BinaryLabelmaps(binaryLabelmaps)
+  {
+  }
+
+  void operator()(vtkIdType beginRow, vtkIdType endRow) const
+  {
+    const int* extent = this->Image->GetExtent();
+    const int numberOfRowsInSlice = extent[3] - extent[2] + 1;
+    const int numberOfComponents = this->Image->GetNumberOfScalarComponents();
+    int lastLabel = 0;
+    vtkImageData* lastBinaryLabelmap = NULL;
+    for (vtkIdType row = beginRow; row < endRow; ++row)
+      {
+      int j = extent[2] + static_cast<int>(row % numberOfRowsInSlice);
+      int k = extent[4] + static_cast<int>(row / numberOfRowsInSlice);
+      T* rowPtr = static_cast<T*>(this->Image->GetScalarPointer(extent[0], j, k));
+      int i = extent[0];
+      while (i <= extent[1])
+        {
+        T value = rowPtr[(i - extent[0]) * numberOfComponents];
+        int runStart = i;
+        for (++i; i <= extent[1] && rowPtr[(i - extent[0]) * numberOfComponents] == value; ++i)
+          {
+          }
+        int label = 0;
+        if (!GetLabelFromVoxelValue(value, label))
+          {
+          continue;
+          }
+        if (!lastBinaryLabelmap || label != lastLabel)
+          {
+          std::map<int, vtkImageData*>::const_iterator binaryLabelmapIt = this->BinaryLabelmaps.find(label);
+          if (binaryLabelmapIt == this->BinaryLabelmaps.end())
+            {
+            continue;
+            }
+          lastLabel = label;
+          lastBinaryLabelmap = binaryLabelmapIt->second;
+          }
+        unsigned char* binaryLabelmapPtr = static_cast<unsigned char*>(lastBinaryLabelmap->GetScalarPointer(runStart, j, k));
+        memset(binaryLabelmapPtr, 1, i - runStart);
+        }
+      }
+  }
+
+  vtkImageData* Image;
+  const std::map<int, vtkImageData*>& BinaryLabelmaps;
+};
+
+//-----------------------------------------------------------------------------
+template <class T> void SplitLabelmapGeneric(vtkImageData* labelmap, T*,
+  std::vector<int>& labelValues, std::vector<vtkSmartPointer<vtkOrientedImageData> >& binaryLabelmaps)
+{
+  const int* extent = labelmap->GetExtent();
+  vtkIdType numberOfRows = static_cast<vtkIdType>(extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+
+  // Pass 1: find bounding box of all labels
+  LabelExtentsFunctor<T> labelExtentsFunctor(labelmap);
+  vtkSMPTools::For(0, numberOfRows, labelExtentsFunctor);
+
+  // Allocate cropped binary labelmaps
+  std::map<int, vtkImageData*> binaryLabelmapsByLabel;
+  for (LabelExtentMap::iterator labelExtentIt = labelExtentsFunctor.LabelExtents.begin();
+    labelExtentIt != labelExtentsFunctor.LabelExtents.end(); ++labelExtentIt)
+    {
+    vtkSmartPointer<vtkOrientedImageData> binaryLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    binaryLabelmap->SetExtent(labelExtentIt->second.Extent);
+    binaryLabelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    memset(binaryLabelmap->GetScalarPointer(), 0,
+      binaryLabelmap->GetScalarSize() * binaryLabelmap->GetNumberOfPoints());
+    labelValues.push_back(labelExtentIt->first);
+    binaryLabelmaps.push_back(binaryLabelmap);
+    binaryLabelmapsByLabel[labelExtentIt->first] = binaryLabelmap;
+    }
+
+  // Pass 2: fill all binary labelmaps
+  FillBinaryLabelmapsFunctor<T> fillFunctor(labelmap, binaryLabelmapsByLabel);
+  vtkSMPTools::For(0, numberOfRows, fillFunctor);
+}
+
+//-----------------------------------------------------------------------------
+// Split a multi-label image into binary labelmaps (1 inside the label, 0 elsewhere) for all non-zero label values.
+// Each binary labelmap is cropped to the extent of its label. All labels are processed by two parallel passes
+// over the image, instead of thresholding the full image for each label value.
+// Geometry is not set in the output images.
+void SplitLabelmap(vtkImageData* labelmap,
+  std::vector<int>& labelValues, std::vector<vtkSmartPointer<vtkOrientedImageData> >& binaryLabelmaps)
+{
+  labelValues.clear();
+  binaryLabelmaps.clear();
+  int* extent = labelmap->GetExtent();
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5]
+    || labelmap->GetScalarPointer() == NULL)
+    {
+    return;
+    }
+  switch (labelmap->GetScalarType())
+    {
+    vtkTemplateMacro(SplitLabelmapGeneric(labelmap, static_cast<VTK_TT*>(NULL), labelValues, binaryLabelmaps));
+    default:
+      vtkGenericWarningMacro("SplitLabelmap: Unknown image scalar type");
+    }
+}
+
+} // end of anonymous namespace
+
 //-----------------------------------------------------------------------------
 void vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(vtkIntArray* labels, vtkImageData* labelmap)
 {
@@ -1244,32 +1683,29 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
     segmentationNode->CreateDefaultDisplayNodes();
     }
 
-  // Split labelmap node into per-label image data
-
-  vtkNew<vtkIntArray> labelValues;
-  vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(labelValues.GetPointer(), labelmapNode->GetImageData());
-
-  vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
-  threshold->SetInputConnection(labelmapNode->GetImageDataConnection());
-  threshold->SetInValue(1);
-  threshold->SetOutValue(0);
-  threshold->ReplaceInOn();
-  threshold->ReplaceOutOn();
-  threshold->SetOutputScalarType(labelmapNode->GetImageData()->GetScalarType());
-  //TODO: pending resolution of bug http://www.na-mic.org/Bug/view.php?id=1822,
-  //   run the thresholding in single threaded mode to avoid data corruption observed on mac release builds
-  //threshold->SetNumberOfThreads(1);
+  // Split labelmap node into per-label image data (cropped to the extent of each label)
+  std::vector<int> labelValues;
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > labelImages;
+  SplitLabelmap(labelmapNode->GetImageData(), labelValues, labelImages);
+  int labelmapScalarType = labelmapNode->GetImageData()->GetScalarType();
 
   int segmentationNodeWasModified = segmentationNode->StartModify();
-  for (int labelIndex = 0; labelIndex < labelValues->GetNumberOfValues(); ++labelIndex)
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
     {
-    int label = labelValues->GetValue(labelIndex);
-    threshold->ThresholdBetween(label, label);
-    threshold->Update();
+    int label = labelValues[labelIndex];
 
     // Create oriented image data for label
-    vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
-    labelOrientedImageData->vtkImageData::DeepCopy(threshold->GetOutput());
+    vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = labelImages[labelIndex];
+    if (labelmapScalarType != VTK_UNSIGNED_CHAR)
+      {
+      // Keep the scalar type of the labelmap volume
+      vtkNew<vtkImageCast> cast;
+      cast->SetInputData(labelOrientedImageData);
+      cast->SetOutputScalarType(labelmapScalarType);
+      cast->Update();
+      labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
+      labelOrientedImageData->vtkImageData::ShallowCopy(cast->GetOutput());
+      }
     labelOrientedImageData->SetGeometryFromImageToWorldMatrix(labelmapIjkToRasMatrix);
 
     vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
@@ -1287,19 +1723,22 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
     segment->SetColor(color[0], color[1], color[2]);
 
     // If there is only one label, then the (only) segment name will be the labelmap name
-    if (labelValues->GetNumberOfValues() == 1)
+    if (labelValues.size() == 1)
       {
       labelName = labelmapNode->GetName();
       }
 
     // Set segment name
-    if (!labelName)
+    if (labelName)
+      {
+      segment->SetName(labelName);
+      }
+    else
       {
       std::stringstream ss;
       ss << "Label_" << label;
-      labelName = ss.str().c_str();
+      segment->SetName(ss.str().c_str());
       }
-    segment->SetName(labelName);
 
     // Apply parent transforms if any
     if (labelmapNode->GetParentTransformNode() || segmentationNode->GetParentTransformNode())
@@ -1307,16 +1746,16 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkMRML
       vtkSmartPointer<vtkGeneralTransform> labelmapToSegmentationTransform = vtkSmartPointer<vtkGeneralTransform>::New();
       vtkSlicerSegmentationsModuleLogic::GetTransformBetweenRepresentationAndSegmentation(labelmapNode, segmentationNode, labelmapToSegmentationTransform);
       vtkOrientedImageDataResample::TransformOrientedImage(labelOrientedImageData, labelmapToSegmentationTransform);
-      }
 
-    // Clip to effective extent
-    int labelOrientedImageDataEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
-    vtkOrientedImageDataResample::CalculateEffectiveExtent(labelOrientedImageData, labelOrientedImageDataEffectiveExtent);
-    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-    padder->SetInputData(labelOrientedImageData);
-    padder->SetOutputWholeExtent(labelOrientedImageDataEffectiveExtent);
-    padder->Update();
-    labelOrientedImageData->DeepCopy(padder->GetOutput());
+      // Clip to effective extent (the split labelmap is already cropped but resampling may add empty margins)
+      int labelOrientedImageDataEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkOrientedImageDataResample::CalculateEffectiveExtent(labelOrientedImageData, labelOrientedImageDataEffectiveExtent);
+      vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
+      padder->SetInputData(labelOrientedImageData);
+      padder->SetOutputWholeExtent(labelOrientedImageDataEffectiveExtent);
+      padder->Update();
+      labelOrientedImageData->DeepCopy(padder->GetOutput());
+      }
 
     // Add oriented image data as binary labelmap representation
     segment->AddRepresentation(
@@ -1353,43 +1792,20 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(vtkOrie
 
   // Note: Splitting code ported from EditorLib/HelperBox.py:split
 
-  // Split labelmap node into per-label image data
+  // Split labelmap node into per-label image data (cropped to the extent of each label)
+  std::vector<int> labelValues;
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > labelImages;
+  SplitLabelmap(labelmapImage, labelValues, labelImages);
 
-  vtkNew<vtkIntArray> labelValues;
-  vtkSlicerSegmentationsModuleLogic::GetAllLabelValues(labelValues.GetPointer(), labelmapImage);
+  vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  labelmapImage->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
 
   int segmentationNodeWasModified = segmentationNode->StartModify();
 
-  vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
-  threshold->SetInputData(labelmapImage);
-  threshold->SetInValue(1);
-  threshold->SetOutValue(0);
-  threshold->ReplaceInOn();
-  threshold->ReplaceOutOn();
-  threshold->SetOutputScalarType(VTK_UNSIGNED_CHAR);
-
-  for (int labelIndex = 0; labelIndex < labelValues->GetNumberOfValues(); ++labelIndex)
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
     {
-    int label = labelValues->GetValue(labelIndex);
-
-    threshold->ThresholdBetween(label, label);
-    threshold->Update();
-
     // Create oriented image data for label
-    vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
-    labelOrientedImageData->ShallowCopy(threshold->GetOutput());
-
-    // Clip to effective extent
-    int labelOrientedImageDataEffectiveExtent[6] = { 0, -1, 0, -1, 0, -1 };
-    vtkOrientedImageDataResample::CalculateEffectiveExtent(labelOrientedImageData, labelOrientedImageDataEffectiveExtent);
-    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-    padder->SetInputData(labelOrientedImageData);
-    padder->SetOutputWholeExtent(labelOrientedImageDataEffectiveExtent);
-    padder->Update();
-
-    labelOrientedImageData->ShallowCopy(padder->GetOutput());
-    vtkSmartPointer<vtkMatrix4x4> labelmapImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-    labelmapImage->GetImageToWorldMatrix(labelmapImageToWorldMatrix);
+    vtkOrientedImageData* labelOrientedImageData = labelImages[labelIndex];
     labelOrientedImageData->SetGeometryFromImageToWorldMatrix(labelmapImageToWorldMatrix);
 
     vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
@@ -1488,13 +1904,16 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(
   vtkSmartPointer<vtkMatrix4x4> labelmapIjkToRasMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   labelmapImage->GetImageToWorldMatrix(labelmapIjkToRasMatrix);
 
-  vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
-  threshold->SetInputData(labelmapImage);
-  threshold->SetInValue(1);
-  threshold->SetOutValue(0);
-  threshold->ReplaceInOn();
-  threshold->ReplaceOutOn();
-  threshold->SetOutputScalarType(labelmapImage->GetScalarType());
+  // Split labelmap into per-label image data (cropped to the extent of each label)
+  std::vector<int> labelValues;
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > labelImages;
+  SplitLabelmap(labelmapImage, labelValues, labelImages);
+  std::map<int, vtkOrientedImageData*> labelImagesByLabel;
+  for (int labelIndex = 0; labelIndex < static_cast<int>(labelValues.size()); ++labelIndex)
+    {
+    labelImagesByLabel[labelValues[labelIndex]] = labelImages[labelIndex];
+    }
+  int labelmapScalarType = labelmapImage->GetScalarType();
 
   int segmentationNodeWasModified = segmentationNode->StartModify();
   for (int segmentIndex = 0; segmentIndex < updatedSegmentIDs->GetNumberOfValues(); ++segmentIndex)
@@ -1511,12 +1930,31 @@ bool vtkSlicerSegmentationsModuleLogic::ImportLabelmapToSegmentationNode(
     }
 
     int label = segmentIndex + 1;
-    threshold->ThresholdBetween(label, label);
-    threshold->Update();
 
     // Create oriented image data for label
     vtkSmartPointer<vtkOrientedImageData> labelOrientedImageData = vtkSmartPointer<vtkOrientedImageData>::New();
-    labelOrientedImageData->ShallowCopy(threshold->GetOutput());
+    std::map<int, vtkOrientedImageData*>::iterator labelImageIt = labelImagesByLabel.find(label);
+    if (labelImageIt == labelImagesByLabel.end())
+      {
+      // Label is not present in the labelmap, segment becomes empty
+      labelOrientedImageData->SetExtent(labelmapImage->GetExtent());
+      labelOrientedImageData->AllocateScalars(labelmapScalarType, 1);
+      memset(labelOrientedImageData->GetScalarPointer(), 0,
+        labelOrientedImageData->GetScalarSize() * labelOrientedImageData->GetNumberOfPoints());
+      }
+    else if (labelmapScalarType != VTK_UNSIGNED_CHAR)
+      {
+      // Keep the scalar type of the labelmap
+      vtkNew<vtkImageCast> cast;
+      cast->SetInputData(labelImageIt->second);
+      cast->SetOutputScalarType(labelmapScalarType);
+      cast->Update();
+      labelOrientedImageData->vtkImageData::ShallowCopy(cast->GetOutput());
+      }
+    else
+      {
+      labelOrientedImageData->vtkImageData::ShallowCopy(labelImageIt->second);
+      }
     labelOrientedImageData->SetGeometryFromImageToWorldMatrix(labelmapIjkToRasMatrix);
 
     // Apply parent transforms if any
@@ -1799,6 +2237,10 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
       << "segmentation " << segmentationNode->GetName());
     return false;
     }
+  // The segment labelmap is repeatedly modified and cropped to its effective extent during editing.
+  // Keeping track of non-zero voxels in each slice allows recomputing the effective extent by only
+  // scanning the modified slices.
+  segmentLabelmap->SetSliceExtentTracking(true);
 
   // 1. Append input labelmap to the segment labelmap if requested
   vtkSmartPointer<vtkOrientedImageData> newSegmentLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
@@ -1820,10 +2262,65 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
     mergeMode = MODE_REPLACE;
     }
 
-  if (mergeMode == MODE_REPLACE)
+  // Determine if the segment labelmap can be modified in place. This is possible if the modifier labelmap
+  // has the same lattice as the segment labelmap and the modified region is inside the segment labelmap
+  // (minimum operation cannot change voxels outside of the segment labelmap, as they are all empty).
+  // Modifying in place avoids copying the entire segment labelmap and updating its effective extent.
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  bool modifyInPlace = false;
+  if (mergeMode != MODE_REPLACE && vtkOrientedImageDataResample::DoGeometriesMatch(segmentLabelmap, labelmap))
+    {
+    labelmap->GetExtent(updateExtent);
+    for (int i = 0; i < 3; i++)
+      {
+      if (extent)
+        {
+        updateExtent[i * 2] = std::max(updateExtent[i * 2], extent[i * 2]);
+        updateExtent[i * 2 + 1] = std::min(updateExtent[i * 2 + 1], extent[i * 2 + 1]);
+        }
+      if (mergeMode == MODE_MERGE_MIN)
+        {
+        updateExtent[i * 2] = std::max(updateExtent[i * 2], segmentLabelmapExtent[i * 2]);
+        updateExtent[i * 2 + 1] = std::min(updateExtent[i * 2 + 1], segmentLabelmapExtent[i * 2 + 1]);
+        }
+      }
+    if (updateExtent[0] > updateExtent[1] || updateExtent[2] > updateExtent[3] || updateExtent[4] > updateExtent[5])
+      {
+      // modifier does not overlap with the modifiable region, segment is not changed
+      return true;
+      }
+    modifyInPlace = true;
+    for (int i = 0; i < 3; i++)
+      {
+      if (updateExtent[i * 2] < segmentLabelmapExtent[i * 2] || updateExtent[i * 2 + 1] > segmentLabelmapExtent[i * 2 + 1])
+        {
+        modifyInPlace = false;
+        }
+      }
+    }
+
+  // Disable modified event so that the consequently emitted MasterRepresentationModified event that causes
+  // removal of all other representations in all segments does not get activated. Instead, explicitly create
+  // representations for the edited segment that the other segments have.
+  bool wasMasterRepresentationModifiedEnabled = segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(false);
+
+  if (modifyInPlace)
+    {
+    int operation = (mergeMode==MODE_MERGE_MAX ? vtkOrientedImageDataResample::OPERATION_MAXIMUM : vtkOrientedImageDataResample::OPERATION_MINIMUM);
+    vtkMTimeType segmentLabelmapMTimeBefore = segmentLabelmap->GetMTime();
+    if (!vtkOrientedImageDataResample::ModifyImage(segmentLabelmap, labelmap, operation, updateExtent))
+      {
+      segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
+      vtkErrorWithObjectMacro(segmentationNode, "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: Failed to modify labelmap");
+      return false;
+      }
+    segmentLabelmapModified = (segmentLabelmap->GetMTime() > segmentLabelmapMTimeBefore);
+    }
+  else if (mergeMode == MODE_REPLACE)
     {
     if (!vtkOrientedImageDataResample::CopyImage(labelmap, newSegmentLabelmap, extent))
       {
+      segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
       vtkErrorWithObjectMacro(segmentationNode, "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: Failed to copy labelmap");
       return false;
       }
@@ -1840,6 +2337,7 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
         segmentLabelmap, labelmap, resampledSegmentLabelmap, false /*interpolate*/, true /*pad*/);
       if (!vtkOrientedImageDataResample::MergeImage(resampledSegmentLabelmap, labelmap, newSegmentLabelmap, operation, extent, 0, 1, &segmentLabelmapModified))
         {
+        segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
         vtkErrorWithObjectMacro(segmentationNode, "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: Failed to merge labelmap (max)");
         return false;
         }
@@ -1848,6 +2346,7 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
       {
         if (!vtkOrientedImageDataResample::MergeImage(segmentLabelmap, labelmap, newSegmentLabelmap, operation, extent, 0, 1, &segmentLabelmapModified))
         {
+        segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
         vtkErrorWithObjectMacro(segmentationNode, "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: Failed to merge labelmap (max)");
         return false;
         }
@@ -1857,33 +2356,56 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
   if (!segmentLabelmapModified)
     {
     // segment labelmap not modified, there is no need to update representations
+    segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(wasMasterRepresentationModifiedEnabled);
     return true;
     }
 
   // 2. Copy the temporary padded modifier labelmap to the segment.
-  //    Disable modified event so that the consequently emitted MasterRepresentationModified event that causes
-  //    removal of all other representations in all segments does not get activated. Instead, explicitly create
-  //    representations for the edited segment that the other segments have.
-  bool wasMasterRepresentationModifiedEnabled = segmentationNode->GetSegmentation()->SetMasterRepresentationModifiedEnabled(false);
-  segmentLabelmap->ShallowCopy(newSegmentLabelmap);
+  //    Not needed if the segment labelmap was modified in place.
+  if (!modifyInPlace)
+    {
+    segmentLabelmap->ShallowCopy(newSegmentLabelmap);
+    }
 
-  // 3. Shrink the image data extent to only contain the effective data (extent of non-zero voxels)
-  int effectiveExtent[6] = {0,-1,0,-1,0,-1};
-  vtkOrientedImageDataResample::CalculateEffectiveExtent(segmentLabelmap, effectiveExtent); // TODO: use the update extent? maybe crop when changing segment?
-  if (effectiveExtent[0] > effectiveExtent[1] || effectiveExtent[2] > effectiveExtent[3] || effectiveExtent[4] > effectiveExtent[5])
+  // 3. Shrink the image data extent to only contain the effective data (extent of non-zero voxels).
+  //    If the segment labelmap was modified in place then the effective extent may only change
+  //    if voxels were removed at the boundary of the labelmap.
+  bool updateEffectiveExtent = true;
+  if (modifyInPlace)
     {
-    vtkDebugWithObjectMacro(segmentationNode,
-      "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: effective extent of the labelmap to set is invalid (labelmap is empty)");
+    updateEffectiveExtent = false;
+    if (mergeMode == MODE_MERGE_MIN)
+      {
+      for (int i = 0; i < 6; i++)
+        {
+        if (updateExtent[i] == segmentLabelmapExtent[i])
+          {
+          updateEffectiveExtent = true;
+          }
+        }
+      }
     }
-  else
+  if (updateEffectiveExtent)
     {
-    vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
-    padder->SetInputData(segmentLabelmap);
-    padder->SetOutputWholeExtent(effectiveExtent);
-    padder->Update();
-    segmentLabelmap->DeepCopy(padder->GetOutput());
+    int effectiveExtent[6] = {0,-1,0,-1,0,-1};
+    vtkOrientedImageDataResample::CalculateEffectiveExtent(segmentLabelmap, effectiveExtent);
+    if (effectiveExtent[0] > effectiveExtent[1] || effectiveExtent[2] > effectiveExtent[3] || effectiveExtent[4] > effectiveExtent[5])
+      {
+      vtkDebugWithObjectMacro(segmentationNode,
+        "vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment: effective extent of the labelmap to set is invalid (labelmap is empty)");
+      }
+    else
+      {
+      vtkSmartPointer<vtkImageConstantPad> padder = vtkSmartPointer<vtkImageConstantPad>::New();
+      padder->SetInputData(segmentLabelmap);
+      padder->SetOutputWholeExtent(effectiveExtent);
+      padder->Update();
+      segmentLabelmap->DeepCopy(padder->GetOutput());
+      }
     }
   // 4. Re-convert all other representations
+  //    The whole segment is converted: converters (e.g., closed surface) produce a single output for the
+  //    entire labelmap, and a partial result could not be stitched into the previous representation.
   std::vector<std::string> representationNames;
   selectedSegment->GetContainedRepresentationNames(representationNames);
   bool conversionHappened = false;
@@ -2010,3 +2532,96 @@ bool vtkSlicerSegmentationsModuleLogic::SetTerminologyToSegmentationFromLabelmap
 
   return true;
 }
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerSegmentationsModuleLogic::GetSweptBrushExtent(vtkMatrix4x4* worldToIjkMatrix, const int labelmapExtent[6],
+  double radius, bool cylinder, const double axisDirection[3], double halfHeight,
+  const double startPosition[3], const double endPosition[3], int sweptBrushExtent[6])
+{
+  if (!worldToIjkMatrix)
+    {
+    vtkGenericWarningMacro("vtkSlicerSegmentationsModuleLogic::GetSweptBrushExtent: Invalid matrix");
+    return false;
+    }
+  double margin = radius;
+  double sweptEndPosition[3] = { endPosition[0], endPosition[1], endPosition[2] };
+  if (cylinder)
+    {
+    // The cylinder is swept at the height of the start position
+    margin += halfHeight;
+    double axis[3] = { axisDirection[0], axisDirection[1], axisDirection[2] };
+    vtkMath::Normalize(axis);
+    double segmentVector[3] = { endPosition[0] - startPosition[0], endPosition[1] - startPosition[1], endPosition[2] - startPosition[2] };
+    ProjectToPlane(segmentVector, axis, segmentVector);
+    vtkMath::Add(startPosition, segmentVector, sweptEndPosition);
+    }
+  double bounds[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  for (int i = 0; i < 3; i++)
+    {
+    bounds[i * 2] = std::min(startPosition[i], sweptEndPosition[i]) - margin;
+    bounds[i * 2 + 1] = std::max(startPosition[i], sweptEndPosition[i]) + margin;
+    }
+  double ijkBounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  for (int corner = 0; corner < 8; corner++)
+    {
+    double corner_World[4] = { bounds[corner & 1], bounds[2 + ((corner >> 1) & 1)], bounds[4 + ((corner >> 2) & 1)], 1.0 };
+    double corner_Ijk[4] = { 0.0, 0.0, 0.0, 1.0 };
+    worldToIjkMatrix->MultiplyPoint(corner_World, corner_Ijk);
+    for (int i = 0; i < 3; i++)
+      {
+      ijkBounds[i * 2] = std::min(ijkBounds[i * 2], corner_Ijk[i]);
+      ijkBounds[i * 2 + 1] = std::max(ijkBounds[i * 2 + 1], corner_Ijk[i]);
+      }
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    sweptBrushExtent[i * 2] = std::max(labelmapExtent[i * 2], static_cast<int>(floor(ijkBounds[i * 2])));
+    sweptBrushExtent[i * 2 + 1] = std::min(labelmapExtent[i * 2 + 1], static_cast<int>(ceil(ijkBounds[i * 2 + 1])));
+    if (sweptBrushExtent[i * 2] > sweptBrushExtent[i * 2 + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerSegmentationsModuleLogic::PaintSweptBrush(vtkImageData* labelmap, vtkMatrix4x4* ijkToWorldMatrix, const int extent[6],
+  double radius, bool cylinder, const double axisDirection[3], double halfHeight,
+  const double startPosition[3], const double endPosition[3], double fillValue)
+{
+  if (!labelmap || !ijkToWorldMatrix || !labelmap->GetPointData() || !labelmap->GetPointData()->GetScalars())
+    {
+    vtkGenericWarningMacro("vtkSlicerSegmentationsModuleLogic::PaintSweptBrush: Invalid inputs");
+    return false;
+    }
+  const int* labelmapExtent = labelmap->GetExtent();
+  for (int i = 0; i < 3; i++)
+    {
+    if (extent[i * 2] < labelmapExtent[i * 2] || extent[i * 2 + 1] > labelmapExtent[i * 2 + 1])
+      {
+      vtkGenericWarningMacro("vtkSlicerSegmentationsModuleLogic::PaintSweptBrush: Extent is outside of the labelmap extent");
+      return false;
+      }
+    }
+  PaintBrushShape brush;
+  brush.Radius = radius;
+  brush.Cylinder = cylinder;
+  brush.AxisDirection[0] = axisDirection[0];
+  brush.AxisDirection[1] = axisDirection[1];
+  brush.AxisDirection[2] = axisDirection[2];
+  brush.HalfHeight = halfHeight;
+  if (cylinder)
+    {
+    vtkMath::Normalize(brush.AxisDirection);
+    }
+  switch (labelmap->GetScalarType())
+    {
+    vtkTemplateMacro(PaintSweptBrushGeneric<VTK_TT>(labelmap, ijkToWorldMatrix, extent,
+      brush, startPosition, endPosition, static_cast<VTK_TT>(fillValue)));
+    default:
+      vtkGenericWarningMacro("vtkSlicerSegmentationsModuleLogic::PaintSweptBrush: Unsupported labelmap scalar type");
+      return false;
+    }
+  return true;
+}
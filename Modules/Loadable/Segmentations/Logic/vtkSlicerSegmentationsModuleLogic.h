@@ -38,6 +38,8 @@ class vtkOrientedImageData;
 class vtkPolyData;
 class vtkDataObject;
 class vtkGeneralTransform;
+class vtkImageData;
+class vtkMatrix4x4;
 
 class vtkMRMLSegmentationStorageNode;
 class vtkMRMLScalarVolumeNode;
@@ -303,6 +305,8 @@ public:
   /// Master representation must be binary labelmap! Master representation changed event is disabled to prevent deletion of all
   /// other representation in all segments. The other representations in the given segment are re-converted. The extent of the
   /// segment binary labelmap is shrunk to the effective extent. Display update is triggered.
+  /// If the labelmap has the same geometry as the segment labelmap and the modified region is inside the
+  /// segment labelmap then the segment labelmap is merged in place, only within the specified extent.
   /// \param mergeMode Determines if the labelmap should replace the segment, or combined with a maximum or minimum operation.
   /// \param extent If extent is specified then only that extent of the labelmap is used.
   enum
@@ -313,6 +317,26 @@ public:
     };
   static bool SetBinaryLabelmapToSegment(vtkOrientedImageData* labelmap, vtkMRMLSegmentationNode* segmentationNode, std::string segmentID, int mergeMode=MODE_REPLACE, const int extent[6]=0);
 
+  /// Get the extent of a paint brush swept from startPosition to endPosition (world coordinates)
+  /// in the IJK coordinate system of a labelmap, clipped to labelmapExtent.
+  /// \param radius Radius of the brush sphere or cylinder
+  /// \param cylinder If true then the brush is a cylinder with axisDirection axis and 2*halfHeight height,
+  ///   swept at the height of startPosition (as in PaintSweptBrush). Otherwise the brush is a sphere.
+  /// \return False if the swept brush does not intersect the labelmap.
+  static bool GetSweptBrushExtent(vtkMatrix4x4* worldToIjkMatrix, const int labelmapExtent[6],
+    double radius, bool cylinder, const double axisDirection[3], double halfHeight,
+    const double startPosition[3], const double endPosition[3], int sweptBrushExtent[6]);
+
+  /// Set fillValue in all voxels of the labelmap whose center is inside the brush swept from
+  /// startPosition to endPosition (world coordinates), within the given extent (see GetSweptBrushExtent).
+  /// A sphere brush is swept into a capsule. A cylinder brush (with axisDirection axis) is swept in the plane
+  /// orthogonal to its axis, at the height of the start position. For each voxel row the painted voxels are
+  /// computed analytically, so the cost is proportional to the number of rows and painted voxels.
+  /// \return False if inputs are invalid or the labelmap scalar type is not supported.
+  static bool PaintSweptBrush(vtkImageData* labelmap, vtkMatrix4x4* ijkToWorldMatrix, const int extent[6],
+    double radius, bool cylinder, const double axisDirection[3], double halfHeight,
+    const double startPosition[3], const double endPosition[3], double fillValue);
+
   /// Assign terminology to segments in a segmentation node based on the labels of a labelmap node. Match is made based on the
   /// 3dSlicerLabel terminology type attribute. If the terminology context does not contain that attribute, match cannot be made.
   /// \param terminologyContextName Terminology context the entries of which are mapped to the labels imported from the labelmap node
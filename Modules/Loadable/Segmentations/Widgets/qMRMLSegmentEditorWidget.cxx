@@ -49,6 +49,7 @@
 #include <vtkGeneralTransform.h>
 #include <vtkImageThreshold.h>
 #include <vtkInteractorObserver.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkRenderer.h>
@@ -56,6 +57,7 @@
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkSmartPointer.h>
+#include <vtkTimeStamp.h>
 #include <vtkWeakPointer.h>
 
 // Slicer includes
@@ -103,12 +105,102 @@
 #include <ctkFlowLayout.h>
 #include <ctkCollapsibleButton.h>
 
+// STD includes
+#include <algorithm>
+
 static const int BINARY_LABELMAP_SCALAR_TYPE = VTK_UNSIGNED_CHAR;
 // static const unsigned char BINARY_LABELMAP_VOXEL_FULL = 1; // unused
 static const unsigned char BINARY_LABELMAP_VOXEL_EMPTY = 0;
 
 static const char NULL_EFFECT_NAME[] = "NULL";
 
+namespace
+{
+//-----------------------------------------------------------------------------
+bool IsExtentEmpty(const int extent[6])
+{
+  return (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5]);
+}
+
+//-----------------------------------------------------------------------------
+bool IsExtentInside(const int innerExtent[6], const int outerExtent[6])
+{
+  if (IsExtentEmpty(outerExtent))
+    {
+    return false;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    if (innerExtent[i * 2] < outerExtent[i * 2] || innerExtent[i * 2 + 1] > outerExtent[i * 2 + 1])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Compute the extent of a cached image that needs to be updated.
+/// \param fullExtent Extent of the entire image
+/// \param requestedExtent Extent that is requested to be up-to-date (entire image if NULL)
+/// \param validExtent Extent of the image that is currently up-to-date (invalid extent if none)
+/// \param updateExtent Computed extent that has to be updated. Invalid if no update is needed.
+void GetExtentToUpdate(const int fullExtent[6], const int* requestedExtent, const int validExtent[6], int updateExtent[6])
+{
+  for (int i = 0; i < 6; i++)
+    {
+    updateExtent[i] = fullExtent[i];
+    }
+  if (requestedExtent)
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      updateExtent[i * 2] = std::max(updateExtent[i * 2], requestedExtent[i * 2]);
+      updateExtent[i * 2 + 1] = std::min(updateExtent[i * 2 + 1], requestedExtent[i * 2 + 1]);
+      }
+    if (IsExtentEmpty(updateExtent))
+      {
+      // requested region is outside of the image, update the entire image to make sure it is valid
+      for (int i = 0; i < 6; i++)
+        {
+        updateExtent[i] = fullExtent[i];
+        }
+      }
+    }
+  if (IsExtentInside(updateExtent, validExtent))
+    {
+    // already up-to-date
+    updateExtent[0] = 0;
+    updateExtent[1] = -1;
+    return;
+    }
+  if (!IsExtentEmpty(validExtent))
+    {
+    // Extend the valid region so that the updated region remains a box
+    for (int i = 0; i < 3; i++)
+      {
+      updateExtent[i * 2] = std::min(updateExtent[i * 2], validExtent[i * 2]);
+      updateExtent[i * 2 + 1] = std::max(updateExtent[i * 2 + 1], validExtent[i * 2 + 1]);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Allocate new scalars for the image in the specified geometry.
+/// Scalars are not shared with any other images after this call.
+void AllocateImage(vtkOrientedImageData* image, vtkOrientedImageData* geometryImage, int scalarType, int numberOfComponents)
+{
+  vtkNew<vtkOrientedImageData> newImage;
+  newImage->SetExtent(geometryImage->GetExtent());
+  newImage->AllocateScalars(scalarType, numberOfComponents);
+  image->ShallowCopy(newImage.GetPointer());
+  vtkNew<vtkMatrix4x4> imageToWorldMatrix;
+  geometryImage->GetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+  image->SetImageToWorldMatrix(imageToWorldMatrix.GetPointer());
+}
+
+} // end of anonymous namespace
+
 //---------------------------------------------------------------------------
 class vtkSegmentEditorEventCallbackCommand : public vtkCallbackCommand
 {
@@ -182,10 +274,14 @@ public:
   bool updateSelectedSegmentLabelmap();
 
   /// Updates a resampled master volume in a geometry aligned with default modifierLabelmap.
-  bool updateAlignedMasterVolume();
+  /// The volume is only recomputed if its inputs changed. If extent is specified then the volume
+  /// is only guaranteed to be up-to-date within that extent.
+  bool updateAlignedMasterVolume(const int* extent = NULL);
 
   /// Updates mask labelmap aligned with default modifierLabelmap.
-  bool updateMaskLabelmap();
+  /// The mask is only recomputed if its inputs changed. If extent is specified then the mask
+  /// is only guaranteed to be up-to-date within that extent.
+  bool updateMaskLabelmap(const int* extent = NULL);
 
   bool updateReferenceGeometryImage();
 
@@ -255,6 +351,20 @@ public:
   vtkMRMLVolumeNode* AlignedMasterVolumeUpdateMasterVolumeNode;
   vtkMRMLTransformNode* AlignedMasterVolumeUpdateMasterVolumeNodeTransform;
   vtkMRMLTransformNode* AlignedMasterVolumeUpdateSegmentationNodeTransform;
+  std::string AlignedMasterVolumeUpdateReferenceGeometry;
+  vtkTimeStamp AlignedMasterVolumeUpdateTime;
+  /// Region of AlignedMasterVolume that is up-to-date
+  int AlignedMasterVolumeValidExtent[6];
+
+  /// Input data that is used for computing MaskLabelmap.
+  /// It is stored so that it can be determined that the mask has to be updated
+  vtkMRMLSegmentationNode* MaskLabelmapUpdateSegmentationNode;
+  std::vector<std::string> MaskLabelmapUpdateSegmentIDs;
+  bool MaskLabelmapUpdatePaintInsideSegments;
+  std::string MaskLabelmapUpdateReferenceGeometry;
+  vtkTimeStamp MaskLabelmapUpdateTime;
+  /// Region of MaskLabelmap that is up-to-date
+  int MaskLabelmapValidExtent[6];
 
   int MaskModeComboBoxFixedItemsCount;
 
@@ -283,9 +393,17 @@ qMRMLSegmentEditorWidgetPrivate::qMRMLSegmentEditorWidgetPrivate(qMRMLSegmentEdi
   , AlignedMasterVolumeUpdateMasterVolumeNode(NULL)
   , AlignedMasterVolumeUpdateMasterVolumeNodeTransform(NULL)
   , AlignedMasterVolumeUpdateSegmentationNodeTransform(NULL)
+  , MaskLabelmapUpdateSegmentationNode(NULL)
+  , MaskLabelmapUpdatePaintInsideSegments(false)
   , MaskModeComboBoxFixedItemsCount(0)
   , EffectButtonStyle(Qt::ToolButtonTextUnderIcon)
 {
+  const int invalidExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int i = 0; i < 6; i++)
+    {
+    this->AlignedMasterVolumeValidExtent[i] = invalidExtent[i];
+    this->MaskLabelmapValidExtent[i] = invalidExtent[i];
+    }
   this->AlignedMasterVolume = vtkOrientedImageData::New();
   this->ModifierLabelmap = vtkOrientedImageData::New();
   this->MaskLabelmap = vtkOrientedImageData::New();
@@ -460,7 +578,8 @@ void qMRMLSegmentEditorWidgetPrivate::updateEffectList()
     effect->setCallbackSlots(q,
       SLOT(setActiveEffectByName(QString)),
       SLOT(updateVolume(void*, bool&)),
-      SLOT(saveStateForUndo()));
+      SLOT(saveStateForUndo()),
+      SLOT(updateVolumeInExtent(void*, const int*, bool&)));
 
     effect->setVolumes(this->AlignedMasterVolume, this->ModifierLabelmap, this->MaskLabelmap, this->SelectedSegmentLabelmap, this->ReferenceGeometryImage);
 
@@ -643,7 +762,7 @@ bool qMRMLSegmentEditorWidgetPrivate::updateSelectedSegmentLabelmap()
 
 
 //-----------------------------------------------------------------------------
-bool qMRMLSegmentEditorWidgetPrivate::updateAlignedMasterVolume()
+bool qMRMLSegmentEditorWidgetPrivate::updateAlignedMasterVolume(const int* extent/*=NULL*/)
 {
   if (!this->ParameterSetNode)
     {
@@ -654,7 +773,7 @@ bool qMRMLSegmentEditorWidgetPrivate::updateAlignedMasterVolume()
   vtkMRMLSegmentationNode* segmentationNode = this->ParameterSetNode->GetSegmentationNode();
   vtkMRMLScalarVolumeNode* masterVolumeNode = this->ParameterSetNode->GetMasterVolumeNode();
   std::string referenceImageGeometry = this->referenceImageGeometry();
-  if (!segmentationNode || !masterVolumeNode || referenceImageGeometry.empty())
+  if (!segmentationNode || !masterVolumeNode || !masterVolumeNode->GetImageData() || referenceImageGeometry.empty())
     {
     return false;
     }
@@ -662,40 +781,48 @@ bool qMRMLSegmentEditorWidgetPrivate::updateAlignedMasterVolume()
   vtkNew<vtkOrientedImageData> referenceImage;
   vtkSegmentationConverter::DeserializeImageGeometry(referenceImageGeometry, referenceImage.GetPointer(), false);
 
-  int* referenceImageExtent = referenceImage->GetExtent();
-  int* alignedMasterVolumeExtent = this->AlignedMasterVolume->GetExtent();
-  // If master volume node and transform nodes did not change and the aligned master volume covers the entire reference geometry
-  // then we don't need to update the aligned master volume.
-  if (vtkOrientedImageDataResample::DoGeometriesMatch(referenceImage.GetPointer(), this->AlignedMasterVolume)
-    && alignedMasterVolumeExtent[0] <= referenceImageExtent[0] && alignedMasterVolumeExtent[1] >= referenceImageExtent[1]
-    && alignedMasterVolumeExtent[2] <= referenceImageExtent[2] && alignedMasterVolumeExtent[3] >= referenceImageExtent[3]
-    && alignedMasterVolumeExtent[4] <= referenceImageExtent[4] && alignedMasterVolumeExtent[5] >= referenceImageExtent[5]
-    && vtkOrientedImageDataResample::DoExtentsMatch(referenceImage.GetPointer(), this->AlignedMasterVolume)
-    && this->AlignedMasterVolumeUpdateMasterVolumeNode == masterVolumeNode
-    && this->AlignedMasterVolumeUpdateMasterVolumeNodeTransform == masterVolumeNode->GetParentTransformNode()
-    && this->AlignedMasterVolumeUpdateSegmentationNodeTransform == segmentationNode->GetParentTransformNode() )
-    {
-    // Extents and nodes are matching, check if they have not been modified since the aligned master
-    // volume generation.
+  // Invalidate the aligned master volume if the master volume, transform nodes, or reference geometry
+  // changed since the aligned master volume generation.
+  if (!IsExtentEmpty(this->AlignedMasterVolumeValidExtent))
+    {
     bool updateAlignedMasterVolumeRequired = false;
-    if (masterVolumeNode->GetMTime() > this->AlignedMasterVolume->GetMTime())
+    if (this->AlignedMasterVolumeUpdateReferenceGeometry != referenceImageGeometry
+      || this->AlignedMasterVolumeUpdateMasterVolumeNode != masterVolumeNode
+      || this->AlignedMasterVolumeUpdateMasterVolumeNodeTransform != masterVolumeNode->GetParentTransformNode()
+      || this->AlignedMasterVolumeUpdateSegmentationNodeTransform != segmentationNode->GetParentTransformNode()
+      || !vtkOrientedImageDataResample::DoGeometriesMatch(referenceImage.GetPointer(), this->AlignedMasterVolume)
+      || !vtkOrientedImageDataResample::DoExtentsMatch(referenceImage.GetPointer(), this->AlignedMasterVolume))
       {
       updateAlignedMasterVolumeRequired = true;
       }
-    else if (masterVolumeNode->GetParentTransformNode() && masterVolumeNode->GetParentTransformNode()->GetMTime() > this->AlignedMasterVolume->GetMTime())
+    else if (masterVolumeNode->GetMTime() > this->AlignedMasterVolumeUpdateTime
+      || masterVolumeNode->GetImageData()->GetMTime() > this->AlignedMasterVolumeUpdateTime)
       {
       updateAlignedMasterVolumeRequired = true;
       }
-    else if (segmentationNode->GetParentTransformNode() && segmentationNode->GetParentTransformNode()->GetMTime() > this->AlignedMasterVolume->GetMTime())
+    else if (masterVolumeNode->GetParentTransformNode() && masterVolumeNode->GetParentTransformNode()->GetMTime() > this->AlignedMasterVolumeUpdateTime)
       {
       updateAlignedMasterVolumeRequired = true;
       }
-    if (!updateAlignedMasterVolumeRequired)
+    else if (segmentationNode->GetParentTransformNode() && segmentationNode->GetParentTransformNode()->GetMTime() > this->AlignedMasterVolumeUpdateTime)
       {
-      return true;
+      updateAlignedMasterVolumeRequired = true;
+      }
+    if (updateAlignedMasterVolumeRequired)
+      {
+      this->AlignedMasterVolumeValidExtent[0] = 0;
+      this->AlignedMasterVolumeValidExtent[1] = -1;
       }
     }
 
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  GetExtentToUpdate(referenceImage->GetExtent(), extent, this->AlignedMasterVolumeValidExtent, updateExtent);
+  if (IsExtentEmpty(updateExtent))
+    {
+    // aligned master volume is up-to-date in the requested extent
+    return true;
+    }
+
   // Get a read-only version of masterVolume as a vtkOrientedImageData
   vtkNew<vtkOrientedImageData> masterVolume;
   masterVolume->vtkImageData::ShallowCopy(masterVolumeNode->GetImageData());
@@ -703,21 +830,61 @@ bool qMRMLSegmentEditorWidgetPrivate::updateAlignedMasterVolume()
   masterVolumeNode->GetIJKToRASMatrix(ijkToRasMatrix);
   masterVolume->SetGeometryFromImageToWorldMatrix(ijkToRasMatrix);
 
-  vtkNew<vtkGeneralTransform> masterVolumeToSegmentationTransform;
-  vtkMRMLTransformNode::GetTransformBetweenNodes(masterVolumeNode->GetParentTransformNode(), segmentationNode->GetParentTransformNode(), masterVolumeToSegmentationTransform.GetPointer());
+  if (masterVolumeNode->GetParentTransformNode() == segmentationNode->GetParentTransformNode()
+    && vtkOrientedImageDataResample::DoGeometriesMatch(masterVolume.GetPointer(), referenceImage.GetPointer())
+    && vtkOrientedImageDataResample::DoExtentsMatch(masterVolume.GetPointer(), referenceImage.GetPointer()))
+    {
+    // Master volume is already aligned with the reference geometry (this is the most common case),
+    // there is no need to resample or copy voxels.
+    this->AlignedMasterVolume->ShallowCopy(masterVolume.GetPointer());
+    referenceImage->GetExtent(updateExtent);
+    }
+  else
+    {
+    vtkNew<vtkGeneralTransform> masterVolumeToSegmentationTransform;
+    vtkMRMLTransformNode::GetTransformBetweenNodes(masterVolumeNode->GetParentTransformNode(), segmentationNode->GetParentTransformNode(), masterVolumeToSegmentationTransform.GetPointer());
 
-  vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(masterVolume.GetPointer(), referenceImage.GetPointer(), this->AlignedMasterVolume,
-    /*linearInterpolation=*/true, /*padImage=*/false, masterVolumeToSegmentationTransform.GetPointer());
+    int* referenceImageExtent = referenceImage->GetExtent();
+    if (updateExtent[0] == referenceImageExtent[0] && updateExtent[1] == referenceImageExtent[1]
+      && updateExtent[2] == referenceImageExtent[2] && updateExtent[3] == referenceImageExtent[3]
+      && updateExtent[4] == referenceImageExtent[4] && updateExtent[5] == referenceImageExtent[5])
+      {
+      vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(masterVolume.GetPointer(), referenceImage.GetPointer(), this->AlignedMasterVolume,
+        /*linearInterpolation=*/true, /*padImage=*/false, masterVolumeToSegmentationTransform.GetPointer());
+      }
+    else
+      {
+      // Only resample the region that is needed
+      if (IsExtentEmpty(this->AlignedMasterVolumeValidExtent))
+        {
+        AllocateImage(this->AlignedMasterVolume, referenceImage.GetPointer(), masterVolume->GetScalarType(), masterVolume->GetNumberOfScalarComponents());
+        }
+      vtkNew<vtkOrientedImageData> regionReferenceImage;
+      vtkSegmentationConverter::DeserializeImageGeometry(referenceImageGeometry, regionReferenceImage.GetPointer(), false);
+      regionReferenceImage->SetExtent(updateExtent);
+      vtkNew<vtkOrientedImageData> alignedMasterVolumeRegion;
+      vtkOrientedImageDataResample::ResampleOrientedImageToReferenceOrientedImage(masterVolume.GetPointer(), regionReferenceImage.GetPointer(),
+        alignedMasterVolumeRegion.GetPointer(), /*linearInterpolation=*/true, /*padImage=*/false, masterVolumeToSegmentationTransform.GetPointer());
+      this->AlignedMasterVolume->CopyAndCastFrom(alignedMasterVolumeRegion.GetPointer(), updateExtent);
+      this->AlignedMasterVolume->Modified();
+      }
+    }
 
+  for (int i = 0; i < 6; i++)
+    {
+    this->AlignedMasterVolumeValidExtent[i] = updateExtent[i];
+    }
   this->AlignedMasterVolumeUpdateMasterVolumeNode = masterVolumeNode;
   this->AlignedMasterVolumeUpdateMasterVolumeNodeTransform = masterVolumeNode->GetParentTransformNode();
   this->AlignedMasterVolumeUpdateSegmentationNodeTransform = segmentationNode->GetParentTransformNode();
+  this->AlignedMasterVolumeUpdateReferenceGeometry = referenceImageGeometry;
+  this->AlignedMasterVolumeUpdateTime.Modified();
 
   return true;
 }
 
 //-----------------------------------------------------------------------------
-bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap()
+bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap(const int* extent/*=NULL*/)
 {
   if (!this->ParameterSetNode)
     {
@@ -736,6 +903,11 @@ bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap()
     {
     return false;
     }
+  std::string referenceImageGeometry = this->referenceImageGeometry();
+  if (referenceImageGeometry.empty())
+    {
+    return false;
+    }
 
   std::vector<std::string> allSegmentIDs;
   segmentationNode->GetSegmentation()->GetSegmentIDs(allSegmentIDs);
@@ -809,32 +981,106 @@ bool qMRMLSegmentEditorWidgetPrivate::updateMaskLabelmap()
     maskSegmentIDs.erase(std::remove(maskSegmentIDs.begin(), maskSegmentIDs.end(), editedSegmentID), maskSegmentIDs.end());
     }
 
-  // Update mask if modifier labelmap is valid
-  int modifierLabelmapExtent[6] = { 0, -1, 0, -1, 0, -1 };
-  this->ModifierLabelmap->GetExtent(modifierLabelmapExtent);
-  if (modifierLabelmapExtent[0] <= modifierLabelmapExtent[1]
-    && modifierLabelmapExtent[2] <= modifierLabelmapExtent[3]
-    && modifierLabelmapExtent[4] <= modifierLabelmapExtent[5])
+  vtkNew<vtkOrientedImageData> referenceImage;
+  vtkSegmentationConverter::DeserializeImageGeometry(referenceImageGeometry, referenceImage.GetPointer(), false);
+
+  // Invalidate the mask if the list of masking segments, their content, or the reference geometry
+  // changed since the mask generation.
+  if (!IsExtentEmpty(this->MaskLabelmapValidExtent))
+    {
+    bool updateMaskRequired = false;
+    if (this->MaskLabelmapUpdateReferenceGeometry != referenceImageGeometry
+      || this->MaskLabelmapUpdateSegmentationNode != segmentationNode
+      || this->MaskLabelmapUpdateSegmentIDs != maskSegmentIDs
+      || this->MaskLabelmapUpdatePaintInsideSegments != paintInsideSegments
+      || !vtkOrientedImageDataResample::DoGeometriesMatch(referenceImage.GetPointer(), maskImage)
+      || !vtkOrientedImageDataResample::DoExtentsMatch(referenceImage.GetPointer(), maskImage))
+      {
+      updateMaskRequired = true;
+      }
+    for (std::vector<std::string>::iterator segmentIDIt = maskSegmentIDs.begin();
+      !updateMaskRequired && segmentIDIt != maskSegmentIDs.end(); ++segmentIDIt)
+      {
+      vtkSegment* segment = segmentationNode->GetSegmentation()->GetSegment(*segmentIDIt);
+      vtkDataObject* segmentLabelmap = (segment ? segment->GetRepresentation(
+        vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()) : NULL);
+      if (!segmentLabelmap || segmentLabelmap->GetMTime() > this->MaskLabelmapUpdateTime)
+        {
+        updateMaskRequired = true;
+        }
+      }
+    if (updateMaskRequired)
+      {
+      this->MaskLabelmapValidExtent[0] = 0;
+      this->MaskLabelmapValidExtent[1] = -1;
+      }
+    }
+
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  GetExtentToUpdate(referenceImage->GetExtent(), extent, this->MaskLabelmapValidExtent, updateExtent);
+  if (IsExtentEmpty(updateExtent))
     {
-    maskImage->SetExtent(modifierLabelmapExtent);
-    maskImage->AllocateScalars(VTK_SHORT, 1); // Change scalar type from unsigned int back to short for merged labelmap generation
+    // mask is up-to-date in the requested extent
+    return true;
+    }
 
-    segmentationNode->GenerateMergedLabelmap(maskImage, vtkSegmentation::EXTENT_UNION_OF_SEGMENTS, this->ModifierLabelmap, maskSegmentIDs);
-    vtkSmartPointer<vtkMatrix4x4> mergedImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-    maskImage->GetImageToWorldMatrix(mergedImageToWorldMatrix);
+  // Generate the mask only in the region that is needed
+  vtkNew<vtkOrientedImageData> regionReferenceImage;
+  vtkSegmentationConverter::DeserializeImageGeometry(referenceImageGeometry, regionReferenceImage.GetPointer(), false);
+  regionReferenceImage->SetExtent(updateExtent);
 
-    vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
-    threshold->SetInputData(maskImage);
-    threshold->SetInValue(paintInsideSegments ? 1 : 0);
-    threshold->SetOutValue(paintInsideSegments ? 0 : 1);
-    threshold->ReplaceInOn();
-    threshold->ThresholdByLower(0);
-    threshold->SetOutputScalarType(VTK_UNSIGNED_CHAR);
-    threshold->Update();
+  vtkNew<vtkOrientedImageData> mergedImage;
+  if (maskSegmentIDs.empty())
+    {
+    // No segments are used for masking (empty segment list would mean all segments for GenerateMergedLabelmap)
+    mergedImage->SetExtent(updateExtent);
+    mergedImage->AllocateScalars(VTK_SHORT, 1);
+    vtkOrientedImageDataResample::FillImage(mergedImage.GetPointer(), 0);
+    }
+  else
+    {
+    segmentationNode->GenerateMergedLabelmap(mergedImage.GetPointer(), vtkSegmentation::EXTENT_UNION_OF_SEGMENTS, regionReferenceImage.GetPointer(), maskSegmentIDs);
+    }
+
+  vtkSmartPointer<vtkImageThreshold> threshold = vtkSmartPointer<vtkImageThreshold>::New();
+  threshold->SetInputData(mergedImage.GetPointer());
+  threshold->SetInValue(paintInsideSegments ? 1 : 0);
+  threshold->SetOutValue(paintInsideSegments ? 0 : 1);
+  threshold->ReplaceInOn();
+  threshold->ThresholdByLower(0);
+  threshold->SetOutputScalarType(VTK_UNSIGNED_CHAR);
+  threshold->Update();
 
-    maskImage->DeepCopy(threshold->GetOutput());
-    maskImage->SetImageToWorldMatrix(mergedImageToWorldMatrix);
+  vtkNew<vtkMatrix4x4> referenceImageToWorldMatrix;
+  referenceImage->GetImageToWorldMatrix(referenceImageToWorldMatrix.GetPointer());
+  int* referenceImageExtent = referenceImage->GetExtent();
+  if (updateExtent[0] == referenceImageExtent[0] && updateExtent[1] == referenceImageExtent[1]
+    && updateExtent[2] == referenceImageExtent[2] && updateExtent[3] == referenceImageExtent[3]
+    && updateExtent[4] == referenceImageExtent[4] && updateExtent[5] == referenceImageExtent[5])
+    {
+    maskImage->ShallowCopy(threshold->GetOutput());
+    maskImage->SetImageToWorldMatrix(referenceImageToWorldMatrix.GetPointer());
     }
+  else
+    {
+    if (IsExtentEmpty(this->MaskLabelmapValidExtent))
+      {
+      AllocateImage(maskImage, referenceImage.GetPointer(), VTK_UNSIGNED_CHAR, 1);
+      }
+    maskImage->CopyAndCastFrom(threshold->GetOutput(), updateExtent);
+    maskImage->Modified();
+    }
+
+  for (int i = 0; i < 6; i++)
+    {
+    this->MaskLabelmapValidExtent[i] = updateExtent[i];
+    }
+  this->MaskLabelmapUpdateSegmentationNode = segmentationNode;
+  this->MaskLabelmapUpdateSegmentIDs = maskSegmentIDs;
+  this->MaskLabelmapUpdatePaintInsideSegments = paintInsideSegments;
+  this->MaskLabelmapUpdateReferenceGeometry = referenceImageGeometry;
+  this->MaskLabelmapUpdateTime.Modified();
+
   return true;
 }
 
@@ -2551,6 +2797,26 @@ void qMRMLSegmentEditorWidget::updateVolume(void* volumeToUpdate, bool& success)
     }
 }
 
+//---------------------------------------------------------------------------
+void qMRMLSegmentEditorWidget::updateVolumeInExtent(void* volumeToUpdate, const int* extent, bool& success)
+{
+  Q_D(qMRMLSegmentEditorWidget);
+
+  if (volumeToUpdate == d->AlignedMasterVolume)
+    {
+    success = d->updateAlignedMasterVolume(extent);
+    }
+  else if (volumeToUpdate == d->MaskLabelmap)
+    {
+    success = d->updateMaskLabelmap(extent);
+    }
+  else
+    {
+    // partial update is not supported for this volume, update the entire volume
+    this->updateVolume(volumeToUpdate, success);
+    }
+}
+
 //---------------------------------------------------------------------------
 void qMRMLSegmentEditorWidget::processEvents(vtkObject* caller,
                                         unsigned long eid,
@@ -215,12 +215,18 @@ public slots:
   void setActiveEffectByName(QString effectName);
 
   /// Save current segmentation before performing an edit operation
-  /// to allow reverting to the current state by using undo
+  /// to allow reverting to the current state by using undo.
+  /// Only segments modified since the previous saved state are copied
+  /// (see vtkSegmentationHistory::SaveState).
   void saveStateForUndo();
 
   /// Update modifierLabelmap, maskLabelmap, or alignedMasterVolumeNode
   void updateVolume(void* volumePtr, bool& success);
 
+  /// Update maskLabelmap or alignedMasterVolumeNode, only within the specified extent.
+  /// Content of the volume outside the extent may be obsolete.
+  void updateVolumeInExtent(void* volumePtr, const int* extent, bool& success);
+
   /// Show/hide the segmentation node selector widget.
   void setSegmentationNodeSelectorVisible(bool);
   /// Show/hide the master volume node selector widget.
@@ -0,0 +1,121 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QPersistentModelIndex>
+#include <QSignalSpy>
+#include <QStandardItem>
+
+// SubjectHierarchy includes
+#include "qMRMLSubjectHierarchyModel.h"
+#include "qSlicerSubjectHierarchyPluginHandler.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+QString itemText(qMRMLSubjectHierarchyModel& model, vtkIdType itemID)
+{
+  return model.indexFromSubjectHierarchyItem(itemID, model.nameColumn()).data().toString();
+}
+
+//-----------------------------------------------------------------------------
+// Items added, reparented and renamed during batch processing are updated
+// in the model without repopulating it.
+int testBatchProcessIncrementalUpdate(vtkMRMLScene* scene)
+{
+  vtkMRMLSubjectHierarchyNode* shNode = vtkMRMLSubjectHierarchyNode::GetSubjectHierarchyNode(scene);
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+  vtkIdType folder1ItemID = shNode->CreateFolderItem(sceneItemID, "Folder1");
+  vtkIdType folder2ItemID = shNode->CreateFolderItem(sceneItemID, "Folder2");
+
+  qMRMLSubjectHierarchyModel model;
+  model.setMRMLScene(scene);
+  CHECK_NOT_NULL(model.subjectHierarchySceneItem());
+  CHECK_INT(model.subjectHierarchySceneItem()->rowCount(), 2);
+
+  QStandardItem* folder1Item = model.itemFromSubjectHierarchyItem(folder1ItemID);
+  CHECK_NOT_NULL(folder1Item);
+  QPersistentModelIndex folder1Index(folder1Item->index());
+  QSignalSpy updatedSpy(&model, SIGNAL(subjectHierarchyUpdated()));
+
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  vtkIdType folder3ItemID = shNode->CreateFolderItem(sceneItemID, "Folder3");
+  vtkIdType childItemID = shNode->CreateFolderItem(folder1ItemID, "Child");
+  shNode->SetItemParent(folder2ItemID, folder1ItemID);
+  shNode->SetItemName(folder1ItemID, "Renamed");
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+
+  CHECK_INT(updatedSpy.count(), 1);
+  // Items of the model are kept
+  CHECK_BOOL(folder1Index.isValid(), true);
+  CHECK_POINTER(model.itemFromSubjectHierarchyItem(folder1ItemID), folder1Item);
+
+  CHECK_INT(model.subjectHierarchySceneItem()->rowCount(), 2);
+  CHECK_INT(model.subjectHierarchyItemFromIndex(model.subjectHierarchySceneItem()->child(0)->index()), folder1ItemID);
+  CHECK_INT(model.subjectHierarchyItemFromIndex(model.subjectHierarchySceneItem()->child(1)->index()), folder3ItemID);
+  CHECK_INT(folder1Item->rowCount(), 2);
+  CHECK_INT(model.subjectHierarchyItemFromIndex(folder1Item->child(0)->index()), childItemID);
+  CHECK_INT(model.subjectHierarchyItemFromIndex(folder1Item->child(1)->index()), folder2ItemID);
+  CHECK_POINTER(model.itemFromSubjectHierarchyItem(folder2ItemID)->parent(), folder1Item);
+  CHECK_STRING(itemText(model, folder1ItemID).toLatin1().constData(), "Renamed");
+  CHECK_STRING(itemText(model, folder3ItemID).toLatin1().constData(), "Folder3");
+
+  // Removing items during batch processing repopulates the model
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  shNode->RemoveItem(folder3ItemID);
+  shNode->RemoveItem(childItemID);
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+
+  CHECK_INT(updatedSpy.count(), 2);
+  CHECK_INT(model.subjectHierarchySceneItem()->rowCount(), 1);
+  CHECK_NULL(model.itemFromSubjectHierarchyItem(folder3ItemID));
+  CHECK_NULL(model.itemFromSubjectHierarchyItem(childItemID));
+  folder1Item = model.itemFromSubjectHierarchyItem(folder1ItemID);
+  CHECK_NOT_NULL(folder1Item);
+  CHECK_INT(folder1Item->rowCount(), 1);
+  CHECK_INT(model.subjectHierarchyItemFromIndex(folder1Item->child(0)->index()), folder2ItemID);
+  CHECK_STRING(itemText(model, folder1ItemID).toLatin1().constData(), "Renamed");
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int qMRMLSubjectHierarchyModelTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  vtkNew<vtkMRMLScene> scene;
+  // Owner plugins are assigned to the items by the plugin handler
+  qSlicerSubjectHierarchyPluginHandler::instance()->setMRMLScene(scene.GetPointer());
+
+  int result = testBatchProcessIncrementalUpdate(scene.GetPointer());
+
+  // Release the subject hierarchy node before the scene is deleted
+  qSlicerSubjectHierarchyPluginHandler::setInstance(NULL);
+  return result;
+}
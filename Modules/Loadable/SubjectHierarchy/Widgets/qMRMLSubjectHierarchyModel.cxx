@@ -55,6 +55,7 @@ qMRMLSubjectHierarchyModelPrivate::qMRMLSubjectHierarchyModelPrivate(qMRMLSubjec
 {
   this->CallBack = vtkSmartPointer<vtkCallbackCommand>::New();
   this->PendingItemModified = -1; // -1 means not updating
+  this->PendingFullUpdate = false;
 
   this->HiddenIcon = QIcon(":Icons/VisibleOff.png");
   this->VisibleIcon = QIcon(":Icons/VisibleOn.png");
@@ -122,6 +123,14 @@ QString qMRMLSubjectHierarchyModelPrivate::subjectHierarchyItemName(vtkIdType it
   return QString(this->SubjectHierarchyNode->GetItemName(itemID).c_str());
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSubjectHierarchyModelPrivate::clearPendingChanges()
+{
+  this->PendingAddedItems.clear();
+  this->PendingModifiedItems.clear();
+  this->PendingFullUpdate = false;
+}
+
 //------------------------------------------------------------------------------
 QStandardItem* qMRMLSubjectHierarchyModelPrivate::insertSubjectHierarchyItem(vtkIdType itemID, int index)
 {
@@ -646,6 +655,7 @@ void qMRMLSubjectHierarchyModel::updateFromSubjectHierarchy()
   Q_D(qMRMLSubjectHierarchyModel);
 
   d->RowCache.clear();
+  d->clearPendingChanges();
 
   // Enabled so it can be interacted with
   this->invisibleRootItem()->setFlags(Qt::ItemIsEnabled);
@@ -1136,8 +1146,13 @@ void qMRMLSubjectHierarchyModel::updateSubjectHierarchyItemFromItemData(vtkIdTyp
 void qMRMLSubjectHierarchyModel::updateModelItems(vtkIdType itemID)
 {
   Q_D(qMRMLSubjectHierarchyModel);
-  if (d->MRMLScene->IsClosing() || d->MRMLScene->IsBatchProcessing())
+  if (d->MRMLScene->IsClosing())
+    {
+    return;
+    }
+  if (d->MRMLScene->IsBatchProcessing())
     {
+    d->PendingModifiedItems.insert(itemID);
     return;
     }
 
@@ -1241,7 +1256,12 @@ void qMRMLSubjectHierarchyModel::onEvent(
 //------------------------------------------------------------------------------
 void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemAdded(vtkIdType itemID)
 {
+  Q_D(qMRMLSubjectHierarchyModel);
   this->insertSubjectHierarchyItem(itemID);
+  if (d->MRMLScene && d->MRMLScene->IsBatchProcessing())
+    {
+    d->PendingAddedItems << itemID;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -1250,6 +1270,7 @@ void qMRMLSubjectHierarchyModel::onSubjectHierarchyItemAboutToBeRemoved(vtkIdTyp
   Q_D(qMRMLSubjectHierarchyModel);
   if (d->MRMLScene->IsClosing() || d->MRMLScene->IsBatchProcessing())
     {
+    d->PendingFullUpdate = true;
     return;
     }
 
@@ -1345,8 +1366,34 @@ void qMRMLSubjectHierarchyModel::onMRMLSceneStartBatchProcess(vtkMRMLScene* scen
 //------------------------------------------------------------------------------
 void qMRMLSubjectHierarchyModel::onMRMLSceneEndBatchProcess(vtkMRMLScene* scene)
 {
+  Q_D(qMRMLSubjectHierarchyModel);
   Q_UNUSED(scene);
-  this->updateFromSubjectHierarchy();
+  if (d->PendingFullUpdate || !d->SubjectHierarchyNode || !this->subjectHierarchySceneItem())
+    {
+    this->updateFromSubjectHierarchy();
+    return;
+    }
+
+  // Items added during batch processing are already in the model, only the items modified
+  // in the meantime (e.g. reparented) need to be updated
+  QList<vtkIdType> addedItemIDs = d->PendingAddedItems;
+  QSet<vtkIdType> modifiedItemIDs = d->PendingModifiedItems;
+  d->clearPendingChanges();
+  foreach (vtkIdType itemID, modifiedItemIDs)
+    {
+    this->updateModelItems(itemID);
+    }
+  // Update expanded states (they could not be set in the tree view while the items were inserted)
+  foreach (vtkIdType itemID, addedItemIDs)
+    {
+    QStandardItem* item = this->itemFromSubjectHierarchyItem(itemID, this->nameColumn());
+    if (item)
+      {
+      this->updateItemDataFromSubjectHierarchyItem(item, itemID, this->nameColumn());
+      }
+    }
+
+  emit subjectHierarchyUpdated();
 }
 
 //------------------------------------------------------------------------------
@@ -38,6 +38,7 @@
 class QStandardItemModel;
 #include <QFlags>
 #include <QMap>
+#include <QSet>
 
 // SubjectHierarchy includes
 #include "qSlicerSubjectHierarchyModuleWidgetsExport.h"
@@ -74,10 +75,20 @@ public:
   /// Convenience function to get name for subject hierarchy item
   QString subjectHierarchyItemName(vtkIdType itemID);
 
+  /// Forget about the subject hierarchy changes that were ignored during batch processing
+  void clearPendingChanges();
+
 public:
   vtkSmartPointer<vtkCallbackCommand> CallBack;
   int PendingItemModified;
 
+  // Subject hierarchy changes during batch processing. At the end of the batch processing,
+  // the items added or modified in the meantime are updated incrementally instead of
+  // repopulating the whole model, unless items have been removed.
+  QList<vtkIdType> PendingAddedItems;
+  QSet<vtkIdType> PendingModifiedItems;
+  bool PendingFullUpdate;
+
   int NameColumn;
   int IDColumn;
   int VisibilityColumn;
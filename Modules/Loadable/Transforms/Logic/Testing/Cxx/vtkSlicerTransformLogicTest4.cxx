@@ -0,0 +1,258 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Logic includes
+#include "vtkSlicerTransformLogic.h"
+
+// MRML includes
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTransformNode.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageInterpolator.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkOrientedGridTransform.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+
+// Hardening a non-linear transform on a volume is tested by comparing the result of
+// vtkSlicerTransformLogic::HardenVolumeTransform with the result of the generic
+// vtkMRMLTransformableNode::HardenTransform method.
+// Computation times of both methods are printed. The volume size can be specified
+// as first argument (e.g., run with 512 to benchmark on a 512^3 volume).
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLScalarVolumeNode> CreateRampVolume(vtkMRMLScene* scene, int size)
+{
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, size - 1, 0, size - 1, 0, size - 1);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  float* voxelPtr = static_cast<float*>(image->GetScalarPointer());
+  for (int k = 0; k < size; k++)
+    {
+    for (int j = 0; j < size; j++)
+      {
+      for (int i = 0; i < size; i++)
+        {
+        *(voxelPtr++) = static_cast<float>(i + 2 * j + 3 * k);
+        }
+      }
+    }
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetOrigin(-size / 2.0, -size / 2.0, -size / 2.0);
+  volumeNode->SetSpacing(1.0, 1.0, 1.0);
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  scene->AddNode(volumeNode);
+  return volumeNode;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLTransformNode> CreateWarpTransform(vtkMRMLScene* scene, int size)
+{
+  // Smooth displacement field that covers the entire volume
+  const int gridSize = 10;
+  const double gridSpacing = size / (gridSize - 3.0);
+  const double amplitude = 2.0;
+  const double pi = 3.14159265358979;
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetExtent(0, gridSize - 1, 0, gridSize - 1, 0, gridSize - 1);
+  displacementGrid->SetOrigin(-size / 2.0 - gridSpacing, -size / 2.0 - gridSpacing, -size / 2.0 - gridSpacing);
+  displacementGrid->SetSpacing(gridSpacing, gridSpacing, gridSpacing);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  for (int k = 0; k < gridSize; k++)
+    {
+    for (int j = 0; j < gridSize; j++)
+      {
+      for (int i = 0; i < gridSize; i++)
+        {
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 0, amplitude * sin(2.0 * pi * j / (gridSize - 1)));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 1, amplitude * sin(2.0 * pi * k / (gridSize - 1)));
+        displacementGrid->SetScalarComponentFromDouble(i, j, k, 2, amplitude * sin(2.0 * pi * i / (gridSize - 1)));
+        }
+      }
+    }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementGrid.GetPointer());
+  gridTransform->SetInterpolationModeToCubic();
+
+  vtkSmartPointer<vtkMRMLTransformNode> transformNode = vtkSmartPointer<vtkMRMLTransformNode>::New();
+  scene->AddNode(transformNode);
+  transformNode->SetAndObserveTransformToParent(gridTransform.GetPointer());
+  return transformNode;
+}
+
+//-----------------------------------------------------------------------------
+// Returns the number of voxels where the two hardened volumes differ by more than the tolerance.
+// Voxels whose source position is close to the boundary of the original volume are skipped,
+// because background and interpolated values may be mixed there.
+int CompareHardenedVolumes(vtkMRMLScalarVolumeNode* volume, vtkMRMLScalarVolumeNode* referenceVolume,
+  vtkMRMLTransformNode* transformNode, int originalSize, double tolerance, int& numberOfComparedVoxels)
+{
+  vtkNew<vtkGeneralTransform> worldToOriginalVolume;
+  transformNode->GetTransformFromWorld(worldToOriginalVolume.GetPointer());
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  volume->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  vtkNew<vtkMatrix4x4> referenceRASToIJK;
+  referenceVolume->GetRASToIJKMatrix(referenceRASToIJK.GetPointer());
+  double originalOrigin = -originalSize / 2.0;
+
+  vtkNew<vtkImageInterpolator> referenceInterpolator;
+  referenceInterpolator->SetInterpolationModeToLinear();
+  referenceInterpolator->Initialize(referenceVolume->GetImageData());
+  referenceInterpolator->Update();
+
+  vtkImageData* image = volume->GetImageData();
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image->GetExtent(extent);
+  numberOfComparedVoxels = 0;
+  int numberOfMismatches = 0;
+  const int step = 3;
+  for (int k = extent[4]; k <= extent[5]; k += step)
+    {
+    for (int j = extent[2]; j <= extent[3]; j += step)
+      {
+      for (int i = extent[0]; i <= extent[1]; i += step)
+        {
+        double point_IJK[4] = { static_cast<double>(i), static_cast<double>(j), static_cast<double>(k), 1.0 };
+        double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
+        double sourcePoint_RAS[3] = { 0.0, 0.0, 0.0 };
+        worldToOriginalVolume->TransformPoint(point_RAS, sourcePoint_RAS);
+        bool nearBoundary = false;
+        for (int c = 0; c < 3; c++)
+          {
+          double sourceIndex = sourcePoint_RAS[c] - originalOrigin;
+          if (sourceIndex < 2.0 || sourceIndex > originalSize - 3.0)
+            {
+            nearBoundary = true;
+            }
+          }
+        if (nearBoundary)
+          {
+          continue;
+          }
+        double referencePoint_IJK[4] = { 0.0, 0.0, 0.0, 1.0 };
+        referenceRASToIJK->MultiplyPoint(point_RAS, referencePoint_IJK);
+        if (!referenceInterpolator->CheckBoundsIJK(referencePoint_IJK))
+          {
+          continue;
+          }
+        double referenceValue = 0.0;
+        referenceInterpolator->InterpolateIJK(referencePoint_IJK, &referenceValue);
+        double value = image->GetScalarComponentAsDouble(i, j, k, 0);
+        numberOfComparedVoxels++;
+        if (fabs(value - referenceValue) > tolerance)
+          {
+          if (numberOfMismatches < 10)
+            {
+            std::cerr << "Mismatch at voxel (" << i << ", " << j << ", " << k << "): "
+              << value << " != " << referenceValue << std::endl;
+            }
+          numberOfMismatches++;
+          }
+        }
+      }
+    }
+  return numberOfMismatches;
+}
+
+//-----------------------------------------------------------------------------
+bool TestHardenVolumeTransform(int size, int displacementFieldSubsampling, double tolerance)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkSmartPointer<vtkMRMLTransformNode> transformNode = CreateWarpTransform(scene.GetPointer(), size);
+
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> referenceVolume = CreateRampVolume(scene.GetPointer(), size);
+  referenceVolume->SetAndObserveTransformNodeID(transformNode->GetID());
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volume = CreateRampVolume(scene.GetPointer(), size);
+  volume->SetAndObserveTransformNodeID(transformNode->GetID());
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  if (!referenceVolume->HardenTransform())
+    {
+    std::cerr << "Line " << __LINE__ << ": vtkMRMLTransformableNode::HardenTransform failed" << std::endl;
+    return false;
+    }
+  timer->StopTimer();
+  double referenceTime = timer->GetElapsedTime();
+
+  vtkNew<vtkSlicerTransformLogic> logic;
+  timer->StartTimer();
+  if (!logic->HardenVolumeTransform(volume, VTK_LINEAR_INTERPOLATION, displacementFieldSubsampling))
+    {
+    std::cerr << "Line " << __LINE__ << ": vtkSlicerTransformLogic::HardenVolumeTransform failed" << std::endl;
+    return false;
+    }
+  timer->StopTimer();
+  double hardeningTime = timer->GetElapsedTime();
+
+  std::cout << "Hardening " << size << "^3 volume (displacement field subsampling: " << displacementFieldSubsampling << ")" << std::endl;
+  std::cout << "  vtkMRMLTransformableNode::HardenTransform: " << referenceTime << "s" << std::endl;
+  std::cout << "  vtkSlicerTransformLogic::HardenVolumeTransform: " << hardeningTime << "s" << std::endl;
+
+  if (volume->GetParentTransformNode() != NULL)
+    {
+    std::cerr << "Line " << __LINE__ << ": transform is not removed from hardened volume" << std::endl;
+    return false;
+    }
+
+  int numberOfComparedVoxels = 0;
+  int numberOfMismatches = CompareHardenedVolumes(volume, referenceVolume, transformNode, size, tolerance, numberOfComparedVoxels);
+  std::cout << "  Number of mismatching voxels: " << numberOfMismatches << " / " << numberOfComparedVoxels << std::endl;
+  if (numberOfComparedVoxels == 0 || numberOfMismatches > numberOfComparedVoxels / 100)
+    {
+    std::cerr << "Line " << __LINE__ << ": hardened volumes are different" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}// end namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerTransformLogicTest4(int argc, char * argv [])
+{
+  int size = 40;
+  if (argc > 1)
+    {
+    size = atoi(argv[1]);
+    }
+  if (size < 10)
+    {
+    std::cerr << "Invalid volume size: " << size << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Full-resolution displacement field
+  if (!TestHardenVolumeTransform(size, 1, 0.5))
+    {
+    return EXIT_FAILURE;
+    }
+  // Subsampled displacement field
+  if (!TestHardenVolumeTransform(size, 4, 1.0))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -16,6 +16,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "vtkMRMLBSplineTransformNode.h"
 #include "vtkMRMLColorNode.h"
 #include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLLabelMapVolumeNode.h"
 #include "vtkMRMLLinearTransformNode.h"
 #include "vtkMRMLMarkupsFiducialNode.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
@@ -32,6 +33,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 // VTK includes
 #include <vtkAppendPolyData.h>
 #include <vtkCollection.h>
+#include <vtkCommand.h>
 #include <vtkArrowSource.h>
 #include <vtkBoundingBox.h>
 #include <vtkConeSource.h>
@@ -41,6 +43,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkGeneralTransform.h>
 #include <vtkGlyphSource2D.h>
 #include <vtkImageData.h>
+#include <vtkImageInterpolator.h>
 #include <vtkLine.h>
 #include <vtkLookupTable.h>
 #include <vtkMath.h>
@@ -52,6 +55,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <vtkPoints.h>
 #include <vtkPointSet.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkSphereSource.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
@@ -77,6 +81,13 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include "itkTranslationTransform.h"
 #include "itkTransformFactory.h"
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
 vtkStandardNewMacro(vtkSlicerTransformLogic);
 
 //----------------------------------------------------------------------------
@@ -96,9 +107,386 @@ bool vtkSlicerTransformLogic::hardenTransform(vtkMRMLTransformableNode* transfor
     {
     return false;
     }
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(transformableNode);
+  vtkMRMLTransformNode* transformNode = transformableNode->GetParentTransformNode();
+  if (volumeNode && volumeNode->GetImageData() && volumeNode->CanApplyNonLinearTransforms()
+    && transformNode && !transformNode->IsTransformToWorldLinear())
+    {
+    // Labels must not be blended, therefore use nearest neighbor interpolation for labelmaps
+    int interpolationMode = vtkMRMLLabelMapVolumeNode::SafeDownCast(volumeNode) ? VTK_NEAREST_INTERPOLATION : VTK_LINEAR_INTERPOLATION;
+    vtkNew<vtkSlicerTransformLogic> logic;
+    return logic->HardenVolumeTransform(volumeNode, interpolationMode);
+    }
   return transformableNode->HardenTransform();
 }
 
+//----------------------------------------------------------------------------
+// Copies interpolated values to the output image, with clamping to the output
+// scalar range and rounding for integer types.
+template <class T>
+void vtkSlicerTransformLogicCopyToOutput(const double* values, T* outPtr, vtkIdType numberOfValues,
+  double minValue, double maxValue)
+{
+  const bool roundValues = std::numeric_limits<T>::is_integer;
+  for (vtkIdType valueIndex = 0; valueIndex < numberOfValues; valueIndex++)
+    {
+    double value = values[valueIndex];
+    if (value < minValue)
+      {
+      value = minValue;
+      }
+    else if (value > maxValue)
+      {
+      value = maxValue;
+      }
+    if (roundValues)
+      {
+      value = floor(value + 0.5);
+      }
+    outPtr[valueIndex] = static_cast<T>(value);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Resamples rows of a slab of the output volume for hardening a transform.
+// Displacements (transform from world, in RAS) are known at the nodes of a coarse grid
+// (one node every Subsampling voxels) that covers the slab. Displacements are trilinearly
+// interpolated at each output voxel and converted to source positions in input IJK coordinates.
+class vtkSlicerTransformLogicHardenVolumeFunctor
+{
+public:
+  vtkSlicerTransformLogicHardenVolumeFunctor(vtkImageInterpolator* interpolator, vtkImageData* outputImage,
+    const int outputStart_IJK[3], vtkMatrix4x4* inputRASToIJK, const int coarseDimensions[3], int subsampling,
+    const std::vector<double>& backgroundValue)
+    : Interpolator(interpolator)
+    , OutputImage(outputImage)
+    , Subsampling(subsampling)
+    , BackgroundValue(backgroundValue)
+    , Displacements(NULL)
+    , FirstSlice(0)
+    , FirstCoarseSlice(0)
+  {
+    outputImage->GetDimensions(this->OutputDimensions);
+    for (int i = 0; i < 3; i++)
+      {
+      this->CoarseDimensions[i] = coarseDimensions[i];
+      this->OutputStart_IJK[i] = outputStart_IJK[i];
+      for (int j = 0; j < 3; j++)
+        {
+        this->RASToIJKDirection[i][j] = inputRASToIJK->GetElement(i, j);
+        }
+      }
+    this->NumberOfComponents = outputImage->GetNumberOfScalarComponents();
+    this->OutputMinValue = outputImage->GetScalarTypeMin();
+    this->OutputMaxValue = outputImage->GetScalarTypeMax();
+  }
+
+  /// Set the displacements of the coarse grid slab that starts at coarse slice firstCoarseSlice.
+  /// Rows are counted from output slice firstSlice.
+  void SetSlab(const float* displacements, int firstSlice, int firstCoarseSlice)
+  {
+    this->Displacements = displacements;
+    this->FirstSlice = firstSlice;
+    this->FirstCoarseSlice = firstCoarseSlice;
+  }
+
+  void operator()(vtkIdType firstRow, vtkIdType lastRow) const
+  {
+    const int numberOfColumns = this->OutputDimensions[0];
+    const vtkIdType coarseRowLength = 3 * this->CoarseDimensions[0];
+    const vtkIdType coarseSliceLength = coarseRowLength * this->CoarseDimensions[1];
+    std::vector<double> coarseRowPositions(coarseRowLength);
+    std::vector<double> rowValues(static_cast<size_t>(numberOfColumns) * this->NumberOfComponents);
+    for (vtkIdType rowIndex = firstRow; rowIndex < lastRow; rowIndex++)
+      {
+      const int j = static_cast<int>(rowIndex % this->OutputDimensions[1]);
+      const int k = this->FirstSlice + static_cast<int>(rowIndex / this->OutputDimensions[1]);
+
+      // Interpolate displacements along the coarse grid row that contains the current row
+      // and compute the source positions.
+      // Output voxels are aligned with input voxels, therefore the position without displacement is
+      // only shifted by the output start index.
+      int coarseJ[2] = { j / this->Subsampling, std::min(j / this->Subsampling + 1, this->CoarseDimensions[1] - 1) };
+      int coarseK[2] = { k / this->Subsampling, std::min(k / this->Subsampling + 1, this->CoarseDimensions[2] - 1) };
+      const double fj = static_cast<double>(j % this->Subsampling) / this->Subsampling;
+      const double fk = static_cast<double>(k % this->Subsampling) / this->Subsampling;
+      coarseK[0] -= this->FirstCoarseSlice;
+      coarseK[1] -= this->FirstCoarseSlice;
+      const float* d00 = this->Displacements + coarseK[0] * coarseSliceLength + coarseJ[0] * coarseRowLength;
+      const float* d10 = this->Displacements + coarseK[0] * coarseSliceLength + coarseJ[1] * coarseRowLength;
+      const float* d01 = this->Displacements + coarseK[1] * coarseSliceLength + coarseJ[0] * coarseRowLength;
+      const float* d11 = this->Displacements + coarseK[1] * coarseSliceLength + coarseJ[1] * coarseRowLength;
+      for (int coarseI = 0; coarseI < this->CoarseDimensions[0]; coarseI++)
+        {
+        const double position_IJK[3] =
+          {
+          static_cast<double>(coarseI * this->Subsampling + this->OutputStart_IJK[0]),
+          static_cast<double>(j + this->OutputStart_IJK[1]),
+          static_cast<double>(k + this->OutputStart_IJK[2])
+          };
+        double displacement_RAS[3] = { 0.0, 0.0, 0.0 };
+        for (int c = 0; c < 3; c++)
+          {
+          const vtkIdType index = 3 * coarseI + c;
+          displacement_RAS[c] = (1.0 - fk) * ((1.0 - fj) * d00[index] + fj * d10[index])
+            + fk * ((1.0 - fj) * d01[index] + fj * d11[index]);
+          }
+        for (int row = 0; row < 3; row++)
+          {
+          coarseRowPositions[3 * coarseI + row] = position_IJK[row]
+            + this->RASToIJKDirection[row][0] * displacement_RAS[0]
+            + this->RASToIJKDirection[row][1] * displacement_RAS[1]
+            + this->RASToIJKDirection[row][2] * displacement_RAS[2];
+          }
+        }
+
+      // Interpolate source voxel values
+      double* valuePtr = &(rowValues[0]);
+      for (int i = 0; i < numberOfColumns; i++, valuePtr += this->NumberOfComponents)
+        {
+        const int coarseI = i / this->Subsampling;
+        const int nextCoarseI = std::min(coarseI + 1, this->CoarseDimensions[0] - 1);
+        const double fi = static_cast<double>(i % this->Subsampling) / this->Subsampling;
+        double sourcePosition_IJK[3] =
+          {
+          (1.0 - fi) * coarseRowPositions[3 * coarseI] + fi * coarseRowPositions[3 * nextCoarseI],
+          (1.0 - fi) * coarseRowPositions[3 * coarseI + 1] + fi * coarseRowPositions[3 * nextCoarseI + 1],
+          (1.0 - fi) * coarseRowPositions[3 * coarseI + 2] + fi * coarseRowPositions[3 * nextCoarseI + 2]
+          };
+        if (this->Interpolator->CheckBoundsIJK(sourcePosition_IJK))
+          {
+          this->Interpolator->InterpolateIJK(sourcePosition_IJK, valuePtr);
+          }
+        else
+          {
+          std::copy(this->BackgroundValue.begin(), this->BackgroundValue.end(), valuePtr);
+          }
+        }
+
+      void* outPtr = this->OutputImage->GetScalarPointer(0, j, k);
+      switch (this->OutputImage->GetScalarType())
+        {
+        vtkTemplateMacro(vtkSlicerTransformLogicCopyToOutput(&(rowValues[0]), static_cast<VTK_TT*>(outPtr),
+          static_cast<vtkIdType>(rowValues.size()), this->OutputMinValue, this->OutputMaxValue));
+        }
+      }
+  }
+
+protected:
+  vtkImageInterpolator* Interpolator;
+  vtkImageData* OutputImage;
+  int OutputStart_IJK[3];
+  double RASToIJKDirection[3][3];
+  int CoarseDimensions[3];
+  int Subsampling;
+  const std::vector<double>& BackgroundValue;
+  const float* Displacements;
+  int FirstSlice;
+  int FirstCoarseSlice;
+  int OutputDimensions[3];
+  int NumberOfComponents;
+  double OutputMinValue;
+  double OutputMaxValue;
+};
+
+//----------------------------------------------------------------------------
+bool vtkSlicerTransformLogic::HardenVolumeTransform(vtkMRMLVolumeNode* volumeNode,
+  int interpolationMode /* =VTK_LINEAR_INTERPOLATION */, int displacementFieldSubsampling /* =1 */)
+{
+  if (!volumeNode)
+    {
+    vtkErrorMacro("vtkSlicerTransformLogic::HardenVolumeTransform failed: invalid volume node");
+    return false;
+    }
+  if (interpolationMode != VTK_NEAREST_INTERPOLATION && interpolationMode != VTK_LINEAR_INTERPOLATION
+    && interpolationMode != VTK_CUBIC_INTERPOLATION)
+    {
+    vtkErrorMacro("vtkSlicerTransformLogic::HardenVolumeTransform failed: invalid interpolation mode " << interpolationMode);
+    return false;
+    }
+  if (displacementFieldSubsampling < 1)
+    {
+    vtkErrorMacro("vtkSlicerTransformLogic::HardenVolumeTransform failed: invalid displacement field subsampling "
+      << displacementFieldSubsampling);
+    return false;
+    }
+  vtkMRMLTransformNode* transformNode = volumeNode->GetParentTransformNode();
+  vtkImageData* inputImage = volumeNode->GetImageData();
+  if (!transformNode || !inputImage || transformNode->IsTransformToWorldLinear())
+    {
+    // No resampling is needed
+    return volumeNode->HardenTransform();
+    }
+  int inputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inputImage->GetExtent(inputExtent);
+  if (inputExtent[0] > inputExtent[1] || inputExtent[2] > inputExtent[3] || inputExtent[4] > inputExtent[5])
+    {
+    return volumeNode->HardenTransform();
+    }
+
+  double progress = 0.0;
+  this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+
+  vtkNew<vtkMatrix4x4> inputIJKToRAS;
+  volumeNode->GetIJKToRASMatrix(inputIJKToRAS.GetPointer());
+  vtkNew<vtkMatrix4x4> inputRASToIJK;
+  volumeNode->GetRASToIJKMatrix(inputRASToIJK.GetPointer());
+
+  // Determine output extent: transform points on the boundary of the input volume
+  // to world and compute their bounding box in the input IJK coordinate system.
+  std::vector<double> boundaryPoints;
+  const int maximumNumberOfSamplesAlongAxis = 32;
+  for (int faceAxis = 0; faceAxis < 3; faceAxis++)
+    {
+    const int axis1 = (faceAxis + 1) % 3;
+    const int axis2 = (faceAxis + 2) % 3;
+    const int step1 = std::max(1, (inputExtent[axis1 * 2 + 1] - inputExtent[axis1 * 2]) / maximumNumberOfSamplesAlongAxis);
+    const int step2 = std::max(1, (inputExtent[axis2 * 2 + 1] - inputExtent[axis2 * 2]) / maximumNumberOfSamplesAlongAxis);
+    for (int side = 0; side < 2; side++)
+      {
+      for (int index1 = inputExtent[axis1 * 2]; ; index1 = std::min(index1 + step1, inputExtent[axis1 * 2 + 1]))
+        {
+        for (int index2 = inputExtent[axis2 * 2]; ; index2 = std::min(index2 + step2, inputExtent[axis2 * 2 + 1]))
+          {
+          double point_IJK[4] = { 0.0, 0.0, 0.0, 1.0 };
+          point_IJK[faceAxis] = inputExtent[faceAxis * 2 + side];
+          point_IJK[axis1] = index1;
+          point_IJK[axis2] = index2;
+          double point_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+          inputIJKToRAS->MultiplyPoint(point_IJK, point_RAS);
+          boundaryPoints.insert(boundaryPoints.end(), point_RAS, point_RAS + 3);
+          if (index2 == inputExtent[axis2 * 2 + 1])
+            {
+            break;
+            }
+          }
+        if (index1 == inputExtent[axis1 * 2 + 1])
+          {
+          break;
+          }
+        }
+      }
+    }
+  vtkNew<vtkGeneralTransform> nodeToWorldTransform;
+  transformNode->GetTransformToWorld(nodeToWorldTransform.GetPointer());
+  const vtkIdType numberOfBoundaryPoints = static_cast<vtkIdType>(boundaryPoints.size() / 3);
+  vtkMRMLTransformNode::TransformPointArray(nodeToWorldTransform.GetPointer(),
+    &(boundaryPoints[0]), &(boundaryPoints[0]), numberOfBoundaryPoints);
+  double boundsMin_IJK[3] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+  double boundsMax_IJK[3] = { VTK_DOUBLE_MIN, VTK_DOUBLE_MIN, VTK_DOUBLE_MIN };
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfBoundaryPoints; pointIndex++)
+    {
+    double point_RAS[4] = { boundaryPoints[3 * pointIndex], boundaryPoints[3 * pointIndex + 1], boundaryPoints[3 * pointIndex + 2], 1.0 };
+    double point_IJK[4] = { 0.0, 0.0, 0.0, 1.0 };
+    inputRASToIJK->MultiplyPoint(point_RAS, point_IJK);
+    for (int i = 0; i < 3; i++)
+      {
+      boundsMin_IJK[i] = std::min(boundsMin_IJK[i], point_IJK[i]);
+      boundsMax_IJK[i] = std::max(boundsMax_IJK[i], point_IJK[i]);
+      }
+    }
+  // Output voxels are aligned with the input voxels, only the extent changes
+  const double tolerance = 1e-3;
+  int outputStart_IJK[3] = { 0, 0, 0 };
+  int outputDimensions[3] = { 1, 1, 1 };
+  for (int i = 0; i < 3; i++)
+    {
+    outputStart_IJK[i] = static_cast<int>(floor(boundsMin_IJK[i] + tolerance));
+    outputDimensions[i] = static_cast<int>(ceil(boundsMax_IJK[i] - tolerance)) - outputStart_IJK[i] + 1;
+    if (outputDimensions[i] < 1)
+      {
+      outputDimensions[i] = 1;
+      }
+    }
+  vtkNew<vtkMatrix4x4> outputIJKToRAS;
+  outputIJKToRAS->DeepCopy(inputIJKToRAS.GetPointer());
+  double outputOrigin_IJK[4] = { static_cast<double>(outputStart_IJK[0]), static_cast<double>(outputStart_IJK[1]),
+    static_cast<double>(outputStart_IJK[2]), 1.0 };
+  double outputOrigin_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+  inputIJKToRAS->MultiplyPoint(outputOrigin_IJK, outputOrigin_RAS);
+  for (int i = 0; i < 3; i++)
+    {
+    outputIJKToRAS->SetElement(i, 3, outputOrigin_RAS[i]);
+    }
+
+  // Sample the transform from world on a grid that covers the output volume.
+  // By default (subsampling = 1) the transform is evaluated exactly at each output voxel.
+  const int subsampling = displacementFieldSubsampling;
+  int coarseDimensions[3] = { 1, 1, 1 };
+  for (int i = 0; i < 3; i++)
+    {
+    coarseDimensions[i] = (outputDimensions[i] - 1 + subsampling - 1) / subsampling + 1;
+    }
+  vtkNew<vtkMatrix4x4> coarseIJKToRAS;
+  coarseIJKToRAS->DeepCopy(outputIJKToRAS.GetPointer());
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 3; col++)
+      {
+      coarseIJKToRAS->SetElement(row, col, outputIJKToRAS->GetElement(row, col) * subsampling);
+      }
+    }
+
+  const int numberOfComponents = inputImage->GetNumberOfScalarComponents();
+  std::vector<double> backgroundValue(numberOfComponents);
+  for (int c = 0; c < numberOfComponents; c++)
+    {
+    backgroundValue[c] = volumeNode->GetImageBackgroundScalarComponentAsDouble(c);
+    }
+
+  vtkNew<vtkImageInterpolator> interpolator;
+  interpolator->SetInterpolationMode(interpolationMode);
+  interpolator->SetOutValue(backgroundValue.empty() ? 0.0 : backgroundValue[0]);
+  interpolator->Initialize(inputImage);
+  interpolator->Update();
+
+  vtkNew<vtkImageData> outputImage;
+  outputImage->SetExtent(0, outputDimensions[0] - 1, 0, outputDimensions[1] - 1, 0, outputDimensions[2] - 1);
+  outputImage->AllocateScalars(inputImage->GetScalarType(), numberOfComponents);
+
+  // The output is processed in slabs of slices. For each slab the displacement field is computed
+  // on the part of the coarse grid that covers the slab, then the slab is resampled in parallel.
+  // The displacement field buffer is reused for all slabs, therefore the memory needed in addition
+  // to the output volume is bounded, regardless of the volume size.
+  // Slabs are also small enough to allow progress reporting from the main thread.
+  const vtkIdType maximumNumberOfSlabPoints = 1 << 20;
+  const vtkIdType numberOfCoarsePointsInSlice = static_cast<vtkIdType>(coarseDimensions[0]) * coarseDimensions[1];
+  // A slab of n slices needs at most (n - 1) / subsampling + 2 coarse slices
+  const int maximumNumberOfSlabCoarseSlices = static_cast<int>(std::max(static_cast<vtkIdType>(2),
+    maximumNumberOfSlabPoints / numberOfCoarsePointsInSlice));
+  const int numberOfSlicesPerSlab = std::max(1, std::min(outputDimensions[2] / 50,
+    (maximumNumberOfSlabCoarseSlices - 2) * subsampling + 1));
+
+  vtkNew<vtkImageData> slabDisplacementField;
+  vtkSlicerTransformLogicHardenVolumeFunctor functor(interpolator.GetPointer(), outputImage.GetPointer(),
+    outputStart_IJK, inputRASToIJK.GetPointer(), coarseDimensions, subsampling, backgroundValue);
+  for (int firstSlice = 0; firstSlice < outputDimensions[2]; firstSlice += numberOfSlicesPerSlab)
+    {
+    const int numberOfSlices = std::min(numberOfSlicesPerSlab, outputDimensions[2] - firstSlice);
+    const int lastSlice = firstSlice + numberOfSlices - 1;
+    int slabCoarseExtent[6] = { 0, coarseDimensions[0] - 1, 0, coarseDimensions[1] - 1,
+      firstSlice / subsampling, std::min(lastSlice / subsampling + 1, coarseDimensions[2] - 1) };
+    if (!transformNode->ComputeDisplacementField(coarseIJKToRAS.GetPointer(), slabCoarseExtent,
+      slabDisplacementField.GetPointer(), false))
+      {
+      vtkErrorMacro("vtkSlicerTransformLogic::HardenVolumeTransform failed: displacement field computation failed");
+      return false;
+      }
+    functor.SetSlab(static_cast<float*>(slabDisplacementField->GetScalarPointer()), firstSlice, slabCoarseExtent[4]);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfSlices) * outputDimensions[1], functor);
+    progress = static_cast<double>(lastSlice + 1) / outputDimensions[2];
+    this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    }
+
+  // Perform image data and origin update in one step
+  int wasModified = volumeNode->StartModify();
+  volumeNode->SetOrigin(outputOrigin_RAS[0], outputOrigin_RAS[1], outputOrigin_RAS[2]);
+  volumeNode->SetAndObserveImageData(outputImage.GetPointer());
+  volumeNode->SetAndObserveTransformNodeID(NULL);
+  volumeNode->EndModify(wasModified);
+  return true;
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLTransformNode* vtkSlicerTransformLogic::AddTransform(const char* filename, vtkMRMLScene *scene)
 {
@@ -210,21 +598,12 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
   vtkMRMLTransformNode* inputTransformNode, vtkMatrix4x4* gridToRAS, int* gridSize,
   bool transformToWorld /* = true */)
 {
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
-  {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
-  }
   // Generate sample point set on a grid
+  // (displacements are computed for all the points at once in GetTransformedPointSamples)
   vtkNew<vtkPoints> samplePositions_RAS;
   int numOfSamples = gridSize[0] * gridSize[1] * gridSize[2];
   samplePositions_RAS->SetNumberOfPoints(numOfSamples);
   double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
   double point_Grid[4] = { 0, 0, 0, 1 };
   int sampleIndex = 0;
   for (point_Grid[2] = 0; point_Grid[2]<gridSize[2]; point_Grid[2]++)
@@ -234,7 +613,6 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
       for (point_Grid[0] = 0; point_Grid[0]<gridSize[0]; point_Grid[0]++)
         {
         gridToRAS->MultiplyPoint(point_Grid, point_RAS);
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
         samplePositions_RAS->SetPoint(sampleIndex, point_RAS[0], point_RAS[1], point_RAS[2]);
         sampleIndex++;
         }
@@ -272,19 +650,22 @@ void vtkSlicerTransformLogic::GetTransformedPointSamples(vtkPointSet* outputPoin
     inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
     }
 
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
+  // Transform all the points at once (in parallel)
+  std::vector<double> points_RAS(3 * numOfSamples);
   for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++)
     {
-    double* point_RAS = samplePositions_RAS->GetPoint(sampleIndex);
-
-    inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-    pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-    pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-    pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
+    samplePositions_RAS->GetPoint(sampleIndex, &(points_RAS[3 * sampleIndex]));
+    }
+  std::vector<double> transformedPoints_RAS(3 * numOfSamples);
+  if (numOfSamples > 0)
+    {
+    vtkMRMLTransformNode::TransformPointArray(inputTransform.GetPointer(), &(points_RAS[0]), &(transformedPoints_RAS[0]), numOfSamples);
+    }
 
-    sampleVectors_RAS->SetTuple3(sampleIndex, pointDislocationVector_RAS[0], pointDislocationVector_RAS[1], pointDislocationVector_RAS[2]);
+  double* pointDislocationVector_RAS = (numOfSamples > 0 ? sampleVectors_RAS->GetPointer(0) : NULL);
+  for (int componentIndex = 0; componentIndex < 3 * numOfSamples; componentIndex++)
+    {
+    pointDislocationVector_RAS[componentIndex] = transformedPoints_RAS[componentIndex] - points_RAS[componentIndex];
     }
 
   outputPointSet->SetPoints(samplePositions_RAS);
@@ -394,14 +775,14 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(vtkImag
     return false;
   }
 
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
+  // Displacement field is cached in the transform node, so repeated requests
+  // with the same geometry do not require evaluating the transform again.
+  int* extent = magnitudeImage->GetExtent();
+  vtkImageData* displacementField = inputTransformNode->GetCachedDisplacementField(ijkToRAS, extent, transformToWorld);
+  if (!displacementField)
   {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
+    vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage failed: cannot compute displacement field");
+    return false;
   }
 
   // The orientation of the volume cannot be set in the image
@@ -409,34 +790,16 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsMagnitudeImage(vtkImag
   // if the direction matrix is not identity.
   magnitudeImage->AllocateScalars(VTK_FLOAT, 1);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double pointDislocationVector_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
   float* voxelPtr = static_cast<float*>(magnitudeImage->GetScalarPointer());
-  int* extent = magnitudeImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
+  float* displacementPtr = static_cast<float*>(displacementField->GetScalarPointer());
+  vtkIdType numberOfVoxels = magnitudeImage->GetNumberOfPoints();
+  for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; voxelIndex++)
   {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        pointDislocationVector_RAS[0] = transformedPoint_RAS[0] - point_RAS[0];
-        pointDislocationVector_RAS[1] = transformedPoint_RAS[1] - point_RAS[1];
-        pointDislocationVector_RAS[2] = transformedPoint_RAS[2] - point_RAS[2];
-
-        float mag = sqrt(
-          pointDislocationVector_RAS[0] * pointDislocationVector_RAS[0] +
-          pointDislocationVector_RAS[1] * pointDislocationVector_RAS[1] +
-          pointDislocationVector_RAS[2] * pointDislocationVector_RAS[2]);
-
-        *(voxelPtr++) = mag;
-      }
-    }
+    *(voxelPtr++) = sqrt(
+      displacementPtr[0] * displacementPtr[0] +
+      displacementPtr[1] * displacementPtr[1] +
+      displacementPtr[2] * displacementPtr[2]);
+    displacementPtr += 3;
   }
 
   return true;
@@ -688,14 +1051,15 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageDa
     vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage failed: invalid input");
     return false;
   }
-  vtkNew<vtkGeneralTransform> inputTransform;
-  if (transformToWorld)
-  {
-    inputTransformNode->GetTransformToWorld(inputTransform.GetPointer());
-  }
-  else
+
+  // Displacement field is cached in the transform node, so repeated requests
+  // with the same geometry do not require evaluating the transform again.
+  int* extent = vectorImage->GetExtent();
+  vtkImageData* displacementField = inputTransformNode->GetCachedDisplacementField(ijkToRAS, extent, transformToWorld);
+  if (!displacementField)
   {
-    inputTransformNode->GetTransformFromWorld(inputTransform.GetPointer());
+    vtkGenericWarningMacro("vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage failed: cannot compute displacement field");
+    return false;
   }
 
   // The orientation of the volume cannot be set in the image
@@ -703,28 +1067,9 @@ bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageDa
   // if the direction matrix is not identity.
   vectorImage->AllocateScalars(VTK_FLOAT, 3);
 
-  double point_RAS[4] = { 0, 0, 0, 1 };
-  double transformedPoint_RAS[4] = { 0, 0, 0, 1 };
-  double point_IJK[4] = { 0, 0, 0, 1 };
-  float* voxelPtr = static_cast<float*>(vectorImage->GetScalarPointer());
-  int* extent = vectorImage->GetExtent();
-  for (point_IJK[2] = extent[4]; point_IJK[2] <= extent[5]; point_IJK[2]++)
-  {
-    for (point_IJK[1] = extent[2]; point_IJK[1] <= extent[3]; point_IJK[1]++)
-    {
-      for (point_IJK[0] = extent[0]; point_IJK[0] <= extent[1]; point_IJK[0]++)
-      {
-        ijkToRAS->MultiplyPoint(point_IJK, point_RAS);
-
-        inputTransform->TransformPoint(point_RAS, transformedPoint_RAS);
-
-        // store the pointDislocationVector_RAS components in the image
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[0] - point_RAS[0]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[1] - point_RAS[1]);
-        *(voxelPtr++) = static_cast<float>(transformedPoint_RAS[2] - point_RAS[2]);
-      }
-    }
-  }
+  // store the pointDislocationVector_RAS components in the image
+  memcpy(vectorImage->GetScalarPointer(), displacementField->GetScalarPointer(),
+    vectorImage->GetNumberOfPoints() * 3 * sizeof(float));
 
   return true;
 }
@@ -62,8 +62,25 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   /// on success, false otherwise.
   /// This method is kept for backward compatibility only, it is recommended to use
   /// vtkMRMLTransformableNode::HardenTransform() method instead.
+  /// Volume nodes under a non-linear transform are resampled using HardenVolumeTransform.
   static bool hardenTransform(vtkMRMLTransformableNode* node);
 
+  /// Harden the parent transform of a volume node by resampling its voxels.
+  /// If the transform is linear then only the volume geometry (IJK to RAS matrix) is updated.
+  /// If the transform is non-linear then the volume is processed in slabs: the transform chain is sampled
+  /// into a displacement field that covers the slab and then the slab is resampled in parallel.
+  /// Memory usage in addition to the output volume is bounded. By default the displacement field is sampled
+  /// at each output voxel, therefore the result is the same as resampling with the exact transform.
+  /// If displacementFieldSubsampling is larger than 1 then one sample is taken every
+  /// displacementFieldSubsampling voxels along each axis and displacements are interpolated in between,
+  /// which is faster but only approximates the transform.
+  /// The resampled volume extent covers the entire transformed volume.
+  /// interpolationMode can be VTK_NEAREST_INTERPOLATION, VTK_LINEAR_INTERPOLATION, or VTK_CUBIC_INTERPOLATION.
+  /// Progress is reported by invoking vtkCommand::ProgressEvent with a pointer to a double value (0.0-1.0).
+  /// Returns true on success.
+  bool HardenVolumeTransform(vtkMRMLVolumeNode* volumeNode, int interpolationMode = VTK_LINEAR_INTERPOLATION,
+    int displacementFieldSubsampling = 1);
+
   ///
   /// Read transform from file
   vtkMRMLTransformNode* AddTransform (const char* filename, vtkMRMLScene *scene);
@@ -14,6 +14,9 @@
 
 // STD includes
 #include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
 
 // Volumes includes
 #include "vtkSlicerVolumesLogic.h"
@@ -35,6 +38,7 @@
 #include "vtkMRMLLabelMapVolumeNode.h"
 #include "vtkMRMLNRRDStorageNode.h"
 #include "vtkMRMLScene.h"
+#include "vtkMRMLSliceCompositeNode.h"
 #include "vtkMRMLVectorVolumeDisplayNode.h"
 #include "vtkMRMLVectorVolumeNode.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
@@ -642,18 +646,8 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     return 0;
     }
 
-  bool labelMap = false;
-  if ( loadingOptions & 1 )    // labelMap is true
-    {
-    labelMap = true;
-    }
-
   this->GetMRMLScene()->SaveStateForUndo();
 
-  vtkSmartPointer<vtkMRMLVolumeNode> volumeNode;
-  vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
-  vtkSmartPointer<vtkMRMLStorageNode> storageNode;
-
   // Compute volume name
   std::string volumeName = volname != NULL ? volname : vtksys::SystemTools::GetFilenameName(filename);
   volumeName = this->GetMRMLScene()->GetUniqueNameByString(volumeName.c_str());
@@ -683,11 +677,48 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
   this->GetApplicationLogic()->SetMRMLSceneDataIO(testScene.GetPointer(),
                                                   remoteIOLogic, dataIOManagerLogic);
 
+  ArchetypeVolumeNodeSet nodeSet = this->ReadArchetypeVolumeNodeSet(volumeRegistry, testScene.GetPointer(),
+    filename, volumeName, loadingOptions, fileList, errorSink.GetPointer(), true);
+
+  // display any errors
+  if (nodeSet.Node == 0)
+    {
+    errorSink->DisplayErrors();
+    }
+
+  vtkMRMLVolumeNode* volumeNode = this->AddNodeSetToScene(nodeSet, filename);
+
+  // clean up the test scene
+  remoteIOLogic->RemoveDataIOFromScene();
+  if (testScene->GetCacheManager())
+    {
+    testScene->SetCacheManager(0);
+    }
+  if (testScene->GetDataIOManager())
+    {
+    testScene->SetDataIOManager(0);
+    }
+
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+ArchetypeVolumeNodeSet vtkSlicerVolumesLogic::ReadArchetypeVolumeNodeSet(
+    const NodeSetFactoryRegistry& volumeRegistry, vtkMRMLScene* scene,
+    const char* filename, std::string& volumeName, int loadingOptions,
+    vtkStringArray *fileList, vtkCommand* errorSink, bool reportProgress)
+{
+  bool labelMap = false;
+  if ( loadingOptions & 1 )    // labelMap is true
+    {
+    labelMap = true;
+    }
+
   // Run through the factory list and test each factory until success
   for (NodeSetFactoryRegistry::const_iterator fit = volumeRegistry.begin();
        fit != volumeRegistry.end(); ++fit)
     {
-    ArchetypeVolumeNodeSet nodeSet( (*fit)(volumeName, testScene.GetPointer(), loadingOptions) );
+    ArchetypeVolumeNodeSet nodeSet( (*fit)(volumeName, scene, loadingOptions) );
 
     // if the labelMap flags for reader and factory are consistent
     // (both true or both false)
@@ -695,10 +726,15 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
       {
 
       // connect the observers
-      nodeSet.StorageNode->AddObserver(vtkCommand::ErrorEvent, errorSink.GetPointer());
-      nodeSet.StorageNode->AddObserver(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
+      nodeSet.StorageNode->AddObserver(vtkCommand::ErrorEvent, errorSink);
+      if (reportProgress)
+        {
+        // The callback command is shared by the logic, it is only observed when reading
+        // on the main thread (progress events would be invoked on the logic from the reading thread)
+        nodeSet.StorageNode->AddObserver(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
+        }
 
-      this->InitializeStorageNode(nodeSet.StorageNode, filename, fileList, testScene.GetPointer());
+      this->InitializeStorageNode(nodeSet.StorageNode, filename, fileList, scene);
 
       vtkDebugMacro("Attempt to read file as a volume of type "
                     << nodeSet.Node->GetNodeTagName() << " using "
@@ -706,17 +742,17 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
       bool success = nodeSet.StorageNode->ReadData(nodeSet.Node);
 
       // disconnect the observers
-      nodeSet.StorageNode->RemoveObservers(vtkCommand::ErrorEvent, errorSink.GetPointer());
-      nodeSet.StorageNode->RemoveObservers(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
+      nodeSet.StorageNode->RemoveObservers(vtkCommand::ErrorEvent, errorSink);
+      if (reportProgress)
+        {
+        nodeSet.StorageNode->RemoveObservers(vtkCommand::ProgressEvent,  this->GetMRMLNodesCallbackCommand());
+        }
 
       if (success)
         {
-        displayNode = nodeSet.DisplayNode;
-        volumeNode =  nodeSet.Node;
-        storageNode = nodeSet.StorageNode;
         vtkDebugMacro(<< "File successfully read as " << nodeSet.Node->GetNodeTagName()
                       << " [filename = " << filename << "]");
-        break;
+        return nodeSet;
         }
       }
 
@@ -727,60 +763,105 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     // clean up the scene
     nodeSet.Node->SetAndObserveDisplayNodeID(NULL);
     nodeSet.Node->SetAndObserveStorageNodeID(NULL);
-    testScene->RemoveNode(nodeSet.DisplayNode);
-    testScene->RemoveNode(nodeSet.StorageNode);
-    testScene->RemoveNode(nodeSet.Node);
+    scene->RemoveNode(nodeSet.DisplayNode);
+    scene->RemoveNode(nodeSet.StorageNode);
+    scene->RemoveNode(nodeSet.Node);
     }
 
-  // display any errors
-  if (volumeNode == 0)
+  // none of the factories could read the file
+  ArchetypeVolumeNodeSet emptyNodeSet(scene);
+  emptyNodeSet.LabelMap = labelMap;
+  return emptyNodeSet;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddNodeSetToScene(ArchetypeVolumeNodeSet& nodeSet, const char* filename)
+{
+  if (nodeSet.Node == NULL)
     {
-    errorSink->DisplayErrors();
+    return NULL;
     }
+  vtkMRMLVolumeNode* volumeNode = nodeSet.Node;
+  vtkMRMLVolumeDisplayNode* displayNode = nodeSet.DisplayNode;
+  vtkMRMLStorageNode* storageNode = nodeSet.StorageNode;
 
+  // move the nodes from the test scene to the main one, removing from the
+  // test scene first to avoid missing ID/reference errors and to fix a
+  // problem found in testing an extension where the RAS to IJK matrix
+  /// was reset to identity.
+  nodeSet.Scene->RemoveNode(displayNode);
+  nodeSet.Scene->RemoveNode(storageNode);
+  nodeSet.Scene->RemoveNode(volumeNode);
+  this->GetMRMLScene()->AddNode(displayNode);
+  this->GetMRMLScene()->AddNode(storageNode);
+  this->GetMRMLScene()->AddNode(volumeNode);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
 
-  bool modified = false;
-  if (volumeNode != NULL)
-    {
-    // move the nodes from the test scene to the main one, removing from the
-    // test scene first to avoid missing ID/reference errors and to fix a
-    // problem found in testing an extension where the RAS to IJK matrix
-    /// was reset to identity.
-    testScene->RemoveNode(displayNode);
-    testScene->RemoveNode(storageNode);
-    testScene->RemoveNode(volumeNode);
-    this->GetMRMLScene()->AddNode(displayNode);
-    this->GetMRMLScene()->AddNode(storageNode);
-    this->GetMRMLScene()->AddNode(volumeNode);
-    volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
-    volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  this->SetAndObserveColorToDisplayNode(displayNode, nodeSet.LabelMap, filename);
 
-    this->SetAndObserveColorToDisplayNode(displayNode, labelMap, filename);
+  vtkDebugMacro("Name vol node "<<volumeNode->GetClassName());
+  vtkDebugMacro("Display node "<<displayNode->GetClassName());
 
-    vtkDebugMacro("Name vol node "<<volumeNode->GetClassName());
-    vtkDebugMacro("Display node "<<displayNode->GetClassName());
+  this->SetActiveVolumeNode(volumeNode);
 
-    this->SetActiveVolumeNode(volumeNode);
+  this->Modified();
+  return volumeNode;
+}
 
-    modified = true;
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesLogic::InitializeReadArchetypeVolumeScene(vtkMRMLScene* scene)
+{
+  if (scene == NULL || this->GetMRMLScene() == NULL)
+    {
+    return;
     }
+  this->GetMRMLScene()->CopyDefaultNodesToScene(scene);
+}
 
-  // clean up the test scene
-  remoteIOLogic->RemoveDataIOFromScene();
-  if (testScene->GetCacheManager())
+//----------------------------------------------------------------------------
+ArchetypeVolumeNodeSet vtkSlicerVolumesLogic::ReadArchetypeVolume(vtkMRMLScene* scene,
+  const char* filename, int loadingOptions, vtkStringArray *fileList)
+{
+  if (scene == NULL)
     {
-    testScene->SetCacheManager(0);
+    // no error macro, this may be called from a worker thread
+    return ArchetypeVolumeNodeSet(scene);
     }
-  if (testScene->GetDataIOManager())
+
+  // The name is set when the volume is added to the scene
+  std::string volumeName = vtksys::SystemTools::GetFilenameName(filename);
+
+  vtkNew<vtkSlicerErrorSink> errorSink;
+
+  // errors are not displayed, the file is read again (reporting errors) when the volume is added
+  return this->ReadArchetypeVolumeNodeSet(this->VolumeRegistry, scene,
+    filename, volumeName, loadingOptions, fileList, errorSink.GetPointer(), false);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddPreparedArchetypeVolume(
+  ArchetypeVolumeNodeSet& nodeSet, const char* filename, const char* volname)
+{
+  if (this->GetMRMLScene() == 0)
     {
-    testScene->SetDataIOManager(0);
+    vtkErrorMacro("AddPreparedArchetypeVolume: Failed to add volume - MRMLScene is null");
+    return 0;
     }
-
-  if (modified)
+  if (nodeSet.Node == 0)
     {
-    this->Modified();
+    vtkErrorMacro("AddPreparedArchetypeVolume: Failed to add volume - invalid node set");
+    return 0;
     }
-  return volumeNode;
+
+  this->GetMRMLScene()->SaveStateForUndo();
+
+  // Compute volume name
+  std::string volumeName = volname != NULL ? volname : vtksys::SystemTools::GetFilenameName(filename);
+  volumeName = this->GetMRMLScene()->GetUniqueNameByString(volumeName.c_str());
+  nodeSet.Node->SetName(volumeName.c_str());
+
+  return this->AddNodeSetToScene(nodeSet, filename);
 }
 
 //----------------------------------------------------------------------------
@@ -1449,6 +1530,57 @@ void vtkSlicerVolumesLogic
   origin[2] = -0.5 * rasCorner[2];
 }
 
+//-------------------------------------------------------------------------
+int vtkSlicerVolumesLogic::ReleaseDeferredImageData(bool onlyHiddenVolumes)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (!scene)
+    {
+    return 0;
+    }
+
+  std::set<std::string> shownVolumeIDs;
+  if (onlyHiddenVolumes)
+    {
+    std::vector<vtkMRMLNode*> sliceCompositeNodes;
+    scene->GetNodesByClass("vtkMRMLSliceCompositeNode", sliceCompositeNodes);
+    for (std::vector<vtkMRMLNode*>::iterator it = sliceCompositeNodes.begin(); it != sliceCompositeNodes.end(); ++it)
+      {
+      vtkMRMLSliceCompositeNode* sliceCompositeNode = vtkMRMLSliceCompositeNode::SafeDownCast(*it);
+      const char* volumeIDs[3] = { sliceCompositeNode->GetBackgroundVolumeID(),
+        sliceCompositeNode->GetForegroundVolumeID(), sliceCompositeNode->GetLabelVolumeID() };
+      for (int i = 0; i < 3; i++)
+        {
+        if (volumeIDs[i])
+          {
+          shownVolumeIDs.insert(volumeIDs[i]);
+          }
+        }
+      }
+    }
+
+  int numberOfReleasedVolumes = 0;
+  std::vector<vtkMRMLNode*> volumeNodes;
+  scene->GetNodesByClass("vtkMRMLVolumeNode", volumeNodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = volumeNodes.begin(); it != volumeNodes.end(); ++it)
+    {
+    vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(*it);
+    if (!volumeNode || !volumeNode->GetImageDataDeferred())
+      {
+      continue;
+      }
+    if (shownVolumeIDs.find(volumeNode->GetID()) != shownVolumeIDs.end())
+      {
+      continue;
+      }
+    if (volumeNode->ReleaseDeferredImageData())
+      {
+      numberOfReleasedVolumes++;
+      }
+    }
+  return numberOfReleasedVolumes;
+}
+
 //-------------------------------------------------------------------------
 void vtkSlicerVolumesLogic::TranslateFreeSurferRegistrationMatrixIntoSlicerRASToRASMatrix( vtkMRMLVolumeNode *V1Node,
                                                                        vtkMRMLVolumeNode *V2Node,
@@ -35,6 +35,7 @@
 
 #include "vtkSlicerVolumesModuleLogicExport.h"
 
+class vtkCommand;
 class vtkMRMLLabelMapVolumeNode;
 class vtkMRMLScalarVolumeNode;
 class vtkMRMLScalarVolumeDisplayNode;
@@ -133,6 +134,28 @@ public:
     return this->AddArchetypeVolume( filename, volname, 0, NULL);
     }
 
+  /// Copy the default nodes of the main scene into \a scene, so that it can be used
+  /// for reading a volume by ReadArchetypeVolume.
+  /// Must be called from the main thread.
+  /// \sa ReadArchetypeVolume
+  void InitializeReadArchetypeVolumeScene(vtkMRMLScene* scene);
+
+  /// Read a volume file into a node set (volume, display and storage node) that is not added to the scene.
+  /// The nodes are created in \a scene, which must not be used by anything else while the volume is read
+  /// and must be initialized by InitializeReadArchetypeVolumeScene on the main thread.
+  /// Neither the main scene nor the logic is modified and progress events are not invoked, therefore the method
+  /// can be called from a worker thread, for example to decode multiple files in parallel.
+  /// Only local files are supported. The returned node set has no volume node if reading failed.
+  /// \sa AddPreparedArchetypeVolume
+  ArchetypeVolumeNodeSet ReadArchetypeVolume(vtkMRMLScene* scene, const char* filename, int loadingOptions,
+    vtkStringArray *fileList);
+
+  /// Add a volume that was read by ReadArchetypeVolume to the scene.
+  /// Must be called from the main thread.
+  /// \sa ReadArchetypeVolume
+  vtkMRMLVolumeNode* AddPreparedArchetypeVolume(ArchetypeVolumeNodeSet& nodeSet,
+    const char* filename, const char* volname);
+
   /// Load a scalar volume function directly, bypassing checks of all factories done in AddArchetypeVolume.
   /// \sa AddArchetypeVolume(const NodeSetFactoryRegistry& volumeRegistry, const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
   vtkMRMLScalarVolumeNode* AddArchetypeScalarVolume(const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList);
@@ -267,6 +290,14 @@ public:
   /// \sa CenterVolume()
   void GetVolumeCenteredOrigin(vtkMRMLVolumeNode *volumeNode, double* origin);
 
+  /// Free voxels of volumes that were read with deferred reading
+  /// (see vtkMRMLVolumeArchetypeStorageNode::SetDeferredRead) to reduce memory usage.
+  /// Voxels are read again from file when they are needed.
+  /// If onlyHiddenVolumes is true then volumes that are shown in any slice view are kept.
+  /// Returns the number of volumes whose voxels were released.
+  /// \sa vtkMRMLVolumeNode::ReleaseDeferredImageData()
+  int ReleaseDeferredImageData(bool onlyHiddenVolumes = true);
+
   ///  Convenience method to resample input volume using reference volume info
   /// \sa CompareVolumeGeometry
   static vtkMRMLScalarVolumeNode* ResampleVolumeToReferenceVolume(vtkMRMLVolumeNode *inputVolumeNode,
@@ -314,6 +345,18 @@ protected:
       const char* filename, const char* volname, int loadingOptions,
       vtkStringArray *fileList);
 
+  /// Try the factories of \a volumeRegistry until one of them can read the file into \a scene.
+  /// Returns a node set without volume node if none of them succeeded.
+  /// Progress events of the storage node are forwarded by the logic only if \a reportProgress
+  /// is true, which must not be used when reading on a worker thread.
+  ArchetypeVolumeNodeSet ReadArchetypeVolumeNodeSet(
+      const NodeSetFactoryRegistry& volumeRegistry, vtkMRMLScene* scene,
+      const char* filename, std::string& volumeName, int loadingOptions,
+      vtkStringArray *fileList, vtkCommand* errorSink, bool reportProgress);
+
+  /// Move the nodes of a successfully read node set into the main scene
+  vtkMRMLVolumeNode* AddNodeSetToScene(ArchetypeVolumeNodeSet& nodeSet, const char* filename);
+
 protected:
   vtkSmartPointer<vtkMRMLVolumeNode> ActiveVolumeNode;
 
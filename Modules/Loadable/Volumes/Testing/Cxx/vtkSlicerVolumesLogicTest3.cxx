@@ -0,0 +1,178 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Volumes logic
+#include "vtkSlicerVolumesLogic.h"
+#include "vtkMRMLCoreTestingMacros.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkAddonMathUtilities.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+
+// STD includes
+#include <cstring>
+#include <vector>
+
+// Volumes are read concurrently with vtkSlicerVolumesLogic::ReadArchetypeVolume (as the parallel
+// load mode of the IO manager does) and compared with the same volumes loaded sequentially
+// with vtkSlicerVolumesLogic::AddArchetypeVolume.
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+struct ConcurrentReadInfo
+{
+  vtkSlicerVolumesLogic* Logic;
+  std::vector<std::string> FileNames;
+  std::vector<vtkSmartPointer<vtkMRMLScene> > Scenes;
+  std::vector<ArchetypeVolumeNodeSet> NodeSets;
+};
+
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE ReadVolumeThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ConcurrentReadInfo* info = static_cast<ConcurrentReadInfo*>(threadInfo->UserData);
+  int fileIndex = threadInfo->ThreadID;
+  if (fileIndex < static_cast<int>(info->FileNames.size()))
+    {
+    info->NodeSets[fileIndex] = info->Logic->ReadArchetypeVolume(info->Scenes[fileIndex],
+      info->FileNames[fileIndex].c_str(), 0, NULL);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+bool AreVolumesEqual(vtkMRMLVolumeNode* volume, vtkMRMLVolumeNode* referenceVolume)
+{
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  volume->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  vtkNew<vtkMatrix4x4> referenceIJKToRAS;
+  referenceVolume->GetIJKToRASMatrix(referenceIJKToRAS.GetPointer());
+  if (!vtkAddonMathUtilities::MatrixAreEqual(ijkToRAS.GetPointer(), referenceIJKToRAS.GetPointer()))
+    {
+    std::cerr << "IJK to RAS matrix mismatch" << std::endl;
+    return false;
+    }
+  vtkImageData* image = volume->GetImageData();
+  vtkImageData* referenceImage = referenceVolume->GetImageData();
+  if (!image || !referenceImage)
+    {
+    std::cerr << "Missing image data" << std::endl;
+    return false;
+    }
+  int* extent = image->GetExtent();
+  int* referenceExtent = referenceImage->GetExtent();
+  for (int i = 0; i < 6; i++)
+    {
+    if (extent[i] != referenceExtent[i])
+      {
+      std::cerr << "Extent mismatch" << std::endl;
+      return false;
+      }
+    }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  vtkDataArray* referenceScalars = referenceImage->GetPointData()->GetScalars();
+  if (scalars->GetDataType() != referenceScalars->GetDataType()
+    || scalars->GetNumberOfComponents() != referenceScalars->GetNumberOfComponents()
+    || scalars->GetNumberOfTuples() != referenceScalars->GetNumberOfTuples())
+    {
+    std::cerr << "Scalar type or size mismatch" << std::endl;
+    return false;
+    }
+  size_t size = static_cast<size_t>(scalars->GetNumberOfTuples()) * scalars->GetNumberOfComponents() * scalars->GetDataTypeSize();
+  if (memcmp(scalars->GetVoidPointer(0), referenceScalars->GetVoidPointer(0), size) != 0)
+    {
+    std::cerr << "Voxel values mismatch" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerVolumesLogicTest3(int argc, char * argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: vtkSlicerVolumesLogicTest3 volumeName1 [volumeName2 ...]"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkSlicerVolumesLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+
+  // Read each file multiple times to have more concurrent reads than files
+  const int numberOfReadsPerFile = 3;
+  ConcurrentReadInfo info;
+  info.Logic = logic.GetPointer();
+  for (int readIndex = 0; readIndex < numberOfReadsPerFile; readIndex++)
+    {
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+      {
+      info.FileNames.push_back(argv[argIndex]);
+      // Scenes are initialized on the main thread, the main scene is not accessed by the reading threads
+      vtkSmartPointer<vtkMRMLScene> readScene = vtkSmartPointer<vtkMRMLScene>::New();
+      logic->InitializeReadArchetypeVolumeScene(readScene);
+      info.Scenes.push_back(readScene);
+      info.NodeSets.push_back(ArchetypeVolumeNodeSet(NULL));
+      }
+    }
+  int numberOfFiles = static_cast<int>(info.FileNames.size());
+
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(numberOfFiles);
+  threader->SetSingleMethod(ReadVolumeThreadFunction, &info);
+  threader->SingleMethodExecute();
+
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLScalarVolumeNode"), 0);
+
+  for (int fileIndex = 0; fileIndex < numberOfFiles; fileIndex++)
+    {
+    const char* fileName = info.FileNames[fileIndex].c_str();
+    CHECK_NOT_NULL(info.NodeSets[fileIndex].Node.GetPointer());
+    vtkMRMLVolumeNode* concurrentVolume = logic->AddPreparedArchetypeVolume(info.NodeSets[fileIndex], fileName, "concurrent");
+    CHECK_NOT_NULL(concurrentVolume);
+    CHECK_POINTER(concurrentVolume->GetScene(), scene.GetPointer());
+    vtkMRMLVolumeNode* sequentialVolume = logic->AddArchetypeVolume(fileName, "sequential", 0);
+    CHECK_NOT_NULL(sequentialVolume);
+    CHECK_STRING(concurrentVolume->GetClassName(), sequentialVolume->GetClassName());
+    CHECK_BOOL(AreVolumesEqual(concurrentVolume, sequentialVolume), true);
+    }
+
+  return EXIT_SUCCESS;
+}
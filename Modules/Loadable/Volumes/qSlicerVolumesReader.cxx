@@ -20,6 +20,10 @@
 
 // Qt includes
 #include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
 
 // SlicerQt includes
 #include "qSlicerVolumesIOOptionsWidget.h"
@@ -33,6 +37,7 @@
 #include <vtkMRMLDisplayNode.h>
 #include <vtkMRMLLabelMapVolumeNode.h>
 #include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
 #include <vtkMRMLSelectionNode.h>
 
 // VTK includes
@@ -44,8 +49,91 @@ class qSlicerVolumesReaderPrivate
 {
   public:
   vtkSmartPointer<vtkSlicerVolumesLogic> Logic;
+
+  /// Return and forget the node set prepared for the properties, null if none
+  QSharedPointer<ArchetypeVolumeNodeSet> takePreparedNodeSet(const qSlicerIO::IOProperties& properties);
+
+  /// Return and forget the scene initialized for reading the volume, null if none
+  vtkSmartPointer<vtkMRMLScene> takePreparedScene(const qSlicerIO::IOProperties& properties);
+
+  /// Node sets read by prepareLoad(), indexed by preparedNodeSetKey()
+  QMap<QString, QSharedPointer<ArchetypeVolumeNodeSet> > PreparedNodeSets;
+  /// Scenes initialized by initializePrepareLoad() on the main thread, indexed by preparedNodeSetKey()
+  QMap<QString, vtkSmartPointer<vtkMRMLScene> > PreparedScenes;
+  QMutex PreparedNodeSetsMutex;
 };
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int loadingOptions(const qSlicerIO::IOProperties& properties)
+{
+  int options = 0;
+  if (properties.contains("labelmap"))
+    {
+    options |= properties["labelmap"].toBool() ? 0x1 : 0x0;
+    }
+  if (properties.contains("center"))
+    {
+    options |= properties["center"].toBool() ? 0x2 : 0x0;
+    }
+  if (properties.contains("singleFile"))
+    {
+    options |= properties["singleFile"].toBool() ? 0x4 : 0x0;
+    }
+  if (properties.contains("autoWindowLevel"))
+    {
+    options |= properties["autoWindowLevel"].toBool() ? 0x8: 0x0;
+    }
+  if (properties.contains("discardOrientation"))
+    {
+    options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
+    }
+  return options;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkStringArray> loadingFileList(const qSlicerIO::IOProperties& properties)
+{
+  vtkSmartPointer<vtkStringArray> fileList;
+  if (properties.contains("fileNames"))
+    {
+    fileList = vtkSmartPointer<vtkStringArray>::New();
+    foreach(QString file, properties["fileNames"].toStringList())
+      {
+      fileList->InsertNextValue(file.toLatin1());
+      }
+    }
+  return fileList;
+}
+
+//-----------------------------------------------------------------------------
+QString preparedNodeSetKey(const qSlicerIO::IOProperties& properties)
+{
+  return QString("%1|%2|%3").arg(loadingOptions(properties))
+    .arg(properties["fileName"].toString())
+    .arg(properties["fileNames"].toStringList().join("|"));
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+QSharedPointer<ArchetypeVolumeNodeSet> qSlicerVolumesReaderPrivate::takePreparedNodeSet(
+  const qSlicerIO::IOProperties& properties)
+{
+  QMutexLocker locker(&this->PreparedNodeSetsMutex);
+  return this->PreparedNodeSets.take(preparedNodeSetKey(properties));
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLScene> qSlicerVolumesReaderPrivate::takePreparedScene(
+  const qSlicerIO::IOProperties& properties)
+{
+  QMutexLocker locker(&this->PreparedNodeSetsMutex);
+  return this->PreparedScenes.take(preparedNodeSetKey(properties));
+}
+
 //-----------------------------------------------------------------------------
 qSlicerVolumesReader::qSlicerVolumesReader(QObject* _parent)
   : Superclass(_parent)
@@ -124,47 +212,28 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     {
     name = properties["name"].toString();
     }
-  int options = 0;
-  if (properties.contains("labelmap"))
-    {
-    options |= properties["labelmap"].toBool() ? 0x1 : 0x0;
-    }
-  if (properties.contains("center"))
-    {
-    options |= properties["center"].toBool() ? 0x2 : 0x0;
-    }
-  if (properties.contains("singleFile"))
-    {
-    options |= properties["singleFile"].toBool() ? 0x4 : 0x0;
-    }
-  if (properties.contains("autoWindowLevel"))
-    {
-    options |= properties["autoWindowLevel"].toBool() ? 0x8: 0x0;
-    }
-  if (properties.contains("discardOrientation"))
-    {
-    options |= properties["discardOrientation"].toBool() ? 0x10 : 0x0;
-    }
   bool propagateVolumeSelection = true;
   if (properties.contains("show"))
     {
     propagateVolumeSelection = properties["show"].toBool();
     }
-  vtkSmartPointer<vtkStringArray> fileList;
-  if (properties.contains("fileNames"))
+  Q_ASSERT(d->Logic);
+  vtkMRMLVolumeNode* node = 0;
+  QSharedPointer<ArchetypeVolumeNodeSet> preparedNodeSet = d->takePreparedNodeSet(properties);
+  if (!preparedNodeSet.isNull())
     {
-    fileList = vtkSmartPointer<vtkStringArray>::New();
-    foreach(QString file, properties["fileNames"].toStringList())
-      {
-      fileList->InsertNextValue(file.toLatin1());
-      }
+    node = d->Logic->AddPreparedArchetypeVolume(*preparedNodeSet,
+      fileName.toLatin1(), name.toLatin1());
+    }
+  if (!node)
+    {
+    vtkSmartPointer<vtkStringArray> fileList = loadingFileList(properties);
+    node = d->Logic->AddArchetypeVolume(
+      fileName.toLatin1(),
+      name.toLatin1(),
+      loadingOptions(properties),
+      fileList.GetPointer());
     }
-  Q_ASSERT(d->Logic);
-  vtkMRMLVolumeNode* node = d->Logic->AddArchetypeVolume(
-    fileName.toLatin1(),
-    name.toLatin1(),
-    options,
-    fileList.GetPointer());
   if (node)
     {
     if (properties.contains("colorNodeID"))
@@ -205,3 +274,56 @@ bool qSlicerVolumesReader::load(const IOProperties& properties)
     }
   return node != 0;
 }
+
+//-----------------------------------------------------------------------------
+bool qSlicerVolumesReader::prepareLoad(const IOProperties& properties)
+{
+  Q_D(qSlicerVolumesReader);
+  QString fileName = properties["fileName"].toString();
+  if (!d->Logic || !QFileInfo(fileName).isFile())
+    {
+    // only local files are prepared, remote files are downloaded in load()
+    return false;
+    }
+  vtkSmartPointer<vtkMRMLScene> scene = d->takePreparedScene(properties);
+  if (!scene)
+    {
+    // initializePrepareLoad() was not called, default nodes are not available
+    return false;
+    }
+  vtkSmartPointer<vtkStringArray> fileList = loadingFileList(properties);
+  QSharedPointer<ArchetypeVolumeNodeSet> nodeSet(new ArchetypeVolumeNodeSet(
+    d->Logic->ReadArchetypeVolume(scene, fileName.toLatin1(), loadingOptions(properties), fileList.GetPointer())));
+  if (!nodeSet->Node)
+    {
+    // errors are reported when the file is read again in load()
+    return false;
+    }
+  QMutexLocker locker(&d->PreparedNodeSetsMutex);
+  d->PreparedNodeSets[preparedNodeSetKey(properties)] = nodeSet;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerVolumesReader::initializePrepareLoad(const IOProperties& properties)
+{
+  Q_D(qSlicerVolumesReader);
+  if (!d->Logic)
+    {
+    return;
+    }
+  // Default nodes are copied here, on the main thread, as the main scene must not
+  // be accessed by prepareLoad()
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  d->Logic->InitializeReadArchetypeVolumeScene(scene);
+  QMutexLocker locker(&d->PreparedNodeSetsMutex);
+  d->PreparedScenes[preparedNodeSetKey(properties)] = scene;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerVolumesReader::discardPreparedLoad(const IOProperties& properties)
+{
+  Q_D(qSlicerVolumesReader);
+  d->takePreparedNodeSet(properties);
+  d->takePreparedScene(properties);
+}
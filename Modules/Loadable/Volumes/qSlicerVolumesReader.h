@@ -47,6 +47,13 @@ public:
   virtual qSlicerIOOptions* options()const;
 
   virtual bool load(const IOProperties& properties);
+
+  /// Read the volume into nodes that are not in the scene yet, load() only
+  /// adds them to the scene.
+  virtual bool prepareLoad(const IOProperties& properties);
+  virtual void initializePrepareLoad(const IOProperties& properties);
+  virtual void discardPreparedLoad(const IOProperties& properties);
+
 protected:
   QScopedPointer<qSlicerVolumesReaderPrivate> d_ptr;
 
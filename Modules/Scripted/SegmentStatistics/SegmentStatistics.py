@@ -414,9 +414,16 @@ class SegmentStatisticsLogic(ScriptedLoadableModuleLogic):
     if visibleSegmentIds.GetNumberOfValues() == 0:
       logging.debug("computeStatistics will not return any results: there are no visible segments")
 
+    segmentIDs = [visibleSegmentIds.GetValue(segmentIndex) for segmentIndex in range(visibleSegmentIds.GetNumberOfValues())]
+
+    # let plugins compute measurements for all segments at once
+    for plugin in self.plugins:
+      pluginName = plugin.__class__.__name__
+      if self.getParameterNode().GetParameter(pluginName+'.enabled')=='True':
+        plugin.prepareStatistics(segmentIDs)
+
     # update statistics for all segment IDs
-    for segmentIndex in range(visibleSegmentIds.GetNumberOfValues()):
-      segmentID = visibleSegmentIds.GetValue(segmentIndex)
+    for segmentID in segmentIDs:
       self.updateStatisticsForSegment(segmentID)
 
   def updateStatisticsForSegment(self, segmentID):
@@ -11,14 +11,27 @@ class LabelmapSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
     self.keys = ["voxel_count", "volume_mm3", "volume_cm3"]
     self.defaultKeys = self.keys # calculate all measurements by default
     #... developer may add extra options to configure other parameters
+    self.precomputedStatistics = {}
+
+  def prepareStatistics(self, segmentIDs):
+    # statistics of all segments are computed in a single pass
+    self.precomputedStatistics = self.computeStatisticsForSegments(segmentIDs)
 
   def computeStatistics(self, segmentID):
+    if segmentID in self.precomputedStatistics:
+      return self.precomputedStatistics.pop(segmentID)
+    return self.computeStatisticsForSegments([segmentID]).get(segmentID, {})
+
+  def computeStatisticsForSegments(self, segmentIDs):
+    """Compute measurements for requested keys on all the given segments and return
+    as dictionary mapping segment IDs to measurement results
+    """
     import vtkSegmentationCorePython as vtkSegmentationCore
     requestedKeys = self.getRequestedKeys()
 
     segmentationNode = slicer.mrmlScene.GetNodeByID(self.getParameterNode().GetParameter("Segmentation"))
 
-    if len(requestedKeys)==0:
+    if len(requestedKeys)==0 or len(segmentIDs)==0:
       return {}
 
     containsLabelmapRepresentation = segmentationNode.GetSegmentation().ContainsRepresentation(
@@ -26,43 +39,29 @@ class LabelmapSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
     if not containsLabelmapRepresentation:
       return {}
 
-    segment = segmentationNode.GetSegmentation().GetSegment(segmentID)
-    segBinaryLabelName = vtkSegmentationCore.vtkSegmentationConverter.GetSegmentationBinaryLabelmapRepresentationName()
-    segmentLabelmap = segment.GetRepresentation(segBinaryLabelName)
-
-    # We need to know exactly the value of the segment voxels, apply threshold to make force the selected label value
-    labelValue = 1
-    backgroundValue = 0
-    thresh = vtk.vtkImageThreshold()
-    thresh.SetInputData(segmentLabelmap)
-    thresh.ThresholdByLower(0)
-    thresh.SetInValue(backgroundValue)
-    thresh.SetOutValue(labelValue)
-    thresh.SetOutputScalarType(vtk.VTK_UNSIGNED_CHAR)
-    thresh.Update()
-
-    #  Use binary labelmap as a stencil
-    stencil = vtk.vtkImageToImageStencil()
-    stencil.SetInputData(thresh.GetOutput())
-    stencil.ThresholdByUpper(labelValue)
-    stencil.Update()
-
-    stat = vtk.vtkImageAccumulate()
-    stat.SetInputData(thresh.GetOutput())
-    stat.SetStencilData(stencil.GetOutput())
-    stat.Update()
+    # Count voxels of all segments in a single pass
+    calculator = vtkSegmentationCore.vtkCalculateSegmentStatistics()
+    calculator.SetSegmentation(segmentationNode.GetSegmentation())
+    for segmentID in segmentIDs:
+      calculator.AddSegmentID(segmentID)
+    if not calculator.CalculateStatistics():
+      return {}
 
     # Add data to statistics list
-    cubicMMPerVoxel = reduce(lambda x,y: x*y, segmentLabelmap.GetSpacing())
     ccPerCubicMM = 0.001
-    stats = {}
-    if "voxel_count" in requestedKeys:
-      stats["voxel_count"] = stat.GetVoxelCount()
-    if "volume_mm3" in requestedKeys:
-      stats["volume_mm3"] = stat.GetVoxelCount() * cubicMMPerVoxel
-    if "volume_cm3" in requestedKeys:
-      stats["volume_cm3"] = stat.GetVoxelCount() * cubicMMPerVoxel * ccPerCubicMM
-    return stats
+    statistics = {}
+    for segmentID in segmentIDs:
+      if not calculator.HasStatistics(segmentID):
+        continue
+      stats = {}
+      if "voxel_count" in requestedKeys:
+        stats["voxel_count"] = calculator.GetVoxelCount(segmentID)
+      if "volume_mm3" in requestedKeys:
+        stats["volume_mm3"] = calculator.GetVolumeMm3(segmentID)
+      if "volume_cm3" in requestedKeys:
+        stats["volume_cm3"] = calculator.GetVolumeMm3(segmentID) * ccPerCubicMM
+      statistics[segmentID] = stats
+    return statistics
 
   def getMeasurementInfo(self, key):
     """Get information (name, description, units, ...) about the measurement for the given key"""
@@ -11,15 +11,28 @@ class ScalarVolumeSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
     self.keys = ["voxel_count", "volume_mm3", "volume_cm3", "min", "max", "mean", "median", "stdev"]
     self.defaultKeys = self.keys # calculate all measurements by default
     #... developer may add extra options to configure other parameters
+    self.precomputedStatistics = {}
+
+  def prepareStatistics(self, segmentIDs):
+    # statistics of all segments are computed in a single pass
+    self.precomputedStatistics = self.computeStatisticsForSegments(segmentIDs)
 
   def computeStatistics(self, segmentID):
+    if segmentID in self.precomputedStatistics:
+      return self.precomputedStatistics.pop(segmentID)
+    return self.computeStatisticsForSegments([segmentID]).get(segmentID, {})
+
+  def computeStatisticsForSegments(self, segmentIDs):
+    """Compute measurements for requested keys on all the given segments and return
+    as dictionary mapping segment IDs to measurement results
+    """
     import vtkSegmentationCorePython as vtkSegmentationCore
     requestedKeys = self.getRequestedKeys()
 
     segmentationNode = slicer.mrmlScene.GetNodeByID(self.getParameterNode().GetParameter("Segmentation"))
     grayscaleNode = slicer.mrmlScene.GetNodeByID(self.getParameterNode().GetParameter("ScalarVolume"))
 
-    if len(requestedKeys)==0:
+    if len(requestedKeys)==0 or len(segmentIDs)==0:
       return {}
 
     containsLabelmapRepresentation = segmentationNode.GetSegmentation().ContainsRepresentation(
@@ -30,80 +43,57 @@ class ScalarVolumeSegmentStatisticsPlugin(SegmentStatisticsPluginBase):
     if grayscaleNode is None or grayscaleNode.GetImageData() is None:
       return {}
 
-    # Get geometry of grayscale volume node as oriented image data
-    # reference geometry in reference node coordinate system
-    referenceGeometry_Reference = vtkSegmentationCore.vtkOrientedImageData()
-    referenceGeometry_Reference.SetExtent(grayscaleNode.GetImageData().GetExtent())
+    # Get grayscale volume node as oriented image data
+    # in reference node coordinate system
+    grayscaleImage_Reference = vtkSegmentationCore.vtkOrientedImageData()
+    grayscaleImage_Reference.ShallowCopy(grayscaleNode.GetImageData())
     ijkToRasMatrix = vtk.vtkMatrix4x4()
     grayscaleNode.GetIJKToRASMatrix(ijkToRasMatrix)
-    referenceGeometry_Reference.SetGeometryFromImageToWorldMatrix(ijkToRasMatrix)
+    grayscaleImage_Reference.SetGeometryFromImageToWorldMatrix(ijkToRasMatrix)
 
     # Get transform between grayscale volume and segmentation
     segmentationToReferenceGeometryTransform = vtk.vtkGeneralTransform()
     slicer.vtkMRMLTransformNode.GetTransformBetweenNodes(segmentationNode.GetParentTransformNode(),
       grayscaleNode.GetParentTransformNode(), segmentationToReferenceGeometryTransform)
 
-    cubicMMPerVoxel = reduce(lambda x,y: x*y, referenceGeometry_Reference.GetSpacing())
-    ccPerCubicMM = 0.001
+    # Compute statistics of all segments in a single pass
+    calculator = vtkSegmentationCore.vtkCalculateSegmentStatistics()
+    calculator.SetSegmentation(segmentationNode.GetSegmentation())
+    calculator.SetScalarImage(grayscaleImage_Reference)
+    calculator.SetSegmentationToScalarImageTransform(segmentationToReferenceGeometryTransform)
+    for segmentID in segmentIDs:
+      calculator.AddSegmentID(segmentID)
+    if not calculator.CalculateStatistics():
+      return {}
 
-    segment = segmentationNode.GetSegmentation().GetSegment(segmentID)
-    segBinaryLabelName = vtkSegmentationCore.vtkSegmentationConverter.GetSegmentationBinaryLabelmapRepresentationName()
-    segmentLabelmap = segment.GetRepresentation(segBinaryLabelName)
-
-    segmentLabelmap_Reference = vtkSegmentationCore.vtkOrientedImageData()
-    vtkSegmentationCore.vtkOrientedImageDataResample.ResampleOrientedImageToReferenceOrientedImage(
-      segmentLabelmap, referenceGeometry_Reference, segmentLabelmap_Reference,
-      False, # nearest neighbor interpolation
-      False, # no padding
-      segmentationToReferenceGeometryTransform)
-
-    # We need to know exactly the value of the segment voxels, apply threshold to make force the selected label value
-    labelValue = 1
-    backgroundValue = 0
-    thresh = vtk.vtkImageThreshold()
-    thresh.SetInputData(segmentLabelmap_Reference)
-    thresh.ThresholdByLower(0)
-    thresh.SetInValue(backgroundValue)
-    thresh.SetOutValue(labelValue)
-    thresh.SetOutputScalarType(vtk.VTK_UNSIGNED_CHAR)
-    thresh.Update()
-
-    #  Use binary labelmap as a stencil
-    stencil = vtk.vtkImageToImageStencil()
-    stencil.SetInputData(thresh.GetOutput())
-    stencil.ThresholdByUpper(labelValue)
-    stencil.Update()
-
-    stat = vtk.vtkImageAccumulate()
-    stat.SetInputData(grayscaleNode.GetImageData())
-    stat.SetStencilData(stencil.GetOutput())
-    stat.Update()
-
-    medians = vtk.vtkImageHistogramStatistics()
-    medians.SetInputData(grayscaleNode.GetImageData())
-    medians.SetStencilData(stencil.GetOutput())
-    medians.Update()
+    ccPerCubicMM = 0.001
 
     # create statistics list
-    stats = {}
-    if "voxel_count" in requestedKeys:
-      stats["voxel_count"] = stat.GetVoxelCount()
-    if "volume_mm3" in requestedKeys:
-      stats["volume_mm3"] = stat.GetVoxelCount() * cubicMMPerVoxel
-    if "volume_cm3" in requestedKeys:
-      stats["volume_cm3"] = stat.GetVoxelCount() * cubicMMPerVoxel * ccPerCubicMM
-    if stat.GetVoxelCount()>0:
-      if "min" in requestedKeys:
-        stats["min"] = stat.GetMin()[0]
-      if "max" in requestedKeys:
-        stats["max"] = stat.GetMax()[0]
-      if "mean" in requestedKeys:
-        stats["mean"] = stat.GetMean()[0]
-      if "stdev" in requestedKeys:
-        stats["stdev"] = stat.GetStandardDeviation()[0]
-      if "median" in requestedKeys:
-        stats["median"] = medians.GetMedian()
-    return stats
+    statistics = {}
+    for segmentID in segmentIDs:
+      if not calculator.HasStatistics(segmentID):
+        continue
+      stats = {}
+      voxelCount = calculator.GetVoxelCount(segmentID)
+      if "voxel_count" in requestedKeys:
+        stats["voxel_count"] = voxelCount
+      if "volume_mm3" in requestedKeys:
+        stats["volume_mm3"] = calculator.GetVolumeMm3(segmentID)
+      if "volume_cm3" in requestedKeys:
+        stats["volume_cm3"] = calculator.GetVolumeMm3(segmentID) * ccPerCubicMM
+      if voxelCount>0:
+        if "min" in requestedKeys:
+          stats["min"] = calculator.GetMinimum(segmentID)
+        if "max" in requestedKeys:
+          stats["max"] = calculator.GetMaximum(segmentID)
+        if "mean" in requestedKeys:
+          stats["mean"] = calculator.GetMean(segmentID)
+        if "stdev" in requestedKeys:
+          stats["stdev"] = calculator.GetStandardDeviation(segmentID)
+        if "median" in requestedKeys:
+          stats["median"] = calculator.GetMedian(segmentID)
+      statistics[segmentID] = stats
+    return statistics
 
   def getMeasurementInfo(self, key):
     """Get information (name, description, units, ...) about the measurement for the given key""" 
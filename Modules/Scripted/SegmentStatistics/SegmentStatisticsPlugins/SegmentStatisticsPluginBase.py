@@ -55,6 +55,13 @@ class SegmentStatisticsPluginBase(object):
     """
     pass
 
+  def prepareStatistics(self, segmentIDs):
+    """Called before computeStatistics is called for each of the given segments.
+    Plugins that can compute measurements for many segments at once more efficiently
+    may do it here and return the stored results in computeStatistics.
+    """
+    pass
+
   def getMeasurementInfo(self, key):
     """Get information (name, description, units, ...) about the measurement for the given key.
     Utilize createMeasurementInfo() to create the dictionary containing the measurement information.